@@ -35,7 +35,6 @@
 #include "u_math.h"
 #include "u_memory.h"
 #include "u_format.h"
-#include "u_format_s3tc.h"
 #include "u_surface.h"
 
 #include "pipe/p_defines.h"
@@ -191,10 +190,6 @@ util_format_is_intensity(enum pipe_format format)
 boolean
 util_format_is_supported(enum pipe_format format, unsigned bind)
 {
-   if (util_format_is_s3tc(format) && !util_format_s3tc_enabled) {
-      return FALSE;
-   }
-
 #ifndef TEXTURE_FLOAT_ENABLED
    if ((bind & PIPE_BIND_RENDER_TARGET) &&
        format != PIPE_FORMAT_R9G9B9E5_FLOAT &&
@@ -40,12 +40,20 @@ static void u_format_signed_encode_rgtc_ubyte(int8_t *blkaddr, int8_t srccolors[
 static void u_format_signed_fetch_texel_rgtc(unsigned srcRowStride, const int8_t *pixdata,
 					       unsigned i, unsigned j, int8_t *value, unsigned comps);
 
+static void u_format_unsigned_encode_rgtc_ubyte_fast(uint8_t *blkaddr, uint8_t srccolors[4][4],
+						    int numxpixels, int numypixels);
+
+static void u_format_signed_encode_rgtc_ubyte_fast(int8_t *blkaddr, int8_t srccolors[4][4],
+						  int numxpixels, int numypixels);
+
 void
 util_format_latc1_unorm_fetch_rgba_8unorm(uint8_t *dst, const uint8_t *src, unsigned i, unsigned j)
 {
    /* Fix warnings here: */
    (void) u_format_unsigned_encode_rgtc_ubyte;
    (void) u_format_signed_encode_rgtc_ubyte;
+   (void) u_format_unsigned_encode_rgtc_ubyte_fast;
+   (void) u_format_signed_encode_rgtc_ubyte_fast;
 
    u_format_unsigned_fetch_texel_rgtc(0, src, i, j, dst, 1);
    dst[1] = dst[0];
@@ -34,7 +34,6 @@
 #include "util/u_memory.h"
 #include "util/u_inlines.h"
 #include "util/u_format.h"
-#include "util/u_format_s3tc.h"
 #include "util/u_string.h"
 #include "util/u_debug.h"
 
@@ -480,8 +479,6 @@ fd_screen_create(struct fd_device *dev)
 	pscreen->fence_signalled = fd_screen_fence_signalled;
 	pscreen->fence_finish = fd_screen_fence_finish;
 
-	util_format_s3tc_init();
-
 	return pscreen;
 
 fail:
@@ -28,7 +28,6 @@
 
 #include "draw/draw_context.h"
 #include "util/u_format.h"
-#include "util/u_format_s3tc.h"
 #include "util/u_inlines.h"
 #include "util/u_memory.h"
 #include "util/u_string.h"
@@ -512,7 +511,5 @@ i915_screen_create(struct i915_winsys *iws)
 
    i915_debug_init(is);
 
-   util_format_s3tc_init();
-
    return &is->base;
 }
@@ -22,7 +22,6 @@
  * USE OR OTHER DEALINGS IN THE SOFTWARE. */
 
 #include "util/u_format.h"
-#include "util/u_format_s3tc.h"
 #include "util/u_memory.h"
 #include "os/os_time.h"
 #include "vl/vl_decoder.h"
@@ -120,7 +119,7 @@ static int r300_get_param(struct pipe_screen* pscreen, enum pipe_cap param)
 
         /* r300 cannot do swizzling of compressed textures. Supported otherwise. */
         case PIPE_CAP_TEXTURE_SWIZZLE:
-            return util_format_s3tc_enabled ? r300screen->caps.dxtc_swizzle : 1;
+            return r300screen->caps.dxtc_swizzle;
 
         /* We don't support color clamping on r500, so that we can use color
          * intepolators for generic varyings. */
@@ -630,7 +629,6 @@ struct pipe_screen* r300_screen_create(struct radeon_winsys *rws)
 
     r300_init_screen_resource_functions(r300screen);
 
-    util_format_s3tc_init();
     pipe_mutex_init(r300screen->cmask_mutex);
 
     return &r300screen->screen;
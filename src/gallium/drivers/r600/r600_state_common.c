@@ -29,7 +29,6 @@
 #include "r600d.h"
 
 #include "util/u_draw_quad.h"
-#include "util/u_format_s3tc.h"
 #include "util/u_index_modify.h"
 #include "util/u_memory.h"
 #include "util/u_upload_mgr.h"
@@ -1917,10 +1916,6 @@ uint32_t r600_translate_texformat(struct pipe_screen *screen,
 		if (!enable_s3tc)
 			goto out_unknown;
 
-		if (!util_format_s3tc_enabled) {
-			goto out_unknown;
-		}
-
 		switch (format) {
 		case PIPE_FORMAT_DXT1_RGB:
 		case PIPE_FORMAT_DXT1_RGBA:
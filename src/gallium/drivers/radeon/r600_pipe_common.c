@@ -28,7 +28,6 @@
 #include "r600_cs.h"
 #include "tgsi/tgsi_parse.h"
 #include "util/u_memory.h"
-#include "util/u_format_s3tc.h"
 #include "util/u_upload_mgr.h"
 #include "vl/vl_decoder.h"
 #include "vl/vl_video_buffer.h"
@@ -668,7 +667,6 @@ bool r600_common_screen_init(struct r600_common_screen *rscreen,
 	if (!r600_init_tiling(rscreen)) {
 		return false;
 	}
-	util_format_s3tc_init();
 	pipe_mutex_init(rscreen->aux_context_lock);
 
 	if (rscreen->info.drm_minor >= 28 && (rscreen->debug_flags & DBG_TRACE_CS)) {
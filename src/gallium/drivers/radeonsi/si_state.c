@@ -32,7 +32,6 @@
 #include "tgsi/tgsi_parse.h"
 #include "tgsi/tgsi_scan.h"
 #include "util/u_format.h"
-#include "util/u_format_s3tc.h"
 #include "util/u_framebuffer.h"
 #include "util/u_helpers.h"
 #include "util/u_memory.h"
@@ -1099,10 +1098,6 @@ static uint32_t si_translate_texformat(struct pipe_screen *screen,
 		if (!enable_s3tc)
 			goto out_unknown;
 
-		if (!util_format_s3tc_enabled) {
-			goto out_unknown;
-		}
-
 		switch (format) {
 		case PIPE_FORMAT_DXT1_RGB:
 		case PIPE_FORMAT_DXT1_RGBA:
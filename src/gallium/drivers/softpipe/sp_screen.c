@@ -28,7 +28,6 @@
 
 #include "util/u_memory.h"
 #include "util/u_format.h"
-#include "util/u_format_s3tc.h"
 #include "util/u_video.h"
 #include "os/os_time.h"
 #include "pipe/p_defines.h"
@@ -319,10 +318,6 @@ softpipe_is_format_supported( struct pipe_screen *screen,
     * All other operations (sampling, transfer, etc).
     */
 
-   if (format_desc->layout == UTIL_FORMAT_LAYOUT_S3TC) {
-      return util_format_s3tc_enabled;
-   }
-
    /*
     * Everything else should be supported by u_format.
     */
@@ -395,8 +390,6 @@ softpipe_create_screen(struct sw_winsys *winsys)
 
    screen->use_llvm = debug_get_option_use_llvm();
 
-   util_format_s3tc_init();
-
    softpipe_init_screen_texture_funcs(&screen->base);
    softpipe_init_screen_fence_funcs(&screen->base);
 
@@ -244,7 +244,6 @@ struct st_config_options
    boolean disable_shader_bit_encoding;
    boolean force_glsl_extensions_warn;
    unsigned force_glsl_version;
-   boolean force_s3tc_enable;
 };
 
 /**
@@ -384,6 +383,14 @@ struct st_context_iface
    void (*flush)(struct st_context_iface *stctxi, unsigned flags,
                  struct pipe_fence_handle **fence);
 
+   /**
+    * Wait until all GL calls queued for a separate dispatch thread have
+    * been executed, so that the caller can use \c pipe directly.
+    *
+    * This function is optional.
+    */
+   void (*thread_finish)(struct st_context_iface *stctxi);
+
    /**
     * Replace the texture image of a texture object at the specified level.
     *
@@ -53,8 +53,6 @@ dri_fill_st_options(struct st_config_options *options,
       driQueryOptionb(optionCache, "force_glsl_extensions_warn");
    options->force_glsl_version =
       driQueryOptioni(optionCache, "force_glsl_version");
-   options->force_s3tc_enable =
-      driQueryOptionb(optionCache, "force_s3tc_enable");
 }
 
 GLboolean
@@ -445,6 +445,12 @@ dri_flush(__DRIcontext *cPriv,
       return;
    }
 
+   /* The resolve, post-processing and HUD below use the pipe directly, so
+    * any GL calls still queued for a dispatch thread must run first.
+    */
+   if (ctx->st->thread_finish)
+      ctx->st->thread_finish(ctx->st);
+
    if (drawable) {
       /* prevent recursion */
       if (drawable->flushing)
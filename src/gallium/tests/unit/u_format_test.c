@@ -33,7 +33,6 @@
 #include "util/u_half.h"
 #include "util/u_format.h"
 #include "util/u_format_tests.h"
-#include "util/u_format_s3tc.h"
 
 
 static boolean
@@ -693,11 +692,6 @@ test_all(void)
          continue;
       }
 
-      if (format_desc->layout == UTIL_FORMAT_LAYOUT_S3TC &&
-          !util_format_s3tc_enabled) {
-         continue;
-      }
-
 #     define TEST_ONE_FUNC(name) \
       if (format_desc->name) { \
          if (!test_one_func(format_desc, &test_format_##name, #name)) { \
@@ -729,8 +723,6 @@ int main(int argc, char **argv)
 {
    boolean success;
 
-   util_format_s3tc_init();
-
    success = test_all();
 
    return success ? 0 : 1;
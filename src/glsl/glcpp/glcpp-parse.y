@@ -1610,13 +1610,28 @@ _glcpp_parser_expand_node (glcpp_parser_t *parser,
 	if (! macro->is_function)
 	{
 		token_list_t *replacement;
+		int error;
 
 		/* Replace a macro defined as empty with a SPACE token. */
 		if (macro->replacements == NULL)
 			return _token_list_create_with_one_space (parser);
 
+		/* Token pasting in an object-like macro gives the same
+		 * result on every expansion, so only do it once. Don't
+		 * cache failed pastes so that each use still reports
+		 * the error. */
+		if (macro->expansion) {
+			replacement = _token_list_copy (parser,
+							macro->expansion);
+			replacement->non_space_tail = replacement->tail;
+			return replacement;
+		}
+
+		error = parser->error;
 		replacement = _token_list_copy (parser, macro->replacements);
 		_glcpp_parser_apply_pastes (parser, replacement);
+		if (parser->error == error)
+			macro->expansion = _token_list_copy (macro, replacement);
 		return replacement;
 	}
 
@@ -1829,6 +1844,7 @@ _define_object_macro (glcpp_parser_t *parser,
 	macro->parameters = NULL;
 	macro->identifier = ralloc_strdup (macro, identifier);
 	macro->replacements = replacements;
+	macro->expansion = NULL;
 	ralloc_steal (macro, replacements);
 
 	previous = hash_table_find (parser->defines, identifier);
@@ -1863,6 +1879,7 @@ _define_function_macro (glcpp_parser_t *parser,
 	macro->parameters = parameters;
 	macro->identifier = ralloc_strdup (macro, identifier);
 	macro->replacements = replacements;
+	macro->expansion = NULL;
 	previous = hash_table_find (parser->defines, identifier);
 	if (previous) {
 		if (_macro_equal (macro, previous)) {
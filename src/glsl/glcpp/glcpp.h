@@ -137,6 +137,9 @@ typedef struct {
 	string_list_t *parameters;
 	const char *identifier;
 	token_list_t *replacements;
+	/* For object-like macros: the replacement list after
+	 * token pasting, computed on first expansion. */
+	token_list_t *expansion;
 } macro_t;
 
 typedef struct expansion_node {
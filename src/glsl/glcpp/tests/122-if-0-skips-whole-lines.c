@@ -0,0 +1,8 @@
+#if 0
+  indented text # with hash
+foo #endif
+	 
+  # define bar baz
+#else
+success
+#endif
@@ -0,0 +1,3 @@
+#define PASTE_MACRO one ## token
+PASTE_MACRO PASTE_MACRO
+PASTE_MACRO
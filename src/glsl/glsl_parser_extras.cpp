@@ -37,6 +37,7 @@ extern "C" {
 #include "glsl_parser.h"
 #include "ir_optimization.h"
 #include "loop_analysis.h"
+#include "ir_stats.h"
 
 /**
  * Format a short human-readable description of the given GLSL version.
@@ -1395,6 +1396,16 @@ set_shader_inout_layout(struct gl_shader *shader,
    }
 }
 
+/**
+ * Timestamp for MESA_GLSL=stats, or 0 when statistics are disabled, so
+ * that normal compiles don't pay for reading the clock.
+ */
+static uint64_t
+stats_time_ns(bool stats)
+{
+   return stats ? ir_stats_get_time_ns() : 0;
+}
+
 extern "C" {
 
 void
@@ -1404,15 +1415,25 @@ _mesa_glsl_compile_shader(struct gl_context *ctx, struct gl_shader *shader,
    struct _mesa_glsl_parse_state *state =
       new(shader) _mesa_glsl_parse_state(ctx, shader->Stage, shader);
    const char *source = shader->Source;
+   const bool stats = (ctx->_Shader->Flags & GLSL_STATS) != 0;
+   uint64_t start_time, preprocess_time, parse_time, hir_time, opt_time;
+   unsigned ir_nodes_before = 0, ir_nodes_after = 0;
+   opt_pass_tracker tracker;
 
+   tracker.count_ir_nodes = stats;
+   tracker.time_passes = stats || (ctx->_Shader->Flags & GLSL_DUMP) != 0;
+
+   start_time = stats_time_ns(stats);
    state->error = glcpp_preprocess(state, &source, &state->info_log,
                              &ctx->Extensions, ctx);
+   preprocess_time = stats_time_ns(stats);
 
    if (!state->error) {
      _mesa_glsl_lexer_ctor(state, source);
      _mesa_glsl_parse(state);
      _mesa_glsl_lexer_dtor(state);
    }
+   parse_time = stats_time_ns(stats);
 
    if (dump_ast) {
       foreach_list_const(n, &state->translation_unit) {
@@ -1426,6 +1447,7 @@ _mesa_glsl_compile_shader(struct gl_context *ctx, struct gl_shader *shader,
    shader->ir = new(shader) exec_list;
    if (!state->error && !state->translation_unit.is_empty())
       _mesa_ast_to_hir(shader->ir, state);
+   hir_time = stats_time_ns(stats);
 
    if (!state->error) {
       validate_ir_tree(shader->ir);
@@ -1441,15 +1463,42 @@ _mesa_glsl_compile_shader(struct gl_context *ctx, struct gl_shader *shader,
       struct gl_shader_compiler_options *options =
          &ctx->ShaderCompilerOptions[shader->Stage];
 
+      if (stats)
+         ir_nodes_before = ir_stats_count_nodes(shader->ir);
+
       /* Do some optimization at compile time to reduce shader IR size
        * and reduce later work if the same shader is linked multiple times
        */
       while (do_common_optimization(shader->ir, false, false, options,
-                                    ctx->Const.NativeIntegers))
+                                    ctx->Const.NativeIntegers, &tracker))
          ;
 
+      if (stats)
+         ir_nodes_after = ir_stats_count_nodes(shader->ir);
+
+      if (ctx->_Shader->Flags & GLSL_DUMP)
+         tracker.print_stats(stdout);
+
       validate_ir_tree(shader->ir);
    }
+   opt_time = stats_time_ns(stats);
+
+   if (stats) {
+      fprintf(stderr, "{\"event\": \"compile\", \"shader\": %u, "
+              "\"stage\": \"%s\", \"status\": %s, "
+              "\"preprocess_ns\": %llu, \"parse_ns\": %llu, "
+              "\"hir_ns\": %llu, \"optimize_ns\": %llu, "
+              "\"ir_nodes_before\": %u, \"ir_nodes_after\": %u, ",
+              shader->Name, _mesa_shader_stage_to_string(shader->Stage),
+              state->error ? "false" : "true",
+              (unsigned long long) (preprocess_time - start_time),
+              (unsigned long long) (parse_time - preprocess_time),
+              (unsigned long long) (hir_time - parse_time),
+              (unsigned long long) (opt_time - hir_time),
+              ir_nodes_before, ir_nodes_after);
+      tracker.print_json(stderr);
+      fprintf(stderr, "}\n");
+   }
 
    if (shader->InfoLog)
       ralloc_free(shader->InfoLog);
@@ -1471,6 +1520,124 @@ _mesa_glsl_compile_shader(struct gl_context *ctx, struct gl_shader *shader,
 }
 
 } /* extern "C" */
+
+static bool
+opt_pass_should_run(opt_pass_tracker *tracker, unsigned pass,
+                    const char *name)
+{
+   if (tracker == NULL)
+      return true;
+
+   assert(pass < OPT_PASS_TRACKER_MAX_PASSES);
+
+   /* The sequence of passes only changes if the tracker is reused with
+    * different do_common_optimization() arguments.  Start the slot over
+    * rather than trusting stale information.
+    */
+   if (pass >= tracker->num_passes ||
+       strcmp(tracker->passes[pass].name, name) != 0) {
+      memset(&tracker->passes[pass], 0, sizeof(tracker->passes[pass]));
+      tracker->passes[pass].name = name;
+      if (pass >= tracker->num_passes)
+         tracker->num_passes = pass + 1;
+   }
+
+   if (tracker->passes[pass].clean_generation == tracker->generation) {
+      tracker->passes[pass].skipped++;
+      return false;
+   }
+
+   tracker->passes[pass].runs++;
+   return true;
+}
+
+static void
+opt_pass_start(opt_pass_tracker *tracker, exec_list *ir)
+{
+   if (tracker == NULL)
+      return;
+
+   if (tracker->count_ir_nodes)
+      tracker->pass_start_nodes = ir_stats_count_nodes(ir);
+   if (tracker->time_passes)
+      tracker->pass_start_time = ir_stats_get_time_ns();
+}
+
+static bool
+opt_pass_finished(opt_pass_tracker *tracker, unsigned pass, exec_list *ir,
+                  bool progress)
+{
+   if (tracker == NULL)
+      return progress;
+
+   if (tracker->time_passes) {
+      tracker->passes[pass].time_ns +=
+         ir_stats_get_time_ns() - tracker->pass_start_time;
+   }
+   if (tracker->count_ir_nodes) {
+      tracker->passes[pass].ir_nodes_delta +=
+         (int) ir_stats_count_nodes(ir) - (int) tracker->pass_start_nodes;
+   }
+
+   if (progress) {
+      tracker->passes[pass].progress++;
+      tracker->generation++;
+   } else {
+      tracker->passes[pass].clean_generation = tracker->generation;
+   }
+
+   return progress;
+}
+
+void
+opt_pass_tracker::print_stats(FILE *f) const
+{
+   fprintf(f, "GLSL optimization: %u iterations\n", this->iterations);
+   fprintf(f, "  %-32s %6s %8s %7s %10s\n",
+           "pass", "runs", "progress", "skipped", "time (us)");
+   for (unsigned i = 0; i < this->num_passes; i++) {
+      fprintf(f, "  %-32s %6u %8u %7u %10.1f\n", this->passes[i].name,
+              this->passes[i].runs, this->passes[i].progress,
+              this->passes[i].skipped, this->passes[i].time_ns / 1000.0);
+   }
+}
+
+void
+opt_pass_tracker::print_json(FILE *f) const
+{
+   fprintf(f, "\"iterations\": %u, \"passes\": [", this->iterations);
+   for (unsigned i = 0; i < this->num_passes; i++) {
+      fprintf(f, "%s{\"name\": \"%s\", \"runs\": %u, \"progress\": %u, "
+              "\"skipped\": %u, \"time_ns\": %llu",
+              i ? ", " : "", this->passes[i].name,
+              this->passes[i].runs, this->passes[i].progress,
+              this->passes[i].skipped,
+              (unsigned long long) this->passes[i].time_ns);
+      if (this->count_ir_nodes) {
+         fprintf(f, ", \"ir_nodes_delta\": %d",
+                 this->passes[i].ir_nodes_delta);
+      }
+      fprintf(f, "}");
+   }
+   fprintf(f, "]");
+}
+
+static bool
+do_loop_unrolling(exec_list *ir,
+                  const struct gl_shader_compiler_options *options)
+{
+   bool progress = false;
+
+   loop_state *ls = analyze_loop_variables(ir);
+   if (ls->loop_found) {
+      progress = set_loop_controls(ir, ls) || progress;
+      progress = unroll_loops(ir, ls, options) || progress;
+   }
+   delete ls;
+
+   return progress;
+}
+
 /**
  * Do the set of common optimizations passes
  *
@@ -1488,63 +1655,77 @@ _mesa_glsl_compile_shader(struct gl_context *ctx, struct gl_shader *shader,
  *                                    unrolled.  Setting to 0 disables loop
  *                                    unrolling.
  * \param options                     The driver's preferred shader options.
+ * \param tracker                     Optional state shared by the iterations
+ *                                    of a fixed-point loop, used to skip
+ *                                    passes whose input has not changed.
  */
 bool
 do_common_optimization(exec_list *ir, bool linked,
 		       bool uniform_locations_assigned,
                        const struct gl_shader_compiler_options *options,
-                       bool native_integers)
+                       bool native_integers,
+                       opt_pass_tracker *tracker)
 {
    GLboolean progress = GL_FALSE;
+   unsigned pass = 0;
 
-   progress = lower_instructions(ir, SUB_TO_ADD_NEG) || progress;
+#define OPT(PASS, ...) do {                                             \
+      if (opt_pass_should_run(tracker, pass, #PASS)) {                  \
+         opt_pass_start(tracker, ir);                                   \
+         progress = opt_pass_finished(tracker, pass, ir,                \
+                                      PASS(__VA_ARGS__)) || progress;   \
+      }                                                                 \
+      pass++;                                                           \
+   } while (false)
+
+   if (tracker)
+      tracker->iterations++;
+
+   OPT(lower_instructions, ir, SUB_TO_ADD_NEG);
 
    if (linked) {
-      progress = do_function_inlining(ir) || progress;
-      progress = do_dead_functions(ir) || progress;
-      progress = do_structure_splitting(ir) || progress;
+      OPT(do_function_inlining, ir);
+      OPT(do_dead_functions, ir);
+      OPT(do_structure_splitting, ir);
    }
-   progress = do_if_simplification(ir) || progress;
-   progress = opt_flatten_nested_if_blocks(ir) || progress;
-   progress = do_copy_propagation(ir) || progress;
-   progress = do_copy_propagation_elements(ir) || progress;
+   OPT(do_if_simplification, ir);
+   OPT(opt_flatten_nested_if_blocks, ir);
+   OPT(do_copy_propagation, ir);
+   OPT(do_copy_propagation_elements, ir);
 
    if (options->OptimizeForAOS && !linked)
-      progress = opt_flip_matrices(ir) || progress;
+      OPT(opt_flip_matrices, ir);
 
    if (linked && options->OptimizeForAOS) {
-      progress = do_vectorize(ir) || progress;
+      OPT(do_vectorize, ir);
    }
 
    if (linked)
-      progress = do_dead_code(ir, uniform_locations_assigned) || progress;
+      OPT(do_dead_code, ir, uniform_locations_assigned);
    else
-      progress = do_dead_code_unlinked(ir) || progress;
-   progress = do_dead_code_local(ir) || progress;
-   progress = do_tree_grafting(ir) || progress;
-   progress = do_constant_propagation(ir) || progress;
+      OPT(do_dead_code_unlinked, ir);
+   OPT(do_dead_code_local, ir);
+   OPT(do_tree_grafting, ir);
+   OPT(do_constant_propagation, ir);
    if (linked)
-      progress = do_constant_variable(ir) || progress;
+      OPT(do_constant_variable, ir);
    else
-      progress = do_constant_variable_unlinked(ir) || progress;
-   progress = do_constant_folding(ir) || progress;
-   progress = do_cse(ir) || progress;
-   progress = do_algebraic(ir, native_integers) || progress;
-   progress = do_lower_jumps(ir) || progress;
-   progress = do_vec_index_to_swizzle(ir) || progress;
-   progress = lower_vector_insert(ir, false) || progress;
-   progress = do_swizzle_swizzle(ir) || progress;
-   progress = do_noop_swizzle(ir) || progress;
-
-   progress = optimize_split_arrays(ir, linked) || progress;
-   progress = optimize_redundant_jumps(ir) || progress;
-
-   loop_state *ls = analyze_loop_variables(ir);
-   if (ls->loop_found) {
-      progress = set_loop_controls(ir, ls) || progress;
-      progress = unroll_loops(ir, ls, options) || progress;
-   }
-   delete ls;
+      OPT(do_constant_variable_unlinked, ir);
+   OPT(do_constant_folding, ir);
+   OPT(do_cse, ir);
+   OPT(do_algebraic, ir, native_integers);
+   OPT(do_lower_jumps, ir);
+   OPT(do_vec_index_to_swizzle, ir);
+   OPT(lower_vector_insert, ir, false);
+   OPT(do_swizzle_swizzle, ir);
+   OPT(do_noop_swizzle, ir);
+
+   OPT(optimize_split_arrays, ir, linked);
+   OPT(optimize_redundant_jumps, ir);
+
+   OPT(do_loop_unrolling, ir, options);
+
+#undef OPT
 
    return progress;
 }
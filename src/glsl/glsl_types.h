@@ -574,6 +574,12 @@ private:
     */
    static void *mem_ctx;
 
+   /**
+    * Protects the type hash tables and \c mem_ctx, so that shaders can be
+    * compiled and optimized on several threads at once.
+    */
+   static mtx_t mutex;
+
    void init_ralloc_type_ctx(void);
 
    /** Constructor for vector and matrix types */
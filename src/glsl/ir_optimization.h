@@ -28,6 +28,10 @@
  * Prototypes for optimization passes to be called by the compiler and drivers.
  */
 
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
 /* Operations for lower_instructions() */
 #define SUB_TO_ADD_NEG     0x01
 #define DIV_TO_MUL_RCP     0x02
@@ -64,10 +68,98 @@ enum lower_packing_builtins_op {
    LOWER_UNPACK_UNORM_4x8               = 0x0800
 };
 
+#define OPT_PASS_TRACKER_MAX_PASSES 32
+
+/**
+ * Bookkeeping for a fixed-point loop around do_common_optimization().
+ *
+ * The optimization passes are deterministic: a pass that made no progress
+ * will make no progress again until some other pass changes the IR.  The
+ * tracker keeps an IR generation number that is bumped every time any pass
+ * (or the caller, via \c invalidate) changes the IR, and remembers for each
+ * pass the generation at which it last came up empty.  Passes whose input
+ * is known to be unchanged are skipped, which mostly eliminates the final
+ * "did anything change?" iteration of the loop.
+ *
+ * The same tracker must only be used with one instruction list and one set
+ * of do_common_optimization() arguments.
+ */
+struct opt_pass_tracker {
+   opt_pass_tracker()
+   {
+      memset(this, 0, sizeof(*this));
+      generation = 1;
+   }
+
+   /**
+    * Notify the tracker that the IR was changed outside of
+    * do_common_optimization().
+    */
+   void invalidate()
+   {
+      generation++;
+   }
+
+   /** Print the per-pass statistics gathered so far. */
+   void print_stats(FILE *f) const;
+
+   /**
+    * Print the statistics as the members of a JSON object (without the
+    * enclosing braces).
+    */
+   void print_json(FILE *f) const;
+
+   unsigned generation;
+
+   /** Number of do_common_optimization() calls using this tracker. */
+   unsigned iterations;
+
+   unsigned num_passes;
+   struct {
+      const char *name;
+
+      /** Generation at which this pass last reported no progress. */
+      unsigned clean_generation;
+
+      unsigned runs;
+      unsigned progress;
+      unsigned skipped;
+
+      /**
+       * Total time spent in the pass (only gathered when \c time_passes
+       * is set).
+       */
+      uint64_t time_ns;
+
+      /**
+       * Total change in IR size caused by the pass (only gathered when
+       * \c count_ir_nodes is set).
+       */
+      int ir_nodes_delta;
+   } passes[OPT_PASS_TRACKER_MAX_PASSES];
+
+   /**
+    * Whether to count the IR nodes around every pass.  This walks the whole
+    * IR twice per pass, so it is only done for MESA_GLSL=stats.
+    */
+   bool count_ir_nodes;
+
+   /**
+    * Whether to time every pass.  Only done when the statistics are going
+    * to be printed (MESA_GLSL=stats or MESA_GLSL=dump).
+    */
+   bool time_passes;
+
+   /** State of the pass that is currently running */
+   uint64_t pass_start_time;
+   unsigned pass_start_nodes;
+};
+
 bool do_common_optimization(exec_list *ir, bool linked,
 			    bool uniform_locations_assigned,
                             const struct gl_shader_compiler_options *options,
-                            bool native_integers);
+                            bool native_integers,
+                            opt_pass_tracker *tracker = NULL);
 
 bool do_algebraic(exec_list *instructions, bool native_integers);
 bool do_constant_folding(exec_list *instructions);
@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2014 The Mesa Authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * \file ir_stats.cpp
+ *
+ * Helpers for the compile-time statistics printed with MESA_GLSL=stats.
+ */
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <time.h>
+#include <sys/time.h>
+#endif
+
+#include "ir.h"
+#include "ir_hierarchical_visitor.h"
+#include "ir_stats.h"
+
+static void
+count_node(ir_instruction *, void *data)
+{
+   (*(unsigned *) data)++;
+}
+
+unsigned
+ir_stats_count_nodes(exec_list *instructions)
+{
+   unsigned count = 0;
+
+   foreach_list(node, instructions) {
+      visit_tree((ir_instruction *) node, count_node, &count);
+   }
+
+   return count;
+}
+
+extern "C" uint64_t
+ir_stats_get_time_ns(void)
+{
+#if defined(CLOCK_MONOTONIC)
+   struct timespec ts;
+
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return ts.tv_nsec + ts.tv_sec * UINT64_C(1000000000);
+#elif defined(_WIN32)
+   static LARGE_INTEGER frequency;
+   LARGE_INTEGER counter;
+
+   if (!frequency.QuadPart)
+      QueryPerformanceFrequency(&frequency);
+   QueryPerformanceCounter(&counter);
+   return counter.QuadPart * UINT64_C(1000000000) / frequency.QuadPart;
+#else
+   struct timeval tv;
+
+   gettimeofday(&tv, NULL);
+   return tv.tv_usec * UINT64_C(1000) + tv.tv_sec * UINT64_C(1000000000);
+#endif
+}
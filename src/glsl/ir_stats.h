@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2014 The Mesa Authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * \file ir_stats.h
+ *
+ * Helpers for the compile-time statistics printed with MESA_GLSL=stats.
+ */
+
+#pragma once
+#ifndef IR_STATS_H
+#define IR_STATS_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+class exec_list;
+
+/**
+ * Count the IR nodes (instructions, rvalues and dereferences) in a list.
+ */
+unsigned ir_stats_count_nodes(exec_list *instructions);
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Monotonic time in nanoseconds, for measuring compile phases. */
+uint64_t ir_stats_get_time_ns(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IR_STATS_H */
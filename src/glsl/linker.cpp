@@ -65,6 +65,7 @@
  */
 
 #include "main/core.h"
+#include "main/threadpool.h"
 #include "glsl_symbol_table.h"
 #include "glsl_parser_extras.h"
 #include "ir.h"
@@ -73,6 +74,7 @@
 #include "linker.h"
 #include "link_varyings.h"
 #include "ir_optimization.h"
+#include "ir_stats.h"
 #include "ir_rvalue_visitor.h"
 
 extern "C" {
@@ -2089,6 +2091,94 @@ check_image_resources(struct gl_context *ctx, struct gl_shader_program *prog)
       linker_error(prog, "Too many combined image uniforms and fragment outputs");
 }
 
+/**
+ * Per-stage state for optimize_linked_shaders().
+ */
+struct optimize_stage_job {
+   struct gl_shader *shader;
+   const struct gl_shader_compiler_options *options;
+   bool native_integers;
+
+   /* Statistics for MESA_GLSL=stats */
+   opt_pass_tracker tracker;
+   uint64_t time_ns;
+   unsigned ir_nodes_before;
+   unsigned ir_nodes_after;
+};
+
+static void
+optimize_linked_shader(void *data, unsigned index)
+{
+   optimize_stage_job *job = ((optimize_stage_job *) data) + index;
+   const bool stats = job->tracker.count_ir_nodes;
+   const uint64_t start_time = stats ? ir_stats_get_time_ns() : 0;
+
+   if (stats)
+      job->ir_nodes_before = ir_stats_count_nodes(job->shader->ir);
+
+   if (job->options->LowerClipDistance) {
+      lower_clip_distance(job->shader);
+   }
+
+   while (do_common_optimization(job->shader->ir, true, false,
+                                 job->options, job->native_integers,
+                                 &job->tracker))
+      ;
+
+   if (stats) {
+      job->ir_nodes_after = ir_stats_count_nodes(job->shader->ir);
+      job->time_ns = ir_stats_get_time_ns() - start_time;
+   }
+}
+
+/**
+ * Run the post-link optimization loop on every linked stage.
+ *
+ * Each stage's IR is self-contained at this point (the only shared state,
+ * the glsl_type tables, is locked), so the stages are optimized
+ * concurrently on the shared thread pool.
+ */
+static void
+optimize_linked_shaders(struct gl_context *ctx,
+                        struct gl_shader_program *prog)
+{
+   optimize_stage_job jobs[MESA_SHADER_STAGES];
+   unsigned num_jobs = 0;
+
+   for (unsigned i = 0; i < MESA_SHADER_STAGES; i++) {
+      if (prog->_LinkedShaders[i] == NULL)
+         continue;
+
+      jobs[num_jobs].shader = prog->_LinkedShaders[i];
+      jobs[num_jobs].options = &ctx->ShaderCompilerOptions[i];
+      jobs[num_jobs].native_integers = ctx->Const.NativeIntegers;
+      jobs[num_jobs].tracker.count_ir_nodes =
+         (ctx->_Shader->Flags & GLSL_STATS) != 0;
+      jobs[num_jobs].time_ns = 0;
+      jobs[num_jobs].ir_nodes_before = 0;
+      jobs[num_jobs].ir_nodes_after = 0;
+      num_jobs++;
+   }
+
+   _mesa_threadpool_run(num_jobs, optimize_linked_shader, jobs);
+
+   if (ctx->_Shader->Flags & GLSL_STATS) {
+      fprintf(stderr, "{\"event\": \"link\", \"program\": %u, "
+              "\"stages\": [", prog->Name);
+      for (unsigned i = 0; i < num_jobs; i++) {
+         fprintf(stderr, "%s{\"stage\": \"%s\", \"optimize_ns\": %llu, "
+                 "\"ir_nodes_before\": %u, \"ir_nodes_after\": %u, ",
+                 i ? ", " : "",
+                 _mesa_shader_stage_to_string(jobs[i].shader->Stage),
+                 (unsigned long long) jobs[i].time_ns,
+                 jobs[i].ir_nodes_before, jobs[i].ir_nodes_after);
+         jobs[i].tracker.print_json(stderr);
+         fprintf(stderr, "}");
+      }
+      fprintf(stderr, "]}\n");
+   }
+}
+
 void
 link_shaders(struct gl_context *ctx, struct gl_shader_program *prog)
 {
@@ -2291,17 +2381,10 @@ link_shaders(struct gl_context *ctx, struct gl_shader_program *prog)
       detect_recursion_linked(prog, prog->_LinkedShaders[i]->ir);
       if (!prog->LinkStatus)
 	 goto done;
-
-      if (ctx->ShaderCompilerOptions[i].LowerClipDistance) {
-         lower_clip_distance(prog->_LinkedShaders[i]);
-      }
-
-      while (do_common_optimization(prog->_LinkedShaders[i]->ir, true, false,
-                                    &ctx->ShaderCompilerOptions[i],
-                                    ctx->Const.NativeIntegers))
-	 ;
    }
 
+   optimize_linked_shaders(ctx, prog);
+
    /* Mark all generic shader inputs and outputs as unpaired. */
    for (unsigned i = MESA_SHADER_VERTEX; i <= MESA_SHADER_FRAGMENT; i++) {
       if (prog->_LinkedShaders[i] != NULL) {
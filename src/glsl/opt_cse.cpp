@@ -27,9 +27,15 @@
  * constant subexpression elimination at the GLSL IR level.
  *
  * Compare to brw_fs_cse.cpp for a more complete CSE implementation.  This one
- * is generic and handles texture operations, but it's rather simple currently
- * and doesn't support modification of variables in the available expressions
- * list, so it can't do variables other than uniforms or shader inputs.
+ * is generic and handles texture operations.  Besides uniforms and shader
+ * inputs, expressions may read scalar and vector temporaries; available
+ * expressions are killed when one of the temporaries they read is assigned.
+ *
+ * Since GLSL IR control flow is structured, the available expressions of a
+ * block remain available inside the if branches and loop bodies nested in
+ * it, and after them (minus anything those nested blocks killed).  This
+ * gives us CSE along the dominator tree rather than only within basic
+ * blocks.
  */
 
 #include "ir.h"
@@ -39,6 +45,7 @@
 #include "ir_optimization.h"
 #include "ir_builder.h"
 #include "glsl_types.h"
+#include "main/hash_table.h"
 
 using namespace ir_builder;
 
@@ -53,14 +60,16 @@ namespace {
 class ae_entry : public exec_node
 {
 public:
-   ae_entry(ir_instruction *base_ir, ir_rvalue **val)
-      : val(val), base_ir(base_ir)
+   ae_entry(ir_instruction *base_ir, ir_rvalue **val, unsigned depth)
+      : val(val), base_ir(base_ir), depth(depth)
    {
       assert(val);
       assert(*val);
       assert(base_ir);
 
       var = NULL;
+      reads_writable = false;
+      live = true;
    }
 
    /**
@@ -81,11 +90,40 @@ public:
     */
    ir_instruction *base_ir;
 
+   /**
+    * Nesting depth of the block in which the expression appeared.
+    *
+    * The entry goes away when control flow leaves that block, since the
+    * expression does not dominate the code that follows.
+    */
+   unsigned depth;
+
    /**
     * The variable that the expression has been stored in, if it's been CSEd
     * once already.
     */
    ir_variable *var;
+
+   /** Whether the expression reads any variable that can be assigned */
+   bool reads_writable;
+
+   /** Whether the entry is still in the list of available expressions */
+   bool live;
+};
+
+/**
+ * Link from a variable to an available expression reading it, so that
+ * assigning the variable only has to look at the expressions it affects.
+ */
+class ae_use : public exec_node
+{
+public:
+   ae_use(ae_entry *entry)
+      : entry(entry)
+   {
+   }
+
+   ae_entry *entry;
 };
 
 class cse_visitor : public ir_rvalue_visitor {
@@ -94,8 +132,10 @@ public:
       : validate_instructions(validate_instructions)
    {
       progress = false;
+      depth = 0;
       mem_ctx = ralloc_context(NULL);
       this->ae = new(mem_ctx) exec_list;
+      readers = _mesa_hash_table_create(mem_ctx, _mesa_key_pointer_equal);
    }
    ~cse_visitor()
    {
@@ -106,6 +146,7 @@ public:
    virtual ir_visitor_status visit_enter(ir_loop *ir);
    virtual ir_visitor_status visit_enter(ir_if *ir);
    virtual ir_visitor_status visit_enter(ir_call *ir);
+   virtual ir_visitor_status visit_leave(ir_assignment *ir);
    virtual void handle_rvalue(ir_rvalue **rvalue);
 
    bool progress;
@@ -115,10 +156,27 @@ private:
 
    ir_rvalue *try_cse(ir_rvalue *rvalue);
    void add_to_ae(ir_rvalue **rvalue);
+   void visit_nested(exec_list *instructions);
+   void remove_entry(ae_entry *entry);
+   void clear_readers();
+   void clear_ae();
+   void kill(ir_variable *var);
+   void kill_all();
+   void kill_assigned_in(exec_list *instructions);
+
+   /** Nesting depth of the block currently being visited */
+   unsigned depth;
 
    /** List of ae_entry: The available expressions to reuse */
    exec_list *ae;
 
+   /**
+    * Maps each writable ir_variable to an exec_list of ae_use, the
+    * available expressions reading it.  Uses of entries that have been
+    * removed since are skipped.
+    */
+   hash_table *readers;
+
    /**
     * The whole shader, so that we can validate_ir_tree in debug mode.
     *
@@ -147,6 +205,61 @@ public:
 };
 
 
+/**
+ * Visitor to record an available expression as a reader of each writable
+ * variable it reads.
+ */
+class read_variables_visitor : public ir_hierarchical_visitor
+{
+public:
+
+   read_variables_visitor(void *mem_ctx, hash_table *readers,
+                          ae_entry *entry)
+      : mem_ctx(mem_ctx), readers(readers), entry(entry)
+   {
+   }
+
+   virtual ir_visitor_status visit(ir_dereference_variable *ir);
+
+   void *mem_ctx;
+   hash_table *readers;
+   ae_entry *entry;
+};
+
+
+/**
+ * Visitor to collect the set of variables written by a list of
+ * instructions.
+ */
+class assigned_variables_visitor : public ir_hierarchical_visitor
+{
+public:
+
+   assigned_variables_visitor()
+      : has_call(false)
+   {
+      ht = _mesa_hash_table_create(NULL, _mesa_key_pointer_equal);
+   }
+
+   ~assigned_variables_visitor()
+   {
+      _mesa_hash_table_destroy(ht, NULL);
+   }
+
+   virtual ir_visitor_status visit_enter(ir_assignment *ir);
+   virtual ir_visitor_status visit_enter(ir_call *ir);
+
+   /** Set of written ir_variables */
+   hash_table *ht;
+
+   /**
+    * Whether a function call was seen.  Calls may write their out
+    * parameters, so we don't try to track what they write.
+    */
+   bool has_call;
+};
+
+
 class contains_rvalue_visitor : public ir_rvalue_visitor
 {
 public:
@@ -190,15 +303,63 @@ dump_ae(exec_list *ae)
 ir_visitor_status
 is_cse_candidate_visitor::visit(ir_dereference_variable *ir)
 {
-   /* Currently, since we don't handle kills of the ae based on variables
-    * getting assigned, we can only handle constant variables.
+   /* Constant variables can always be handled.  Scalar and vector
+    * temporaries can be handled too, since the AE entries reading them are
+    * killed on assignment.  Anything else (arrays, structures, outputs) may
+    * be written in ways we don't track.
     */
-   if (ir->var->data.read_only) {
+   if (ir->var->data.read_only)
+      return visit_continue;
+
+   if ((ir->var->data.mode == ir_var_auto ||
+        ir->var->data.mode == ir_var_temporary) &&
+       (ir->var->type->is_scalar() || ir->var->type->is_vector()))
       return visit_continue;
+
+   ok = false;
+   return visit_stop;
+}
+
+ir_visitor_status
+read_variables_visitor::visit(ir_dereference_variable *ir)
+{
+   if (ir->var->data.read_only)
+      return visit_continue;
+
+   const uint32_t hash = _mesa_hash_pointer(ir->var);
+   struct hash_entry *e = _mesa_hash_table_search(readers, hash, ir->var);
+   exec_list *uses;
+
+   if (e) {
+      uses = (exec_list *) e->data;
    } else {
-      ok = false;
-      return visit_stop;
+      uses = new(mem_ctx) exec_list;
+      _mesa_hash_table_insert(readers, hash, ir->var, uses);
    }
+
+   uses->push_tail(new(mem_ctx) ae_use(entry));
+   entry->reads_writable = true;
+
+   return visit_continue;
+}
+
+ir_visitor_status
+assigned_variables_visitor::visit_enter(ir_assignment *ir)
+{
+   ir_variable *var = ir->lhs->variable_referenced();
+
+   if (var && !_mesa_hash_table_search(ht, _mesa_hash_pointer(var), var))
+      _mesa_hash_table_insert(ht, _mesa_hash_pointer(var), var, var);
+
+   /* Assignments can't nest, so there's nothing more to find inside. */
+   return visit_continue_with_parent;
+}
+
+ir_visitor_status
+assigned_variables_visitor::visit_enter(ir_call *)
+{
+   has_call = true;
+   return visit_stop;
 }
 
 void
@@ -330,7 +491,11 @@ cse_visitor::add_to_ae(ir_rvalue **rvalue)
       printf("\n");
    }
 
-   ae->push_tail(new(mem_ctx) ae_entry(base_ir, rvalue));
+   ae_entry *entry = new(mem_ctx) ae_entry(base_ir, rvalue, depth);
+   read_variables_visitor v(mem_ctx, readers, entry);
+
+   (*rvalue)->accept(&v);
+   ae->push_tail(entry);
 
    if (debug)
       dump_ae(ae);
@@ -363,38 +528,150 @@ cse_visitor::handle_rvalue(ir_rvalue **rvalue)
    }
 }
 
+void
+cse_visitor::remove_entry(ae_entry *entry)
+{
+   entry->remove();
+   entry->live = false;
+}
+
+/** Forgets the readers of all variables. */
+void
+cse_visitor::clear_readers()
+{
+   _mesa_hash_table_destroy(readers, NULL);
+   readers = _mesa_hash_table_create(mem_ctx, _mesa_key_pointer_equal);
+}
+
+/** Empties the list of available expressions. */
+void
+cse_visitor::clear_ae()
+{
+   foreach_list_safe(node, ae) {
+      remove_entry((ae_entry *) node);
+   }
+
+   clear_readers();
+}
+
+/**
+ * Removes the available expressions that read \c var.
+ *
+ * Only the expressions recorded as readers of \c var are looked at, so
+ * that the cost of an assignment doesn't grow with the number of available
+ * expressions.
+ */
+void
+cse_visitor::kill(ir_variable *var)
+{
+   struct hash_entry *e =
+      _mesa_hash_table_search(readers, _mesa_hash_pointer(var), var);
+
+   if (!e)
+      return;
+
+   exec_list *uses = (exec_list *) e->data;
+
+   foreach_list(node, uses) {
+      ae_use *use = (ae_use *) node;
+
+      if (use->entry->live)
+         remove_entry(use->entry);
+   }
+
+   uses->make_empty();
+}
+
+/** Removes the available expressions that read any writable variable. */
+void
+cse_visitor::kill_all()
+{
+   foreach_list_safe(node, ae) {
+      ae_entry *entry = (ae_entry *) node;
+
+      if (entry->reads_writable)
+         remove_entry(entry);
+   }
+
+   clear_readers();
+}
+
+/**
+ * Removes the available expressions invalidated by anything written in
+ * \c instructions.
+ *
+ * Used on entry to a loop body, whose assignments may happen before any
+ * point of the body through the back edge.
+ */
+void
+cse_visitor::kill_assigned_in(exec_list *instructions)
+{
+   assigned_variables_visitor v;
+
+   v.run(instructions);
+
+   if (v.has_call) {
+      kill_all();
+   } else {
+      struct hash_entry *e;
+
+      hash_table_foreach(v.ht, e)
+         kill((ir_variable *) e->data);
+   }
+}
+
+/**
+ * Visits a block nested in the current one.
+ *
+ * The available expressions of the enclosing blocks dominate the nested
+ * block and stay usable, but expressions found in the nested block don't
+ * dominate the code after it, so they are dropped on the way out.
+ */
+void
+cse_visitor::visit_nested(exec_list *instructions)
+{
+   depth++;
+   visit_list_elements(this, instructions);
+   depth--;
+
+   /* Entries are appended as they are found, so the ones from the nested
+    * block are all at the tail.
+    */
+   while (!ae->is_empty()) {
+      ae_entry *entry = (ae_entry *) ae->get_tail();
+      if (entry->depth <= depth)
+         break;
+      remove_entry(entry);
+   }
+}
+
 ir_visitor_status
 cse_visitor::visit_enter(ir_if *ir)
 {
    handle_rvalue(&ir->condition);
 
-   ae->make_empty();
-   visit_list_elements(this, &ir->then_instructions);
-
-   ae->make_empty();
-   visit_list_elements(this, &ir->else_instructions);
+   visit_nested(&ir->then_instructions);
+   visit_nested(&ir->else_instructions);
 
-   ae->make_empty();
    return visit_continue_with_parent;
 }
 
 ir_visitor_status
 cse_visitor::visit_enter(ir_function_signature *ir)
 {
-   ae->make_empty();
+   clear_ae();
    visit_list_elements(this, &ir->body);
 
-   ae->make_empty();
+   clear_ae();
    return visit_continue_with_parent;
 }
 
 ir_visitor_status
 cse_visitor::visit_enter(ir_loop *ir)
 {
-   ae->make_empty();
-   visit_list_elements(this, &ir->body_instructions);
+   kill_assigned_in(&ir->body_instructions);
+   visit_nested(&ir->body_instructions);
 
-   ae->make_empty();
    return visit_continue_with_parent;
 }
 
@@ -404,12 +681,29 @@ cse_visitor::visit_enter(ir_call *)
    /* Because call is an exec_list of ir_rvalues, handle_rvalue gets passed a
     * pointer to the (ir_rvalue *) on the stack.  Since we save those pointers
     * in the AE list, we can't let handle_rvalue get called.
+    *
+    * The call may also write any variable passed as an out parameter or
+    * used for the return value.
     */
+   kill_all();
    return visit_continue_with_parent;
 }
 
+ir_visitor_status
+cse_visitor::visit_leave(ir_assignment *ir)
+{
+   ir_visitor_status s = ir_rvalue_visitor::visit_leave(ir);
+
+   ir_variable *var = ir->lhs->variable_referenced();
+
+   if (var)
+      kill(var);
+
+   return s;
+}
+
 /**
- * Does a (uniform-value) constant subexpression elimination pass on the code
+ * Does a common subexpression elimination pass on the code
  * present in the instruction stream.
  */
 bool
@@ -89,6 +89,11 @@ void initialize_context_to_defaults(struct gl_context *ctx, gl_api api)
 
    ctx->API = api;
 
+   /* The compiler checks the MESA_GLSL debug flags in the current
+    * pipeline object.
+    */
+   ctx->_Shader = &ctx->Shader;
+
    ctx->Extensions.dummy_false = false;
    ctx->Extensions.dummy_true = true;
    ctx->Extensions.ARB_compute_shader = true;
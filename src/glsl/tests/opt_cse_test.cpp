@@ -0,0 +1,234 @@
+/*
+ * Copyright (c) 2014 The Mesa Authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+#include <gtest/gtest.h>
+#include "main/compiler.h"
+#include "main/mtypes.h"
+#include "main/macros.h"
+#include "ralloc.h"
+#include "ir.h"
+#include "ir_builder.h"
+#include "ir_optimization.h"
+
+/**
+ * \file opt_cse_test.cpp
+ *
+ * Check which repeated expressions do_cse() replaces across assignments,
+ * if statements and loops.
+ */
+
+using namespace ir_builder;
+
+namespace {
+
+class count_multiplies : public ir_hierarchical_visitor {
+public:
+   count_multiplies()
+      : count(0)
+   {
+   }
+
+   virtual ir_visitor_status visit_enter(ir_expression *ir)
+   {
+      if (ir->operation == ir_binop_mul)
+         count++;
+      return visit_continue;
+   }
+
+   unsigned count;
+};
+
+} /* anonymous namespace */
+
+class opt_cse : public ::testing::Test {
+public:
+   virtual void SetUp();
+   virtual void TearDown();
+
+   ir_variable *temp(const char *name);
+   unsigned multiplies();
+
+   void *mem_ctx;
+   exec_list ir;
+   ir_variable *a, *b, *c, *t1, *t2, *cond;
+};
+
+void
+opt_cse::SetUp()
+{
+   mem_ctx = ralloc_context(NULL);
+   ir.make_empty();
+
+   a = temp("a");
+   b = temp("b");
+   c = temp("c");
+   t1 = temp("t1");
+   t2 = temp("t2");
+   cond = new(mem_ctx) ir_variable(glsl_type::bool_type, "cond",
+                                   ir_var_temporary);
+   ir.push_tail(cond);
+}
+
+void
+opt_cse::TearDown()
+{
+   ralloc_free(mem_ctx);
+   mem_ctx = NULL;
+}
+
+ir_variable *
+opt_cse::temp(const char *name)
+{
+   ir_variable *var = new(mem_ctx) ir_variable(glsl_type::vec4_type, name,
+                                               ir_var_temporary);
+   ir.push_tail(var);
+   return var;
+}
+
+unsigned
+opt_cse::multiplies()
+{
+   count_multiplies v;
+
+   v.run(&ir);
+   return v.count;
+}
+
+TEST_F(opt_cse, straight_line)
+{
+   ir.push_tail(assign(t1, mul(a, b)));
+   ir.push_tail(assign(c, a));
+   ir.push_tail(assign(t2, mul(a, b)));
+
+   EXPECT_TRUE(do_cse(&ir));
+   EXPECT_EQ(1u, multiplies());
+}
+
+TEST_F(opt_cse, assignment_kills_readers)
+{
+   ir.push_tail(assign(t1, mul(a, b)));
+   ir.push_tail(assign(a, c));
+   ir.push_tail(assign(t2, mul(a, b)));
+
+   EXPECT_FALSE(do_cse(&ir));
+   EXPECT_EQ(2u, multiplies());
+}
+
+TEST_F(opt_cse, assignment_kills_nested_readers)
+{
+   /* a is read by the multiply nested in the add, not by the add itself. */
+   ir.push_tail(assign(t1, add(mul(a, b), c)));
+   ir.push_tail(assign(a, t1));
+   ir.push_tail(assign(t2, add(mul(a, b), c)));
+
+   EXPECT_FALSE(do_cse(&ir));
+   EXPECT_EQ(2u, multiplies());
+}
+
+TEST_F(opt_cse, reuse_inside_if)
+{
+   ir_if *if_stmt = new(mem_ctx) ir_if(new(mem_ctx)
+                                       ir_dereference_variable(cond));
+
+   ir.push_tail(assign(t1, mul(a, b)));
+   if_stmt->then_instructions.push_tail(assign(t2, mul(a, b)));
+   ir.push_tail(if_stmt);
+
+   EXPECT_TRUE(do_cse(&ir));
+   EXPECT_EQ(1u, multiplies());
+}
+
+TEST_F(opt_cse, no_reuse_after_if)
+{
+   ir_if *if_stmt = new(mem_ctx) ir_if(new(mem_ctx)
+                                       ir_dereference_variable(cond));
+
+   if_stmt->then_instructions.push_tail(assign(t1, mul(a, b)));
+   ir.push_tail(if_stmt);
+   ir.push_tail(assign(t2, mul(a, b)));
+
+   EXPECT_FALSE(do_cse(&ir));
+   EXPECT_EQ(2u, multiplies());
+}
+
+TEST_F(opt_cse, assignment_in_if_kills_readers)
+{
+   ir_if *if_stmt = new(mem_ctx) ir_if(new(mem_ctx)
+                                       ir_dereference_variable(cond));
+
+   ir.push_tail(assign(t1, mul(a, b)));
+   if_stmt->else_instructions.push_tail(assign(b, c));
+   ir.push_tail(if_stmt);
+   ir.push_tail(assign(t2, mul(a, b)));
+
+   EXPECT_FALSE(do_cse(&ir));
+   EXPECT_EQ(2u, multiplies());
+}
+
+TEST_F(opt_cse, reuse_inside_loop)
+{
+   ir_loop *loop = new(mem_ctx) ir_loop();
+
+   ir.push_tail(assign(t1, mul(a, b)));
+   loop->body_instructions.push_tail(assign(t2, mul(a, b)));
+   loop->body_instructions.push_tail(assign(c, t2));
+   loop->body_instructions.push_tail(new(mem_ctx)
+                                     ir_loop_jump(ir_loop_jump::jump_break));
+   ir.push_tail(loop);
+
+   EXPECT_TRUE(do_cse(&ir));
+   EXPECT_EQ(1u, multiplies());
+}
+
+TEST_F(opt_cse, loop_back_edge_kills_readers)
+{
+   ir_loop *loop = new(mem_ctx) ir_loop();
+
+   /* a is only assigned after the multiply in the body, but the back edge
+    * makes that assignment reach it on the next iteration.
+    */
+   ir.push_tail(assign(t1, mul(a, b)));
+   loop->body_instructions.push_tail(assign(t2, mul(a, b)));
+   loop->body_instructions.push_tail(assign(a, t2));
+   ir.push_tail(loop);
+
+   EXPECT_FALSE(do_cse(&ir));
+   EXPECT_EQ(2u, multiplies());
+}
+
+TEST_F(opt_cse, many_available_expressions)
+{
+   ir_variable *vars[64];
+   unsigned i;
+
+   /* Only the expressions reading the assigned variable go away. */
+   for (i = 0; i < 64; i++) {
+      vars[i] = temp("v");
+      ir.push_tail(assign(t1, mul(vars[i], b)));
+   }
+   ir.push_tail(assign(vars[5], c));
+   for (i = 0; i < 64; i++)
+      ir.push_tail(assign(t2, mul(vars[i], b)));
+
+   EXPECT_TRUE(do_cse(&ir));
+   EXPECT_EQ(65u, multiplies());
+}
@@ -0,0 +1,476 @@
+#!/usr/bin/env python
+
+# Copyright (C) 2014 The Mesa Authors
+#
+# Permission is hereby granted, free of charge, to any person obtaining a
+# copy of this software and associated documentation files (the "Software"),
+# to deal in the Software without restriction, including without limitation
+# the rights to use, copy, modify, merge, publish, distribute, sublicense,
+# and/or sell copies of the Software, and to permit persons to whom the
+# Software is furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice (including the next
+# paragraph) shall be included in all copies or substantial portions of the
+# Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+# THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+# FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+# IN THE SOFTWARE.
+
+# This script generates the file marshal_generated.c, which contains the
+# functions of the "marshal" dispatch table used by GL threading (see
+# src/mesa/main/glthread.h).  Every GL function gets a marshal function
+# that is called on the application thread.  Functions whose parameters
+# can be copied into a command are queued for the worker thread, all
+# others wait for the worker thread to go idle and call the real function
+# directly.
+
+import license
+import gl_XML
+import sys, getopt
+
+
+header = """/**
+ * \\file marshal_generated.c
+ * Marshalling of GL commands for GL threading.
+ */
+
+
+#include "main/glheader.h"
+#include "main/api_exec.h"
+#include "main/context.h"
+#include "main/dispatch.h"
+#include "main/glthread.h"
+#include "main/imports.h"
+#include "main/macros.h"
+"""
+
+
+# Functions that must wait for the worker thread even though their
+# parameters could be copied.
+sync_functions = set([
+    # Its whole point is to wait for the rendering to finish.
+    'Finish',
+    # Restores array buffer bindings behind our back.
+    'PopClientAttrib',
+    ])
+
+
+# Functions which set up a vertex array.  The pointer is an offset (and
+# can be passed by value) when a buffer object is bound to
+# GL_ARRAY_BUFFER.  Client-side arrays would have to be read at draw time
+# on the worker thread while the application may be changing them, so GL
+# threading is turned off for the context when those are used.
+vertex_pointer_functions = set([
+    'ColorPointer',
+    'ColorPointerEXT',
+    'EdgeFlagPointer',
+    'EdgeFlagPointerEXT',
+    'FogCoordPointer',
+    'IndexPointer',
+    'IndexPointerEXT',
+    'InterleavedArrays',
+    'NormalPointer',
+    'NormalPointerEXT',
+    'PointSizePointerOES',
+    'SecondaryColorPointer',
+    'TexCoordPointer',
+    'TexCoordPointerEXT',
+    'VertexAttribIPointer',
+    'VertexAttribPointer',
+    'VertexAttribPointerNV',
+    'VertexPointer',
+    'VertexPointerEXT',
+    ])
+
+
+# Draw functions whose indices pointer is an offset (and can be passed by
+# value) when a buffer object is bound to GL_ELEMENT_ARRAY_BUFFER.
+draw_elements_functions = set([
+    'DrawElements',
+    'DrawElementsBaseVertex',
+    'DrawElementsInstancedARB',
+    'DrawElementsInstancedBaseInstance',
+    'DrawElementsInstancedBaseVertex',
+    'DrawElementsInstancedBaseVertexBaseInstance',
+    'DrawRangeElements',
+    'DrawRangeElementsBaseVertex',
+    ])
+
+
+# Functions whose array parameter holds pixel data, read through
+# GL_PIXEL_UNPACK_BUFFER when a buffer object is bound to it.  The pointer
+# is then an offset and is passed by value instead of being copied.
+pixel_unpack_functions = set([
+    'CompressedTexImage1D',
+    'CompressedTexImage2D',
+    'CompressedTexImage3D',
+    'CompressedTexSubImage1D',
+    'CompressedTexSubImage2D',
+    'CompressedTexSubImage3D',
+    'PixelMapfv',
+    'PixelMapuiv',
+    'PixelMapusv',
+    ])
+
+
+# Functions that affect the bindings GL threading keeps track of.  The
+# hook is called on the application thread, with the context and the
+# function's parameters, after the command is queued.
+marshal_hooks = {
+    'BindBuffer': '_mesa_glthread_BindBuffer',
+    'DeleteBuffers': '_mesa_glthread_DeleteBuffers',
+    'BindVertexArray': '_mesa_glthread_BindVertexArray',
+    'BindVertexArrayAPPLE': '_mesa_glthread_BindVertexArray',
+    'DeleteVertexArrays': '_mesa_glthread_DeleteVertexArrays',
+    }
+
+
+def by_value_param(func, p):
+    """Return whether parameter p of func is copied into the command as
+    is."""
+    if not p.is_pointer():
+        return True
+    if func.name in vertex_pointer_functions and p.name == 'pointer':
+        return True
+    if func.name in draw_elements_functions and p.name == 'indices':
+        return True
+    return False
+
+
+def element_type(p):
+    base = p.get_base_type_string()
+    if base == 'GLvoid' or base == 'void':
+        return 'GLubyte'
+    return base
+
+
+def fixed_array_param(p):
+    """Return whether p is an input array of a fixed number of elements."""
+    return (p.is_pointer() and p.count and not p.counter and
+            not p.count_parameter_list and not p.is_image() and
+            not p.is_output and
+            'const' in p.type_string() and
+            p.type_string().count('*') == 1 and
+            element_type(p) != 'GLubyte')
+
+
+def variable_array_param(func, p):
+    """Return whether p is an input array whose size is given by another
+    (by-value) parameter."""
+    if not (p.is_pointer() and p.counter and not p.count_parameter_list and
+            not p.is_image() and not p.is_output and
+            'const' in p.type_string() and
+            p.type_string().count('*') == 1):
+        return False
+    for q in func.parameters:
+        if q.name == p.counter:
+            return not q.is_pointer()
+    return False
+
+
+class marshal_function(object):
+    def __init__(self, func):
+        self.func = func
+        self.name = func.name
+        self.params = [p for p in func.parameters if not p.is_padding]
+        self.fixed_params = []
+        self.variable_params = []
+        self.is_async = (func.return_type == 'void' and
+                         func.name not in sync_functions)
+
+        for p in self.params:
+            if p.name in ('ctx', 'cmd', 'cmd_size', 'variable_data'):
+                raise Exception('{0}: parameter name {1!r} clashes with '
+                                'generated code'.format(func.name, p.name))
+            if by_value_param(func, p) or fixed_array_param(p):
+                self.fixed_params.append(p)
+            elif variable_array_param(func, p):
+                self.variable_params.append(p)
+            else:
+                self.is_async = False
+
+        if (func.name in pixel_unpack_functions and
+            len(self.variable_params) != 1):
+            raise Exception('{0}: expected one pixel data parameter'.format(
+                func.name))
+
+    def fixed_field(self, p):
+        if by_value_param(self.func, p):
+            return '{0} {1}'.format(p.type_string(), p.name)
+        return '{0} {1}[{2}]'.format(element_type(p), p.name,
+                                     p.count * p.count_scale)
+
+    def size_expr(self, p, prefix = ''):
+        return '(size_t) {0}{1} * {2} * sizeof({3})'.format(
+            prefix, p.counter, p.count_scale, element_type(p))
+
+    def call_args(self, prefix):
+        args = []
+        for p in self.params:
+            if p in self.variable_params and self.name in pixel_unpack_functions:
+                args.append('{0}unpack_pbo ? {1}_offset : {1}_null ? NULL : '
+                            '{2}'.format(prefix, prefix + p.name, p.name))
+            elif p in self.variable_params:
+                args.append('{0}_null ? NULL : {1}'.format(prefix + p.name,
+                                                           p.name))
+            else:
+                args.append(prefix + p.name)
+        return ', '.join(args)
+
+    def print_sync_call(self, indent):
+        call = 'CALL_{0}(ctx->CurrentDispatch, ({1}))'.format(
+            self.name, self.func.get_called_parameter_string())
+        print indent + '_mesa_glthread_begin_sync(ctx);'
+        if self.func.return_type == 'void':
+            print indent + call + ';'
+            print indent + '_mesa_glthread_end_sync(ctx);'
+        else:
+            print indent + 'result = ' + call + ';'
+            print indent + '_mesa_glthread_end_sync(ctx);'
+            print indent + 'return result;'
+
+    def print_struct(self):
+        print 'struct marshal_cmd_{0}'.format(self.name)
+        print '{'
+        print '   struct marshal_cmd_base cmd_base;'
+        for p in self.fixed_params:
+            print '   {0};'.format(self.fixed_field(p))
+        for p in self.variable_params:
+            print '   GLboolean {0}_null;'.format(p.name)
+        if self.name in pixel_unpack_functions:
+            print '   GLboolean unpack_pbo;'
+            for p in self.variable_params:
+                print '   const {0} *{1}_offset;'.format(element_type(p),
+                                                      p.name)
+        if self.variable_params:
+            print '   /* Next in the command, unless unpack_pbo is set:' \
+                if self.name in pixel_unpack_functions else \
+                '   /* Next in the command:'
+            for p in self.variable_params:
+                print '    * {0}: {1} bytes'.format(p.name, self.size_expr(p))
+            print '    */'
+        print '};'
+
+    def print_unmarshal(self):
+        print 'static inline void'
+        print '_mesa_unmarshal_{0}(struct gl_context *ctx, ' \
+              'const struct marshal_cmd_{0} *cmd)'.format(self.name)
+        print '{'
+        if self.variable_params:
+            print '   const char *variable_data = (const char *) cmd +'
+            print '      ALIGN(sizeof(*cmd), 8);'
+            for p in self.variable_params:
+                print '   const {0} *{1} = (const {0} *) variable_data;'.format(
+                    element_type(p), p.name)
+                if p != self.variable_params[-1]:
+                    print '   variable_data += ALIGN({0}, 8);'.format(
+                        self.size_expr(p, 'cmd->'))
+        print '   CALL_{0}(ctx->CurrentDispatch, ({1}));'.format(
+            self.name, self.call_args('cmd->'))
+        print '}'
+
+    def print_async_marshal(self):
+        print '   size_t cmd_size = ALIGN(sizeof(struct marshal_cmd_{0}), ' \
+              '8);'.format(self.name)
+        has_payload = self.fixed_params or self.variable_params
+        if has_payload:
+            print '   struct marshal_cmd_{0} *cmd;'.format(self.name)
+        unpack = self.name in pixel_unpack_functions
+        if unpack:
+            print '   const bool unpack_pbo = ' \
+                  '_mesa_glthread_pixel_unpack_is_pbo(ctx);'
+        if self.variable_params:
+            indent = '      ' if unpack else '   '
+            print '   char *variable_data;'
+            print
+            if unpack:
+                print '   /* Pixel data in a buffer object is not copied */'
+                print '   if (!unpack_pbo) {'
+            for p in self.variable_params:
+                print indent + 'if (unlikely({0} < 0 || {0} > ' \
+                      'MARSHAL_MAX_CMD_SIZE))'.format(p.counter)
+                print indent + '   goto fallback_to_sync;'
+            for p in self.variable_params:
+                print indent + 'cmd_size += ALIGN({0}, 8);'.format(
+                    self.size_expr(p))
+            print indent + 'if (unlikely(cmd_size > MARSHAL_MAX_CMD_SIZE))'
+            print indent + '   goto fallback_to_sync;'
+            if unpack:
+                print '   }'
+        if self.name in draw_elements_functions:
+            print
+            print '   if (!_mesa_glthread_element_array_is_vbo(ctx))'
+            print '      goto fallback_to_sync;'
+        if self.name in vertex_pointer_functions:
+            print
+            print '   if (!_mesa_glthread_array_buffer_is_vbo(ctx)) {'
+            print '      _mesa_glthread_disable(ctx, "gl{0}(non-VBO array)");'.format(
+                self.name)
+            print '      CALL_{0}(ctx->CurrentDispatch, ({1}));'.format(
+                self.name, self.func.get_called_parameter_string())
+            print '      return;'
+            print '   }'
+        print
+        print '   {0}_mesa_glthread_allocate_command(ctx, ' \
+              'DISPATCH_CMD_{1}, cmd_size);'.format(
+                  'cmd = ' if has_payload else '', self.name)
+        for p in self.fixed_params:
+            if by_value_param(self.func, p):
+                print '   cmd->{0} = {0};'.format(p.name)
+            else:
+                print '   memcpy(cmd->{0}, {0}, sizeof(cmd->{0}));'.format(
+                    p.name)
+        if unpack:
+            print '   cmd->unpack_pbo = unpack_pbo;'
+        if self.variable_params:
+            print '   variable_data = (char *) cmd + ALIGN(sizeof(*cmd), 8);'
+            for p in self.variable_params:
+                print '   cmd->{0}_null = {0} == NULL;'.format(p.name)
+                if unpack:
+                    print '   cmd->{0}_offset = {0};'.format(p.name)
+                    print '   if (!unpack_pbo && {0} != NULL)'.format(p.name)
+                else:
+                    print '   if ({0} != NULL)'.format(p.name)
+                print '      memcpy(variable_data, {0}, {1});'.format(
+                    p.name, self.size_expr(p))
+                if p != self.variable_params[-1]:
+                    print '   variable_data += ALIGN({0}, 8);'.format(
+                        self.size_expr(p))
+        if self.name in marshal_hooks:
+            print '   {0}(ctx, {1});'.format(
+                marshal_hooks[self.name],
+                self.func.get_called_parameter_string())
+        if self.variable_params or self.name in draw_elements_functions:
+            print '   return;'
+            print
+            print 'fallback_to_sync:'
+            self.print_sync_call('   ')
+
+    def print_marshal(self):
+        print 'static {0} GLAPIENTRY'.format(self.func.return_type)
+        print '_mesa_marshal_{0}({1})'.format(
+            self.name, self.func.get_parameter_string())
+        print '{'
+        print '   GET_CURRENT_CONTEXT(ctx);'
+        if self.is_async:
+            self.print_async_marshal()
+        else:
+            if self.func.return_type != 'void':
+                print '   {0} result;'.format(self.func.return_type)
+            print
+            self.print_sync_call('   ')
+        print '}'
+
+
+class PrintCode(gl_XML.gl_print_base):
+
+    def __init__(self):
+        gl_XML.gl_print_base.__init__(self)
+
+        self.name = 'gl_marshal.py'
+        self.license = license.bsd_license_template % (
+            'Copyright (C) 2014 The Mesa Authors',
+            'THE AUTHORS OR COPYRIGHT HOLDERS')
+
+    def printRealHeader(self):
+        print header
+
+    def printRealFooter(self):
+        pass
+
+    def printBody(self, api):
+        functions = [marshal_function(f) for f in api.functionIterateByOffset()]
+        async_functions = [f for f in functions if f.is_async]
+
+        names = set([f.name for f in functions])
+        for name in (vertex_pointer_functions | draw_elements_functions |
+                     pixel_unpack_functions | set(marshal_hooks.keys())):
+            if name not in names:
+                raise Exception('Unknown function {0!r}'.format(name))
+
+        print 'enum marshal_dispatch_cmd_id'
+        print '{'
+        for f in async_functions:
+            print '   DISPATCH_CMD_{0},'.format(f.name)
+        print '};'
+        print
+
+        for f in functions:
+            if f.is_async:
+                f.print_struct()
+                print
+                f.print_unmarshal()
+                print
+            f.print_marshal()
+            print
+            print
+
+        print 'size_t'
+        print '_mesa_unmarshal_dispatch_cmd(struct gl_context *ctx, ' \
+              'const void *cmd)'
+        print '{'
+        print '   const struct marshal_cmd_base *cmd_base = cmd;'
+        print
+        print '   switch (cmd_base->cmd_id) {'
+        for f in async_functions:
+            print '   case DISPATCH_CMD_{0}:'.format(f.name)
+            print '      _mesa_unmarshal_{0}(ctx, ' \
+                  '(const struct marshal_cmd_{0} *) cmd);'.format(f.name)
+            print '      break;'
+        print '   default:'
+        print '      assert(!"Unknown GL thread command");'
+        print '      break;'
+        print '   }'
+        print
+        print '   return cmd_base->cmd_size;'
+        print '}'
+        print
+        print
+
+        print '/**'
+        print ' * Create the dispatch table used on the application thread' \
+              ' while'
+        print ' * GL threading is enabled.'
+        print ' */'
+        print 'struct _glapi_table *'
+        print '_mesa_create_marshal_table(void)'
+        print '{'
+        print '   struct _glapi_table *table;'
+        print
+        print '   table = _mesa_alloc_dispatch_table();'
+        print '   if (table == NULL)'
+        print '      return NULL;'
+        print
+        for f in functions:
+            print '   SET_{0}(table, _mesa_marshal_{0});'.format(f.name)
+        print
+        print '   return table;'
+        print '}'
+
+
+def show_usage():
+    print "Usage: %s [-f input_file_name]" % sys.argv[0]
+    sys.exit(1)
+
+
+if __name__ == '__main__':
+    file_name = "gl_and_es_API.xml"
+
+    try:
+        (args, trail) = getopt.getopt(sys.argv[1:], "m:f:")
+    except Exception,e:
+        show_usage()
+
+    for (arg,val) in args:
+        if arg == "-f":
+            file_name = val
+
+    printer = PrintCode()
+
+    api = gl_XML.parse_GL_API(file_name)
+    printer.Print(api)
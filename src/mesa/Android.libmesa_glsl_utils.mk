@@ -42,6 +42,7 @@ LOCAL_C_INCLUDES := \
 LOCAL_SRC_FILES := \
 	main/hash_table.c \
 	main/imports.c \
+	main/threadpool.c \
 	program/prog_hash_table.c \
 	program/symbol_table.c
 
@@ -64,6 +65,7 @@ LOCAL_C_INCLUDES := \
 LOCAL_SRC_FILES := \
 	main/hash_table.c \
 	main/imports.c \
+	main/threadpool.c \
 	program/prog_hash_table.c \
 	program/symbol_table.c
 
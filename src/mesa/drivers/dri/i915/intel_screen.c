@@ -63,9 +63,6 @@ DRI_CONF_BEGIN
       DRI_CONF_OPT_END
 
    DRI_CONF_SECTION_END
-   DRI_CONF_SECTION_QUALITY
-      DRI_CONF_FORCE_S3TC_ENABLE("false")
-   DRI_CONF_SECTION_END
    DRI_CONF_SECTION_DEBUG
       DRI_CONF_NO_RAST("false")
       DRI_CONF_ALWAYS_FLUSH_BATCH("false")
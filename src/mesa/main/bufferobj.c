@@ -46,6 +46,7 @@
 #include "texstore.h"
 #include "transformfeedback.h"
 #include "dispatch.h"
+#include "vbo/vbo.h"
 
 
 /* Debug flags */
@@ -459,6 +460,8 @@ _mesa_reference_buffer_object_(struct gl_context *ctx,
 	 ASSERT(ctx->Array.VAO->Vertex.BufferObj != bufObj);
 #endif
 
+         vbo_delete_minmax_cache(oldObj);
+
 	 ASSERT(ctx->Driver.DeleteBuffer);
          ctx->Driver.DeleteBuffer(ctx, oldObj);
       }
@@ -935,7 +938,25 @@ bind_buffer_object(struct gl_context *ctx, GLenum target, GLuint buffer)
                                         &newBufObj, "glBindBuffer"))
          return;
    }
-   
+
+   /* Remember buffers the GPU may write to behind our back */
+   switch (target) {
+   case GL_PIXEL_PACK_BUFFER:
+      newBufObj->UsageHistory |= USAGE_PIXEL_PACK_BUFFER;
+      break;
+   case GL_TRANSFORM_FEEDBACK_BUFFER:
+      newBufObj->UsageHistory |= USAGE_TRANSFORM_FEEDBACK_BUFFER;
+      break;
+   case GL_TEXTURE_BUFFER:
+      newBufObj->UsageHistory |= USAGE_TEXTURE_BUFFER;
+      break;
+   case GL_ATOMIC_COUNTER_BUFFER:
+      newBufObj->UsageHistory |= USAGE_ATOMIC_COUNTER_BUFFER;
+      break;
+   default:
+      break;
+   }
+
    /* bind new buffer */
    _mesa_reference_buffer_object(ctx, bindTarget, newBufObj);
 }
@@ -1275,6 +1296,7 @@ _mesa_BufferStorage(GLenum target, GLsizeiptr size, const GLvoid *data,
 
    bufObj->Written = GL_TRUE;
    bufObj->Immutable = GL_TRUE;
+   bufObj->MinMaxCacheDirty = true;
 
    ASSERT(ctx->Driver.BufferData);
    if (!ctx->Driver.BufferData(ctx, target, size, data, GL_DYNAMIC_DRAW,
@@ -1347,6 +1369,7 @@ _mesa_BufferData(GLenum target, GLsizeiptrARB size,
    FLUSH_VERTICES(ctx, _NEW_BUFFER_OBJECT);
 
    bufObj->Written = GL_TRUE;
+   bufObj->MinMaxCacheDirty = true;
 
 #ifdef VBO_DEBUG
    printf("glBufferDataARB(%u, sz %ld, from %p, usage 0x%x)\n",
@@ -1393,6 +1416,7 @@ _mesa_BufferSubData(GLenum target, GLintptrARB offset,
       return;
 
    bufObj->Written = GL_TRUE;
+   bufObj->MinMaxCacheDirty = true;
 
    ASSERT(ctx->Driver.BufferSubData);
    ctx->Driver.BufferSubData( ctx, offset, size, data, bufObj );
@@ -1455,6 +1479,8 @@ _mesa_ClearBufferData(GLenum target, GLenum internalformat, GLenum format,
       return;
    }
 
+   bufObj->MinMaxCacheDirty = true;
+
    if (data == NULL) {
       /* clear to zeros, per the spec */
       ctx->Driver.ClearBufferSubData(ctx, 0, bufObj->Size,
@@ -1506,6 +1532,8 @@ _mesa_ClearBufferSubData(GLenum target, GLenum internalformat,
       return;
    }
 
+   bufObj->MinMaxCacheDirty = true;
+
    if (data == NULL) {
       /* clear to zeros, per the spec */
       if (size > 0) {
@@ -1609,8 +1637,10 @@ _mesa_MapBuffer(GLenum target, GLenum access)
       bufObj->Mappings[MAP_USER].AccessFlags = accessFlags;
    }
 
-   if (access == GL_WRITE_ONLY_ARB || access == GL_READ_WRITE_ARB)
+   if (access == GL_WRITE_ONLY_ARB || access == GL_READ_WRITE_ARB) {
       bufObj->Written = GL_TRUE;
+      bufObj->MinMaxCacheDirty = true;
+   }
 
 #ifdef VBO_DEBUG
    printf("glMapBufferARB(%u, sz %ld, access 0x%x)\n",
@@ -1923,6 +1953,8 @@ _mesa_CopyBufferSubData(GLenum readTarget, GLenum writeTarget,
       }
    }
 
+   dst->MinMaxCacheDirty = true;
+
    ctx->Driver.CopyBufferSubData(ctx, src, dst, readOffset, writeOffset, size);
 }
 
@@ -2062,6 +2094,9 @@ _mesa_MapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length,
       return NULL;
    }
 
+   if (access & GL_MAP_WRITE_BIT)
+      bufObj->MinMaxCacheDirty = true;
+
    /* Mapping zero bytes should return a non-null pointer. */
    if (!length) {
       static long dummy = 0;
@@ -2648,6 +2683,7 @@ set_atomic_buffer_binding(struct gl_context *ctx,
    ctx->NewDriverState |= ctx->DriverFlags.NewAtomicBuffer;
 
    _mesa_reference_buffer_object(ctx, &binding->BufferObject, bufObj);
+   bufObj->UsageHistory |= USAGE_ATOMIC_COUNTER_BUFFER;
 
    if (bufObj == ctx->Shared->NullBufferObj) {
       binding->Offset = -1;
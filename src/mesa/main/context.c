@@ -98,6 +98,7 @@
 #include "fog.h"
 #include "formats.h"
 #include "framebuffer.h"
+#include "glthread.h"
 #include "hint.h"
 #include "hash.h"
 #include "light.h"
@@ -121,7 +122,6 @@
 #include "simple_list.h"
 #include "state.h"
 #include "stencil.h"
-#include "texcompress_s3tc.h"
 #include "texstate.h"
 #include "transformfeedback.h"
 #include "mtypes.h"
@@ -832,11 +832,10 @@ init_attrib_groups(struct gl_context *ctx)
    if (!_mesa_init_texture( ctx ))
       return GL_FALSE;
 
-   _mesa_init_texture_s3tc( ctx );
-
    /* Miscellaneous */
    ctx->NewState = _NEW_ALL;
    ctx->NewDriverState = ~0;
+   ctx->_ValidToRenderGeneration = ~0;
    ctx->ErrorValue = GL_NO_ERROR;
    ctx->ShareGroupReset = false;
    ctx->varying_vp_inputs = VERT_BIT_ALL;
@@ -1095,6 +1094,8 @@ _mesa_initialize_context(struct gl_context *ctx,
       ctx->FragmentProgram._MaintainTexEnvProgram = GL_TRUE;
    }
 
+   ctx->FastTexCompress = (_mesa_getenv("MESA_FAST_TEXCOMPRESS") != NULL);
+
    /* Mesa core handles all the formats that mesa core knows about.
     * Drivers will want to override this list with just the formats
     * they can handle, and confirm that appropriate fallbacks exist in
@@ -1195,6 +1196,8 @@ _mesa_create_context(gl_api api,
 void
 _mesa_free_context_data( struct gl_context *ctx )
 {
+   _mesa_glthread_destroy(ctx);
+
    if (!_mesa_get_current_context()){
       /* No current context, but we may need one in order to delete
        * texture objs, etc.  So temporarily bind the context now.
@@ -1573,6 +1576,10 @@ _mesa_make_current( struct gl_context *newCtx,
       }
    }
 
+   /* Execute the commands still queued for the old context. */
+   if (curCtx && curCtx != newCtx)
+      _mesa_glthread_finish(curCtx);
+
    if (curCtx && 
       (curCtx->WinSysDrawBuffer || curCtx->WinSysReadBuffer) &&
        /* make sure this context is valid for flushing */
@@ -1587,7 +1594,8 @@ _mesa_make_current( struct gl_context *newCtx,
       _glapi_set_dispatch(NULL);  /* none current */
    }
    else {
-      _glapi_set_dispatch(newCtx->CurrentDispatch);
+      _glapi_set_dispatch(newCtx->GLThread ? newCtx->MarshalExec
+                                           : newCtx->CurrentDispatch);
 
       if (drawBuffer && readBuffer) {
          ASSERT(_mesa_is_winsys_fbo(drawBuffer));
@@ -1855,6 +1863,16 @@ _mesa_valid_to_render(struct gl_context *ctx, const char *where)
    if (ctx->NewState)
       _mesa_update_state(ctx);
 
+   /* Nothing below can change without new state, so if the state was
+    * valid the last time and hasn't changed since, it still is.  The
+    * framebuffer status and pipeline validation are rechecked as they
+    * can be reset without flagging new state.
+    */
+   if (ctx->_ValidToRenderGeneration == ctx->StateGeneration &&
+       ctx->DrawBuffer->_Status == GL_FRAMEBUFFER_COMPLETE_EXT &&
+       (!ctx->_Shader->Name || ctx->_Shader->Validated))
+      return GL_TRUE;
+
    for (i = 0; i < MESA_SHADER_COMPUTE; i++) {
       if (!shader_linked_or_absent(ctx, ctx->_Shader->CurrentProgram[i],
                                    &from_glsl_shader[i], where))
@@ -1941,6 +1959,8 @@ _mesa_valid_to_render(struct gl_context *ctx, const char *where)
    }
 #endif
 
+   ctx->_ValidToRenderGeneration = ctx->StateGeneration;
+
    return GL_TRUE;
 }
 
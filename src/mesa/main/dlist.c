@@ -267,7 +267,6 @@ typedef enum
    OPCODE_PUSH_NAME,
    OPCODE_RASTER_POS,
    OPCODE_READ_BUFFER,
-   OPCODE_ROTATE,
    OPCODE_SCALE,
    OPCODE_SCISSOR,
    OPCODE_SELECT_TEXTURE_SGIS,
@@ -995,6 +994,7 @@ dlist_alloc(struct gl_context *ctx, OpCode opcode, GLuint bytes)
 
    n = ctx->ListState.CurrentBlock + ctx->ListState.CurrentPos;
    ctx->ListState.CurrentPos += numNodes;
+   ctx->ListState.LastInstruction = n;
 
    n[0].opcode = opcode;
 
@@ -2797,19 +2797,80 @@ save_MatrixMode(GLenum mode)
 }
 
 
-static void GLAPIENTRY
-save_MultMatrixf(const GLfloat * m)
+/**
+ * Matrix products are computed at compile time so that a run of
+ * glMultMatrix/glRotate/glScale/glTranslate calls executes as a single
+ * glMultMatrixf.  This sets up a stack-allocated GLmatrix to hold them.
+ */
+#define DECLARE_MATRIX(mat)                     \
+   GLfloat mat##_m[16], mat##_inv[16];          \
+   GLmatrix mat = { mat##_m, mat##_inv, 0, MATRIX_IDENTITY }
+
+
+/**
+ * If the last instruction compiled into the current list multiplies the
+ * current matrix, remove it from the list and load the matrix it
+ * multiplies by into \p mat.  Otherwise, set \p mat to the identity.
+ * \return GL_TRUE if an instruction was removed
+ */
+static GLboolean
+pop_matrix_instruction(struct gl_context *ctx, GLmatrix *mat)
 {
-   GET_CURRENT_CONTEXT(ctx);
-   Node *n;
-   ASSERT_OUTSIDE_SAVE_BEGIN_END_AND_FLUSH(ctx);
-   n = alloc_instruction(ctx, OPCODE_MULT_MATRIX, 16);
+   Node *n = ctx->ListState.LastInstruction;
+
+   _math_matrix_set_identity(mat);
+
+   if (!n)
+      return GL_FALSE;
+
+   switch (n[0].opcode) {
+   case OPCODE_MULT_MATRIX:
+      _math_matrix_loadf(mat, &n[1].f);
+      break;
+   case OPCODE_SCALE:
+      _math_matrix_scale(mat, n[1].f, n[2].f, n[3].f);
+      break;
+   case OPCODE_TRANSLATE:
+      _math_matrix_translate(mat, n[1].f, n[2].f, n[3].f);
+      break;
+   default:
+      return GL_FALSE;
+   }
+
+   ASSERT(n + InstSize[n[0].opcode] ==
+          ctx->ListState.CurrentBlock + ctx->ListState.CurrentPos);
+   ctx->ListState.CurrentPos -= InstSize[n[0].opcode];
+   ctx->ListState.LastInstruction = NULL;
+   return GL_TRUE;
+}
+
+
+static void
+save_mult_matrix(struct gl_context *ctx, const GLfloat *m)
+{
+   Node *n = alloc_instruction(ctx, OPCODE_MULT_MATRIX, 16);
    if (n) {
       GLuint i;
       for (i = 0; i < 16; i++) {
          n[1 + i].f = m[i];
       }
    }
+}
+
+
+static void GLAPIENTRY
+save_MultMatrixf(const GLfloat * m)
+{
+   GET_CURRENT_CONTEXT(ctx);
+   DECLARE_MATRIX(mat);
+   ASSERT_OUTSIDE_SAVE_BEGIN_END_AND_FLUSH(ctx);
+   if (pop_matrix_instruction(ctx, &mat)) {
+      _math_matrix_mul_floats(&mat, m);
+      save_mult_matrix(ctx, mat.m);
+   }
+   else {
+      save_mult_matrix(ctx, m);
+   }
    if (ctx->ExecuteFlag) {
       CALL_MultMatrixf(ctx->Exec, (m));
    }
@@ -3382,15 +3443,12 @@ static void GLAPIENTRY
 save_Rotatef(GLfloat angle, GLfloat x, GLfloat y, GLfloat z)
 {
    GET_CURRENT_CONTEXT(ctx);
-   Node *n;
+   DECLARE_MATRIX(mat);
    ASSERT_OUTSIDE_SAVE_BEGIN_END_AND_FLUSH(ctx);
-   n = alloc_instruction(ctx, OPCODE_ROTATE, 4);
-   if (n) {
-      n[1].f = angle;
-      n[2].f = x;
-      n[3].f = y;
-      n[4].f = z;
-   }
+   /* Always store rotations as a matrix, to save the trig at execute time */
+   pop_matrix_instruction(ctx, &mat);
+   _math_matrix_rotate(&mat, angle, x, y, z);
+   save_mult_matrix(ctx, mat.m);
    if (ctx->ExecuteFlag) {
       CALL_Rotatef(ctx->Exec, (angle, x, y, z));
    }
@@ -3408,13 +3466,19 @@ static void GLAPIENTRY
 save_Scalef(GLfloat x, GLfloat y, GLfloat z)
 {
    GET_CURRENT_CONTEXT(ctx);
-   Node *n;
+   DECLARE_MATRIX(mat);
    ASSERT_OUTSIDE_SAVE_BEGIN_END_AND_FLUSH(ctx);
-   n = alloc_instruction(ctx, OPCODE_SCALE, 3);
-   if (n) {
-      n[1].f = x;
-      n[2].f = y;
-      n[3].f = z;
+   if (pop_matrix_instruction(ctx, &mat)) {
+      _math_matrix_scale(&mat, x, y, z);
+      save_mult_matrix(ctx, mat.m);
+   }
+   else {
+      Node *n = alloc_instruction(ctx, OPCODE_SCALE, 3);
+      if (n) {
+         n[1].f = x;
+         n[2].f = y;
+         n[3].f = z;
+      }
    }
    if (ctx->ExecuteFlag) {
       CALL_Scalef(ctx->Exec, (x, y, z));
@@ -4020,13 +4084,19 @@ static void GLAPIENTRY
 save_Translatef(GLfloat x, GLfloat y, GLfloat z)
 {
    GET_CURRENT_CONTEXT(ctx);
-   Node *n;
+   DECLARE_MATRIX(mat);
    ASSERT_OUTSIDE_SAVE_BEGIN_END_AND_FLUSH(ctx);
-   n = alloc_instruction(ctx, OPCODE_TRANSLATE, 3);
-   if (n) {
-      n[1].f = x;
-      n[2].f = y;
-      n[3].f = z;
+   if (pop_matrix_instruction(ctx, &mat)) {
+      _math_matrix_translate(&mat, x, y, z);
+      save_mult_matrix(ctx, mat.m);
+   }
+   else {
+      Node *n = alloc_instruction(ctx, OPCODE_TRANSLATE, 3);
+      if (n) {
+         n[1].f = x;
+         n[2].f = y;
+         n[3].f = z;
+      }
    }
    if (ctx->ExecuteFlag) {
       CALL_Translatef(ctx->Exec, (x, y, z));
@@ -4981,13 +5051,33 @@ save_SetFragmentShaderConstantATI(GLuint dst, const GLfloat *value)
    }
 }
 
+/**
+ * Allocate an instruction setting vertex attribute \p attr.  Of several
+ * consecutive settings of the same attribute only the last can be
+ * observed, so if the previous instruction has the same opcode and
+ * attribute it is reused rather than compiling a new one.  Attribute
+ * zero emits a vertex inside glBegin/End and is never folded.
+ */
+static Node *
+alloc_attr_instruction(struct gl_context *ctx, OpCode opcode,
+                       GLenum attr, GLuint nparams)
+{
+   Node *n = ctx->ListState.LastInstruction;
+
+   if (attr != 0 && n && n[0].opcode == opcode && n[1].e == attr)
+      return n;
+
+   return alloc_instruction(ctx, opcode, nparams);
+}
+
+
 static void GLAPIENTRY
 save_Attr1fNV(GLenum attr, GLfloat x)
 {
    GET_CURRENT_CONTEXT(ctx);
    Node *n;
    SAVE_FLUSH_VERTICES(ctx);
-   n = alloc_instruction(ctx, OPCODE_ATTR_1F_NV, 2);
+   n = alloc_attr_instruction(ctx, OPCODE_ATTR_1F_NV, attr, 2);
    if (n) {
       n[1].e = attr;
       n[2].f = x;
@@ -5008,7 +5098,7 @@ save_Attr2fNV(GLenum attr, GLfloat x, GLfloat y)
    GET_CURRENT_CONTEXT(ctx);
    Node *n;
    SAVE_FLUSH_VERTICES(ctx);
-   n = alloc_instruction(ctx, OPCODE_ATTR_2F_NV, 3);
+   n = alloc_attr_instruction(ctx, OPCODE_ATTR_2F_NV, attr, 3);
    if (n) {
       n[1].e = attr;
       n[2].f = x;
@@ -5030,7 +5120,7 @@ save_Attr3fNV(GLenum attr, GLfloat x, GLfloat y, GLfloat z)
    GET_CURRENT_CONTEXT(ctx);
    Node *n;
    SAVE_FLUSH_VERTICES(ctx);
-   n = alloc_instruction(ctx, OPCODE_ATTR_3F_NV, 4);
+   n = alloc_attr_instruction(ctx, OPCODE_ATTR_3F_NV, attr, 4);
    if (n) {
       n[1].e = attr;
       n[2].f = x;
@@ -5053,7 +5143,7 @@ save_Attr4fNV(GLenum attr, GLfloat x, GLfloat y, GLfloat z, GLfloat w)
    GET_CURRENT_CONTEXT(ctx);
    Node *n;
    SAVE_FLUSH_VERTICES(ctx);
-   n = alloc_instruction(ctx, OPCODE_ATTR_4F_NV, 5);
+   n = alloc_attr_instruction(ctx, OPCODE_ATTR_4F_NV, attr, 5);
    if (n) {
       n[1].e = attr;
       n[2].f = x;
@@ -5078,7 +5168,7 @@ save_Attr1fARB(GLenum attr, GLfloat x)
    GET_CURRENT_CONTEXT(ctx);
    Node *n;
    SAVE_FLUSH_VERTICES(ctx);
-   n = alloc_instruction(ctx, OPCODE_ATTR_1F_ARB, 2);
+   n = alloc_attr_instruction(ctx, OPCODE_ATTR_1F_ARB, attr, 2);
    if (n) {
       n[1].e = attr;
       n[2].f = x;
@@ -5099,7 +5189,7 @@ save_Attr2fARB(GLenum attr, GLfloat x, GLfloat y)
    GET_CURRENT_CONTEXT(ctx);
    Node *n;
    SAVE_FLUSH_VERTICES(ctx);
-   n = alloc_instruction(ctx, OPCODE_ATTR_2F_ARB, 3);
+   n = alloc_attr_instruction(ctx, OPCODE_ATTR_2F_ARB, attr, 3);
    if (n) {
       n[1].e = attr;
       n[2].f = x;
@@ -5121,7 +5211,7 @@ save_Attr3fARB(GLenum attr, GLfloat x, GLfloat y, GLfloat z)
    GET_CURRENT_CONTEXT(ctx);
    Node *n;
    SAVE_FLUSH_VERTICES(ctx);
-   n = alloc_instruction(ctx, OPCODE_ATTR_3F_ARB, 4);
+   n = alloc_attr_instruction(ctx, OPCODE_ATTR_3F_ARB, attr, 4);
    if (n) {
       n[1].e = attr;
       n[2].f = x;
@@ -5144,7 +5234,7 @@ save_Attr4fARB(GLenum attr, GLfloat x, GLfloat y, GLfloat z, GLfloat w)
    GET_CURRENT_CONTEXT(ctx);
    Node *n;
    SAVE_FLUSH_VERTICES(ctx);
-   n = alloc_instruction(ctx, OPCODE_ATTR_4F_ARB, 5);
+   n = alloc_attr_instruction(ctx, OPCODE_ATTR_4F_ARB, attr, 5);
    if (n) {
       n[1].e = attr;
       n[2].f = x;
@@ -7437,9 +7527,6 @@ execute_list(struct gl_context *ctx, GLuint list)
          case OPCODE_READ_BUFFER:
             CALL_ReadBuffer(ctx->Exec, (n[1].e));
             break;
-         case OPCODE_ROTATE:
-            CALL_Rotatef(ctx->Exec, (n[1].f, n[2].f, n[3].f, n[4].f));
-            break;
          case OPCODE_SCALE:
             CALL_Scalef(ctx->Exec, (n[1].f, n[2].f, n[3].f));
             break;
@@ -8236,6 +8323,7 @@ _mesa_NewList(GLuint name, GLenum mode)
    ctx->ListState.CurrentList = make_list(name, BLOCK_SIZE);
    ctx->ListState.CurrentBlock = ctx->ListState.CurrentList->Head;
    ctx->ListState.CurrentPos = 0;
+   ctx->ListState.LastInstruction = NULL;
 
    ctx->Driver.NewList(ctx, name, mode);
 
@@ -8292,6 +8380,7 @@ _mesa_EndList(void)
    ctx->ListState.CurrentList = NULL;
    ctx->ListState.CurrentBlock = NULL;
    ctx->ListState.CurrentPos = 0;
+   ctx->ListState.LastInstruction = NULL;
    ctx->ExecuteFlag = GL_TRUE;
    ctx->CompileFlag = GL_FALSE;
 
@@ -8943,7 +9032,7 @@ print_list(struct gl_context *ctx, GLuint list)
                          n[4].f, n[8].f, n[12].f, n[16].f);
             break;
          case OPCODE_MULT_MATRIX:
-            printf("MultMatrix (or Rotate)\n");
+            printf("MultMatrix (or Rotate/Scale/Translate)\n");
             printf("  %8f %8f %8f %8f\n",
                          n[1].f, n[5].f, n[9].f, n[13].f);
             printf("  %8f %8f %8f %8f\n",
@@ -8979,10 +9068,6 @@ print_list(struct gl_context *ctx, GLuint list)
             printf("RasterPos %g %g %g %g\n",
                          n[1].f, n[2].f, n[3].f, n[4].f);
             break;
-         case OPCODE_ROTATE:
-            printf("Rotate %g %g %g %g\n",
-                         n[1].f, n[2].f, n[3].f, n[4].f);
-            break;
          case OPCODE_SCALE:
             printf("Scale %g %g %g\n", n[1].f, n[2].f, n[3].f);
             break;
@@ -9237,6 +9322,7 @@ _mesa_init_display_list(struct gl_context *ctx)
    ctx->CompileFlag = GL_FALSE;
    ctx->ListState.CurrentBlock = NULL;
    ctx->ListState.CurrentPos = 0;
+   ctx->ListState.LastInstruction = NULL;
 
    /* Display List group */
    ctx->List.ListBase = 0;
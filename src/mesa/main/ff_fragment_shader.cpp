@@ -357,7 +357,7 @@ static GLbitfield get_fp_input_mask( struct gl_context *ctx )
             fp_inputs |= VARYING_BIT_COL1;
       }
 
-      /* _NEW_TEXTURE */
+      /* _NEW_TEXTURE, _NEW_TEXTURE_MATRIX */
       fp_inputs |= (ctx->Texture._TexGenEnabled |
                     ctx->Texture._TexMatEnabled) << VARYING_SLOT_TEX0;
 
@@ -1344,8 +1344,9 @@ create_new_program(struct gl_context *ctx, struct state_key *key)
    const struct gl_shader_compiler_options *options =
       &ctx->ShaderCompilerOptions[MESA_SHADER_FRAGMENT];
 
+   opt_pass_tracker tracker;
    while (do_common_optimization(p.shader->ir, false, false, options,
-                                 ctx->Const.NativeIntegers))
+                                 ctx->Const.NativeIntegers, &tracker))
       ;
    reparent_ir(p.shader->ir, p.shader->ir);
 
@@ -42,6 +42,10 @@
 #include "../../gallium/auxiliary/util/u_format_rgb9e5.h"
 #include "../../gallium/auxiliary/util/u_format_r11g11b10f.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 
 /** Helper struct for MESA_FORMAT_Z32_FLOAT_S8X24_UINT */
 struct z32f_x24s8
@@ -58,6 +62,144 @@ typedef void (*pack_float_rgba_row_func)(GLuint n,
                                          const GLfloat src[][4], void *dst);
 
 
+#if defined(__SSE2__)
+
+/**
+ * \name SSE2 row functions for the 8-bit per channel RGBA formats
+ *
+ * These do the bulk of a row, four pixels at a time, and return the number
+ * of pixels done.  The scalar code finishes off the rest of the row.  The
+ * results are the same as the scalar code's, bit for bit.
+ */
+/*@{*/
+
+/** Where the channels of an 8888 format are, for a little-endian GLuint */
+enum layout_8888 {
+   LAYOUT_RGBA,   /**< R in bits 0-7, A in bits 24-31 */
+   LAYOUT_BGRA,
+   LAYOUT_ABGR,
+   LAYOUT_ARGB
+};
+
+/**
+ * Swizzle pixels in R, G, B, A byte order to \p layout, and clear the
+ * bits not in \p keep (the X channel).
+ */
+static inline __m128i
+swizzle_rgba_to_8888(__m128i p, enum layout_8888 layout, GLuint keep)
+{
+   const __m128i byte0 = _mm_set1_epi32(0xff);
+
+   switch (layout) {
+   case LAYOUT_RGBA:
+      break;
+   case LAYOUT_BGRA:
+      p = _mm_or_si128(_mm_and_si128(p, _mm_set1_epi32(0xff00ff00)),
+                       _mm_or_si128(_mm_and_si128(_mm_srli_epi32(p, 16),
+                                                  byte0),
+                                    _mm_slli_epi32(_mm_and_si128(p, byte0),
+                                                   16)));
+      break;
+   case LAYOUT_ABGR:
+      p = _mm_or_si128(
+             _mm_or_si128(_mm_srli_epi32(p, 24), _mm_slli_epi32(p, 24)),
+             _mm_or_si128(_mm_and_si128(_mm_srli_epi32(p, 8),
+                                        _mm_set1_epi32(0xff00)),
+                          _mm_and_si128(_mm_slli_epi32(p, 8),
+                                        _mm_set1_epi32(0xff0000))));
+      break;
+   case LAYOUT_ARGB:
+      p = _mm_or_si128(_mm_slli_epi32(p, 8), _mm_srli_epi32(p, 24));
+      break;
+   }
+
+   if (keep != ~0u)
+      p = _mm_and_si128(p, _mm_set1_epi32(keep));
+
+   return p;
+}
+
+static inline GLuint
+pack_row_ubyte_8888_sse2(GLuint n, const GLubyte src[][4], GLuint *d,
+                         enum layout_8888 layout, GLuint keep)
+{
+   GLuint i;
+
+   for (i = 0; i + 4 <= n; i += 4) {
+      __m128i p = _mm_loadu_si128((const __m128i *) src[i]);
+      _mm_storeu_si128((__m128i *) (d + i),
+                       swizzle_rgba_to_8888(p, layout, keep));
+   }
+
+   return i;
+}
+
+#if defined(USE_IEEE) && !defined(DEBUG)
+
+/**
+ * UNCLAMPED_FLOAT_TO_UBYTE() of four floats, giving 32-bit values.
+ */
+static inline __m128i
+unclamped_float_to_ubyte4(__m128 f)
+{
+   const __m128i bits = _mm_castps_si128(f);
+   const __m128i neg = _mm_cmplt_epi32(bits, _mm_setzero_si128());
+   const __m128i one = _mm_cmpgt_epi32(bits, _mm_set1_epi32(IEEE_ONE - 1));
+   __m128i ub;
+
+   ub = _mm_castps_si128(_mm_add_ps(_mm_mul_ps(f,
+                                               _mm_set1_ps(255.0F / 256.0F)),
+                                    _mm_set1_ps(32768.0F)));
+   ub = _mm_and_si128(ub, _mm_set1_epi32(0xff));
+   ub = _mm_andnot_si128(_mm_or_si128(neg, one), ub);
+   return _mm_or_si128(ub, _mm_and_si128(one, _mm_set1_epi32(0xff)));
+}
+
+static inline GLuint
+pack_row_float_8888_sse2(GLuint n, const GLfloat src[][4], GLuint *d,
+                         enum layout_8888 layout, GLuint keep)
+{
+   GLuint i;
+
+   for (i = 0; i + 4 <= n; i += 4) {
+      const __m128i p0 = unclamped_float_to_ubyte4(_mm_loadu_ps(src[i + 0]));
+      const __m128i p1 = unclamped_float_to_ubyte4(_mm_loadu_ps(src[i + 1]));
+      const __m128i p2 = unclamped_float_to_ubyte4(_mm_loadu_ps(src[i + 2]));
+      const __m128i p3 = unclamped_float_to_ubyte4(_mm_loadu_ps(src[i + 3]));
+      const __m128i p = _mm_packus_epi16(_mm_packs_epi32(p0, p1),
+                                         _mm_packs_epi32(p2, p3));
+
+      _mm_storeu_si128((__m128i *) (d + i),
+                       swizzle_rgba_to_8888(p, layout, keep));
+   }
+
+   return i;
+}
+
+#define PACK_FLOAT_8888_SSE2(N, SRC, D, LAYOUT, KEEP) \
+   i = pack_row_float_8888_sse2(N, SRC, D, LAYOUT, KEEP)
+
+#endif /* USE_IEEE && !DEBUG */
+
+/*@}*/
+
+#define PACK_UBYTE_8888_SSE2(N, SRC, D, LAYOUT, KEEP) \
+   i = pack_row_ubyte_8888_sse2(N, SRC, D, LAYOUT, KEEP)
+
+#else
+
+#define PACK_UBYTE_8888_SSE2(N, SRC, D, LAYOUT, KEEP) \
+   i = 0
+
+#endif /* __SSE2__ */
+
+#ifndef PACK_FLOAT_8888_SSE2
+#define PACK_FLOAT_8888_SSE2(N, SRC, D, LAYOUT, KEEP) \
+   i = 0
+#endif
+
+
+
 
 static inline GLfloat
 linear_to_srgb(GLfloat cl)
@@ -115,6 +257,7 @@ pack_row_ubyte_A8B8G8R8_UNORM(GLuint n, const GLubyte src[][4], void *dst)
 {
    GLuint *d = ((GLuint *) dst);
    GLuint i;
+   /* Not worth doing with SSE2, compilers turn this into bswap */
    for (i = 0; i < n; i++) {
       d[i] = PACK_COLOR_8888(src[i][RCOMP], src[i][GCOMP],
                              src[i][BCOMP], src[i][ACOMP]);
@@ -126,7 +269,8 @@ pack_row_float_A8B8G8R8_UNORM(GLuint n, const GLfloat src[][4], void *dst)
 {
    GLuint *d = ((GLuint *) dst);
    GLuint i;
-   for (i = 0; i < n; i++) {
+   PACK_FLOAT_8888_SSE2(n, src, d, LAYOUT_ABGR, ~0u);
+   for (; i < n; i++) {
       GLubyte v[4];
       _mesa_unclamped_float_rgba_to_ubyte(v, src[i]);
       pack_ubyte_A8B8G8R8_UNORM(v, d + i);
@@ -159,7 +303,8 @@ pack_row_ubyte_R8G8B8A8_UNORM(GLuint n, const GLubyte src[][4], void *dst)
 {
    GLuint *d = ((GLuint *) dst);
    GLuint i;
-   for (i = 0; i < n; i++) {
+   PACK_UBYTE_8888_SSE2(n, src, d, LAYOUT_RGBA, ~0u);
+   for (; i < n; i++) {
       d[i] = PACK_COLOR_8888(src[i][ACOMP], src[i][BCOMP],
                              src[i][GCOMP], src[i][RCOMP]);
    }
@@ -170,7 +315,8 @@ pack_row_float_R8G8B8A8_UNORM(GLuint n, const GLfloat src[][4], void *dst)
 {
    GLuint *d = ((GLuint *) dst);
    GLuint i;
-   for (i = 0; i < n; i++) {
+   PACK_FLOAT_8888_SSE2(n, src, d, LAYOUT_RGBA, ~0u);
+   for (; i < n; i++) {
       GLubyte v[4];
       _mesa_unclamped_float_rgba_to_ubyte(v, src[i]);
       pack_ubyte_R8G8B8A8_UNORM(v, d + i);
@@ -202,7 +348,8 @@ pack_row_ubyte_B8G8R8A8_UNORM(GLuint n, const GLubyte src[][4], void *dst)
 {
    GLuint *d = ((GLuint *) dst);
    GLuint i;
-   for (i = 0; i < n; i++) {
+   PACK_UBYTE_8888_SSE2(n, src, d, LAYOUT_BGRA, ~0u);
+   for (; i < n; i++) {
       d[i] = PACK_COLOR_8888(src[i][ACOMP], src[i][RCOMP],
                              src[i][GCOMP], src[i][BCOMP]);
    }
@@ -213,7 +360,8 @@ pack_row_float_B8G8R8A8_UNORM(GLuint n, const GLfloat src[][4], void *dst)
 {
    GLuint *d = ((GLuint *) dst);
    GLuint i;
-   for (i = 0; i < n; i++) {
+   PACK_FLOAT_8888_SSE2(n, src, d, LAYOUT_BGRA, ~0u);
+   for (; i < n; i++) {
       GLubyte v[4];
       _mesa_unclamped_float_rgba_to_ubyte(v, src[i]);
       pack_ubyte_B8G8R8A8_UNORM(v, d + i);
@@ -245,7 +393,8 @@ pack_row_ubyte_A8R8G8B8_UNORM(GLuint n, const GLubyte src[][4], void *dst)
 {
    GLuint *d = ((GLuint *) dst);
    GLuint i;
-   for (i = 0; i < n; i++) {
+   PACK_UBYTE_8888_SSE2(n, src, d, LAYOUT_ARGB, ~0u);
+   for (; i < n; i++) {
       d[i] = PACK_COLOR_8888(src[i][BCOMP], src[i][GCOMP],
                              src[i][RCOMP], src[i][ACOMP]);
    }
@@ -256,7 +405,8 @@ pack_row_float_A8R8G8B8_UNORM(GLuint n, const GLfloat src[][4], void *dst)
 {
    GLuint *d = ((GLuint *) dst);
    GLuint i;
-   for (i = 0; i < n; i++) {
+   PACK_FLOAT_8888_SSE2(n, src, d, LAYOUT_ARGB, ~0u);
+   for (; i < n; i++) {
       GLubyte v[4];
       _mesa_unclamped_float_rgba_to_ubyte(v, src[i]);
       pack_ubyte_A8R8G8B8_UNORM(v, d + i);
@@ -288,7 +438,8 @@ pack_row_ubyte_B8G8R8X8_UNORM(GLuint n, const GLubyte src[][4], void *dst)
 {
    GLuint *d = ((GLuint *) dst);
    GLuint i;
-   for (i = 0; i < n; i++) {
+   PACK_UBYTE_8888_SSE2(n, src, d, LAYOUT_BGRA, 0x00ffffff);
+   for (; i < n; i++) {
       d[i] = PACK_COLOR_8888(0, src[i][RCOMP], src[i][GCOMP], src[i][BCOMP]);
    }
 }
@@ -298,7 +449,8 @@ pack_row_float_B8G8R8X8_UNORM(GLuint n, const GLfloat src[][4], void *dst)
 {
    GLuint *d = ((GLuint *) dst);
    GLuint i;
-   for (i = 0; i < n; i++) {
+   PACK_FLOAT_8888_SSE2(n, src, d, LAYOUT_BGRA, 0x00ffffff);
+   for (; i < n; i++) {
       GLubyte v[4];
       _mesa_unclamped_float_rgba_to_ubyte(v, src[i]);
       pack_ubyte_B8G8R8X8_UNORM(v, d + i);
@@ -330,7 +482,8 @@ pack_row_ubyte_X8R8G8B8_UNORM(GLuint n, const GLubyte src[][4], void *dst)
 {
    GLuint *d = ((GLuint *) dst);
    GLuint i;
-   for (i = 0; i < n; i++) {
+   PACK_UBYTE_8888_SSE2(n, src, d, LAYOUT_ARGB, 0xffffff00);
+   for (; i < n; i++) {
       d[i] = PACK_COLOR_8888(src[i][BCOMP], src[i][GCOMP], src[i][RCOMP], 0);
    }
 }
@@ -340,7 +493,8 @@ pack_row_float_X8R8G8B8_UNORM(GLuint n, const GLfloat src[][4], void *dst)
 {
    GLuint *d = ((GLuint *) dst);
    GLuint i;
-   for (i = 0; i < n; i++) {
+   PACK_FLOAT_8888_SSE2(n, src, d, LAYOUT_ARGB, 0xffffff00);
+   for (; i < n; i++) {
       GLubyte v[4];
       _mesa_unclamped_float_rgba_to_ubyte(v, src[i]);
       pack_ubyte_X8R8G8B8_UNORM(v, d + i);
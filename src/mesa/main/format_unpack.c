@@ -29,6 +29,10 @@
 #include "../../gallium/auxiliary/util/u_format_rgb9e5.h"
 #include "../../gallium/auxiliary/util/u_format_r11g11b10f.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 
 /** Helper struct for MESA_FORMAT_Z32_FLOAT_S8X24_UINT */
 struct z32f_x24s8
@@ -88,12 +92,132 @@ _mesa_nonlinear_to_linear(GLubyte cs8)
 typedef void (*unpack_rgba_func)(const void *src, GLfloat dst[][4], GLuint n);
 
 
+#if defined(__SSE2__)
+
+/**
+ * \name SSE2 row functions for the 8-bit per channel RGBA formats
+ *
+ * These do the bulk of a row, four pixels at a time, and return the number
+ * of pixels done.  The scalar code finishes off the rest of the row.  The
+ * pixels are first swizzled to R, G, B, A byte order; the results are the
+ * same as the scalar code's, bit for bit.
+ */
+/*@{*/
+
+/** Where the channels of an 8888 format are, for a little-endian GLuint */
+enum layout_8888 {
+   LAYOUT_RGBA,   /**< R in bits 0-7, A in bits 24-31 */
+   LAYOUT_BGRA,
+   LAYOUT_ABGR,
+   LAYOUT_ARGB
+};
+
+static inline __m128i
+swizzle_8888_to_rgba(__m128i p, enum layout_8888 layout, GLboolean opaque)
+{
+   const __m128i byte0 = _mm_set1_epi32(0xff);
+
+   switch (layout) {
+   case LAYOUT_RGBA:
+      break;
+   case LAYOUT_BGRA:
+      p = _mm_or_si128(_mm_and_si128(p, _mm_set1_epi32(0xff00ff00)),
+                       _mm_or_si128(_mm_and_si128(_mm_srli_epi32(p, 16),
+                                                  byte0),
+                                    _mm_slli_epi32(_mm_and_si128(p, byte0),
+                                                   16)));
+      break;
+   case LAYOUT_ABGR:
+      p = _mm_or_si128(
+             _mm_or_si128(_mm_srli_epi32(p, 24), _mm_slli_epi32(p, 24)),
+             _mm_or_si128(_mm_and_si128(_mm_srli_epi32(p, 8),
+                                        _mm_set1_epi32(0xff00)),
+                          _mm_and_si128(_mm_slli_epi32(p, 8),
+                                        _mm_set1_epi32(0xff0000))));
+      break;
+   case LAYOUT_ARGB:
+      p = _mm_or_si128(_mm_srli_epi32(p, 8), _mm_slli_epi32(p, 24));
+      break;
+   }
+
+   if (opaque)
+      p = _mm_or_si128(p, _mm_set1_epi32(0xff000000));
+
+   return p;
+}
+
+static inline GLuint
+unpack_ubyte_8888_sse2(const GLuint *s, GLubyte dst[][4], GLuint n,
+                       enum layout_8888 layout, GLboolean opaque)
+{
+   GLuint i;
+
+   for (i = 0; i + 4 <= n; i += 4) {
+      __m128i p = _mm_loadu_si128((const __m128i *) (s + i));
+      _mm_storeu_si128((__m128i *) dst[i],
+                       swizzle_8888_to_rgba(p, layout, opaque));
+   }
+
+   return i;
+}
+
+static inline GLuint
+unpack_float_8888_sse2(const GLuint *s, GLfloat dst[][4], GLuint n,
+                       enum layout_8888 layout, GLboolean opaque)
+{
+   const __m128i zero = _mm_setzero_si128();
+   const __m128 scale = _mm_set1_ps(255.0F);
+   GLuint i;
+
+   for (i = 0; i + 4 <= n; i += 4) {
+      __m128i p = _mm_loadu_si128((const __m128i *) (s + i));
+      __m128i lo, hi;
+
+      p = swizzle_8888_to_rgba(p, layout, opaque);
+      lo = _mm_unpacklo_epi8(p, zero);
+      hi = _mm_unpackhi_epi8(p, zero);
+
+      /* Dividing, like the UBYTE_TO_FLOAT() table does, rather than
+       * multiplying by 1/255 keeps the results exact.
+       */
+      _mm_storeu_ps(dst[i + 0],
+                    _mm_div_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, zero)),
+                               scale));
+      _mm_storeu_ps(dst[i + 1],
+                    _mm_div_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, zero)),
+                               scale));
+      _mm_storeu_ps(dst[i + 2],
+                    _mm_div_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, zero)),
+                               scale));
+      _mm_storeu_ps(dst[i + 3],
+                    _mm_div_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, zero)),
+                               scale));
+   }
+
+   return i;
+}
+
+/*@}*/
+
+#define UNPACK_8888_SSE2(FUNC, S, DST, N, LAYOUT, OPAQUE) \
+   i = FUNC(S, DST, N, LAYOUT, OPAQUE)
+
+#else
+
+#define UNPACK_8888_SSE2(FUNC, S, DST, N, LAYOUT, OPAQUE) \
+   i = 0
+
+#endif /* __SSE2__ */
+
+
+
 static void
 unpack_A8B8G8R8_UNORM(const void *src, GLfloat dst[][4], GLuint n)
 {
    const GLuint *s = ((const GLuint *) src);
    GLuint i;
-   for (i = 0; i < n; i++) {
+   UNPACK_8888_SSE2(unpack_float_8888_sse2, s, dst, n, LAYOUT_ABGR, GL_FALSE);
+   for (; i < n; i++) {
       dst[i][RCOMP] = UBYTE_TO_FLOAT( (s[i] >> 24)        );
       dst[i][GCOMP] = UBYTE_TO_FLOAT( (s[i] >> 16) & 0xff );
       dst[i][BCOMP] = UBYTE_TO_FLOAT( (s[i] >>  8) & 0xff );
@@ -106,7 +230,8 @@ unpack_R8G8B8A8_UNORM(const void *src, GLfloat dst[][4], GLuint n)
 {
    const GLuint *s = ((const GLuint *) src);
    GLuint i;
-   for (i = 0; i < n; i++) {
+   UNPACK_8888_SSE2(unpack_float_8888_sse2, s, dst, n, LAYOUT_RGBA, GL_FALSE);
+   for (; i < n; i++) {
       dst[i][RCOMP] = UBYTE_TO_FLOAT( (s[i]      ) & 0xff );
       dst[i][GCOMP] = UBYTE_TO_FLOAT( (s[i] >>  8) & 0xff );
       dst[i][BCOMP] = UBYTE_TO_FLOAT( (s[i] >> 16) & 0xff );
@@ -119,7 +244,8 @@ unpack_B8G8R8A8_UNORM(const void *src, GLfloat dst[][4], GLuint n)
 {
    const GLuint *s = ((const GLuint *) src);
    GLuint i;
-   for (i = 0; i < n; i++) {
+   UNPACK_8888_SSE2(unpack_float_8888_sse2, s, dst, n, LAYOUT_BGRA, GL_FALSE);
+   for (; i < n; i++) {
       dst[i][RCOMP] = UBYTE_TO_FLOAT( (s[i] >> 16) & 0xff );
       dst[i][GCOMP] = UBYTE_TO_FLOAT( (s[i] >>  8) & 0xff );
       dst[i][BCOMP] = UBYTE_TO_FLOAT( (s[i]      ) & 0xff );
@@ -132,7 +258,8 @@ unpack_A8R8G8B8_UNORM(const void *src, GLfloat dst[][4], GLuint n)
 {
    const GLuint *s = ((const GLuint *) src);
    GLuint i;
-   for (i = 0; i < n; i++) {
+   UNPACK_8888_SSE2(unpack_float_8888_sse2, s, dst, n, LAYOUT_ARGB, GL_FALSE);
+   for (; i < n; i++) {
       dst[i][RCOMP] = UBYTE_TO_FLOAT( (s[i] >>  8) & 0xff );
       dst[i][GCOMP] = UBYTE_TO_FLOAT( (s[i] >> 16) & 0xff );
       dst[i][BCOMP] = UBYTE_TO_FLOAT( (s[i] >> 24)        );
@@ -145,7 +272,8 @@ unpack_RGBX8888(const void *src, GLfloat dst[][4], GLuint n)
 {
    const GLuint *s = ((const GLuint *) src);
    GLuint i;
-   for (i = 0; i < n; i++) {
+   UNPACK_8888_SSE2(unpack_float_8888_sse2, s, dst, n, LAYOUT_ABGR, GL_TRUE);
+   for (; i < n; i++) {
       dst[i][RCOMP] = UBYTE_TO_FLOAT( (s[i] >> 24)        );
       dst[i][GCOMP] = UBYTE_TO_FLOAT( (s[i] >> 16) & 0xff );
       dst[i][BCOMP] = UBYTE_TO_FLOAT( (s[i] >>  8) & 0xff );
@@ -158,7 +286,8 @@ unpack_RGBX8888_REV(const void *src, GLfloat dst[][4], GLuint n)
 {
    const GLuint *s = ((const GLuint *) src);
    GLuint i;
-   for (i = 0; i < n; i++) {
+   UNPACK_8888_SSE2(unpack_float_8888_sse2, s, dst, n, LAYOUT_RGBA, GL_TRUE);
+   for (; i < n; i++) {
       dst[i][RCOMP] = UBYTE_TO_FLOAT( (s[i]      ) & 0xff );
       dst[i][GCOMP] = UBYTE_TO_FLOAT( (s[i] >>  8) & 0xff );
       dst[i][BCOMP] = UBYTE_TO_FLOAT( (s[i] >> 16) & 0xff );
@@ -171,7 +300,8 @@ unpack_B8G8R8X8_UNORM(const void *src, GLfloat dst[][4], GLuint n)
 {
    const GLuint *s = ((const GLuint *) src);
    GLuint i;
-   for (i = 0; i < n; i++) {
+   UNPACK_8888_SSE2(unpack_float_8888_sse2, s, dst, n, LAYOUT_BGRA, GL_TRUE);
+   for (; i < n; i++) {
       dst[i][RCOMP] = UBYTE_TO_FLOAT( (s[i] >> 16) & 0xff );
       dst[i][GCOMP] = UBYTE_TO_FLOAT( (s[i] >>  8) & 0xff );
       dst[i][BCOMP] = UBYTE_TO_FLOAT( (s[i]      ) & 0xff );
@@ -184,7 +314,8 @@ unpack_X8R8G8B8_UNORM(const void *src, GLfloat dst[][4], GLuint n)
 {
    const GLuint *s = ((const GLuint *) src);
    GLuint i;
-   for (i = 0; i < n; i++) {
+   UNPACK_8888_SSE2(unpack_float_8888_sse2, s, dst, n, LAYOUT_ARGB, GL_TRUE);
+   for (; i < n; i++) {
       dst[i][RCOMP] = UBYTE_TO_FLOAT( (s[i] >>  8) & 0xff );
       dst[i][GCOMP] = UBYTE_TO_FLOAT( (s[i] >> 16) & 0xff );
       dst[i][BCOMP] = UBYTE_TO_FLOAT( (s[i] >> 24)        );
@@ -2593,7 +2724,8 @@ unpack_ubyte_A8B8G8R8_UNORM(const void *src, GLubyte dst[][4], GLuint n)
 {
    const GLuint *s = ((const GLuint *) src);
    GLuint i;
-   for (i = 0; i < n; i++) {
+   UNPACK_8888_SSE2(unpack_ubyte_8888_sse2, s, dst, n, LAYOUT_ABGR, GL_FALSE);
+   for (; i < n; i++) {
       dst[i][RCOMP] = (s[i] >> 24);
       dst[i][GCOMP] = (s[i] >> 16) & 0xff;
       dst[i][BCOMP] = (s[i] >>  8) & 0xff;
@@ -2606,7 +2738,8 @@ unpack_ubyte_R8G8B8A8_UNORM(const void *src, GLubyte dst[][4], GLuint n)
 {
    const GLuint *s = ((const GLuint *) src);
    GLuint i;
-   for (i = 0; i < n; i++) {
+   UNPACK_8888_SSE2(unpack_ubyte_8888_sse2, s, dst, n, LAYOUT_RGBA, GL_FALSE);
+   for (; i < n; i++) {
       dst[i][RCOMP] = (s[i]      ) & 0xff;
       dst[i][GCOMP] = (s[i] >>  8) & 0xff;
       dst[i][BCOMP] = (s[i] >> 16) & 0xff;
@@ -2619,7 +2752,8 @@ unpack_ubyte_B8G8R8A8_UNORM(const void *src, GLubyte dst[][4], GLuint n)
 {
    const GLuint *s = ((const GLuint *) src);
    GLuint i;
-   for (i = 0; i < n; i++) {
+   UNPACK_8888_SSE2(unpack_ubyte_8888_sse2, s, dst, n, LAYOUT_BGRA, GL_FALSE);
+   for (; i < n; i++) {
       dst[i][RCOMP] = (s[i] >> 16) & 0xff;
       dst[i][GCOMP] = (s[i] >>  8) & 0xff;
       dst[i][BCOMP] = (s[i]      ) & 0xff;
@@ -2632,7 +2766,8 @@ unpack_ubyte_A8R8G8B8_UNORM(const void *src, GLubyte dst[][4], GLuint n)
 {
    const GLuint *s = ((const GLuint *) src);
    GLuint i;
-   for (i = 0; i < n; i++) {
+   UNPACK_8888_SSE2(unpack_ubyte_8888_sse2, s, dst, n, LAYOUT_ARGB, GL_FALSE);
+   for (; i < n; i++) {
       dst[i][RCOMP] = (s[i] >>  8) & 0xff;
       dst[i][GCOMP] = (s[i] >> 16) & 0xff;
       dst[i][BCOMP] = (s[i] >> 24);
@@ -2645,7 +2780,8 @@ unpack_ubyte_RGBX8888(const void *src, GLubyte dst[][4], GLuint n)
 {
    const GLuint *s = ((const GLuint *) src);
    GLuint i;
-   for (i = 0; i < n; i++) {
+   UNPACK_8888_SSE2(unpack_ubyte_8888_sse2, s, dst, n, LAYOUT_ABGR, GL_TRUE);
+   for (; i < n; i++) {
       dst[i][RCOMP] = (s[i] >> 24);
       dst[i][GCOMP] = (s[i] >> 16) & 0xff;
       dst[i][BCOMP] = (s[i] >>  8) & 0xff;
@@ -2658,7 +2794,8 @@ unpack_ubyte_RGBX8888_REV(const void *src, GLubyte dst[][4], GLuint n)
 {
    const GLuint *s = ((const GLuint *) src);
    GLuint i;
-   for (i = 0; i < n; i++) {
+   UNPACK_8888_SSE2(unpack_ubyte_8888_sse2, s, dst, n, LAYOUT_RGBA, GL_TRUE);
+   for (; i < n; i++) {
       dst[i][RCOMP] = (s[i]      ) & 0xff;
       dst[i][GCOMP] = (s[i] >>  8) & 0xff;
       dst[i][BCOMP] = (s[i] >> 16) & 0xff;
@@ -2671,7 +2808,8 @@ unpack_ubyte_B8G8R8X8_UNORM(const void *src, GLubyte dst[][4], GLuint n)
 {
    const GLuint *s = ((const GLuint *) src);
    GLuint i;
-   for (i = 0; i < n; i++) {
+   UNPACK_8888_SSE2(unpack_ubyte_8888_sse2, s, dst, n, LAYOUT_BGRA, GL_TRUE);
+   for (; i < n; i++) {
       dst[i][RCOMP] = (s[i] >> 16) & 0xff;
       dst[i][GCOMP] = (s[i] >>  8) & 0xff;
       dst[i][BCOMP] = (s[i]      ) & 0xff;
@@ -2684,7 +2822,8 @@ unpack_ubyte_X8R8G8B8_UNORM(const void *src, GLubyte dst[][4], GLuint n)
 {
    const GLuint *s = ((const GLuint *) src);
    GLuint i;
-   for (i = 0; i < n; i++) {
+   UNPACK_8888_SSE2(unpack_ubyte_8888_sse2, s, dst, n, LAYOUT_ARGB, GL_TRUE);
+   for (; i < n; i++) {
       dst[i][RCOMP] = (s[i] >>  8) & 0xff;
       dst[i][GCOMP] = (s[i] >> 16) & 0xff;
       dst[i][BCOMP] = (s[i] >> 24);
@@ -0,0 +1,426 @@
+/*
+ * Copyright (c) 2014 The Mesa Authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * \file glthread.c
+ * Worker thread and queue management for GL threading.
+ *
+ * The application thread fills a batch with marshalled commands and hands
+ * it to the worker thread when it is full or when the application needs the
+ * results of the commands queued so far.  The worker thread makes the
+ * context current to itself and executes each batch in order.
+ */
+
+#include "main/glheader.h"
+#include "main/context.h"
+#include "main/errors.h"
+#include "main/glthread.h"
+#include "main/hash.h"
+#include "main/imports.h"
+#include "main/mtypes.h"
+#include "glapi/glapi.h"
+
+
+static void
+glthread_execute_batch(struct gl_context *ctx, struct glthread_batch *batch)
+{
+   size_t pos = 0;
+
+   /* The dispatch table may have been switched (glBegin/glEnd, display list
+    * compilation) by a command in an earlier batch or by a synchronous call
+    * made while the worker was idle.
+    */
+   _glapi_set_dispatch(ctx->CurrentDispatch);
+
+   while (pos < batch->used)
+      pos += _mesa_unmarshal_dispatch_cmd(ctx, (char *) batch->buffer + pos);
+
+   assert(pos == batch->used);
+}
+
+
+static int
+glthread_worker(void *data)
+{
+   struct glthread_state *glthread = data;
+   struct gl_context *ctx = glthread->ctx;
+
+   _glapi_set_context(ctx);
+
+   mtx_lock(&glthread->mutex);
+   for (;;) {
+      struct glthread_batch *batch;
+
+      while (glthread->executed == glthread->submitted && !glthread->shutdown)
+         cnd_wait(&glthread->new_work, &glthread->mutex);
+
+      if (glthread->executed == glthread->submitted)
+         break;
+
+      batch = &glthread->batches[glthread->executed % MARSHAL_MAX_BATCHES];
+      mtx_unlock(&glthread->mutex);
+
+      glthread_execute_batch(ctx, batch);
+
+      mtx_lock(&glthread->mutex);
+      glthread->executed++;
+      cnd_broadcast(&glthread->work_done);
+   }
+   mtx_unlock(&glthread->mutex);
+
+   _glapi_set_context(NULL);
+   _glapi_set_dispatch(NULL);
+   return 0;
+}
+
+
+/**
+ * Reload the bindings tracked by the application thread from the context.
+ * Only valid while the worker thread is idle.
+ */
+static void
+glthread_refresh_bindings(struct gl_context *ctx)
+{
+   struct glthread_state *glthread = ctx->GLThread;
+   struct gl_vertex_array_object *vao = ctx->Array.VAO;
+   struct glthread_vao *shadow;
+
+   glthread->CurrentArrayBufferName = ctx->Array.ArrayBufferObj->Name;
+   glthread->CurrentPixelUnpackBufferName = ctx->Unpack.BufferObj->Name;
+
+   if (vao->Name == 0) {
+      shadow = &glthread->DefaultVAO;
+   }
+   else {
+      shadow = _mesa_HashLookup(glthread->VAOs, vao->Name);
+      if (!shadow) {
+         shadow = CALLOC_STRUCT(glthread_vao);
+         if (!shadow)
+            shadow = &glthread->DefaultVAO;
+         else
+            _mesa_HashInsert(glthread->VAOs, vao->Name, shadow);
+      }
+   }
+
+   shadow->IndexBufferName = vao->IndexBufferObj->Name;
+   glthread->CurrentVAO = shadow;
+}
+
+
+static void
+free_vao(GLuint key, void *data, void *userData)
+{
+   (void) key;
+   (void) userData;
+   free(data);
+}
+
+
+/**
+ * Start a worker thread for the context and route the context's GL calls
+ * through it.  Failure is not an error: the context keeps working without
+ * threading.
+ */
+void
+_mesa_glthread_init(struct gl_context *ctx)
+{
+   struct glthread_state *glthread;
+
+   if (ctx->GLThread)
+      return;
+
+   glthread = calloc(1, sizeof(*glthread));
+   if (!glthread)
+      return;
+
+   ctx->MarshalExec = _mesa_create_marshal_table();
+   glthread->VAOs = _mesa_NewHashTable();
+   if (!ctx->MarshalExec || !glthread->VAOs)
+      goto fail;
+
+   glthread->ctx = ctx;
+   glthread->batch = &glthread->batches[0];
+   mtx_init(&glthread->mutex, mtx_plain);
+   cnd_init(&glthread->new_work);
+   cnd_init(&glthread->work_done);
+
+   ctx->GLThread = glthread;
+   glthread_refresh_bindings(ctx);
+
+   if (thrd_create(&glthread->thread, glthread_worker, glthread) !=
+       thrd_success) {
+      ctx->GLThread = NULL;
+      cnd_destroy(&glthread->work_done);
+      cnd_destroy(&glthread->new_work);
+      mtx_destroy(&glthread->mutex);
+      goto fail;
+   }
+
+   if (_mesa_get_current_context() == ctx)
+      _glapi_set_dispatch(ctx->MarshalExec);
+   return;
+
+fail:
+   if (glthread->VAOs) {
+      _mesa_HashDeleteAll(glthread->VAOs, free_vao, NULL);
+      _mesa_DeleteHashTable(glthread->VAOs);
+   }
+   free(glthread);
+   free(ctx->MarshalExec);
+   ctx->MarshalExec = NULL;
+}
+
+
+/**
+ * Execute everything still queued, stop the worker thread and go back to
+ * direct dispatch.
+ */
+void
+_mesa_glthread_destroy(struct gl_context *ctx)
+{
+   struct glthread_state *glthread = ctx->GLThread;
+
+   if (!glthread)
+      return;
+
+   _mesa_glthread_finish(ctx);
+
+   mtx_lock(&glthread->mutex);
+   glthread->shutdown = true;
+   cnd_broadcast(&glthread->new_work);
+   mtx_unlock(&glthread->mutex);
+   thrd_join(glthread->thread, NULL);
+
+   cnd_destroy(&glthread->work_done);
+   cnd_destroy(&glthread->new_work);
+   mtx_destroy(&glthread->mutex);
+
+   _mesa_HashDeleteAll(glthread->VAOs, free_vao, NULL);
+   _mesa_DeleteHashTable(glthread->VAOs);
+   free(glthread);
+   ctx->GLThread = NULL;
+
+   if (_glapi_get_dispatch() == ctx->MarshalExec)
+      _glapi_set_dispatch(ctx->CurrentDispatch);
+
+   free(ctx->MarshalExec);
+   ctx->MarshalExec = NULL;
+}
+
+
+/**
+ * Turn off threading for the rest of the context's lifetime, e.g. because
+ * the application uses a feature that can't be marshalled.
+ */
+void
+_mesa_glthread_disable(struct gl_context *ctx, const char *reason)
+{
+   if (!ctx->GLThread)
+      return;
+
+   _mesa_debug(ctx, "Disabling GL threading: %s\n", reason);
+   _mesa_glthread_destroy(ctx);
+}
+
+
+/**
+ * Hand the current batch to the worker thread and start filling the next
+ * one, waiting for the worker thread to release it if needed.
+ */
+void
+_mesa_glthread_flush_batch(struct gl_context *ctx)
+{
+   struct glthread_state *glthread = ctx->GLThread;
+
+   if (!glthread->batch->used)
+      return;
+
+   mtx_lock(&glthread->mutex);
+   glthread->submitted++;
+   cnd_signal(&glthread->new_work);
+   while (glthread->submitted - glthread->executed >= MARSHAL_MAX_BATCHES)
+      cnd_wait(&glthread->work_done, &glthread->mutex);
+   mtx_unlock(&glthread->mutex);
+
+   glthread->batch =
+      &glthread->batches[glthread->submitted % MARSHAL_MAX_BATCHES];
+   glthread->batch->used = 0;
+}
+
+
+/**
+ * Wait until the worker thread has executed every command queued so far.
+ */
+void
+_mesa_glthread_finish(struct gl_context *ctx)
+{
+   struct glthread_state *glthread = ctx->GLThread;
+
+   if (!glthread)
+      return;
+
+   /* Nothing to wait for if the worker thread itself ends up here, e.g.
+    * through a driver flush.
+    */
+   if (thrd_equal(glthread->thread, thrd_current()))
+      return;
+
+   _mesa_glthread_flush_batch(ctx);
+
+   mtx_lock(&glthread->mutex);
+   while (glthread->executed != glthread->submitted)
+      cnd_wait(&glthread->work_done, &glthread->mutex);
+   mtx_unlock(&glthread->mutex);
+
+   glthread_refresh_bindings(ctx);
+}
+
+
+/**
+ * Called by the marshalling functions of commands that can't be queued,
+ * before executing them on the application thread.
+ */
+void
+_mesa_glthread_begin_sync(struct gl_context *ctx)
+{
+   _mesa_glthread_finish(ctx);
+
+   /* The command may look at or switch the dispatch table. */
+   _glapi_set_dispatch(ctx->CurrentDispatch);
+}
+
+
+void
+_mesa_glthread_end_sync(struct gl_context *ctx)
+{
+   /* The command may have disabled threading (or, via a nested call,
+    * destroyed it).
+    */
+   if (!ctx->GLThread)
+      return;
+
+   glthread_refresh_bindings(ctx);
+   _glapi_set_dispatch(ctx->MarshalExec);
+}
+
+
+void
+_mesa_glthread_BindBuffer(struct gl_context *ctx, GLenum target,
+                          GLuint buffer)
+{
+   struct glthread_state *glthread = ctx->GLThread;
+
+   switch (target) {
+   case GL_ARRAY_BUFFER:
+      glthread->CurrentArrayBufferName = buffer;
+      break;
+   case GL_ELEMENT_ARRAY_BUFFER:
+      glthread->CurrentVAO->IndexBufferName = buffer;
+      break;
+   case GL_PIXEL_UNPACK_BUFFER:
+      glthread->CurrentPixelUnpackBufferName = buffer;
+      break;
+   }
+}
+
+
+void
+_mesa_glthread_DeleteBuffers(struct gl_context *ctx, GLsizei n,
+                             const GLuint *buffers)
+{
+   struct glthread_state *glthread = ctx->GLThread;
+   GLsizei i;
+
+   if (n < 0 || !buffers)
+      return;
+
+   /* Deleting a bound buffer unbinds it from the current VAO and the
+    * context; bindings in other VAOs are left alone.
+    */
+   for (i = 0; i < n; i++) {
+      if (!buffers[i])
+         continue;
+      if (glthread->CurrentArrayBufferName == buffers[i])
+         glthread->CurrentArrayBufferName = 0;
+      if (glthread->CurrentPixelUnpackBufferName == buffers[i])
+         glthread->CurrentPixelUnpackBufferName = 0;
+      if (glthread->CurrentVAO->IndexBufferName == buffers[i])
+         glthread->CurrentVAO->IndexBufferName = 0;
+   }
+}
+
+
+void
+_mesa_glthread_BindVertexArray(struct gl_context *ctx, GLuint array)
+{
+   struct glthread_state *glthread = ctx->GLThread;
+   struct glthread_vao *vao;
+
+   if (array == 0) {
+      glthread->CurrentVAO = &glthread->DefaultVAO;
+      return;
+   }
+
+   vao = _mesa_HashLookup(glthread->VAOs, array);
+   if (!vao) {
+      vao = CALLOC_STRUCT(glthread_vao);
+      if (!vao) {
+         /* Be conservative: assume client-side indices. */
+         glthread->DefaultVAO.IndexBufferName = 0;
+         glthread->CurrentVAO = &glthread->DefaultVAO;
+         return;
+      }
+      _mesa_HashInsert(glthread->VAOs, array, vao);
+   }
+   glthread->CurrentVAO = vao;
+}
+
+
+void
+_mesa_glthread_DeleteVertexArrays(struct gl_context *ctx, GLsizei n,
+                                  const GLuint *arrays)
+{
+   struct glthread_state *glthread = ctx->GLThread;
+   GLsizei i;
+
+   if (n < 0 || !arrays)
+      return;
+
+   for (i = 0; i < n; i++) {
+      struct glthread_vao *vao;
+
+      if (!arrays[i])
+         continue;
+
+      vao = _mesa_HashLookup(glthread->VAOs, arrays[i]);
+      if (!vao)
+         continue;
+
+      /* Deleting the bound VAO binds the default one. */
+      if (glthread->CurrentVAO == vao)
+         glthread->CurrentVAO = &glthread->DefaultVAO;
+
+      _mesa_HashRemove(glthread->VAOs, arrays[i]);
+      free(vao);
+   }
+}
@@ -0,0 +1,223 @@
+/*
+ * Copyright (c) 2014 The Mesa Authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * \file glthread.h
+ * GL threading: execution of GL commands on a separate worker thread.
+ *
+ * When GL threading is enabled for a context, the application thread
+ * dispatches through ctx->MarshalExec (see marshal_generated.c, generated
+ * by gl_marshal.py).  Commands whose parameters can be copied are packed
+ * into batches which are executed by the worker thread against
+ * ctx->CurrentDispatch.  Every other command first waits for the worker
+ * thread to go idle and then runs directly on the application thread.
+ */
+
+#ifndef GLTHREAD_H
+#define GLTHREAD_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "c11/threads.h"
+#include "main/glheader.h"
+#include "main/macros.h"
+#include "main/mtypes.h"
+
+/**
+ * Size of a batch of commands, which is also the largest command that can
+ * be queued.  Larger commands are executed synchronously.
+ */
+#define MARSHAL_MAX_CMD_SIZE (8 * 1024)
+
+/**
+ * Number of batches, which bounds how far the application thread may run
+ * ahead of the worker thread.
+ */
+#define MARSHAL_MAX_BATCHES 4
+
+
+/** Header of each command in a batch */
+struct marshal_cmd_base
+{
+   /** Index in the enum marshal_dispatch_cmd_id of marshal_generated.c */
+   uint16_t cmd_id;
+
+   /** Size of the command in bytes, including this header */
+   uint16_t cmd_size;
+};
+
+
+struct glthread_batch
+{
+   /** Number of bytes used in buffer */
+   size_t used;
+
+   /** Commands, 8-byte aligned */
+   uint64_t buffer[MARSHAL_MAX_CMD_SIZE / 8];
+};
+
+
+/**
+ * Element array buffer binding of a vertex array object, as seen by the
+ * application thread.
+ */
+struct glthread_vao
+{
+   GLuint IndexBufferName;
+};
+
+
+struct glthread_state
+{
+   struct gl_context *ctx;
+   thrd_t thread;
+
+   /** Protects submitted, executed and shutdown */
+   mtx_t mutex;
+
+   /** Signalled when a batch is submitted or the thread must exit */
+   cnd_t new_work;
+
+   /** Signalled when the worker thread finished a batch */
+   cnd_t work_done;
+
+   bool shutdown;
+
+   /**
+    * Number of batches handed to and finished by the worker thread.  Batch
+    * n lives in batches[n % MARSHAL_MAX_BATCHES].
+    */
+   unsigned submitted;
+   unsigned executed;
+
+   struct glthread_batch batches[MARSHAL_MAX_BATCHES];
+
+   /**
+    * State only touched by the application thread.
+    */
+
+   /** Batch being filled, batches[submitted % MARSHAL_MAX_BATCHES] */
+   struct glthread_batch *batch;
+
+   /**
+    * Buffer bindings that decide whether pointer parameters are buffer
+    * offsets (which can be passed by value) or client memory.  These are
+    * tracked as commands are queued and reloaded from the real context
+    * state whenever the worker thread is idle.
+    */
+   GLuint CurrentArrayBufferName;
+   GLuint CurrentPixelUnpackBufferName;
+   struct glthread_vao *CurrentVAO;
+   struct glthread_vao DefaultVAO;
+   struct _mesa_HashTable *VAOs;
+};
+
+
+void
+_mesa_glthread_init(struct gl_context *ctx);
+
+void
+_mesa_glthread_destroy(struct gl_context *ctx);
+
+void
+_mesa_glthread_disable(struct gl_context *ctx, const char *reason);
+
+void
+_mesa_glthread_flush_batch(struct gl_context *ctx);
+
+void
+_mesa_glthread_finish(struct gl_context *ctx);
+
+void
+_mesa_glthread_begin_sync(struct gl_context *ctx);
+
+void
+_mesa_glthread_end_sync(struct gl_context *ctx);
+
+void
+_mesa_glthread_BindBuffer(struct gl_context *ctx, GLenum target,
+                          GLuint buffer);
+
+void
+_mesa_glthread_DeleteBuffers(struct gl_context *ctx, GLsizei n,
+                             const GLuint *buffers);
+
+void
+_mesa_glthread_BindVertexArray(struct gl_context *ctx, GLuint array);
+
+void
+_mesa_glthread_DeleteVertexArrays(struct gl_context *ctx, GLsizei n,
+                                  const GLuint *arrays);
+
+/* Implemented in marshal_generated.c */
+size_t
+_mesa_unmarshal_dispatch_cmd(struct gl_context *ctx, const void *cmd);
+
+struct _glapi_table *
+_mesa_create_marshal_table(void);
+
+
+/**
+ * Reserve \p size bytes for a command in the current batch.
+ */
+static inline void *
+_mesa_glthread_allocate_command(struct gl_context *ctx,
+                                uint16_t cmd_id, size_t size)
+{
+   struct glthread_state *glthread = ctx->GLThread;
+   struct marshal_cmd_base *cmd_base;
+   const size_t aligned_size = ALIGN(size, 8);
+
+   if (unlikely(glthread->batch->used + aligned_size > MARSHAL_MAX_CMD_SIZE))
+      _mesa_glthread_flush_batch(ctx);
+
+   cmd_base = (struct marshal_cmd_base *)
+      ((char *) glthread->batch->buffer + glthread->batch->used);
+   glthread->batch->used += aligned_size;
+   cmd_base->cmd_id = cmd_id;
+   cmd_base->cmd_size = aligned_size;
+   return cmd_base;
+}
+
+
+static inline bool
+_mesa_glthread_array_buffer_is_vbo(const struct gl_context *ctx)
+{
+   return ctx->GLThread->CurrentArrayBufferName != 0;
+}
+
+
+static inline bool
+_mesa_glthread_element_array_is_vbo(const struct gl_context *ctx)
+{
+   return ctx->GLThread->CurrentVAO->IndexBufferName != 0;
+}
+
+
+static inline bool
+_mesa_glthread_pixel_unpack_is_pbo(const struct gl_context *ctx)
+{
+   return ctx->GLThread->CurrentPixelUnpackBufferName != 0;
+}
+
+#endif /* GLTHREAD_H */
@@ -52,6 +52,45 @@
  */
 #define DELETED_KEY_VALUE 1
 
+/**
+ * Keys below this are also stored in the direct lookup array.
+ */
+#define DIRECT_MAX_KEYS (64 * 1024)
+
+/**
+ * \name Lock-free lookups
+ *
+ * Most lookups are of small glGen*()ed names, and come from every bind of a
+ * texture, buffer, program, etc.  The values of the keys below
+ * _mesa_HashTable::Direct->Size are also kept in an array indexed by key,
+ * which is only modified with the table's mutex held, and which
+ * _mesa_HashLookup() reads without taking the mutex when the compiler gives
+ * us atomic loads and stores with acquire/release semantics.
+ *
+ * When the array needs to grow, a copy is made and published, and the old
+ * array is only freed with the table since concurrent lookups may still be
+ * reading it.  As the array at least doubles in size each time, that's less
+ * memory than the current array.  If a copy can't be allocated, the array
+ * is dropped for good and all lookups go to the hash table.
+ */
+/*@{*/
+#if defined(__ATOMIC_ACQUIRE)
+#define HASH_LOCKLESS_LOOKUP 1
+#define load_acquire(p) __atomic_load_n(p, __ATOMIC_ACQUIRE)
+#define store_release(p, v) __atomic_store_n(p, v, __ATOMIC_RELEASE)
+#else
+#define HASH_LOCKLESS_LOOKUP 0
+#define load_acquire(p) (*(p))
+#define store_release(p, v) (*(p) = (v))
+#endif
+
+struct hash_direct {
+   GLuint Size;                 /**< number of entries in Data */
+   struct hash_direct *Older;   /**< retired arrays, freed with the table */
+   void **Data;                 /**< allocated along with the struct */
+};
+/*@}*/
+
 /**
  * The hash table data structure.  
  */
@@ -63,6 +102,12 @@ struct _mesa_HashTable {
    GLboolean InDeleteAll;                /**< Debug check */
    /** Value that would be in the table for DELETED_KEY_VALUE. */
    void *deleted_key_data;
+   /** Values of the small keys, see "Lock-free lookups" above */
+   struct hash_direct *Direct;
+   /** Set once an array couldn't be allocated, see set_direct_value() */
+   GLboolean NoDirect;
+   /** The arrays in use until then, freed with the table */
+   struct hash_direct *DroppedDirect;
 };
 
 /** @{
@@ -103,6 +148,68 @@ uint_key(GLuint id)
 }
 /** @} */
 
+/**
+ * Store the value of a key in the direct lookup array, growing the array if
+ * needed.  Called with the table's mutex held.
+ */
+static void
+set_direct_value(struct _mesa_HashTable *table, GLuint key, void *data)
+{
+   struct hash_direct *direct = table->Direct;
+
+   if (key >= DIRECT_MAX_KEYS || table->NoDirect)
+      return;
+
+   if (!direct || key >= direct->Size) {
+      struct hash_direct *grown;
+      GLuint size = direct ? direct->Size * 2 : 64;
+
+      if (!data)
+         return;   /* nothing to remove */
+
+      while (size <= key)
+         size *= 2;
+
+      grown = calloc(1, sizeof(struct hash_direct) + size * sizeof(void *));
+      if (!grown) {
+         /* The value would only be in the hash table, and a later, bigger
+          * copy of the array would hide it.  Stop using the array.
+          */
+         table->NoDirect = GL_TRUE;
+         table->DroppedDirect = direct;
+         store_release(&table->Direct, NULL);
+         return;
+      }
+
+      grown->Size = size;
+      grown->Data = (void **) (grown + 1);
+      grown->Older = direct;
+      if (direct) {
+         memcpy(grown->Data, direct->Data, direct->Size * sizeof(void *));
+      }
+      grown->Data[key] = data;
+      store_release(&table->Direct, grown);
+      return;
+   }
+
+   store_release(&direct->Data[key], data);
+}
+
+
+/**
+ * Free a direct lookup array and all the ones it replaced.
+ */
+static void
+free_direct_arrays(struct hash_direct *direct)
+{
+   while (direct) {
+      struct hash_direct *older = direct->Older;
+      free(direct);
+      direct = older;
+   }
+}
+
+
 /**
  * Create a new hash table.
  * 
@@ -143,6 +250,9 @@ _mesa_DeleteHashTable(struct _mesa_HashTable *table)
 
    _mesa_hash_table_destroy(table->ht, NULL);
 
+   free_direct_arrays(table->Direct);
+   free_direct_arrays(table->DroppedDirect);
+
    mtx_destroy(&table->Mutex);
    mtx_destroy(&table->WalkMutex);
    free(table);
@@ -162,6 +272,9 @@ _mesa_HashLookup_unlocked(struct _mesa_HashTable *table, GLuint key)
    assert(table);
    assert(key);
 
+   if (table->Direct && key < table->Direct->Size)
+      return table->Direct->Data[key];
+
    if (key == DELETED_KEY_VALUE)
       return table->deleted_key_data;
 
@@ -186,6 +299,13 @@ _mesa_HashLookup(struct _mesa_HashTable *table, GLuint key)
 {
    void *res;
    assert(table);
+
+   if (HASH_LOCKLESS_LOOKUP) {
+      const struct hash_direct *direct = load_acquire(&table->Direct);
+      if (direct && key < direct->Size)
+         return load_acquire(&direct->Data[key]);
+   }
+
    mtx_lock(&table->Mutex);
    res = _mesa_HashLookup_unlocked(table, key);
    mtx_unlock(&table->Mutex);
@@ -215,6 +335,8 @@ _mesa_HashInsert(struct _mesa_HashTable *table, GLuint key, void *data)
    if (key > table->MaxKey)
       table->MaxKey = key;
 
+   set_direct_value(table, key, data);
+
    if (key == DELETED_KEY_VALUE) {
       table->deleted_key_data = data;
    } else {
@@ -256,6 +378,7 @@ _mesa_HashRemove(struct _mesa_HashTable *table, GLuint key)
    }
 
    mtx_lock(&table->Mutex);
+   set_direct_value(table, key, NULL);
    if (key == DELETED_KEY_VALUE) {
       table->deleted_key_data = NULL;
    } else {
@@ -289,10 +412,12 @@ _mesa_HashDeleteAll(struct _mesa_HashTable *table,
    table->InDeleteAll = GL_TRUE;
    hash_table_foreach(table->ht, entry) {
       callback((uintptr_t)entry->key, entry->data, userData);
+      set_direct_value(table, (uintptr_t)entry->key, NULL);
       _mesa_hash_table_remove(table->ht, entry);
    }
    if (table->deleted_key_data) {
       callback(DELETED_KEY_VALUE, table->deleted_key_data, userData);
+      set_direct_value(table, DELETED_KEY_VALUE, NULL);
       table->deleted_key_data = NULL;
    }
    table->InDeleteAll = GL_FALSE;
@@ -38,6 +38,9 @@
 #include "macros.h"
 #include "mtypes.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 
 /**
@@ -75,6 +78,46 @@ _mesa_swap4( GLuint *p, GLuint n )
 }
 
 
+/**
+ * Copy \p n 8-bit RGBA (or BGRA) pixels, swapping the R and B channels if
+ * \p swapRB is set and setting alpha to 0xff if \p opaque is set.
+ */
+void
+_mesa_swizzle_rgba8_row(const GLubyte *src, GLubyte *dst, GLuint n,
+                        GLboolean swapRB, GLboolean opaque)
+{
+   GLuint i = 0;
+
+#if defined(__SSE2__)
+   const __m128i ga = _mm_set1_epi32(0xff00ff00);
+   const __m128i rb = _mm_set1_epi32(0x00ff00ff);
+   const __m128i alpha = _mm_set1_epi32(0xff000000);
+
+   for (; i + 4 <= n; i += 4) {
+      __m128i p = _mm_loadu_si128((const __m128i *) (src + i * 4));
+      if (swapRB) {
+         const __m128i swapped = _mm_or_si128(_mm_slli_epi32(p, 16),
+                                              _mm_srli_epi32(p, 16));
+         p = _mm_or_si128(_mm_and_si128(p, ga), _mm_and_si128(swapped, rb));
+      }
+      if (opaque)
+         p = _mm_or_si128(p, alpha);
+      _mm_storeu_si128((__m128i *) (dst + i * 4), p);
+   }
+#endif
+
+   for (; i < n; i++) {
+      const GLubyte *s = src + i * 4;
+      GLubyte *d = dst + i * 4;
+      const GLubyte r = s[0], b = s[2];
+      d[0] = swapRB ? b : r;
+      d[1] = s[1];
+      d[2] = swapRB ? r : b;
+      d[3] = opaque ? 0xff : s[3];
+   }
+}
+
+
 /**
  * Return the byte offset of a specific pixel in an image (1D, 2D or 3D).
  *
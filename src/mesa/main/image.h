@@ -38,6 +38,10 @@ _mesa_swap2( GLushort *p, GLuint n );
 extern void
 _mesa_swap4( GLuint *p, GLuint n );
 
+extern void
+_mesa_swizzle_rgba8_row(const GLubyte *src, GLubyte *dst, GLuint n,
+                        GLboolean swapRB, GLboolean opaque);
+
 extern GLintptr
 _mesa_image_offset( GLuint dimensions,
                     const struct gl_pixelstore_attrib *packing,
@@ -56,6 +56,16 @@
 #endif
 #endif
 
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 
 #ifdef _WIN32
 #define vsnprintf _vsnprintf
@@ -485,6 +495,140 @@ _mesa_half_to_float(GLhalfARB val)
    return result;
 }
 
+
+#if defined(__SSE2__)
+
+/**
+ * Convert four floats to half floats (in the low 16 bits of each 32-bit
+ * lane, without the sign bit).  Gives the same results as
+ * _mesa_float_to_half().
+ */
+static inline __m128i
+float4_to_half4_sse2(__m128i x)
+{
+   const __m128i abs = _mm_and_si128(x, _mm_set1_epi32(0x7fffffff));
+   const __m128i one = _mm_set1_epi32(1);
+   /* Normal halves: rebias the exponent and round the mantissa to nearest
+    * even.  A mantissa which rounds up carries into the exponent, up to
+    * infinity.
+    */
+   const __m128i rebiased = _mm_sub_epi32(abs, _mm_set1_epi32(112 << 23));
+   const __m128i odd = _mm_and_si128(_mm_srli_epi32(abs, 13), one);
+   const __m128i normal =
+      _mm_srli_epi32(_mm_add_epi32(_mm_add_epi32(rebiased,
+                                                 _mm_set1_epi32(0xfff)),
+                                   odd), 13);
+   /* Denormal halves: round like _mesa_round_to_even(), that is IROUND()
+    * with ties going to even.  A result of 0x400 is the smallest normal
+    * half.
+    */
+   const __m128 scaled = _mm_mul_ps(_mm_castsi128_ps(abs),
+                                    _mm_set1_ps((float) (1 << 24)));
+   const __m128i rounded = _mm_cvttps_epi32(_mm_add_ps(scaled,
+                                                       _mm_set1_ps(0.5F)));
+   const __m128i tie = _mm_castps_si128(
+      _mm_cmpeq_ps(_mm_sub_ps(_mm_cvtepi32_ps(rounded), _mm_set1_ps(0.5F)),
+                   scaled));
+   const __m128i denormal =
+      _mm_sub_epi32(rounded, _mm_and_si128(tie, _mm_and_si128(rounded, one)));
+   const __m128i is_denormal = _mm_cmplt_epi32(abs,
+                                               _mm_set1_epi32(113 << 23));
+   const __m128i is_zero = _mm_cmplt_epi32(abs, _mm_set1_epi32(1 << 23));
+   const __m128i is_inf = _mm_cmpgt_epi32(abs,
+                                          _mm_set1_epi32((143 << 23) - 1));
+   const __m128i is_nan = _mm_cmpgt_epi32(abs, _mm_set1_epi32(0x7f800000));
+   __m128i h;
+
+   h = _mm_or_si128(_mm_and_si128(is_denormal, denormal),
+                    _mm_andnot_si128(is_denormal, normal));
+   h = _mm_andnot_si128(is_zero, h);
+   h = _mm_or_si128(_mm_andnot_si128(is_inf, h),
+                    _mm_and_si128(is_inf, _mm_set1_epi32(0x7c00)));
+   return _mm_or_si128(h, _mm_and_si128(is_nan, one));
+}
+
+/**
+ * Convert four half floats (in the low 16 bits of each 32-bit lane) to
+ * floats.  Gives the same results as _mesa_half_to_float().
+ */
+static inline __m128i
+half4_to_float4_sse2(__m128i h)
+{
+   const __m128i expmant = _mm_and_si128(h, _mm_set1_epi32(0x7fff));
+   const __m128i sign = _mm_slli_epi32(_mm_xor_si128(h, expmant), 16);
+   /* Shift exponent and mantissa into place and rescale the exponent,
+    * which also normalizes denormals.
+    */
+   const __m128i scaled = _mm_castps_si128(
+      _mm_mul_ps(_mm_castsi128_ps(_mm_slli_epi32(expmant, 13)),
+                 _mm_castsi128_ps(_mm_set1_epi32((254 - 15) << 23))));
+   const __m128i is_infnan = _mm_cmpgt_epi32(expmant,
+                                             _mm_set1_epi32(0x7bff));
+   const __m128i is_nan = _mm_cmpgt_epi32(expmant, _mm_set1_epi32(0x7c00));
+   /* Infinities and NaNs, with the NaN payload of _mesa_half_to_float() */
+   const __m128i infnan = _mm_or_si128(_mm_set1_epi32(0x7f800000),
+                                       _mm_and_si128(is_nan,
+                                                     _mm_set1_epi32(1)));
+
+   return _mm_or_si128(sign,
+                       _mm_or_si128(_mm_andnot_si128(is_infnan, scaled),
+                                    _mm_and_si128(is_infnan, infnan)));
+}
+
+#endif /* __SSE2__ */
+
+
+/**
+ * Convert \p n floats to half floats, as _mesa_float_to_half() does.
+ */
+void
+_mesa_float_to_half_row(const GLfloat *src, GLhalfARB *dst, GLuint n)
+{
+   GLuint i = 0;
+
+#if defined(__SSE2__)
+   for (; i + 8 <= n; i += 8) {
+      const __m128i x0 = _mm_loadu_si128((const __m128i *) (src + i));
+      const __m128i x1 = _mm_loadu_si128((const __m128i *) (src + i + 4));
+      const __m128i h = _mm_packs_epi32(float4_to_half4_sse2(x0),
+                                        float4_to_half4_sse2(x1));
+      const __m128i sign = _mm_packs_epi32(_mm_srai_epi32(x0, 31),
+                                           _mm_srai_epi32(x1, 31));
+      _mm_storeu_si128((__m128i *) (dst + i),
+                       _mm_or_si128(h, _mm_and_si128(sign,
+                                                     _mm_set1_epi16(0x8000))));
+   }
+#endif
+
+   for (; i < n; i++)
+      dst[i] = _mesa_float_to_half(src[i]);
+}
+
+
+/**
+ * Convert \p n half floats to floats, as _mesa_half_to_float() does.
+ */
+void
+_mesa_half_to_float_row(const GLhalfARB *src, GLfloat *dst, GLuint n)
+{
+   GLuint i = 0;
+
+#if defined(__SSE2__)
+   const __m128i zero = _mm_setzero_si128();
+
+   for (; i + 8 <= n; i += 8) {
+      const __m128i h = _mm_loadu_si128((const __m128i *) (src + i));
+      _mm_storeu_si128((__m128i *) (dst + i),
+                       half4_to_float4_sse2(_mm_unpacklo_epi16(h, zero)));
+      _mm_storeu_si128((__m128i *) (dst + i + 4),
+                       half4_to_float4_sse2(_mm_unpackhi_epi16(h, zero)));
+   }
+#endif
+
+   for (; i < n; i++)
+      dst[i] = _mesa_half_to_float(src[i]);
+}
+
 /*@}*/
 
 
@@ -542,6 +686,31 @@ _mesa_getenv( const char *var )
 /*@}*/
 
 
+/**********************************************************************/
+/** \name System information */
+/*@{*/
+
+/**
+ * Return the number of online CPUs, or 1 if unknown.
+ */
+unsigned
+_mesa_get_cpu_count(void)
+{
+#if defined(_WIN32)
+   SYSTEM_INFO info;
+   GetSystemInfo(&info);
+   return MAX2(info.dwNumberOfProcessors, 1);
+#elif defined(_SC_NPROCESSORS_ONLN)
+   const long count = sysconf(_SC_NPROCESSORS_ONLN);
+   return count > 0 ? (unsigned) count : 1;
+#else
+   return 1;
+#endif
+}
+
+/*@}*/
+
+
 /**********************************************************************/
 /** \name String */
 /*@{*/
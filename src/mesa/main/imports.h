@@ -546,6 +546,12 @@ _mesa_float_to_half(float f);
 extern float
 _mesa_half_to_float(GLhalfARB h);
 
+extern void
+_mesa_float_to_half_row(const GLfloat *src, GLhalfARB *dst, GLuint n);
+
+extern void
+_mesa_half_to_float_row(const GLhalfARB *src, GLfloat *dst, GLuint n);
+
 
 extern void *
 _mesa_bsearch( const void *key, const void *base, size_t nmemb, size_t size, 
@@ -554,6 +560,9 @@ _mesa_bsearch( const void *key, const void *base, size_t nmemb, size_t size,
 extern char *
 _mesa_getenv( const char *var );
 
+extern unsigned
+_mesa_get_cpu_count(void);
+
 extern char *
 _mesa_strdup( const char *s );
 
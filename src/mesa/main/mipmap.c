@@ -37,9 +37,32 @@
 #include "texstore.h"
 #include "image.h"
 #include "macros.h"
+#include "threadpool.h"
 #include "../../gallium/auxiliary/util/u_format_rgb9e5.h"
 #include "../../gallium/auxiliary/util/u_format_r11g11b10f.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+
+/**
+ * Pseudo datatypes for 8-bit sRGB formats.  They are used in place of
+ * GL_UNSIGNED_BYTE so that the color channels get averaged in linear space
+ * rather than on the encoded values, and differ in which byte of a texel,
+ * if any, holds (linear) alpha or padding.
+ */
+#define MIPMAP_SRGB8              0x10000
+#define MIPMAP_SRGB8_ALPHA_LAST   0x10001
+#define MIPMAP_SRGB8_ALPHA_FIRST  0x10002
+
+static inline GLboolean
+is_srgb8_datatype(GLenum datatype)
+{
+   return datatype == MIPMAP_SRGB8 ||
+          datatype == MIPMAP_SRGB8_ALPHA_LAST ||
+          datatype == MIPMAP_SRGB8_ALPHA_FIRST;
+}
 
 
 static GLint
@@ -51,6 +74,9 @@ bytes_per_pixel(GLenum datatype, GLuint comps)
        datatype == GL_UNSIGNED_INT_24_8_MESA)
       return 4;
 
+   if (is_srgb8_datatype(datatype))
+      return comps;
+
    b = _mesa_sizeof_packed_type(datatype);
    assert(b >= 0);
 
@@ -137,6 +163,289 @@ bytes_per_pixel(GLenum datatype, GLuint comps)
 /*@}*/
 
 
+/**
+ * \name 8-bit sRGB filtering
+ */
+/*@{*/
+
+static GLfloat srgb8_to_linear[256];
+
+/**
+ * srgb8_linear_threshold[n] is the smallest linear value that is encoded
+ * as n or more (entry 0 is unused).
+ */
+static GLfloat srgb8_linear_threshold[256];
+
+static once_flag srgb8_tables_once = ONCE_FLAG_INIT;
+
+static double
+srgb_to_linear(double cs)
+{
+   if (cs <= 0.04045)
+      return cs / 12.92;
+   else
+      return pow((cs + 0.055) / 1.055, 2.4);
+}
+
+static void
+init_srgb8_tables(void)
+{
+   GLuint i;
+
+   for (i = 0; i < 256; i++) {
+      srgb8_to_linear[i] = (GLfloat) srgb_to_linear(i / 255.0);
+      srgb8_linear_threshold[i] = (GLfloat) srgb_to_linear((i - 0.5) / 255.0);
+   }
+}
+
+/**
+ * Encode a linear value, rounding to the nearest 8-bit sRGB value.
+ */
+static inline GLubyte
+linear_to_srgb8(GLfloat l)
+{
+   GLuint lo = 0, hi = 255;
+
+   /* NaN and negative values end up as 0 */
+   while (lo < hi) {
+      const GLuint mid = (lo + hi + 1) / 2;
+      if (l >= srgb8_linear_threshold[mid])
+         lo = mid;
+      else
+         hi = mid - 1;
+   }
+   return (GLubyte) lo;
+}
+
+/**
+ * Index of the component that isn't sRGB encoded, or -1.
+ */
+static inline GLint
+srgb8_alpha_component(GLenum datatype, GLuint comps)
+{
+   switch (datatype) {
+   case MIPMAP_SRGB8_ALPHA_LAST:
+      return comps - 1;
+   case MIPMAP_SRGB8_ALPHA_FIRST:
+      return 0;
+   default:
+      return -1;
+   }
+}
+
+static void
+do_row_srgb8(GLenum datatype, GLuint comps, GLint srcWidth,
+             const GLubyte *rowA, const GLubyte *rowB,
+             GLint dstWidth, GLubyte *dst)
+{
+   const GLuint k0 = (srcWidth == dstWidth) ? 0 : 1;
+   const GLuint colStride = (srcWidth == dstWidth) ? 1 : 2;
+   const GLint alpha = srgb8_alpha_component(datatype, comps);
+   GLuint i, j, k, c;
+
+   call_once(&srgb8_tables_once, init_srgb8_tables);
+
+   for (i = j = 0, k = k0; i < (GLuint) dstWidth;
+        i++, j += colStride, k += colStride) {
+      for (c = 0; c < comps; c++) {
+         const GLubyte aj = rowA[j * comps + c], ak = rowA[k * comps + c];
+         const GLubyte bj = rowB[j * comps + c], bk = rowB[k * comps + c];
+
+         if ((GLint) c == alpha) {
+            dst[i * comps + c] = (aj + ak + bj + bk) / 4;
+         }
+         else {
+            dst[i * comps + c] =
+               linear_to_srgb8((srgb8_to_linear[aj] + srgb8_to_linear[ak] +
+                                srgb8_to_linear[bj] + srgb8_to_linear[bk])
+                               * 0.25F);
+         }
+      }
+   }
+}
+
+static void
+do_row_3D_srgb8(GLenum datatype, GLuint comps, GLint srcWidth,
+                const GLubyte *rowA, const GLubyte *rowB,
+                const GLubyte *rowC, const GLubyte *rowD,
+                GLint dstWidth, GLubyte *dst)
+{
+   const GLuint k0 = (srcWidth == dstWidth) ? 0 : 1;
+   const GLuint colStride = (srcWidth == dstWidth) ? 1 : 2;
+   const GLint alpha = srgb8_alpha_component(datatype, comps);
+   GLuint i, j, k, c;
+
+   call_once(&srgb8_tables_once, init_srgb8_tables);
+
+   for (i = j = 0, k = k0; i < (GLuint) dstWidth;
+        i++, j += colStride, k += colStride) {
+      for (c = 0; c < comps; c++) {
+         const GLuint jc = j * comps + c, kc = k * comps + c;
+
+         if ((GLint) c == alpha) {
+            dst[i * comps + c] = FILTER_SUM_3D(rowA[jc], rowA[kc],
+                                               rowB[jc], rowB[kc],
+                                               rowC[jc], rowC[kc],
+                                               rowD[jc], rowD[kc]);
+         }
+         else {
+            dst[i * comps + c] =
+               linear_to_srgb8((srgb8_to_linear[rowA[jc]] +
+                                srgb8_to_linear[rowA[kc]] +
+                                srgb8_to_linear[rowB[jc]] +
+                                srgb8_to_linear[rowB[kc]] +
+                                srgb8_to_linear[rowC[jc]] +
+                                srgb8_to_linear[rowC[kc]] +
+                                srgb8_to_linear[rowD[jc]] +
+                                srgb8_to_linear[rowD[kc]]) * 0.125F);
+         }
+      }
+   }
+}
+/*@}*/
+
+
+#if defined(__SSE2__)
+
+/**
+ * \name SSE2 versions of the most common do_row() cases
+ *
+ * These only handle the case where the row width is halved.  They produce
+ * exactly the same results as the C code and return the number of
+ * destination texels written, leaving the rest of the row to the C code.
+ */
+/*@{*/
+
+static GLuint
+halve_row_ubyte4_sse2(const GLubyte *rowA, const GLubyte *rowB,
+                      GLuint dstWidth, GLubyte *dst)
+{
+   const __m128i zero = _mm_setzero_si128();
+   GLuint i;
+
+   for (i = 0; i + 4 <= dstWidth; i += 4) {
+      const __m128i a0 = _mm_loadu_si128((const __m128i *) (rowA + i * 8));
+      const __m128i a1 = _mm_loadu_si128((const __m128i *) (rowA + i * 8 + 16));
+      const __m128i b0 = _mm_loadu_si128((const __m128i *) (rowB + i * 8));
+      const __m128i b1 = _mm_loadu_si128((const __m128i *) (rowB + i * 8 + 16));
+      /* Sums of the two rows for each pair of source texels */
+      __m128i s0 = _mm_add_epi16(_mm_unpacklo_epi8(a0, zero),
+                                 _mm_unpacklo_epi8(b0, zero));
+      __m128i s1 = _mm_add_epi16(_mm_unpackhi_epi8(a0, zero),
+                                 _mm_unpackhi_epi8(b0, zero));
+      __m128i s2 = _mm_add_epi16(_mm_unpacklo_epi8(a1, zero),
+                                 _mm_unpacklo_epi8(b1, zero));
+      __m128i s3 = _mm_add_epi16(_mm_unpackhi_epi8(a1, zero),
+                                 _mm_unpackhi_epi8(b1, zero));
+      __m128i d01, d23;
+
+      /* Add the two texels of each pair */
+      s0 = _mm_add_epi16(s0, _mm_srli_si128(s0, 8));
+      s1 = _mm_add_epi16(s1, _mm_srli_si128(s1, 8));
+      s2 = _mm_add_epi16(s2, _mm_srli_si128(s2, 8));
+      s3 = _mm_add_epi16(s3, _mm_srli_si128(s3, 8));
+
+      d01 = _mm_srli_epi16(_mm_unpacklo_epi64(s0, s1), 2);
+      d23 = _mm_srli_epi16(_mm_unpacklo_epi64(s2, s3), 2);
+      _mm_storeu_si128((__m128i *) (dst + i * 4), _mm_packus_epi16(d01, d23));
+   }
+
+   return i;
+}
+
+/**
+ * Sum one bitfield of eight 565 texels of each row, pairwise: returns the
+ * four sums for the texels of the four destination texels.
+ */
+static inline __m128i
+sum_565_field_sse2(__m128i a, __m128i b, int shift, __m128i mask)
+{
+   const __m128i ones = _mm_set1_epi16(1);
+
+   a = _mm_and_si128(_mm_srli_epi16(a, shift), mask);
+   b = _mm_and_si128(_mm_srli_epi16(b, shift), mask);
+   return _mm_add_epi32(_mm_madd_epi16(a, ones), _mm_madd_epi16(b, ones));
+}
+
+static GLuint
+halve_row_565_sse2(const GLushort *rowA, const GLushort *rowB,
+                   GLuint dstWidth, GLushort *dst)
+{
+   const __m128i mask5 = _mm_set1_epi16(0x1f);
+   const __m128i mask6 = _mm_set1_epi16(0x3f);
+   GLuint i;
+
+   for (i = 0; i + 8 <= dstWidth; i += 8) {
+      const __m128i a0 = _mm_loadu_si128((const __m128i *) (rowA + i * 2));
+      const __m128i a1 = _mm_loadu_si128((const __m128i *) (rowA + i * 2 + 8));
+      const __m128i b0 = _mm_loadu_si128((const __m128i *) (rowB + i * 2));
+      const __m128i b1 = _mm_loadu_si128((const __m128i *) (rowB + i * 2 + 8));
+      __m128i red, green, blue;
+
+      red = _mm_packs_epi32(
+         _mm_srli_epi32(sum_565_field_sse2(a0, b0, 0, mask5), 2),
+         _mm_srli_epi32(sum_565_field_sse2(a1, b1, 0, mask5), 2));
+      green = _mm_packs_epi32(
+         _mm_srli_epi32(sum_565_field_sse2(a0, b0, 5, mask6), 2),
+         _mm_srli_epi32(sum_565_field_sse2(a1, b1, 5, mask6), 2));
+      blue = _mm_packs_epi32(
+         _mm_srli_epi32(sum_565_field_sse2(a0, b0, 11, mask5), 2),
+         _mm_srli_epi32(sum_565_field_sse2(a1, b1, 11, mask5), 2));
+
+      _mm_storeu_si128((__m128i *) (dst + i),
+                       _mm_or_si128(_mm_or_si128(red,
+                                                 _mm_slli_epi16(green, 5)),
+                                    _mm_slli_epi16(blue, 11)));
+   }
+
+   return i;
+}
+
+static GLuint
+halve_row_float4_sse2(const GLfloat *rowA, const GLfloat *rowB,
+                      GLuint dstWidth, GLfloat *dst)
+{
+   const __m128 quarter = _mm_set1_ps(0.25F);
+   GLuint i;
+
+   /* Same order of additions as the C code */
+   for (i = 0; i < dstWidth; i++) {
+      __m128 sum = _mm_add_ps(_mm_loadu_ps(rowA + i * 8),
+                              _mm_loadu_ps(rowA + i * 8 + 4));
+      sum = _mm_add_ps(sum, _mm_loadu_ps(rowB + i * 8));
+      sum = _mm_add_ps(sum, _mm_loadu_ps(rowB + i * 8 + 4));
+      _mm_storeu_ps(dst + i * 4, _mm_mul_ps(sum, quarter));
+   }
+
+   return i;
+}
+
+/** Destination texels converted per _mesa_half_to_float_row() call */
+#define HALF4_CHUNK 64
+
+static GLuint
+halve_row_half4_sse2(const GLhalfARB *rowA, const GLhalfARB *rowB,
+                     GLuint dstWidth, GLhalfARB *dst)
+{
+   GLfloat a[HALF4_CHUNK * 8], b[HALF4_CHUNK * 8], avg[HALF4_CHUNK * 4];
+   GLuint i, n;
+
+   for (i = 0; i < dstWidth; i += n) {
+      n = MIN2(dstWidth - i, HALF4_CHUNK);
+
+      _mesa_half_to_float_row(rowA + i * 8, a, n * 8);
+      _mesa_half_to_float_row(rowB + i * 8, b, n * 8);
+      halve_row_float4_sse2(a, b, n, avg);
+      _mesa_float_to_half_row(avg, dst + i * 4, n * 4);
+   }
+
+   return i;
+}
+/*@}*/
+
+#endif /* __SSE2__ */
+
+
 /**
  * Average together two rows of a source image to produce a single new
  * row in the dest image.  It's legal for the two source rows to point
@@ -160,12 +469,20 @@ do_row(GLenum datatype, GLuint comps, GLint srcWidth,
    assert(srcWidth == dstWidth || srcWidth == 2 * dstWidth);
    */
 
-   if (datatype == GL_UNSIGNED_BYTE && comps == 4) {
-      GLuint i, j, k;
+   if (is_srgb8_datatype(datatype)) {
+      do_row_srgb8(datatype, comps, srcWidth, srcRowA, srcRowB,
+                   dstWidth, dstRow);
+   }
+   else if (datatype == GL_UNSIGNED_BYTE && comps == 4) {
+      GLuint i = 0, j, k;
       const GLubyte(*rowA)[4] = (const GLubyte(*)[4]) srcRowA;
       const GLubyte(*rowB)[4] = (const GLubyte(*)[4]) srcRowB;
       GLubyte(*dst)[4] = (GLubyte(*)[4]) dstRow;
-      for (i = j = 0, k = k0; i < (GLuint) dstWidth;
+#if defined(__SSE2__)
+      if (colStride == 2)
+         i = halve_row_ubyte4_sse2(srcRowA, srcRowB, dstWidth, dstRow);
+#endif
+      for (j = i * colStride, k = j + k0; i < (GLuint) dstWidth;
            i++, j += colStride, k += colStride) {
          dst[i][0] = (rowA[j][0] + rowA[k][0] + rowB[j][0] + rowB[k][0]) / 4;
          dst[i][1] = (rowA[j][1] + rowA[k][1] + rowB[j][1] + rowB[k][1]) / 4;
@@ -349,11 +666,15 @@ do_row(GLenum datatype, GLuint comps, GLint srcWidth,
    }
 
    else if (datatype == GL_FLOAT && comps == 4) {
-      GLuint i, j, k;
+      GLuint i = 0, j, k;
       const GLfloat(*rowA)[4] = (const GLfloat(*)[4]) srcRowA;
       const GLfloat(*rowB)[4] = (const GLfloat(*)[4]) srcRowB;
       GLfloat(*dst)[4] = (GLfloat(*)[4]) dstRow;
-      for (i = j = 0, k = k0; i < (GLuint) dstWidth;
+#if defined(__SSE2__)
+      if (colStride == 2)
+         i = halve_row_float4_sse2(srcRowA, srcRowB, dstWidth, dstRow);
+#endif
+      for (j = i * colStride, k = j + k0; i < (GLuint) dstWidth;
            i++, j += colStride, k += colStride) {
          dst[i][0] = (rowA[j][0] + rowA[k][0] +
                       rowB[j][0] + rowB[k][0]) * 0.25F;
@@ -405,11 +726,15 @@ do_row(GLenum datatype, GLuint comps, GLint srcWidth,
    }
 
    else if (datatype == GL_HALF_FLOAT_ARB && comps == 4) {
-      GLuint i, j, k, comp;
+      GLuint i = 0, j, k, comp;
       const GLhalfARB(*rowA)[4] = (const GLhalfARB(*)[4]) srcRowA;
       const GLhalfARB(*rowB)[4] = (const GLhalfARB(*)[4]) srcRowB;
       GLhalfARB(*dst)[4] = (GLhalfARB(*)[4]) dstRow;
-      for (i = j = 0, k = k0; i < (GLuint) dstWidth;
+#if defined(__SSE2__)
+      if (colStride == 2)
+         i = halve_row_half4_sse2(srcRowA, srcRowB, dstWidth, dstRow);
+#endif
+      for (j = i * colStride, k = j + k0; i < (GLuint) dstWidth;
            i++, j += colStride, k += colStride) {
          for (comp = 0; comp < 4; comp++) {
             GLfloat aj, ak, bj, bk;
@@ -483,11 +808,15 @@ do_row(GLenum datatype, GLuint comps, GLint srcWidth,
    }
 
    else if (datatype == GL_UNSIGNED_SHORT_5_6_5 && comps == 3) {
-      GLuint i, j, k;
+      GLuint i = 0, j, k;
       const GLushort *rowA = (const GLushort *) srcRowA;
       const GLushort *rowB = (const GLushort *) srcRowB;
       GLushort *dst = (GLushort *) dstRow;
-      for (i = j = 0, k = k0; i < (GLuint) dstWidth;
+#if defined(__SSE2__)
+      if (colStride == 2)
+         i = halve_row_565_sse2(rowA, rowB, dstWidth, dst);
+#endif
+      for (j = i * colStride, k = j + k0; i < (GLuint) dstWidth;
            i++, j += colStride, k += colStride) {
          const GLint rowAr0 = rowA[j] & 0x1f;
          const GLint rowAr1 = rowA[k] & 0x1f;
@@ -791,7 +1120,11 @@ do_row_3D(GLenum datatype, GLuint comps, GLint srcWidth,
    ASSERT(comps >= 1);
    ASSERT(comps <= 4);
 
-   if ((datatype == GL_UNSIGNED_BYTE) && (comps == 4)) {
+   if (is_srgb8_datatype(datatype)) {
+      do_row_3D_srgb8(datatype, comps, srcWidth, srcRowA, srcRowB,
+                      srcRowC, srcRowD, dstWidth, dstRow);
+   }
+   else if ((datatype == GL_UNSIGNED_BYTE) && (comps == 4)) {
       DECLARE_ROW_POINTERS(GLubyte, 4);
 
       for (i = j = 0, k = k0; i < (GLuint) dstWidth;
@@ -1687,23 +2020,19 @@ make_3d_mipmap(GLenum datatype, GLuint comps, GLint border,
 
 
 /**
- * Down-sample a texture image to produce the next lower mipmap level.
- * \param comps  components per texel (1, 2, 3 or 4)
- * \param srcData  array[slice] of pointers to source image slices
- * \param dstData  array[slice] of pointers to dest image slices
- * \param srcRowStride  stride between source rows, in bytes
- * \param dstRowStride  stride between destination rows, in bytes
+ * Down-sample a texture image to produce the next lower mipmap level,
+ * on the calling thread.
  */
-void
-_mesa_generate_mipmap_level(GLenum target,
-                            GLenum datatype, GLuint comps,
-                            GLint border,
-                            GLint srcWidth, GLint srcHeight, GLint srcDepth,
-                            const GLubyte **srcData,
-                            GLint srcRowStride,
-                            GLint dstWidth, GLint dstHeight, GLint dstDepth,
-                            GLubyte **dstData,
-                            GLint dstRowStride)
+static void
+make_mipmap_level(GLenum target,
+                  GLenum datatype, GLuint comps,
+                  GLint border,
+                  GLint srcWidth, GLint srcHeight, GLint srcDepth,
+                  const GLubyte **srcData,
+                  GLint srcRowStride,
+                  GLint dstWidth, GLint dstHeight, GLint dstDepth,
+                  GLubyte **dstData,
+                  GLint dstRowStride)
 {
    int i;
 
@@ -1759,6 +2088,220 @@ _mesa_generate_mipmap_level(GLenum target,
 }
 
 
+/**
+ * \name Multithreaded mipmap generation
+ *
+ * Large levels without borders are split into bands of destination rows
+ * (2D images) or images (3D and array textures), which are generated
+ * concurrently on the shared thread pool.  Every band is an ordinary, smaller mipmap level, so the
+ * result is identical to generating the whole level at once.
+ */
+/*@{*/
+
+#define MIPMAP_MAX_THREADS 8
+
+/** Don't bother with another thread for less than this much output */
+#define MIPMAP_MIN_BYTES_PER_THREAD (128 * 1024)
+
+struct mipmap_band
+{
+   GLenum target;
+   GLenum datatype;
+   GLuint comps;
+   GLint srcWidth, srcHeight, srcDepth;
+   const GLubyte **srcData;
+   GLint srcRowStride;
+   GLint dstWidth, dstHeight, dstDepth;
+   GLubyte **dstData;
+   GLint dstRowStride;
+
+   /** Slice pointers for bands of a 2D image */
+   const GLubyte *srcSlice;
+   GLubyte *dstSlice;
+};
+
+static void
+make_mipmap_band(void *data, unsigned index)
+{
+   const struct mipmap_band *band = (const struct mipmap_band *) data + index;
+
+   make_mipmap_level(band->target, band->datatype, band->comps, 0,
+                     band->srcWidth, band->srcHeight, band->srcDepth,
+                     band->srcData, band->srcRowStride,
+                     band->dstWidth, band->dstHeight, band->dstDepth,
+                     band->dstData, band->dstRowStride);
+}
+
+/**
+ * Generate a level using several threads, if it is worth it.
+ * \return GL_FALSE if nothing was done
+ */
+static GLboolean
+make_mipmap_level_threaded(GLenum target, GLenum datatype, GLuint comps,
+                           GLint border,
+                           GLint srcWidth, GLint srcHeight, GLint srcDepth,
+                           const GLubyte **srcData, GLint srcRowStride,
+                           GLint dstWidth, GLint dstHeight, GLint dstDepth,
+                           GLubyte **dstData, GLint dstRowStride)
+{
+   struct mipmap_band bands[MIPMAP_MAX_THREADS];
+   GLboolean splitRows;
+   GLint units, numBands, b;
+   GLint64 dstBytes;
+
+   if (border)
+      return GL_FALSE;
+
+   switch (target) {
+   case GL_TEXTURE_2D:
+   case GL_TEXTURE_CUBE_MAP_POSITIVE_X_ARB:
+   case GL_TEXTURE_CUBE_MAP_NEGATIVE_X_ARB:
+   case GL_TEXTURE_CUBE_MAP_POSITIVE_Y_ARB:
+   case GL_TEXTURE_CUBE_MAP_NEGATIVE_Y_ARB:
+   case GL_TEXTURE_CUBE_MAP_POSITIVE_Z_ARB:
+   case GL_TEXTURE_CUBE_MAP_NEGATIVE_Z_ARB:
+      /* Source rows are consumed in pairs, see make_2d_mipmap() */
+      if (srcHeight == dstHeight)
+         return GL_FALSE;
+      splitRows = GL_TRUE;
+      units = dstHeight;
+      break;
+   case GL_TEXTURE_3D:
+      if (srcDepth == dstDepth)
+         return GL_FALSE;
+      /* fall-through */
+   case GL_TEXTURE_1D_ARRAY_EXT:
+   case GL_TEXTURE_2D_ARRAY_EXT:
+   case GL_TEXTURE_CUBE_MAP_ARRAY:
+      splitRows = GL_FALSE;
+      units = dstDepth;
+      break;
+   default:
+      return GL_FALSE;
+   }
+
+   dstBytes = (GLint64) dstWidth * dstHeight * dstDepth *
+              bytes_per_pixel(datatype, comps);
+   numBands = MIN2((GLint) _mesa_threadpool_num_threads(), MIPMAP_MAX_THREADS);
+   numBands = MIN2(numBands, dstBytes / MIPMAP_MIN_BYTES_PER_THREAD);
+   numBands = MIN2(numBands, units);
+   if (numBands < 2)
+      return GL_FALSE;
+
+   for (b = 0; b < numBands; b++) {
+      struct mipmap_band *band = &bands[b];
+      const GLint first = units * b / numBands;
+      const GLint count = units * (b + 1) / numBands - first;
+
+      band->target = target;
+      band->datatype = datatype;
+      band->comps = comps;
+      band->srcWidth = srcWidth;
+      band->srcHeight = srcHeight;
+      band->srcDepth = srcDepth;
+      band->srcRowStride = srcRowStride;
+      band->dstWidth = dstWidth;
+      band->dstHeight = dstHeight;
+      band->dstDepth = dstDepth;
+      band->dstRowStride = dstRowStride;
+
+      if (splitRows) {
+         band->srcSlice = srcData[0] + 2 * first * srcRowStride;
+         band->dstSlice = dstData[0] + first * dstRowStride;
+         band->srcData = &band->srcSlice;
+         band->dstData = &band->dstSlice;
+         band->srcHeight = 2 * count;
+         band->dstHeight = count;
+      }
+      else if (target == GL_TEXTURE_3D) {
+         band->srcData = srcData + 2 * first;
+         band->dstData = dstData + first;
+         band->srcDepth = 2 * count;
+         band->dstDepth = count;
+      }
+      else {
+         band->srcData = srcData + first;
+         band->dstData = dstData + first;
+         band->srcDepth = count;
+         band->dstDepth = count;
+      }
+   }
+
+   _mesa_threadpool_run(numBands, make_mipmap_band, bands);
+
+   return GL_TRUE;
+}
+/*@}*/
+
+
+/**
+ * Down-sample a texture image to produce the next lower mipmap level.
+ * \param comps  components per texel (1, 2, 3 or 4)
+ * \param srcData  array[slice] of pointers to source image slices
+ * \param dstData  array[slice] of pointers to dest image slices
+ * \param srcRowStride  stride between source rows, in bytes
+ * \param dstRowStride  stride between destination rows, in bytes
+ */
+void
+_mesa_generate_mipmap_level(GLenum target,
+                            GLenum datatype, GLuint comps,
+                            GLint border,
+                            GLint srcWidth, GLint srcHeight, GLint srcDepth,
+                            const GLubyte **srcData,
+                            GLint srcRowStride,
+                            GLint dstWidth, GLint dstHeight, GLint dstDepth,
+                            GLubyte **dstData,
+                            GLint dstRowStride)
+{
+   if (make_mipmap_level_threaded(target, datatype, comps, border,
+                                  srcWidth, srcHeight, srcDepth,
+                                  srcData, srcRowStride,
+                                  dstWidth, dstHeight, dstDepth,
+                                  dstData, dstRowStride))
+      return;
+
+   make_mipmap_level(target, datatype, comps, border,
+                     srcWidth, srcHeight, srcDepth, srcData, srcRowStride,
+                     dstWidth, dstHeight, dstDepth, dstData, dstRowStride);
+}
+
+
+/**
+ * Get the datatype and number of components to filter texels of the given
+ * format with (see do_row()).
+ */
+static void
+get_filter_type_and_comps(mesa_format format,
+                          GLenum *datatype, GLuint *comps)
+{
+   _mesa_format_to_type_and_comps(format, datatype, comps);
+
+   if (*datatype != GL_UNSIGNED_BYTE ||
+       _mesa_get_format_color_encoding(format) != GL_SRGB)
+      return;
+
+   switch (format) {
+   case MESA_FORMAT_A8B8G8R8_SRGB:
+      *datatype = MIPMAP_SRGB8_ALPHA_FIRST;
+      break;
+   case MESA_FORMAT_B8G8R8A8_SRGB:
+   case MESA_FORMAT_B8G8R8X8_SRGB:
+   case MESA_FORMAT_R8G8B8A8_SRGB:
+   case MESA_FORMAT_R8G8B8X8_SRGB:
+   case MESA_FORMAT_L8A8_SRGB:
+      *datatype = MIPMAP_SRGB8_ALPHA_LAST;
+      break;
+   case MESA_FORMAT_L_SRGB8:
+   case MESA_FORMAT_BGR_SRGB8:
+      *datatype = MIPMAP_SRGB8;
+      break;
+   default:
+      /* Filter the encoded values, as before. */
+      break;
+   }
+}
+
+
 /**
  * compute next (level+1) image size
  * \return GL_FALSE if no smaller size can be generated (eg. src is 1x1x1 size)
@@ -1886,7 +2429,7 @@ generate_mipmap_uncompressed(struct gl_context *ctx, GLenum target,
    GLenum datatype;
    GLuint comps;
 
-   _mesa_format_to_type_and_comps(srcImage->TexFormat, &datatype, &comps);
+   get_filter_type_and_comps(srcImage->TexFormat, &datatype, &comps);
 
    for (level = texObj->BaseLevel; level < maxLevel; level++) {
       /* generate image[level+1] from image[level] */
@@ -2019,7 +2562,7 @@ generate_mipmap_compressed(struct gl_context *ctx, GLenum target,
    GLint components;
    GLuint temp_src_row_stride, temp_src_img_stride; /* in bytes */
    GLubyte *temp_src = NULL, *temp_dst = NULL;
-   GLenum temp_datatype;
+   GLenum temp_datatype, filter_datatype;
    GLenum temp_base_format;
    GLubyte **temp_src_slices = NULL, **temp_dst_slices = NULL;
 
@@ -2047,6 +2590,16 @@ generate_mipmap_compressed(struct gl_context *ctx, GLenum target,
       temp_datatype = GL_UNSIGNED_BYTE;
    }
 
+   /* The temporary image holds the sRGB encoded values */
+   if (temp_datatype == GL_UNSIGNED_BYTE &&
+       _mesa_get_format_color_encoding(srcImage->TexFormat) == GL_SRGB) {
+      filter_datatype = components == 4 ? MIPMAP_SRGB8_ALPHA_LAST
+                                        : MIPMAP_SRGB8;
+   }
+   else {
+      filter_datatype = temp_datatype;
+   }
+
    temp_base_format = _mesa_get_format_base_format(temp_format);
 
 
@@ -2136,7 +2689,7 @@ generate_mipmap_compressed(struct gl_context *ctx, GLenum target,
       /* Rescale src image to dest image.
        * This will loop over the slices of a 2D array.
        */
-      _mesa_generate_mipmap_level(target, temp_datatype, components, border,
+      _mesa_generate_mipmap_level(target, filter_datatype, components, border,
                                   srcWidth, srcHeight, srcDepth,
                                   (const GLubyte **) temp_src_slices,
                                   temp_src_row_stride,
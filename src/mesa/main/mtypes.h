@@ -83,7 +83,9 @@ struct prog_instruction;
 struct gl_program_parameter_list;
 struct set;
 struct set_entry;
+struct hash_table;
 struct vbo_context;
+struct glthread_state;
 /*@}*/
 
 
@@ -1459,6 +1461,18 @@ struct gl_buffer_mapping {
 };
 
 
+/**
+ * Flags for gl_buffer_object::UsageHistory.  The first ones are set when a
+ * buffer is bound to a target through which the GPU may write to it.  None
+ * of them are ever cleared.
+ */
+#define USAGE_TEXTURE_BUFFER              0x1
+#define USAGE_ATOMIC_COUNTER_BUFFER       0x2
+#define USAGE_TRANSFORM_FEEDBACK_BUFFER   0x4
+#define USAGE_PIXEL_PACK_BUFFER           0x8
+#define USAGE_DISABLE_MINMAX_CACHE        0x10
+
+
 /**
  * GL_ARB_vertex/pixel_buffer_object buffer object
  */
@@ -1476,6 +1490,16 @@ struct gl_buffer_object
    GLboolean Written;   /**< Ever written to? (for debugging) */
    GLboolean Purgeable; /**< Is the buffer purgeable under memory pressure? */
    GLboolean Immutable; /**< GL_ARB_buffer_storage */
+   GLbitfield UsageHistory; /**< How the buffer was ever used, USAGE_* */
+
+   /**
+    * Index ranges of glDrawElements() calls sourcing indices from this
+    * buffer, see vbo_minmax_index.c.  Protected by Mutex.
+    */
+   struct hash_table *MinMaxCache;
+   unsigned MinMaxCacheHitIndices;
+   unsigned MinMaxCacheMissIndices;
+   bool MinMaxCacheDirty;      /**< Buffer contents changed since caching */
 
    struct gl_buffer_mapping Mappings[MAP_COUNT];
 };
@@ -2768,6 +2792,7 @@ struct gl_shader_program
 #define GLSL_USE_PROG 0x80  /**< Log glUseProgram calls */
 #define GLSL_REPORT_ERRORS 0x100  /**< Print compilation errors */
 #define GLSL_DUMP_ON_ERROR 0x200 /**< Dump shaders to stderr on compile error */
+#define GLSL_STATS    0x400 /**< Print compile-time statistics as JSON */
 
 
 /**
@@ -3762,6 +3787,7 @@ struct gl_dlist_state
    struct gl_display_list *CurrentList; /**< List currently being compiled */
    union gl_dlist_node *CurrentBlock; /**< Pointer to current block of nodes */
    GLuint CurrentPos;		/**< Index into current block of nodes */
+   union gl_dlist_node *LastInstruction; /**< Most recently compiled node */
 
    GLvertexformat ListVtxfmt;
 
@@ -4026,8 +4052,16 @@ struct gl_context
     * re-set on glXMakeCurrent().
     */
    struct _glapi_table *CurrentDispatch;
+   /**
+    * Dispatch table that queues commands for the GL thread, used instead
+    * of CurrentDispatch while GLThread is set.
+    */
+   struct _glapi_table *MarshalExec;
    /*@}*/
 
+   /** GL threading state, NULL unless enabled (see glthread.h) */
+   struct glthread_state *GLThread;
+
    struct gl_config Visual;
    struct gl_framebuffer *DrawBuffer;	/**< buffer for writing */
    struct gl_framebuffer *ReadBuffer;	/**< buffer for reading */
@@ -4218,6 +4252,16 @@ struct gl_context
    GLbitfield NewState;      /**< bitwise-or of _NEW_* flags */
    GLbitfield NewDriverState;/**< bitwise-or of flags from DriverFlags */
 
+   /**
+    * Incremented by _mesa_update_state() for every change of state other
+    * than current vertex attributes, so that results which only depend on
+    * the state can be cached.
+    */
+   GLuint StateGeneration;
+
+   /** StateGeneration at which _mesa_valid_to_render() last succeeded */
+   GLuint _ValidToRenderGeneration;
+
    struct gl_driver_flags DriverFlags;
 
    GLboolean ViewportInitialized;  /**< has viewport size been initialized? */
@@ -4246,8 +4290,8 @@ struct gl_context
     */
    GLboolean HasConfig;
 
-   /** software compression/decompression supported or not */
-   GLboolean Mesa_DXTn;
+   /** use the fast rather than the high quality software compressors */
+   GLboolean FastTexCompress;
 
    GLboolean TextureFormatSupported[MESA_FORMAT_COUNT];
 
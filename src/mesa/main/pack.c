@@ -6103,3 +6103,187 @@ _mesa_rebase_rgba_uint(GLuint n, GLuint rgba[][4], GLenum baseFormat)
 }
 
 
+
+
+/**
+ * \name Direct packing
+ *
+ * Functions which pack a row of renderbuffer or texture data straight into
+ * the user's format and type, for some common cases of glReadPixels and
+ * glGetTexImage.  They give the same results as unpacking to float and
+ * packing with _mesa_pack_rgba_span_float() without any transfer ops.
+ */
+/*@{*/
+
+static void
+pack_rgba8_row(GLuint n, const GLubyte *src, GLubyte *dst)
+{
+   _mesa_swizzle_rgba8_row(src, dst, n, GL_FALSE, GL_FALSE);
+}
+
+static void
+pack_rgba8_row_opaque(GLuint n, const GLubyte *src, GLubyte *dst)
+{
+   _mesa_swizzle_rgba8_row(src, dst, n, GL_FALSE, GL_TRUE);
+}
+
+static void
+pack_rgba8_row_swap_rb(GLuint n, const GLubyte *src, GLubyte *dst)
+{
+   _mesa_swizzle_rgba8_row(src, dst, n, GL_TRUE, GL_FALSE);
+}
+
+static void
+pack_rgba8_row_swap_rb_opaque(GLuint n, const GLubyte *src, GLubyte *dst)
+{
+   _mesa_swizzle_rgba8_row(src, dst, n, GL_TRUE, GL_TRUE);
+}
+
+/** RGBA8 to RGB8, or BGRA8 to BGR8 */
+static void
+pack_rgba8_row_to_rgb8(GLuint n, const GLubyte *src, GLubyte *dst)
+{
+   GLuint i;
+
+   for (i = 0; i < n; i++) {
+      dst[i * 3 + 0] = src[i * 4 + 0];
+      dst[i * 3 + 1] = src[i * 4 + 1];
+      dst[i * 3 + 2] = src[i * 4 + 2];
+   }
+}
+
+/** RGBA8 to BGR8, or BGRA8 to RGB8 */
+static void
+pack_rgba8_row_to_bgr8(GLuint n, const GLubyte *src, GLubyte *dst)
+{
+   GLuint i;
+
+   for (i = 0; i < n; i++) {
+      dst[i * 3 + 0] = src[i * 4 + 2];
+      dst[i * 3 + 1] = src[i * 4 + 1];
+      dst[i * 3 + 2] = src[i * 4 + 0];
+   }
+}
+
+#define PACK_FLOAT_ROW_FUNCS(COMPS)                                     \
+static void                                                             \
+pack_half##COMPS##_row_to_float(GLuint n, const GLubyte *src,           \
+                                GLubyte *dst)                           \
+{                                                                       \
+   _mesa_half_to_float_row((const GLhalfARB *) src, (GLfloat *) dst,    \
+                           n * COMPS);                                  \
+}                                                                       \
+                                                                        \
+static void                                                             \
+pack_float##COMPS##_row_to_half(GLuint n, const GLubyte *src,           \
+                                GLubyte *dst)                           \
+{                                                                       \
+   _mesa_float_to_half_row((const GLfloat *) src, (GLhalfARB *) dst,    \
+                           n * COMPS);                                  \
+}
+
+PACK_FLOAT_ROW_FUNCS(1)
+PACK_FLOAT_ROW_FUNCS(2)
+PACK_FLOAT_ROW_FUNCS(3)
+PACK_FLOAT_ROW_FUNCS(4)
+
+#undef PACK_FLOAT_ROW_FUNCS
+
+
+/**
+ * Return a function which packs rows of \p srcFormat texels directly to
+ * \p dstFormat, \p dstType, or NULL if there is none.
+ *
+ * \param srcBaseFormat  the base internal format of the renderbuffer or
+ *                       texture image, which may have fewer components
+ *                       than srcFormat
+ */
+mesa_pack_row_func
+_mesa_get_pack_row_func(mesa_format srcFormat, GLenum srcBaseFormat,
+                        GLenum dstFormat, GLenum dstType,
+                        GLboolean swapBytes)
+{
+   /* sRGB values are returned as they are stored */
+   const mesa_format format = _mesa_get_srgb_format_linear(srcFormat);
+
+   /* The 8-bit formats are described as packed words, the layouts below
+    * are the little endian ones.
+    */
+   if (swapBytes || !_mesa_little_endian())
+      return NULL;
+
+   switch (format) {
+   case MESA_FORMAT_R8G8B8A8_UNORM:
+   case MESA_FORMAT_R8G8B8X8_UNORM:
+   case MESA_FORMAT_B8G8R8A8_UNORM:
+   case MESA_FORMAT_B8G8R8X8_UNORM: {
+      const GLboolean srcIsBGRA = format == MESA_FORMAT_B8G8R8A8_UNORM ||
+                                  format == MESA_FORMAT_B8G8R8X8_UNORM;
+      const GLboolean opaque = srcBaseFormat == GL_RGB ||
+                               format == MESA_FORMAT_R8G8B8X8_UNORM ||
+                               format == MESA_FORMAT_B8G8R8X8_UNORM;
+
+      if (srcBaseFormat != GL_RGBA && srcBaseFormat != GL_RGB)
+         return NULL;
+
+      if ((dstFormat == GL_RGBA || dstFormat == GL_BGRA) &&
+          (dstType == GL_UNSIGNED_BYTE ||
+           dstType == GL_UNSIGNED_INT_8_8_8_8_REV)) {
+         if ((dstFormat == GL_BGRA) != srcIsBGRA)
+            return opaque ? pack_rgba8_row_swap_rb_opaque
+                          : pack_rgba8_row_swap_rb;
+         else
+            return opaque ? pack_rgba8_row_opaque : pack_rgba8_row;
+      }
+
+      if ((dstFormat == GL_RGB || dstFormat == GL_BGR) &&
+          dstType == GL_UNSIGNED_BYTE) {
+         if ((dstFormat == GL_BGR) != srcIsBGRA)
+            return pack_rgba8_row_to_bgr8;
+         else
+            return pack_rgba8_row_to_rgb8;
+      }
+
+      return NULL;
+   }
+
+   case MESA_FORMAT_R_FLOAT16:
+   case MESA_FORMAT_RG_FLOAT16:
+   case MESA_FORMAT_RGB_FLOAT16:
+   case MESA_FORMAT_RGBA_FLOAT16:
+      if (dstType != GL_FLOAT ||
+          dstFormat != srcBaseFormat ||
+          dstFormat != _mesa_get_format_base_format(format))
+         return NULL;
+
+      switch (_mesa_components_in_format(dstFormat)) {
+      case 1: return pack_half1_row_to_float;
+      case 2: return pack_half2_row_to_float;
+      case 3: return pack_half3_row_to_float;
+      case 4: return pack_half4_row_to_float;
+      }
+      return NULL;
+
+   case MESA_FORMAT_R_FLOAT32:
+   case MESA_FORMAT_RG_FLOAT32:
+   case MESA_FORMAT_RGB_FLOAT32:
+   case MESA_FORMAT_RGBA_FLOAT32:
+      if (dstType != GL_HALF_FLOAT_ARB ||
+          dstFormat != srcBaseFormat ||
+          dstFormat != _mesa_get_format_base_format(format))
+         return NULL;
+
+      switch (_mesa_components_in_format(dstFormat)) {
+      case 1: return pack_float1_row_to_half;
+      case 2: return pack_float2_row_to_half;
+      case 3: return pack_float3_row_to_half;
+      case 4: return pack_float4_row_to_half;
+      }
+      return NULL;
+
+   default:
+      return NULL;
+   }
+}
+
+/*@}*/
@@ -163,4 +163,15 @@ _mesa_rebase_rgba_float(GLuint n, GLfloat rgba[][4], GLenum baseFormat);
 extern void
 _mesa_rebase_rgba_uint(GLuint n, GLuint rgba[][4], GLenum baseFormat);
 
+
+/**
+ * Pack \p n texels of a renderbuffer or texture row from \p src to \p dst.
+ */
+typedef void (*mesa_pack_row_func)(GLuint n, const GLubyte *src, GLubyte *dst);
+
+extern mesa_pack_row_func
+_mesa_get_pack_row_func(mesa_format srcFormat, GLenum srcBaseFormat,
+                        GLenum dstFormat, GLenum dstType,
+                        GLboolean swapBytes);
+
 #endif
@@ -40,6 +40,10 @@
 #include "glformats.h"
 #include "fbobject.h"
 
+#ifdef __SSE4_1__
+#include "streaming-load-memcpy.h"
+#endif
+
 
 /**
  * Return true if the conversion L=R+G+B is needed.
@@ -232,7 +236,12 @@ readpixels_memcpy(struct gl_context *ctx,
 
    /* memcpy*/
    for (j = 0; j < height; j++) {
+#ifdef __SSE4_1__
+      /* The mapping may well be uncached, use streaming loads */
+      _mesa_streaming_load_memcpy(dst, map, width * texelBytes);
+#else
       memcpy(dst, map, width * texelBytes);
+#endif
       dst += dstStride;
       map += stride;
    }
@@ -407,38 +416,27 @@ read_stencil_pixels( struct gl_context *ctx,
 
 
 /**
- * Try to do glReadPixels of RGBA data using swizzle.
+ * Try to do glReadPixels of RGBA data by packing the renderbuffer rows
+ * directly into the user's format/type (e.g. swizzling BGRA to RGBA).
  * \return GL_TRUE if successful, GL_FALSE otherwise (use the slow path)
  */
 static GLboolean
-read_rgba_pixels_swizzle(struct gl_context *ctx,
-                         GLint x, GLint y,
-                         GLsizei width, GLsizei height,
-                         GLenum format, GLenum type,
-                         GLvoid *pixels,
-                         const struct gl_pixelstore_attrib *packing)
+read_rgba_pixels_direct(struct gl_context *ctx,
+                        GLint x, GLint y,
+                        GLsizei width, GLsizei height,
+                        GLenum format, GLenum type,
+                        GLvoid *pixels,
+                        const struct gl_pixelstore_attrib *packing)
 {
    struct gl_renderbuffer *rb = ctx->ReadBuffer->_ColorReadBuffer;
+   mesa_pack_row_func packRow;
    GLubyte *dst, *map;
    int dstStride, stride, j;
-   GLboolean swizzle_rb = GL_FALSE, copy_xrgb = GL_FALSE;
-
-   /* XXX we could check for other swizzle/special cases here as needed */
-   if (rb->Format == MESA_FORMAT_R8G8B8A8_UNORM &&
-       format == GL_BGRA &&
-       type == GL_UNSIGNED_INT_8_8_8_8_REV &&
-       !ctx->Pack.SwapBytes) {
-      swizzle_rb = GL_TRUE;
-   }
-   else if (rb->Format == MESA_FORMAT_B8G8R8X8_UNORM &&
-       format == GL_BGRA &&
-       type == GL_UNSIGNED_INT_8_8_8_8_REV &&
-       !ctx->Pack.SwapBytes) {
-      copy_xrgb = GL_TRUE;
-   }
-   else {
+
+   packRow = _mesa_get_pack_row_func(rb->Format, rb->_BaseFormat,
+                                     format, type, packing->SwapBytes);
+   if (!packRow)
       return GL_FALSE;
-   }
 
    dstStride = _mesa_image_row_stride(packing, width, format, type);
    dst = (GLubyte *) _mesa_image_address2d(packing, pixels, width, height,
@@ -451,31 +449,10 @@ read_rgba_pixels_swizzle(struct gl_context *ctx,
       return GL_TRUE;  /* don't bother trying the slow path */
    }
 
-   if (swizzle_rb) {
-      /* swap R/B */
-      for (j = 0; j < height; j++) {
-         int i;
-         for (i = 0; i < width; i++) {
-            GLuint *dst4 = (GLuint *) dst, *map4 = (GLuint *) map;
-            GLuint pixel = map4[i];
-            dst4[i] = (pixel & 0xff00ff00)
-                   | ((pixel & 0x00ff0000) >> 16)
-                   | ((pixel & 0x000000ff) << 16);
-         }
-         dst += dstStride;
-         map += stride;
-      }
-   } else if (copy_xrgb) {
-      /* convert xrgb -> argb */
-      for (j = 0; j < height; j++) {
-         GLuint *dst4 = (GLuint *) dst, *map4 = (GLuint *) map;
-         int i;
-         for (i = 0; i < width; i++) {
-            dst4[i] = map4[i] | 0xff000000;  /* set A=0xff */
-         }
-         dst += dstStride;
-         map += stride;
-      }
+   for (j = 0; j < height; j++) {
+      packRow(width, map, dst);
+      dst += dstStride;
+      map += stride;
    }
 
    ctx->Driver.UnmapRenderbuffer(ctx, rb);
@@ -566,8 +543,8 @@ read_rgba_pixels( struct gl_context *ctx,
 
    /* Try the optimized paths first. */
    if (!transferOps &&
-       read_rgba_pixels_swizzle(ctx, x, y, width, height,
-                                    format, type, pixels, packing)) {
+       read_rgba_pixels_direct(ctx, x, y, width, height,
+                               format, type, pixels, packing)) {
       return;
    }
 
@@ -93,6 +93,8 @@ _mesa_get_shader_flags(void)
          flags |= GLSL_USE_PROG;
       if (strstr(env, "errors"))
          flags |= GLSL_REPORT_ERRORS;
+      if (strstr(env, "stats"))
+         flags |= GLSL_STATS;
    }
 
    return flags;
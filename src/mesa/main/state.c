@@ -77,6 +77,26 @@ update_program_enables(struct gl_context *ctx)
 }
 
 
+/**
+ * State the fixed-function fragment program key is built from.
+ * _NEW_TEXTURE_MATRIX is needed because the key's input mask depends on
+ * Texture._TexMatEnabled, which is only recomputed under that flag.
+ */
+#define FF_FRAGMENT_PROGRAM_STATE (_NEW_BUFFERS | _NEW_TEXTURE | _NEW_FOG | \
+                                   _NEW_TEXTURE_MATRIX | \
+                                   _NEW_VARYING_VP_INPUTS | _NEW_LIGHT | \
+                                   _NEW_POINT | _NEW_RENDERMODE | \
+                                   _NEW_PROGRAM | _NEW_FRAG_CLAMP | \
+                                   _NEW_COLOR)
+
+/** State the fixed-function vertex program key is built from */
+#define FF_VERTEX_PROGRAM_STATE (_NEW_VARYING_VP_INPUTS | _NEW_TEXTURE | \
+                                 _NEW_TEXTURE_MATRIX | _NEW_TRANSFORM | \
+                                 _NEW_POINT | _NEW_FOG | _NEW_LIGHT | \
+                                 _NEW_RENDERMODE | _NEW_PROGRAM | \
+                                 _MESA_NEW_NEED_EYE_COORDS)
+
+
 /**
  * Update the ctx->Vertex/Geometry/FragmentProgram._Current pointers to point
  * to the current/active programs.  Then call ctx->Driver.BindProgram() to
@@ -88,11 +108,14 @@ update_program_enables(struct gl_context *ctx)
  * This function needs to be called after texture state validation in case
  * we're generating a fragment program from fixed-function texture state.
  *
+ * Programs derived from fixed-function state are only looked up again
+ * when \p dirty_state touches the state their keys are built from.
+ *
  * \return bitfield which will indicate _NEW_PROGRAM state if a new vertex
  * or fragment program is being used.
  */
 static GLbitfield
-update_program(struct gl_context *ctx)
+update_program(struct gl_context *ctx, GLbitfield dirty_state)
 {
    const struct gl_shader_program *vsProg =
       ctx->_Shader->CurrentProgram[MESA_SHADER_VERTEX];
@@ -144,15 +167,19 @@ update_program(struct gl_context *ctx)
    }
    else if (ctx->FragmentProgram._MaintainTexEnvProgram) {
       /* Use fragment program generated from fixed-function state */
-      struct gl_shader_program *f = _mesa_get_fixed_func_fragment_program(ctx);
-
-      _mesa_reference_shader_program(ctx,
-                                     &ctx->_Shader->_CurrentFragmentProgram,
-				     f);
-      _mesa_reference_fragprog(ctx, &ctx->FragmentProgram._Current,
-			       gl_fragment_program(f->_LinkedShaders[MESA_SHADER_FRAGMENT]->Program));
-      _mesa_reference_fragprog(ctx, &ctx->FragmentProgram._TexEnvProgram,
-			       gl_fragment_program(f->_LinkedShaders[MESA_SHADER_FRAGMENT]->Program));
+      if (!prevFP || prevFP != ctx->FragmentProgram._TexEnvProgram ||
+          (dirty_state & FF_FRAGMENT_PROGRAM_STATE)) {
+         struct gl_shader_program *f =
+            _mesa_get_fixed_func_fragment_program(ctx);
+
+         _mesa_reference_shader_program(ctx,
+                                        &ctx->_Shader->_CurrentFragmentProgram,
+                                        f);
+         _mesa_reference_fragprog(ctx, &ctx->FragmentProgram._Current,
+                                  gl_fragment_program(f->_LinkedShaders[MESA_SHADER_FRAGMENT]->Program));
+         _mesa_reference_fragprog(ctx, &ctx->FragmentProgram._TexEnvProgram,
+                                  gl_fragment_program(f->_LinkedShaders[MESA_SHADER_FRAGMENT]->Program));
+      }
    }
    else {
       /* No fragment program */
@@ -187,11 +214,18 @@ update_program(struct gl_context *ctx)
                                ctx->VertexProgram.Current);
    }
    else if (ctx->VertexProgram._MaintainTnlProgram) {
-      /* Use vertex program generated from fixed-function state */
-      _mesa_reference_vertprog(ctx, &ctx->VertexProgram._Current,
-                               _mesa_get_fixed_func_vertex_program(ctx));
-      _mesa_reference_vertprog(ctx, &ctx->VertexProgram._TnlProgram,
-                               ctx->VertexProgram._Current);
+      /* Use vertex program generated from fixed-function state.  Its key
+       * also includes the inputs of the fragment program and whether
+       * there's a point size array.
+       */
+      if (!prevVP || prevVP != ctx->VertexProgram._TnlProgram ||
+          ctx->FragmentProgram._Current != prevFP ||
+          (dirty_state & (FF_VERTEX_PROGRAM_STATE | _NEW_ARRAY))) {
+         _mesa_reference_vertprog(ctx, &ctx->VertexProgram._Current,
+                                  _mesa_get_fixed_func_vertex_program(ctx));
+         _mesa_reference_vertprog(ctx, &ctx->VertexProgram._TnlProgram,
+                                  ctx->VertexProgram._Current);
+      }
    }
    else {
       /* no vertex program */
@@ -342,21 +376,17 @@ _mesa_update_state_locked( struct gl_context *ctx )
    if (new_state == _NEW_CURRENT_ATTRIB) 
       goto out;
 
+   ctx->StateGeneration++;
+
    if (MESA_VERBOSE & VERBOSE_STATE)
       _mesa_print_state("_mesa_update_state", new_state);
 
    /* Determine which state flags effect vertex/fragment program state */
    if (ctx->FragmentProgram._MaintainTexEnvProgram) {
-      prog_flags |= (_NEW_BUFFERS | _NEW_TEXTURE | _NEW_FOG |
-		     _NEW_VARYING_VP_INPUTS | _NEW_LIGHT | _NEW_POINT |
-		     _NEW_RENDERMODE | _NEW_PROGRAM | _NEW_FRAG_CLAMP |
-		     _NEW_COLOR);
+      prog_flags |= FF_FRAGMENT_PROGRAM_STATE;
    }
    if (ctx->VertexProgram._MaintainTnlProgram) {
-      prog_flags |= (_NEW_VARYING_VP_INPUTS | _NEW_TEXTURE |
-                     _NEW_TEXTURE_MATRIX | _NEW_TRANSFORM | _NEW_POINT |
-                     _NEW_FOG | _NEW_LIGHT |
-                     _MESA_NEW_NEED_EYE_COORDS);
+      prog_flags |= FF_VERTEX_PROGRAM_STATE;
    }
 
    /*
@@ -413,7 +443,7 @@ _mesa_update_state_locked( struct gl_context *ctx )
        * this call may generate/bind a new program.  If so, we need to
        * propogate the _NEW_PROGRAM flag to the driver.
        */
-      new_prog_state |= update_program( ctx );
+      new_prog_state |= update_program( ctx, new_state );
    }
 
    if (new_state & _NEW_ARRAY)
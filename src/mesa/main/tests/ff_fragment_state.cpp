@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2014 The Mesa Authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * \file ff_fragment_state.cpp
+ * Check that the fixed-function fragment program is regenerated for every
+ * piece of state its key is built from.
+ */
+
+#include <gtest/gtest.h>
+
+extern "C" {
+#include "GL/gl.h"
+#include "GL/glext.h"
+#include "main/compiler.h"
+#include "main/context.h"
+#include "main/enable.h"
+#include "main/extensions.h"
+#include "main/fbobject.h"
+#include "main/framebuffer.h"
+#include "main/matrix.h"
+#include "main/state.h"
+#include "main/teximage.h"
+#include "main/texparam.h"
+#include "drivers/common/driverfuncs.h"
+#include "vbo/vbo.h"
+}
+
+class ff_fragment_state : public ::testing::Test {
+public:
+   virtual void SetUp();
+   virtual void TearDown();
+
+   struct gl_config visual;
+   struct dd_function_table driver_functions;
+   struct gl_context ctx;
+};
+
+static void
+update_state_nop(struct gl_context *ctx, GLbitfield new_state)
+{
+   (void) ctx;
+   (void) new_state;
+}
+
+void
+ff_fragment_state::SetUp()
+{
+   memset(&visual, 0, sizeof(visual));
+   memset(&driver_functions, 0, sizeof(driver_functions));
+   memset(&ctx, 0, sizeof(ctx));
+
+   _mesa_init_driver_functions(&driver_functions);
+   driver_functions.UpdateState = update_state_nop;
+
+   _mesa_initialize_context(&ctx, API_OPENGL_COMPAT, &visual,
+                            NULL, &driver_functions);
+   _vbo_CreateContext(&ctx);
+   _mesa_enable_sw_extensions(&ctx);
+
+   ctx.Version = 21;
+   ctx.FragmentProgram._MaintainTexEnvProgram = GL_TRUE;
+
+   _mesa_reference_framebuffer(&ctx.DrawBuffer,
+                               _mesa_get_incomplete_framebuffer());
+   _mesa_reference_framebuffer(&ctx.ReadBuffer,
+                               _mesa_get_incomplete_framebuffer());
+   _mesa_make_current(&ctx, NULL, NULL);
+}
+
+void
+ff_fragment_state::TearDown()
+{
+   _mesa_make_current(NULL, NULL, NULL);
+   _vbo_DestroyContext(&ctx);
+   _mesa_free_context_data(&ctx);
+}
+
+/**
+ * A texture matrix turns an unused texture coordinate into a varying one:
+ * the generated program must switch from the current attribute to the
+ * interpolated gl_TexCoord[0] when only _NEW_TEXTURE_MATRIX is flagged.
+ */
+TEST_F(ff_fragment_state, texture_matrix)
+{
+   static const GLubyte texel[4] = { 255, 255, 255, 255 };
+
+   _mesa_TexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+   _mesa_TexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0,
+                    GL_RGBA, GL_UNSIGNED_BYTE, texel);
+   _mesa_Enable(GL_TEXTURE_2D);
+   /* Only positions come from arrays, the texcoord is the current value. */
+   _mesa_set_varying_vp_inputs(&ctx, VERT_BIT_POS);
+   _mesa_MatrixMode(GL_TEXTURE);
+   _mesa_update_state(&ctx);
+
+   ASSERT_NE((void *) 0, ctx.FragmentProgram._Current);
+   EXPECT_EQ(0u, ctx.FragmentProgram._Current->Base.InputsRead &
+                 VARYING_BIT_TEX0);
+
+   _mesa_Scalef(2.0f, 2.0f, 2.0f);
+   EXPECT_EQ((GLbitfield) _NEW_TEXTURE_MATRIX, ctx.NewState);
+   _mesa_update_state(&ctx);
+
+   ASSERT_NE((void *) 0, ctx.FragmentProgram._Current);
+   EXPECT_NE(0u, ctx.FragmentProgram._Current->Base.InputsRead &
+                 VARYING_BIT_TEX0);
+}
@@ -0,0 +1,173 @@
+/*
+ * Copyright (c) 2014 The Mesa Authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * \file hash_lookup.cpp
+ * Look up names in a _mesa_HashTable from several threads, the way binds
+ * from shared contexts do, while another thread keeps inserting and
+ * removing names and growing the table.  Every lookup has to return either
+ * nothing or the object stored for that name.
+ */
+
+#include <gtest/gtest.h>
+
+extern "C" {
+#include "main/hash.h"
+#include "c11/threads.h"
+}
+
+#define NUM_READERS 4
+#define NUM_KEYS 4096
+#define LOOKUPS_PER_READER (1024 * 1024)
+
+namespace {
+
+struct object {
+   GLuint name;
+};
+
+struct _mesa_HashTable *table;
+struct object objects[NUM_KEYS];
+volatile int done;
+
+struct reader_state {
+   unsigned seed;
+   unsigned found;
+   unsigned wrong;
+};
+
+int
+reader(void *data)
+{
+   struct reader_state *state = (struct reader_state *) data;
+
+   for (unsigned i = 0; i < LOOKUPS_PER_READER; i++) {
+      state->seed = state->seed * 1103515245 + 12345;
+      GLuint key = 1 + (state->seed >> 8) % (NUM_KEYS - 1);
+
+      struct object *obj = (struct object *) _mesa_HashLookup(table, key);
+      if (obj) {
+         state->found++;
+         if (obj != &objects[key] || obj->name != key)
+            state->wrong++;
+      }
+   }
+
+   return 0;
+}
+
+int
+writer(void *data)
+{
+   unsigned pass = 0;
+
+   (void) data;
+
+   while (!done) {
+      /* Grow the set of live names from the bottom up, so the lookup
+       * array gets reallocated under the readers, then drop every other
+       * one.
+       */
+      for (GLuint key = 1; key < NUM_KEYS; key++)
+         _mesa_HashInsert(table, key, &objects[key]);
+      for (GLuint key = 1 + (pass & 1); key < NUM_KEYS; key += 2)
+         _mesa_HashRemove(table, key);
+      pass++;
+   }
+
+   return 0;
+}
+
+class hash_lookup : public ::testing::Test {
+public:
+   virtual void SetUp();
+   virtual void TearDown();
+};
+
+void
+hash_lookup::SetUp()
+{
+   for (GLuint key = 0; key < NUM_KEYS; key++)
+      objects[key].name = key;
+
+   table = _mesa_NewHashTable();
+   done = 0;
+}
+
+void
+hash_lookup::TearDown()
+{
+   _mesa_DeleteHashTable(table);
+   table = NULL;
+}
+
+} /* anonymous namespace */
+
+TEST_F(hash_lookup, small_and_large_keys)
+{
+   /* Names past the start of the table shouldn't be found. */
+   EXPECT_EQ(NULL, _mesa_HashLookup(table, 1));
+   EXPECT_EQ(NULL, _mesa_HashLookup(table, NUM_KEYS * 100));
+
+   _mesa_HashInsert(table, 1, &objects[1]);
+   _mesa_HashInsert(table, NUM_KEYS * 100, &objects[2]);
+   EXPECT_EQ(&objects[1], _mesa_HashLookup(table, 1));
+   EXPECT_EQ(&objects[2], _mesa_HashLookup(table, NUM_KEYS * 100));
+
+   _mesa_HashRemove(table, 1);
+   _mesa_HashRemove(table, NUM_KEYS * 100);
+   EXPECT_EQ(NULL, _mesa_HashLookup(table, 1));
+   EXPECT_EQ(NULL, _mesa_HashLookup(table, NUM_KEYS * 100));
+}
+
+TEST_F(hash_lookup, concurrent_with_insert_and_remove)
+{
+   thrd_t readers[NUM_READERS], writer_thread;
+   struct reader_state states[NUM_READERS];
+
+   ASSERT_EQ(thrd_success, thrd_create(&writer_thread, writer, NULL));
+
+   for (unsigned i = 0; i < NUM_READERS; i++) {
+      states[i].seed = i + 1;
+      states[i].found = 0;
+      states[i].wrong = 0;
+      ASSERT_EQ(thrd_success, thrd_create(&readers[i], reader, &states[i]));
+   }
+   for (unsigned i = 0; i < NUM_READERS; i++)
+      thrd_join(readers[i], NULL);
+
+   done = 1;
+   thrd_join(writer_thread, NULL);
+
+   for (unsigned i = 0; i < NUM_READERS; i++)
+      EXPECT_EQ(0u, states[i].wrong) << "reader " << i;
+
+   /* After the writer is done, the table must agree with itself. */
+   for (GLuint key = 1; key < NUM_KEYS; key++) {
+      struct object *obj = (struct object *) _mesa_HashLookup(table, key);
+      if (obj) {
+         EXPECT_EQ(&objects[key], obj) << "key " << key;
+         _mesa_HashRemove(table, key);
+      }
+   }
+}
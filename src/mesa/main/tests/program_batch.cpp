@@ -0,0 +1,437 @@
+/*
+ * Copyright (c) 2014 The Mesa Authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * \file program_batch.cpp
+ * Check that _mesa_execute_program_batch() gives the same results as
+ * _mesa_execute_program() on programs shaped like the ones generated for
+ * fixed-function vertex and fragment processing.
+ */
+
+#include <gtest/gtest.h>
+#include <string.h>
+
+extern "C" {
+#include "main/mtypes.h"
+#include "program/prog_execute.h"
+#include "program/prog_instruction.h"
+#include "program/prog_parameter.h"
+}
+
+#define NUM_ELEMENTS 1024
+#define NUM_STATE 16
+
+namespace {
+
+class program_batch : public ::testing::Test {
+public:
+   virtual void SetUp();
+   virtual void TearDown();
+
+   void init_program(GLenum target, GLuint numInst);
+   struct prog_instruction *emit(gl_inst_opcode op, GLuint dstFile,
+                                 GLuint dstIndex, GLuint writeMask);
+   void src(struct prog_instruction *inst, GLuint i, GLuint file,
+            GLint index, GLuint swizzle = SWIZZLE_NOOP,
+            GLuint negate = NEGATE_NONE, GLuint abs = 0);
+   void run_and_compare(GLbitfield64 inputs, GLbitfield64 outputs);
+
+   struct gl_context *ctx;
+   struct gl_program prog;
+   struct gl_program_machine machine;
+   struct gl_program_batch *batch;
+   GLuint numInst;
+
+   GLfloat (*inputs)[4];
+   GLfloat (*attribs)[4];
+   GLfloat (*ref)[MAX_PROGRAM_OUTPUTS][4];
+   GLboolean ref_killed[NUM_ELEMENTS];
+};
+
+void
+program_batch::SetUp()
+{
+   ctx = (struct gl_context *) calloc(1, sizeof(*ctx));
+   memset(&prog, 0, sizeof(prog));
+   memset(&machine, 0, sizeof(machine));
+   batch = _mesa_new_program_batch();
+
+   inputs = (GLfloat (*)[4])
+      calloc(NUM_ELEMENTS * VARYING_SLOT_MAX, 4 * sizeof(GLfloat));
+   ref = (GLfloat (*)[MAX_PROGRAM_OUTPUTS][4])
+      calloc(NUM_ELEMENTS, sizeof(*ref));
+   attribs = (GLfloat (*)[4])
+      calloc(VARYING_SLOT_MAX * PROG_MAX_WIDTH, 4 * sizeof(GLfloat));
+   machine.Attribs = (GLfloat (**)[4])
+      calloc(VARYING_SLOT_MAX, sizeof(*machine.Attribs));
+   for (unsigned attr = 0; attr < VARYING_SLOT_MAX; attr++)
+      machine.Attribs[attr] = attribs + attr * PROG_MAX_WIDTH;
+
+   /* Inputs in [-2, 2], with some exact zeros and ones mixed in */
+   srand(42);
+   for (unsigned i = 0; i < NUM_ELEMENTS * VARYING_SLOT_MAX * 4; i++) {
+      GLfloat *f = &inputs[0][0] + i;
+      switch (rand() % 16) {
+      case 0:  *f = 0.0f; break;
+      case 1:  *f = 1.0f; break;
+      case 2:  *f = -0.0f; break;
+      default: *f = (rand() / (GLfloat) RAND_MAX) * 4.0f - 2.0f; break;
+      }
+   }
+}
+
+void
+program_batch::TearDown()
+{
+   _mesa_free_parameter_list(prog.Parameters);
+   _mesa_free_instructions(prog.Instructions, prog.NumInstructions);
+   _mesa_delete_program_batch(batch);
+   free(machine.Attribs);
+   free(attribs);
+   free(inputs);
+   free(ref);
+   free(ctx);
+}
+
+static void
+fetch_texel_lod(struct gl_context *ctx, const GLfloat texcoord[4],
+                GLfloat lambda, GLuint unit, GLfloat color[4])
+{
+   color[0] = texcoord[0] * 0.5f + 0.5f;
+   color[1] = texcoord[1] * texcoord[1];
+   color[2] = texcoord[2] + lambda;
+   color[3] = (GLfloat) unit;
+}
+
+void
+program_batch::init_program(GLenum target, GLuint n)
+{
+   prog.Target = target;
+   prog.Instructions = _mesa_alloc_instructions(n);
+   _mesa_init_instructions(prog.Instructions, n);
+   prog.NumInstructions = n;
+   numInst = 0;
+
+   /* Stand-ins for the matrix and light state of a fixed-function
+    * program.
+    */
+   prog.Parameters = _mesa_new_parameter_list();
+   for (unsigned i = 0; i < NUM_STATE; i++) {
+      gl_constant_value v[4];
+      for (unsigned j = 0; j < 4; j++)
+         v[j].f = (GLfloat) ((i * 7 + j * 3) % 11) / 5.0f - 1.0f;
+      _mesa_add_parameter(prog.Parameters, PROGRAM_CONSTANT, NULL, 4,
+                          GL_NONE, v, NULL);
+   }
+
+   machine.FetchTexelLod = fetch_texel_lod;
+   machine.Samplers = prog.SamplerUnits;
+   prog.SamplerUnits[1] = 3;
+}
+
+struct prog_instruction *
+program_batch::emit(gl_inst_opcode op, GLuint dstFile, GLuint dstIndex,
+                    GLuint writeMask)
+{
+   struct prog_instruction *inst = &prog.Instructions[numInst++];
+
+   EXPECT_LE(numInst, prog.NumInstructions);
+   inst->Opcode = op;
+   inst->DstReg.File = dstFile;
+   inst->DstReg.Index = dstIndex;
+   inst->DstReg.WriteMask = writeMask;
+   return inst;
+}
+
+void
+program_batch::src(struct prog_instruction *inst, GLuint i, GLuint file,
+                   GLint index, GLuint swizzle, GLuint negate, GLuint abs)
+{
+   inst->SrcReg[i].File = file;
+   inst->SrcReg[i].Index = index;
+   inst->SrcReg[i].Swizzle = swizzle;
+   inst->SrcReg[i].Negate = negate;
+   inst->SrcReg[i].Abs = abs;
+}
+
+void
+program_batch::run_and_compare(GLbitfield64 inputsRead,
+                               GLbitfield64 outputsWritten)
+{
+   const bool vertex = prog.Target == GL_VERTEX_PROGRAM_ARB;
+
+   prog.InputsRead = inputsRead;
+   prog.OutputsWritten = outputsWritten;
+
+   ASSERT_TRUE(_mesa_prepare_program_batch(ctx, &prog, &machine, batch));
+
+   /* reference, one element at a time */
+   for (unsigned i = 0; i < NUM_ELEMENTS; i++) {
+      for (unsigned attr = 0; attr < VARYING_SLOT_MAX; attr++) {
+         const GLfloat *v = inputs[i * VARYING_SLOT_MAX + attr];
+         if (!(inputsRead & BITFIELD64_BIT(attr)))
+            continue;
+         if (vertex)
+            memcpy(machine.VertAttribs[attr], v, 4 * sizeof(GLfloat));
+         else
+            memcpy(machine.Attribs[attr][i % PROG_MAX_WIDTH], v,
+                   4 * sizeof(GLfloat));
+      }
+      machine.CurElement = i % PROG_MAX_WIDTH;
+      ref_killed[i] = !_mesa_execute_program(ctx, &prog, &machine);
+      memcpy(ref[i], machine.Outputs, sizeof(ref[i]));
+   }
+
+   /* batched */
+   for (unsigned i = 0; i < NUM_ELEMENTS; i += PROG_BATCH_SIZE) {
+      for (unsigned attr = 0; attr < VARYING_SLOT_MAX; attr++) {
+         if (!(inputsRead & BITFIELD64_BIT(attr)))
+            continue;
+         for (unsigned l = 0; l < PROG_BATCH_SIZE; l++) {
+            const GLfloat *v = inputs[(i + l) * VARYING_SLOT_MAX + attr];
+            for (unsigned c = 0; c < 4; c++)
+               batch->Inputs[attr][c][l] = v[c];
+         }
+      }
+
+      _mesa_execute_program_batch(ctx, &machine, batch, PROG_BATCH_SIZE);
+
+      for (unsigned l = 0; l < PROG_BATCH_SIZE; l++) {
+         EXPECT_EQ(ref_killed[i + l], batch->Killed[l]) << "element " << i + l;
+         if (ref_killed[i + l])
+            continue;
+         for (unsigned out = 0; out < MAX_PROGRAM_OUTPUTS; out++) {
+            if (!(outputsWritten & BITFIELD64_BIT(out)))
+               continue;
+            for (unsigned c = 0; c < 4; c++) {
+               const GLfloat r = ref[i + l][out][c];
+               const GLfloat b = batch->Outputs[out][c][l];
+               EXPECT_EQ(0, memcmp(&r, &b, sizeof(r)))
+                  << "element " << i + l << " output " << out
+                  << " component " << c << ": " << r << " vs. " << b;
+            }
+         }
+      }
+   }
+}
+
+} /* anonymous namespace */
+
+
+/**
+ * Transform and light a vertex the way ffvertex_prog.c does it: position
+ * by the MVP matrix, normal by the inverse modelview and normalized, one
+ * directional light with LIT, fog coordinate from eye Z and a texcoord.
+ */
+TEST_F(program_batch, fixed_function_vertex)
+{
+   struct prog_instruction *inst;
+   unsigned i;
+
+   init_program(GL_VERTEX_PROGRAM_ARB, 22);
+
+   for (i = 0; i < 4; i++) {
+      /* DP4 o[HPOS].i, state[i], v[POS] */
+      inst = emit(OPCODE_DP4, PROGRAM_OUTPUT, VARYING_SLOT_POS, 1 << i);
+      src(inst, 0, PROGRAM_CONSTANT, i);
+      src(inst, 1, PROGRAM_INPUT, VERT_ATTRIB_POS);
+   }
+   for (i = 0; i < 3; i++) {
+      /* DP3 TEMP[0].i, state[4 + i], v[NORMAL] */
+      inst = emit(OPCODE_DP3, PROGRAM_TEMPORARY, 0, 1 << i);
+      src(inst, 0, PROGRAM_CONSTANT, 4 + i);
+      src(inst, 1, PROGRAM_INPUT, VERT_ATTRIB_NORMAL);
+   }
+   inst = emit(OPCODE_DP3, PROGRAM_TEMPORARY, 0, WRITEMASK_W);
+   src(inst, 0, PROGRAM_TEMPORARY, 0);
+   src(inst, 1, PROGRAM_TEMPORARY, 0);
+   inst = emit(OPCODE_RSQ, PROGRAM_TEMPORARY, 0, WRITEMASK_W);
+   src(inst, 0, PROGRAM_TEMPORARY, 0, SWIZZLE_WWWW);
+   inst = emit(OPCODE_MUL, PROGRAM_TEMPORARY, 0, WRITEMASK_XYZ);
+   src(inst, 0, PROGRAM_TEMPORARY, 0);
+   src(inst, 1, PROGRAM_TEMPORARY, 0, SWIZZLE_WWWW);
+
+   /* n.VP and n.H into TEMP[1].xy, shininess into .w, then LIT */
+   inst = emit(OPCODE_DP3, PROGRAM_TEMPORARY, 1, WRITEMASK_X);
+   src(inst, 0, PROGRAM_TEMPORARY, 0);
+   src(inst, 1, PROGRAM_CONSTANT, 8);
+   inst = emit(OPCODE_DP3, PROGRAM_TEMPORARY, 1, WRITEMASK_Y);
+   src(inst, 0, PROGRAM_TEMPORARY, 0);
+   src(inst, 1, PROGRAM_CONSTANT, 9);
+   inst = emit(OPCODE_MUL, PROGRAM_TEMPORARY, 1, WRITEMASK_W);
+   src(inst, 0, PROGRAM_CONSTANT, 10, SWIZZLE_XXXX, NEGATE_NONE, 1);
+   src(inst, 1, PROGRAM_CONSTANT, 11, SWIZZLE_XXXX);
+   inst = emit(OPCODE_LIT, PROGRAM_TEMPORARY, 2, WRITEMASK_XYZW);
+   src(inst, 0, PROGRAM_TEMPORARY, 1);
+
+   /* color = ambient + diffuse * lit.y + specular * lit.z, saturated */
+   inst = emit(OPCODE_MAD, PROGRAM_TEMPORARY, 3, WRITEMASK_XYZW);
+   src(inst, 0, PROGRAM_TEMPORARY, 2, SWIZZLE_YYYY);
+   src(inst, 1, PROGRAM_CONSTANT, 12);
+   src(inst, 2, PROGRAM_CONSTANT, 13);
+   inst = emit(OPCODE_MAD, PROGRAM_OUTPUT, VARYING_SLOT_COL0, WRITEMASK_XYZW);
+   src(inst, 0, PROGRAM_TEMPORARY, 2, SWIZZLE_ZZZZ);
+   src(inst, 1, PROGRAM_CONSTANT, 14);
+   src(inst, 2, PROGRAM_TEMPORARY, 3);
+   inst->SaturateMode = SATURATE_ZERO_ONE;
+
+   /* eye distance fog: EX2 of -|z| * density */
+   inst = emit(OPCODE_DP4, PROGRAM_TEMPORARY, 4, WRITEMASK_X);
+   src(inst, 0, PROGRAM_CONSTANT, 2);
+   src(inst, 1, PROGRAM_INPUT, VERT_ATTRIB_POS);
+   inst = emit(OPCODE_MUL, PROGRAM_TEMPORARY, 4, WRITEMASK_X);
+   src(inst, 0, PROGRAM_TEMPORARY, 4, SWIZZLE_XXXX, NEGATE_XYZW, 1);
+   src(inst, 1, PROGRAM_CONSTANT, 15, SWIZZLE_XXXX);
+   inst = emit(OPCODE_EX2, PROGRAM_OUTPUT, VARYING_SLOT_FOGC, WRITEMASK_X);
+   src(inst, 0, PROGRAM_TEMPORARY, 4, SWIZZLE_XXXX);
+
+   inst = emit(OPCODE_MOV, PROGRAM_OUTPUT, VARYING_SLOT_TEX0, WRITEMASK_XYZW);
+   src(inst, 0, PROGRAM_INPUT, VERT_ATTRIB_TEX0);
+
+   emit(OPCODE_END, PROGRAM_UNDEFINED, 0, 0);
+
+   run_and_compare(VERT_BIT_POS | VERT_BIT_NORMAL | VERT_BIT_TEX0,
+                   BITFIELD64_BIT(VARYING_SLOT_POS) |
+                   BITFIELD64_BIT(VARYING_SLOT_COL0) |
+                   BITFIELD64_BIT(VARYING_SLOT_FOGC) |
+                   BITFIELD64_BIT(VARYING_SLOT_TEX0));
+}
+
+
+/**
+ * Texture environment combine the way ff_fragment_shader.cpp does it,
+ * plus alpha test with KIL and linear fog, and a few of the less common
+ * opcodes so that every batched opcode is checked.
+ */
+TEST_F(program_batch, fixed_function_fragment)
+{
+   struct prog_instruction *inst;
+
+   init_program(GL_FRAGMENT_PROGRAM_ARB, 24);
+
+   inst = emit(OPCODE_TXP, PROGRAM_TEMPORARY, 0, WRITEMASK_XYZW);
+   src(inst, 0, PROGRAM_INPUT, VARYING_SLOT_TEX0);
+   inst->TexSrcUnit = 1;
+   /* GL_MODULATE */
+   inst = emit(OPCODE_MUL, PROGRAM_TEMPORARY, 1, WRITEMASK_XYZW);
+   src(inst, 0, PROGRAM_TEMPORARY, 0);
+   src(inst, 1, PROGRAM_INPUT, VARYING_SLOT_COL0);
+   /* GL_INTERPOLATE with a constant */
+   inst = emit(OPCODE_LRP, PROGRAM_TEMPORARY, 1, WRITEMASK_XYZ);
+   src(inst, 0, PROGRAM_CONSTANT, 0, SWIZZLE_WWWW);
+   src(inst, 1, PROGRAM_TEMPORARY, 1);
+   src(inst, 2, PROGRAM_INPUT, VARYING_SLOT_COL1);
+   inst->SaturateMode = SATURATE_ZERO_ONE;
+   /* GL_ADD_SIGNED */
+   inst = emit(OPCODE_ADD, PROGRAM_TEMPORARY, 2, WRITEMASK_XYZW);
+   src(inst, 0, PROGRAM_TEMPORARY, 1);
+   src(inst, 1, PROGRAM_INPUT, VARYING_SLOT_TEX1, SWIZZLE_NOOP, NEGATE_XYZW);
+   inst = emit(OPCODE_SUB, PROGRAM_TEMPORARY, 2, WRITEMASK_XYZ);
+   src(inst, 0, PROGRAM_TEMPORARY, 2);
+   src(inst, 1, PROGRAM_CONSTANT, 1);
+   /* GL_DOT3_RGBA */
+   inst = emit(OPCODE_DP3, PROGRAM_TEMPORARY, 3, WRITEMASK_XYZW);
+   src(inst, 0, PROGRAM_TEMPORARY, 2);
+   src(inst, 1, PROGRAM_INPUT, VARYING_SLOT_TEX1);
+   inst = emit(OPCODE_TEX, PROGRAM_TEMPORARY, 4, WRITEMASK_XYZW);
+   src(inst, 0, PROGRAM_TEMPORARY, 3, MAKE_SWIZZLE4(SWIZZLE_X, SWIZZLE_Y,
+                                                    SWIZZLE_Z, SWIZZLE_X));
+   inst = emit(OPCODE_TXB, PROGRAM_TEMPORARY, 5, WRITEMASK_XYZW);
+   src(inst, 0, PROGRAM_INPUT, VARYING_SLOT_TEX1);
+   /* alpha test */
+   inst = emit(OPCODE_SLT, PROGRAM_TEMPORARY, 6, WRITEMASK_XYZW);
+   src(inst, 0, PROGRAM_TEMPORARY, 1, SWIZZLE_WWWW);
+   src(inst, 1, PROGRAM_CONSTANT, 2);
+   inst = emit(OPCODE_KIL, PROGRAM_UNDEFINED, 0, 0);
+   src(inst, 0, PROGRAM_TEMPORARY, 2, SWIZZLE_WWWW, NEGATE_XYZW);
+   /* the odd ones */
+   inst = emit(OPCODE_CMP, PROGRAM_TEMPORARY, 7, WRITEMASK_XYZW);
+   src(inst, 0, PROGRAM_INPUT, VARYING_SLOT_TEX2);
+   src(inst, 1, PROGRAM_TEMPORARY, 4);
+   src(inst, 2, PROGRAM_TEMPORARY, 5);
+   inst = emit(OPCODE_SWZ, PROGRAM_TEMPORARY, 8, WRITEMASK_XYZW);
+   src(inst, 0, PROGRAM_TEMPORARY, 7,
+       MAKE_SWIZZLE4(SWIZZLE_W, SWIZZLE_ZERO, SWIZZLE_X, SWIZZLE_ONE),
+       NEGATE_Y | NEGATE_W);
+   inst = emit(OPCODE_XPD, PROGRAM_TEMPORARY, 9, WRITEMASK_XYZW);
+   src(inst, 0, PROGRAM_TEMPORARY, 8);
+   src(inst, 1, PROGRAM_TEMPORARY, 6, SWIZZLE_NOOP, NEGATE_NONE, 1);
+   inst = emit(OPCODE_FRC, PROGRAM_TEMPORARY, 10, WRITEMASK_XY);
+   src(inst, 0, PROGRAM_TEMPORARY, 9);
+   inst = emit(OPCODE_FLR, PROGRAM_TEMPORARY, 10, WRITEMASK_ZW);
+   src(inst, 0, PROGRAM_TEMPORARY, 9);
+   inst = emit(OPCODE_POW, PROGRAM_TEMPORARY, 11, WRITEMASK_XYZW);
+   src(inst, 0, PROGRAM_TEMPORARY, 10, SWIZZLE_XXXX, NEGATE_NONE, 1);
+   src(inst, 1, PROGRAM_INPUT, VARYING_SLOT_TEX2, SWIZZLE_YYYY);
+   inst = emit(OPCODE_LG2, PROGRAM_TEMPORARY, 12, WRITEMASK_X);
+   src(inst, 0, PROGRAM_TEMPORARY, 11, SWIZZLE_XXXX, NEGATE_NONE, 1);
+   inst = emit(OPCODE_SCS, PROGRAM_TEMPORARY, 12, WRITEMASK_YZ);
+   src(inst, 0, PROGRAM_TEMPORARY, 10, SWIZZLE_WWWW);
+   inst = emit(OPCODE_DST, PROGRAM_TEMPORARY, 12, WRITEMASK_W);
+   src(inst, 0, PROGRAM_TEMPORARY, 12);
+   src(inst, 1, PROGRAM_TEMPORARY, 10);
+   inst = emit(OPCODE_MAX, PROGRAM_OUTPUT, FRAG_RESULT_DEPTH, WRITEMASK_Z);
+   src(inst, 0, PROGRAM_TEMPORARY, 12, SWIZZLE_XXXX);
+   src(inst, 1, PROGRAM_TEMPORARY, 12, SWIZZLE_YYYY);
+   /* linear fog */
+   inst = emit(OPCODE_MAD, PROGRAM_TEMPORARY, 13, WRITEMASK_X);
+   src(inst, 0, PROGRAM_INPUT, VARYING_SLOT_FOGC, SWIZZLE_XXXX);
+   src(inst, 1, PROGRAM_CONSTANT, 3, SWIZZLE_XXXX);
+   src(inst, 2, PROGRAM_CONSTANT, 3, SWIZZLE_YYYY);
+   inst->SaturateMode = SATURATE_ZERO_ONE;
+   inst = emit(OPCODE_LRP, PROGRAM_OUTPUT, FRAG_RESULT_COLOR, WRITEMASK_XYZ);
+   src(inst, 0, PROGRAM_TEMPORARY, 13, SWIZZLE_XXXX);
+   src(inst, 1, PROGRAM_TEMPORARY, 1);
+   src(inst, 2, PROGRAM_TEMPORARY, 12);
+   inst = emit(OPCODE_MIN, PROGRAM_OUTPUT, FRAG_RESULT_COLOR, WRITEMASK_W);
+   src(inst, 0, PROGRAM_TEMPORARY, 1);
+   src(inst, 1, PROGRAM_TEMPORARY, 11);
+
+   emit(OPCODE_END, PROGRAM_UNDEFINED, 0, 0);
+
+   run_and_compare(VARYING_BIT_COL0 | VARYING_BIT_COL1 | VARYING_BIT_FOGC |
+                   VARYING_BIT_TEX0 | VARYING_BIT_TEX1 | VARYING_BIT_TEX2,
+                   BITFIELD64_BIT(FRAG_RESULT_COLOR) |
+                   BITFIELD64_BIT(FRAG_RESULT_DEPTH));
+}
+
+
+/**
+ * Programs with flow control must keep using the reference interpreter.
+ */
+TEST_F(program_batch, flow_control_not_batched)
+{
+   struct prog_instruction *inst;
+
+   init_program(GL_VERTEX_PROGRAM_ARB, 4);
+
+   inst = emit(OPCODE_IF, PROGRAM_UNDEFINED, 0, 0);
+   src(inst, 0, PROGRAM_INPUT, VERT_ATTRIB_POS, SWIZZLE_XXXX);
+   inst->BranchTarget = 2;
+   inst = emit(OPCODE_MOV, PROGRAM_OUTPUT, VARYING_SLOT_POS, WRITEMASK_XYZW);
+   src(inst, 0, PROGRAM_INPUT, VERT_ATTRIB_POS);
+   emit(OPCODE_ENDIF, PROGRAM_UNDEFINED, 0, 0);
+   emit(OPCODE_END, PROGRAM_UNDEFINED, 0, 0);
+
+   EXPECT_FALSE(_mesa_prepare_program_batch(ctx, &prog, &machine, batch));
+}
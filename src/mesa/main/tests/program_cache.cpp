@@ -0,0 +1,166 @@
+/*
+ * Copyright (c) 2014 The Mesa Authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * \file program_cache.cpp
+ * Check that the program cache keeps the most recently used programs
+ * once it is full, and that it counts hits, misses and evictions.
+ */
+
+#include <gtest/gtest.h>
+#include <stdlib.h>
+#include <string.h>
+
+extern "C" {
+#include "main/mtypes.h"
+#include "program/prog_cache.h"
+#include "program/program.h"
+}
+
+namespace {
+
+GLuint num_deleted;
+
+void
+delete_program(struct gl_context *, struct gl_program *prog)
+{
+   num_deleted++;
+   free(prog);
+}
+
+struct gl_program *
+new_program(void)
+{
+   struct gl_program *prog =
+      (struct gl_program *) calloc(1, sizeof(struct gl_program));
+
+   prog->Target = GL_VERTEX_PROGRAM_ARB;
+   prog->RefCount = 1;
+   return prog;
+}
+
+class program_cache : public ::testing::Test {
+public:
+   virtual void SetUp();
+   virtual void TearDown();
+
+   struct gl_context *ctx;
+   struct gl_program_cache *cache;
+};
+
+void
+program_cache::SetUp()
+{
+   ctx = (struct gl_context *) calloc(1, sizeof(*ctx));
+   ctx->Driver.DeleteProgram = delete_program;
+   cache = _mesa_new_program_cache();
+   num_deleted = 0;
+}
+
+void
+program_cache::TearDown()
+{
+   _mesa_delete_program_cache(ctx, cache);
+   free(ctx);
+}
+
+} /* anonymous namespace */
+
+
+TEST_F(program_cache, hits_and_misses)
+{
+   struct gl_program *prog = new_program();
+   GLuint key[4] = { 1, 2, 3, 4 };
+   GLuint hits, misses, evictions;
+
+   EXPECT_EQ(NULL, _mesa_search_program_cache(cache, key, sizeof(key)));
+   _mesa_program_cache_insert(ctx, cache, key, sizeof(key), prog);
+   EXPECT_EQ(prog, _mesa_search_program_cache(cache, key, sizeof(key)));
+   EXPECT_EQ(prog, _mesa_search_program_cache(cache, key, sizeof(key)));
+
+   key[3] = 5;
+   EXPECT_EQ(NULL, _mesa_search_program_cache(cache, key, sizeof(key)));
+
+   _mesa_program_cache_stats(cache, &hits, &misses, &evictions);
+   EXPECT_EQ(2u, hits);
+   EXPECT_EQ(2u, misses);
+   EXPECT_EQ(0u, evictions);
+}
+
+
+TEST_F(program_cache, evicts_least_recently_used)
+{
+   struct gl_program *progs[3] = { NULL, NULL, NULL };
+   struct gl_program *bound = NULL;
+   GLuint hits, misses, evictions;
+   GLuint key, n;
+
+   /* Fill the cache up, which grows it rather than evicting anything,
+    * until inserting one more program evicts the first one.
+    */
+   for (n = 0; ; n++) {
+      struct gl_program *prog = new_program();
+
+      if (n < 3)
+         progs[n] = prog;
+      key = n;
+      _mesa_program_cache_insert(ctx, cache, &key, sizeof(key), prog);
+      _mesa_program_cache_stats(cache, &hits, &misses, &evictions);
+      if (evictions)
+         break;
+   }
+
+   ASSERT_GT(n, 1000u);
+   EXPECT_EQ(1u, num_deleted);
+   key = 0;
+   EXPECT_EQ(NULL, _mesa_search_program_cache(cache, &key, sizeof(key)));
+
+   /* Program 1 is now the least recently used one, then 2 and 3, but
+    * looking 2 up makes 3 the next one to go after 1.  Evicting program 1
+    * while something else holds a reference to it doesn't delete it.
+    */
+   _mesa_reference_program(ctx, &bound, progs[1]);
+   key = 2;
+   EXPECT_EQ(progs[2], _mesa_search_program_cache(cache, &key, sizeof(key)));
+
+   key = n + 1;
+   _mesa_program_cache_insert(ctx, cache, &key, sizeof(key), new_program());
+   EXPECT_EQ(1u, num_deleted);
+   EXPECT_EQ(1, bound->RefCount);
+   key = 1;
+   EXPECT_EQ(NULL, _mesa_search_program_cache(cache, &key, sizeof(key)));
+
+   key = n + 2;
+   _mesa_program_cache_insert(ctx, cache, &key, sizeof(key), new_program());
+   EXPECT_EQ(2u, num_deleted);
+   key = 3;
+   EXPECT_EQ(NULL, _mesa_search_program_cache(cache, &key, sizeof(key)));
+   key = 2;
+   EXPECT_EQ(progs[2], _mesa_search_program_cache(cache, &key, sizeof(key)));
+
+   _mesa_reference_program(ctx, &bound, NULL);
+   EXPECT_EQ(3u, num_deleted);
+
+   _mesa_program_cache_stats(cache, &hits, &misses, &evictions);
+   EXPECT_EQ(3u, evictions);
+}
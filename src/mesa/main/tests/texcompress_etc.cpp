@@ -0,0 +1,261 @@
+/*
+ * Copyright (c) 2014 The Mesa Authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * \file texcompress_etc.cpp
+ * Decode known ETC1 and ETC2 blocks of every mode and check them against
+ * texels computed separately from the block layouts in the OpenGL ES 3.0
+ * specification, through both the whole-image unpack and the per-texel
+ * fetch functions.
+ */
+
+#include <gtest/gtest.h>
+#include <stdint.h>
+#include <string.h>
+
+extern "C" {
+#include "main/texcompress_etc.h"
+}
+
+namespace {
+
+struct etc_block {
+   const char *name;
+   uint8_t data[8];
+   /** Expected RGBA texels, row by row */
+   uint8_t texels[16][4];
+};
+
+const etc_block etc2_rgb8_blocks[] = {
+   /* Individual mode, subblocks side by side. */
+   {
+      "individual",
+      { 0x83, 0x4c, 0x2f, 0x54, 0x5a, 0x3c, 0x3c, 0x96 },
+      {
+         { 145,  77,  43, 255 }, { 107,  39,   5, 255 },
+         {  75, 228, 255, 255 }, {   0, 124, 175, 255 },
+         { 165,  97,  63, 255 }, { 127,  59,  25, 255 },
+         {  27, 180, 231, 255 }, { 131, 255, 255, 255 },
+         { 107,  39,   5, 255 }, { 145,  77,  43, 255 },
+         { 131, 255, 255, 255 }, {  27, 180, 231, 255 },
+         { 127,  59,  25, 255 }, { 165,  97,  63, 255 },
+         {   0, 124, 175, 255 }, {  75, 228, 255, 255 },
+      },
+   },
+   /* Differential mode, subblocks on top of each other.  Some
+    * texels clamp.
+    */
+   {
+      "differential",
+      { 0xa5, 0x52, 0xff, 0x1f, 0x5a, 0x3c, 0x3c, 0x96 },
+      {
+         { 167,  84, 255, 255 }, { 157,  74, 247, 255 },
+         { 167,  84, 255, 255 }, { 157,  74, 247, 255 },
+         { 173,  90, 255, 255 }, { 163,  80, 253, 255 },
+         { 163,  80, 253, 255 }, { 173,  90, 255, 255 },
+         {   0,   0,  64, 255 }, { 187, 146, 255, 255 },
+         { 255, 255, 255, 255 }, {  93,  52, 200, 255 },
+         {  93,  52, 200, 255 }, { 255, 255, 255, 255 },
+         {   0,   0,  64, 255 }, { 187, 146, 255, 255 },
+      },
+   },
+   /* T mode: the red base color overflows the differential
+    * encoding.
+    */
+   {
+      "t_mode",
+      { 0x0c, 0xa6, 0xc3, 0x9b, 0x5a, 0x3c, 0x3c, 0x96 },
+      {
+         {  68, 170, 102, 255 }, { 172,  19, 121, 255 },
+         {  68, 170, 102, 255 }, { 172,  19, 121, 255 },
+         { 236,  83, 185, 255 }, { 204,  51, 153, 255 },
+         { 204,  51, 153, 255 }, { 236,  83, 185, 255 },
+         { 172,  19, 121, 255 }, {  68, 170, 102, 255 },
+         { 236,  83, 185, 255 }, { 204,  51, 153, 255 },
+         { 204,  51, 153, 255 }, { 236,  83, 185, 255 },
+         { 172,  19, 121, 255 }, {  68, 170, 102, 255 },
+      },
+   },
+   /* H mode: the green base color overflows the differential
+    * encoding.
+    */
+   {
+      "h_mode",
+      { 0x5a, 0x1c, 0x97, 0x26, 0x5a, 0x3c, 0x3c, 0x96 },
+      {
+         { 219, 117, 185, 255 }, {   2, 206,  36, 255 },
+         { 219, 117, 185, 255 }, {   2, 206,  36, 255 },
+         { 155,  53, 121, 255 }, {  66, 255, 100, 255 },
+         {  66, 255, 100, 255 }, { 155,  53, 121, 255 },
+         {   2, 206,  36, 255 }, { 219, 117, 185, 255 },
+         { 155,  53, 121, 255 }, {  66, 255, 100, 255 },
+         {  66, 255, 100, 255 }, { 155,  53, 121, 255 },
+         {   2, 206,  36, 255 }, { 219, 117, 185, 255 },
+      },
+   },
+   /* Planar mode: the blue base color overflows the differential
+    * encoding.
+    */
+   {
+      "planar",
+      { 0x54, 0x23, 0xfa, 0x0b, 0xe1, 0x07, 0xf0, 0x01 },
+      {
+         { 170,  34, 243, 255 }, { 133,  82, 215, 255 },
+         {  95, 130, 187, 255 }, {  58, 177, 158, 255 },
+         { 191,  58, 183, 255 }, { 154, 106, 155, 255 },
+         { 116, 153, 127, 255 }, {  79, 201,  99, 255 },
+         { 213,  82, 124, 255 }, { 175, 129,  95, 255 },
+         { 138, 177,  67, 255 }, { 100, 225,  39, 255 },
+         { 234, 105,  64, 255 }, { 196, 153,  36, 255 },
+         { 159, 201,   7, 255 }, { 121, 249,   0, 255 },
+      },
+   },
+};
+
+const etc_block etc2_punchthrough_blocks[] = {
+   /* Differential mode without the opaque bit: selector 2 is
+    * transparent and selector 0 has no modifier.
+    */
+   {
+      "differential",
+      { 0x63, 0xcc, 0x30, 0x64, 0x5a, 0x3c, 0x3c, 0x96 },
+      {
+         {  99, 206,  49, 255 }, {  57, 164,   7, 255 },
+         { 123, 173,  49, 255 }, { 106, 156,  32, 255 },
+         { 141, 248,  91, 255 }, {   0,   0,   0,   0 },
+         {   0,   0,   0,   0 }, { 140, 190,  66, 255 },
+         {  57, 164,   7, 255 }, {  99, 206,  49, 255 },
+         { 140, 190,  66, 255 }, {   0,   0,   0,   0 },
+         {   0,   0,   0,   0 }, { 141, 248,  91, 255 },
+         { 106, 156,  32, 255 }, { 123, 173,  49, 255 },
+      },
+   },
+   /* T mode without the opaque bit: paint color 2 is transparent. */
+   {
+      "t_mode",
+      { 0x15, 0x2e, 0x77, 0x15, 0x5a, 0x3c, 0x3c, 0x96 },
+      {
+         { 153,  34, 238, 255 }, { 103, 103,   1, 255 },
+         { 153,  34, 238, 255 }, { 103, 103,   1, 255 },
+         { 135, 135,  33, 255 }, {   0,   0,   0,   0 },
+         {   0,   0,   0,   0 }, { 135, 135,  33, 255 },
+         { 103, 103,   1, 255 }, { 153,  34, 238, 255 },
+         { 135, 135,  33, 255 }, {   0,   0,   0,   0 },
+         {   0,   0,   0,   0 }, { 135, 135,  33, 255 },
+         { 103, 103,   1, 255 }, { 153,  34, 238, 255 },
+      },
+   },
+};
+
+/** EAC alpha block: base 128, multiplier 3, modifier table 6 */
+const uint8_t eac_alpha_block[8] = {
+   0x80, 0x36, 0x15, 0x78, 0x73, 0x15, 0x78, 0x73
+};
+
+/** The individual mode block with the EAC alpha above */
+const etc_block etc2_rgba8_eac_block = {
+   "rgba8_eac",
+   { 0x83, 0x4c, 0x2f, 0x54, 0x5a, 0x3c, 0x3c, 0x96 },
+   {
+      { 145,  77,  43, 116 }, { 107,  39,   5, 137 },
+      {  75, 228, 255, 116 }, {   0, 124, 175, 137 },
+      { 165,  97,  63, 146 }, { 127,  59,  25, 107 },
+      {  27, 180, 231, 146 }, { 131, 255, 255, 107 },
+      { 107,  39,   5, 104 }, { 145,  77,  43, 149 },
+      { 131, 255, 255, 104 }, {  27, 180, 231, 149 },
+      { 127,  59,  25, 158 }, { 165,  97,  63,  95 },
+      {   0, 124, 175, 158 }, {  75, 228, 255,  95 },
+   },
+};
+
+void
+check_texels(mesa_format format, const etc_block *block,
+             const uint8_t *data, unsigned block_size)
+{
+   compressed_fetch_func fetch = _mesa_get_etc_fetch_func(format);
+   uint8_t texels[16][4];
+
+   memset(texels, 0xcd, sizeof(texels));
+   if (format == MESA_FORMAT_ETC1_RGB8)
+      _mesa_etc1_unpack_rgba8888(texels[0], 16, data, block_size, 4, 4);
+   else
+      _mesa_unpack_etc2_format(texels[0], 16, data, block_size, 4, 4, format);
+
+   ASSERT_TRUE(fetch != NULL);
+
+   for (unsigned i = 0; i < 16; i++) {
+      GLfloat fetched[4];
+
+      fetch(data, 4, i % 4, i / 4, fetched);
+
+      for (unsigned c = 0; c < 4; c++) {
+         EXPECT_EQ(block->texels[i][c], texels[i][c])
+            << block->name << " texel " << i << " component " << c;
+         EXPECT_EQ(block->texels[i][c], (int) (fetched[c] * 255.0f + 0.5f))
+            << block->name << " fetched texel " << i << " component " << c;
+      }
+   }
+}
+
+} /* anonymous namespace */
+
+
+/**
+ * ETC2 is a superset of ETC1, so the individual and differential blocks
+ * decode the same way in both.
+ */
+TEST(texcompress_etc, etc1_rgb8)
+{
+   for (unsigned i = 0; i < 2; i++) {
+      check_texels(MESA_FORMAT_ETC1_RGB8, &etc2_rgb8_blocks[i],
+                   etc2_rgb8_blocks[i].data, 8);
+   }
+}
+
+TEST(texcompress_etc, etc2_rgb8)
+{
+   for (unsigned i = 0; i < sizeof(etc2_rgb8_blocks) / sizeof(etc2_rgb8_blocks[0]); i++) {
+      check_texels(MESA_FORMAT_ETC2_RGB8, &etc2_rgb8_blocks[i],
+                   etc2_rgb8_blocks[i].data, 8);
+   }
+}
+
+TEST(texcompress_etc, etc2_rgb8_punchthrough_alpha1)
+{
+   for (unsigned i = 0; i < sizeof(etc2_punchthrough_blocks) /
+                           sizeof(etc2_punchthrough_blocks[0]); i++) {
+      check_texels(MESA_FORMAT_ETC2_RGB8_PUNCHTHROUGH_ALPHA1,
+                   &etc2_punchthrough_blocks[i],
+                   etc2_punchthrough_blocks[i].data, 8);
+   }
+}
+
+TEST(texcompress_etc, etc2_rgba8_eac)
+{
+   uint8_t data[16];
+
+   memcpy(data, eac_alpha_block, 8);
+   memcpy(data + 8, etc2_rgba8_eac_block.data, 8);
+
+   check_texels(MESA_FORMAT_ETC2_RGBA8_EAC, &etc2_rgba8_eac_block, data, 16);
+}
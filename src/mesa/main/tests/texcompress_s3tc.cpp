@@ -0,0 +1,267 @@
+/*
+ * Copyright (c) 2014 The Mesa Authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * \file texcompress_s3tc.cpp
+ * Round trip the built-in DXTn encoders through their decoders and check
+ * the PSNR of both the fast and the high quality modes.
+ */
+
+#include <gtest/gtest.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "main/texcompress_s3tc_tmp.h"
+
+namespace {
+
+const int width = 128;
+const int height = 128;
+
+typedef void (*fetch_func)(int srcRowStride, const uint8_t *pixdata,
+                           int i, int j, uint8_t *texel);
+
+struct dxtn_format {
+   const char *name;
+   unsigned format;
+   int blocksize;
+   fetch_func fetch;
+};
+
+const dxtn_format formats[] = {
+   { "DXT1 RGB",  DXTN_RGB_DXT1,  8,  fetch_2d_texel_rgb_dxt1 },
+   { "DXT1 RGBA", DXTN_RGBA_DXT1, 8,  fetch_2d_texel_rgba_dxt1 },
+   { "DXT3 RGBA", DXTN_RGBA_DXT3, 16, fetch_2d_texel_rgba_dxt3 },
+   { "DXT5 RGBA", DXTN_RGBA_DXT5, 16, fetch_2d_texel_rgba_dxt5 },
+};
+
+uint8_t
+clamp_ubyte(int v)
+{
+   return v < 0 ? 0 : v > 255 ? 255 : v;
+}
+
+/**
+ * A mix of smooth gradients, noise, hard edges and flat areas, with an
+ * alpha channel that has opaque, transparent and ramp regions.
+ */
+void
+make_image(uint8_t *img)
+{
+   uint32_t seed = 1;
+
+   for (int y = 0; y < height; y++) {
+      for (int x = 0; x < width; x++) {
+         uint8_t *p = img + 4 * (y * width + x);
+         int noise;
+
+         seed = seed * 1103515245 + 12345;
+         noise = (int) ((seed >> 16) & 0x1f) - 16;
+
+         if (x < width / 2 && y < height / 2) {
+            /* gradients */
+            p[0] = x * 4;
+            p[1] = y * 4;
+            p[2] = 255 - (x + y) * 2;
+         }
+         else if (x >= width / 2 && y < height / 2) {
+            /* noisy gradient */
+            p[0] = clamp_ubyte(128 + noise + (x - width / 2));
+            p[1] = clamp_ubyte(64 + noise);
+            p[2] = clamp_ubyte(200 - noise - y);
+         }
+         else if (x < width / 2) {
+            /* checkerboard */
+            const int on = ((x / 3) ^ (y / 3)) & 1;
+            p[0] = on ? 230 : 20;
+            p[1] = on ? 40 : 180;
+            p[2] = on ? 90 : 250;
+         }
+         else {
+            /* flat */
+            p[0] = 77;
+            p[1] = 140;
+            p[2] = 33;
+         }
+
+         if (y < height / 4)
+            p[3] = 255;
+         else if (y < height / 2)
+            p[3] = x * 2;
+         else if (y < 3 * height / 4)
+            p[3] = ((x / 4) & 1) ? 255 : 0;
+         else
+            p[3] = clamp_ubyte(128 + 4 * noise);
+      }
+   }
+}
+
+double
+psnr(uint64_t sq_err, int samples)
+{
+   const double mse = (double) sq_err / samples;
+
+   if (mse == 0.0)
+      return 99.0;
+   return 10.0 * log10(255.0 * 255.0 / mse);
+}
+
+/**
+ * Compress the test image and return the RGB and alpha PSNR.
+ */
+void
+round_trip(const dxtn_format *f, int fast, const uint8_t *img,
+           double *rgb_psnr, double *alpha_psnr)
+{
+   const int stride = (width / 4) * f->blocksize;
+   uint8_t *dst = (uint8_t *) calloc(stride * (height / 4), 1);
+   uint64_t rgb_err = 0, alpha_err = 0;
+
+   s3tc_compress_dxtn(4, width, height, img, f->format, dst, stride, fast);
+
+   for (int y = 0; y < height; y++) {
+      for (int x = 0; x < width; x++) {
+         const uint8_t *p = img + 4 * (y * width + x);
+         uint8_t texel[4];
+
+         f->fetch(width, dst, x, y, texel);
+
+         for (int k = 0; k < 3; k++) {
+            const int d = texel[k] - p[k];
+            rgb_err += d * d;
+         }
+         if (f->format == DXTN_RGBA_DXT1) {
+            /* DXT1 alpha is 1 bit, transparent texels are black */
+            EXPECT_EQ(p[3] >= 128 ? 255 : 0, texel[3]);
+            if (p[3] < 128) {
+               rgb_err -= (texel[0] - p[0]) * (texel[0] - p[0]) +
+                          (texel[1] - p[1]) * (texel[1] - p[1]) +
+                          (texel[2] - p[2]) * (texel[2] - p[2]);
+            }
+         }
+         else if (f->format != DXTN_RGB_DXT1) {
+            const int d = texel[3] - p[3];
+            alpha_err += d * d;
+         }
+      }
+   }
+
+   *rgb_psnr = psnr(rgb_err, width * height * 3);
+   *alpha_psnr = psnr(alpha_err, width * height);
+
+   free(dst);
+}
+
+} /* anonymous namespace */
+
+
+TEST(texcompress_s3tc, psnr)
+{
+   uint8_t *img = (uint8_t *) malloc(width * height * 4);
+
+   make_image(img);
+
+   for (unsigned i = 0; i < sizeof(formats) / sizeof(formats[0]); i++) {
+      double fast_rgb, fast_alpha, quality_rgb, quality_alpha;
+
+      round_trip(&formats[i], 1, img, &fast_rgb, &fast_alpha);
+      round_trip(&formats[i], 0, img, &quality_rgb, &quality_alpha);
+
+      EXPECT_GT(fast_rgb, 30.0) << formats[i].name;
+      EXPECT_GT(quality_rgb, 32.0) << formats[i].name;
+      EXPECT_GE(quality_rgb, fast_rgb) << formats[i].name;
+
+      if (formats[i].format == DXTN_RGBA_DXT3 ||
+          formats[i].format == DXTN_RGBA_DXT5) {
+         EXPECT_GT(fast_alpha, 35.0) << formats[i].name;
+         EXPECT_GE(quality_alpha, fast_alpha) << formats[i].name;
+      }
+   }
+
+   free(img);
+}
+
+
+/**
+ * Colors that are exactly representable as 565 must survive unchanged.
+ */
+TEST(texcompress_s3tc, solid_565_blocks)
+{
+   static const uint8_t colors[][3] = {
+      { 0, 0, 0 }, { 255, 255, 255 }, { 255, 0, 0 }, { 0, 255, 0 },
+      { 0, 0, 255 }, { 132, 130, 132 }, { 16, 32, 8 },
+   };
+
+   for (unsigned c = 0; c < sizeof(colors) / sizeof(colors[0]); c++) {
+      uint8_t img[4 * 4 * 3], blk[8];
+
+      for (int i = 0; i < 16; i++)
+         memcpy(img + 3 * i, colors[c], 3);
+
+      for (int fast = 0; fast < 2; fast++) {
+         s3tc_compress_dxtn(3, 4, 4, img, DXTN_RGB_DXT1, blk, 8, fast);
+         for (int i = 0; i < 16; i++) {
+            uint8_t texel[4];
+
+            fetch_2d_texel_rgb_dxt1(4, blk, i % 4, i / 4, texel);
+            EXPECT_EQ(colors[c][0], texel[0]);
+            EXPECT_EQ(colors[c][1], texel[1]);
+            EXPECT_EQ(colors[c][2], texel[2]);
+            EXPECT_EQ(255, texel[3]);
+         }
+      }
+   }
+}
+
+
+/**
+ * The fast RGTC coder keeps every value within half a step of the
+ * eight value ramp between the block's extremes.
+ */
+TEST(texcompress_s3tc, rgtc_fast_error_bound)
+{
+   uint32_t seed = 7;
+
+   for (int n = 0; n < 1000; n++) {
+      uint8_t values[4][4], blk[8];
+      int lo = 255, hi = 0;
+
+      for (int i = 0; i < 16; i++) {
+         seed = seed * 1103515245 + 12345;
+         values[i / 4][i % 4] = (seed >> 16) & 0xff;
+         if (values[i / 4][i % 4] < lo)
+            lo = values[i / 4][i % 4];
+         if (values[i / 4][i % 4] > hi)
+            hi = values[i / 4][i % 4];
+      }
+
+      s3tc_encode_rgtc_ubyte_fast(blk, values, 4, 4);
+
+      for (int i = 0; i < 16; i++) {
+         uint8_t v;
+
+         s3tc_fetch_texel_rgtc(4, blk, i % 4, i / 4, &v, 1);
+         EXPECT_LE(abs(v - values[i / 4][i % 4]), (hi - lo) / 14 + 1);
+      }
+   }
+}
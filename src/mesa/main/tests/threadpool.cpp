@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2014 The Mesa Authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * \file threadpool.cpp
+ * Check that the thread pool runs every piece of a job exactly once,
+ * also when several threads submit jobs at the same time.
+ */
+
+#include <gtest/gtest.h>
+#include <string.h>
+
+#include "main/threadpool.h"
+#include "c11/threads.h"
+
+struct counts {
+   unsigned count;
+   int runs[256];
+};
+
+static void
+count_piece(void *data, unsigned index)
+{
+   struct counts *c = (struct counts *) data;
+
+   __sync_fetch_and_add(&c->runs[index], 1);
+}
+
+static void
+check_counts(struct counts *c)
+{
+   memset(c->runs, 0, sizeof(c->runs));
+   _mesa_threadpool_run(c->count, count_piece, c);
+
+   for (unsigned i = 0; i < c->count; i++)
+      EXPECT_EQ(1, c->runs[i]) << "piece " << i;
+   for (unsigned i = c->count; i < 256; i++)
+      EXPECT_EQ(0, c->runs[i]) << "piece " << i;
+}
+
+TEST(threadpool, num_threads)
+{
+   EXPECT_GE(_mesa_threadpool_num_threads(), 1u);
+}
+
+TEST(threadpool, runs_each_piece_once)
+{
+   static const unsigned sizes[] = { 0, 1, 2, 3, 7, 8, 9, 100, 256 };
+   struct counts c;
+
+   for (unsigned i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+      c.count = sizes[i];
+      check_counts(&c);
+   }
+}
+
+static int
+submit_jobs(void *data)
+{
+   struct counts *c = (struct counts *) data;
+
+   for (unsigned i = 0; i < 50; i++)
+      check_counts(c);
+
+   return 0;
+}
+
+TEST(threadpool, concurrent_callers)
+{
+   struct counts c[4];
+   thrd_t threads[4];
+
+   for (unsigned i = 0; i < 4; i++) {
+      c[i].count = 31 + i * 17;
+      ASSERT_EQ(thrd_success, thrd_create(&threads[i], submit_jobs, &c[i]));
+   }
+
+   for (unsigned i = 0; i < 4; i++)
+      thrd_join(threads[i], NULL);
+}
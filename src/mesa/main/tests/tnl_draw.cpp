@@ -0,0 +1,250 @@
+/*
+ * Copyright (c) 2014 The Mesa Authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * \file tnl_draw.cpp
+ * Bind sparse indexed draws to the software TNL vertex buffer with and
+ * without compacting the referenced vertices, and check that every
+ * element still resolves to the same attribute values.
+ */
+
+#include <gtest/gtest.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+extern "C" {
+#include "main/mtypes.h"
+#include "tnl/t_context.h"
+}
+
+namespace {
+
+const GLuint num_verts = 1000;
+const GLint basevertex = 600;
+const GLushort restart = 0xffff;
+
+struct vertex {
+   GLfloat pos[4];
+   GLubyte color[4];
+   GLshort tex[2];
+};
+
+const GLuint attribs[] = {
+   VERT_ATTRIB_POS, VERT_ATTRIB_COLOR0, VERT_ATTRIB_TEX0
+};
+
+class tnl_draw : public ::testing::Test {
+public:
+   virtual void SetUp();
+   virtual void TearDown();
+
+   void set_array(GLuint attr, GLint size, GLenum type, GLboolean normalized,
+                  const void *ptr, GLsizei stride, GLuint element_size);
+   std::vector<GLfloat> bind(const GLushort *elts, GLuint nr_elts,
+                             const _mesa_prim *prims, GLuint nr_prims,
+                             GLboolean compact, GLuint *nr_verts);
+   void check(const GLushort *elts, GLuint nr_elts,
+              const _mesa_prim *prims, GLuint nr_prims, GLuint nr_used);
+
+   gl_context *ctx;
+   gl_buffer_object no_buffer;
+   gl_client_array array_storage[VERT_ATTRIB_MAX];
+   const gl_client_array *arrays[VERT_ATTRIB_MAX];
+   vertex verts[num_verts];
+   GLfloat current[4];
+};
+
+void
+tnl_draw::SetUp()
+{
+   ctx = (gl_context *) calloc(1, sizeof(gl_context));
+   ctx->swtnl_context = calloc(1, sizeof(TNLcontext));
+   ctx->Polygon.FrontMode = GL_FILL;
+   ctx->Polygon.BackMode = GL_FILL;
+
+   memset(&no_buffer, 0, sizeof(no_buffer));
+
+   for (GLuint i = 0; i < num_verts; i++) {
+      for (int c = 0; c < 4; c++) {
+         verts[i].pos[c] = i + c * 0.25f;
+         verts[i].color[c] = (GLubyte) (i * 7 + c);
+      }
+      verts[i].tex[0] = (GLshort) -i;
+      verts[i].tex[1] = (GLshort) (i * 3);
+   }
+
+   /* The attributes without an array read the current value */
+   current[0] = current[1] = current[2] = 0.0f;
+   current[3] = 1.0f;
+   for (GLuint a = 0; a < VERT_ATTRIB_MAX; a++) {
+      set_array(a, 4, GL_FLOAT, GL_FALSE, current, 0, 4 * sizeof(GLfloat));
+      arrays[a] = &array_storage[a];
+   }
+
+   set_array(VERT_ATTRIB_POS, 4, GL_FLOAT, GL_FALSE, verts[0].pos,
+             sizeof(vertex), 4 * sizeof(GLfloat));
+   set_array(VERT_ATTRIB_COLOR0, 4, GL_UNSIGNED_BYTE, GL_TRUE, verts[0].color,
+             sizeof(vertex), 4 * sizeof(GLubyte));
+   set_array(VERT_ATTRIB_TEX0, 2, GL_SHORT, GL_FALSE, verts[0].tex,
+             sizeof(vertex), 2 * sizeof(GLshort));
+}
+
+void
+tnl_draw::TearDown()
+{
+   free(ctx->swtnl_context);
+   free(ctx);
+}
+
+void
+tnl_draw::set_array(GLuint attr, GLint size, GLenum type, GLboolean normalized,
+                    const void *ptr, GLsizei stride, GLuint element_size)
+{
+   gl_client_array *array = &array_storage[attr];
+
+   memset(array, 0, sizeof(*array));
+   array->Size = size;
+   array->Type = type;
+   array->Format = GL_RGBA;
+   array->Stride = stride;
+   array->StrideB = stride;
+   array->Ptr = (const GLubyte *) ptr;
+   array->Enabled = stride != 0;
+   array->Normalized = normalized;
+   array->_ElementSize = element_size;
+   array->BufferObj = &no_buffer;
+}
+
+/**
+ * Bind the draw and return the attribute values each element of the
+ * primitives resolves to, element by element.
+ */
+std::vector<GLfloat>
+tnl_draw::bind(const GLushort *elts, GLuint nr_elts,
+               const _mesa_prim *prims, GLuint nr_prims,
+               GLboolean compact, GLuint *nr_verts)
+{
+   const vertex_buffer *VB = &TNL_CONTEXT(ctx)->vb;
+   gl_buffer_object *bo[VERT_ATTRIB_MAX + 1];
+   GLuint nr_bo = 0;
+   _mesa_index_buffer ib;
+   std::vector<GLfloat> values;
+   GLuint max_index = 0;
+
+   for (GLuint i = 0; i < nr_elts; i++) {
+      if (elts[i] != restart && elts[i] > max_index)
+         max_index = elts[i];
+   }
+
+   ib.count = nr_elts;
+   ib.type = GL_UNSIGNED_SHORT;
+   ib.obj = &no_buffer;
+   ib.ptr = elts;
+
+   _tnl_bind_draw(ctx, arrays, prims, nr_prims, &ib,
+                  max_index + basevertex + 1, compact, bo, &nr_bo);
+
+   *nr_verts = VB->Count;
+   for (GLuint p = 0; p < nr_prims; p++) {
+      for (GLuint j = prims[p].start; j < prims[p].start + prims[p].count;
+           j++) {
+         for (unsigned a = 0; a < sizeof(attribs) / sizeof(attribs[0]); a++) {
+            const GLvector4f *v = VB->AttribPtr[attribs[a]];
+            const GLfloat *f = (const GLfloat *)
+               ((const GLubyte *) v->start + VB->Elts[j] * v->stride);
+
+            EXPECT_LT(VB->Elts[j], VB->Count);
+            values.insert(values.end(), f, f + v->size);
+         }
+      }
+   }
+
+   _tnl_unbind_draw(ctx, bo, nr_bo);
+   return values;
+}
+
+void
+tnl_draw::check(const GLushort *elts, GLuint nr_elts,
+                const _mesa_prim *prims, GLuint nr_prims, GLuint nr_used)
+{
+   GLuint full_verts, compact_verts;
+   std::vector<GLfloat> full =
+      bind(elts, nr_elts, prims, nr_prims, GL_FALSE, &full_verts);
+   std::vector<GLfloat> compact =
+      bind(elts, nr_elts, prims, nr_prims, GL_TRUE, &compact_verts);
+
+   EXPECT_EQ(num_verts, full_verts);
+   EXPECT_EQ(nr_used, compact_verts);
+   ASSERT_EQ(full.size(), compact.size());
+   EXPECT_EQ(0, memcmp(&full[0], &compact[0], full.size() * sizeof(GLfloat)));
+}
+
+_mesa_prim
+strip(GLuint start, GLuint count)
+{
+   _mesa_prim prim;
+
+   memset(&prim, 0, sizeof(prim));
+   prim.mode = GL_TRIANGLE_STRIP;
+   prim.indexed = 1;
+   prim.begin = 1;
+   prim.end = 1;
+   prim.start = start;
+   prim.count = count;
+   prim.basevertex = basevertex;
+   prim.num_instances = 1;
+   return prim;
+}
+
+} /* anonymous namespace */
+
+
+/**
+ * One strip through a few scattered vertices between 600 and 999, some
+ * of them used twice.
+ */
+TEST_F(tnl_draw, sparse_elements)
+{
+   const GLushort elts[] = {
+      3, 90, 17, 250, 311, 17, 399, 42, 128, 3, 205, 377
+   };
+   const _mesa_prim prim = strip(0, 12);
+
+   check(elts, 12, &prim, 1, 10);
+}
+
+
+/**
+ * The same vertices in three strips separated by restart indices, split
+ * up the way vbo_sw_primitive_restart() does.
+ */
+TEST_F(tnl_draw, sparse_elements_with_restart)
+{
+   const GLushort elts[] = {
+      3, 90, 17, 250, restart, 311, 17, 399, 42, restart, 128, 3, 205, 377
+   };
+   const _mesa_prim prims[] = { strip(0, 4), strip(5, 4), strip(10, 4) };
+
+   check(elts, 14, prims, 3, 10);
+}
@@ -0,0 +1,227 @@
+/*
+ * Copyright (c) 2014 The Mesa Authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * \file tnl_vertex_emit.cpp
+ * Compare the vertices built by the runtime generated t_vertex emit
+ * functions against _tnl_generic_emit() for a few hardware vertex
+ * layouts.  Where there is no code generator both sides use the C
+ * emitters and trivially agree.
+ */
+
+#include <gtest/gtest.h>
+#include <stdlib.h>
+#include <string.h>
+
+extern "C" {
+#include "main/mtypes.h"
+#include "math/m_matrix.h"
+#include "swrast/s_chan.h"
+#include "tnl/t_context.h"
+#include "tnl/t_vertex.h"
+}
+
+namespace {
+
+const GLuint num_verts = 1024;
+const GLuint max_vertex_size = 128;
+
+struct layout {
+   const char *name;
+   GLuint nr;
+   tnl_attr_map map[8];
+   GLuint input_size[_TNL_ATTRIB_MAX];
+};
+
+/* Roughly what swrast_setup, i915 and r200 style drivers install. */
+const layout layouts[] = {
+   { "swrast", 4,
+     { { _TNL_ATTRIB_POS, EMIT_4F_VIEWPORT, 0 },
+       { _TNL_ATTRIB_COLOR0, EMIT_4CHAN_4F_RGBA, 0 },
+       { _TNL_ATTRIB_TEX0, EMIT_4F, 0 },
+       { _TNL_ATTRIB_FOG, EMIT_1F, 0 } },
+     { 4, 0, 0, 4, 0, 1, 0, 0, 2 } },
+   { "bgra+spec", 5,
+     { { _TNL_ATTRIB_POS, EMIT_4F_VIEWPORT, 0 },
+       { _TNL_ATTRIB_COLOR0, EMIT_4UB_4F_BGRA, 0 },
+       { _TNL_ATTRIB_COLOR1, EMIT_3UB_3F_BGR, 0 },
+       { _TNL_ATTRIB_FOG, EMIT_1UB_1F, 0 },
+       { _TNL_ATTRIB_TEX0, EMIT_2F, 0 } },
+     { 4, 0, 0, 4, 3, 1, 0, 0, 2 } },
+   { "xyz+proj", 5,
+     { { _TNL_ATTRIB_POS, EMIT_3F_VIEWPORT, 0 },
+       { _TNL_ATTRIB_COLOR0, EMIT_4UB_4F_RGBA, 0 },
+       { _TNL_ATTRIB_TEX0, EMIT_3F_XYW, 0 },
+       { _TNL_ATTRIB_TEX1, EMIT_3F, 0 },
+       { _TNL_ATTRIB_POINTSIZE, EMIT_1F, 0 } },
+     { 3, 0, 0, 3, 0, 0, 0, 0, 4, 2, 0, 0, 0, 0, 0, 0, 1 } },
+};
+
+struct emit_state {
+   gl_context *ctx;
+   GLvector4f inputs[_TNL_ATTRIB_MAX];
+   GLfloat (*data)[4];
+   GLfloat vp[16];
+};
+
+bool
+is_ubyte_format(GLuint format)
+{
+   switch (format) {
+   case EMIT_1UB_1F:
+   case EMIT_3UB_3F_RGB:
+   case EMIT_3UB_3F_BGR:
+   case EMIT_4UB_4F_RGBA:
+   case EMIT_4UB_4F_BGRA:
+   case EMIT_4UB_4F_ARGB:
+   case EMIT_4UB_4F_ABGR:
+      return true;
+   case EMIT_4CHAN_4F_RGBA:
+      return CHAN_TYPE == GL_UNSIGNED_BYTE;
+   default:
+      return false;
+   }
+}
+
+/**
+ * Set up just enough of a context for t_vertex.c, with every enabled
+ * input pointing at the same pseudo random data.  Colors go slightly
+ * out of [0,1] to exercise the clamping.
+ */
+void
+init_state(emit_state *s, const layout *l, bool codegen)
+{
+   uint32_t seed = 3;
+
+   s->ctx = (gl_context *) calloc(1, sizeof(gl_context));
+   s->ctx->swtnl_context = calloc(1, sizeof(TNLcontext));
+   _tnl_init_vertices(s->ctx, num_verts, max_vertex_size);
+   if (!codegen) {
+      tnl_clipspace *vtx = GET_VERTEX_STATE(s->ctx);
+      vtx->codegen_emit = NULL;
+   }
+
+   s->data = (GLfloat (*)[4]) malloc(num_verts * sizeof(s->data[0]));
+   for (GLuint i = 0; i < num_verts; i++) {
+      for (int c = 0; c < 4; c++) {
+         seed = seed * 1103515245 + 12345;
+         s->data[i][c] = ((seed >> 8) & 0xffff) / 60000.0f - 0.05f;
+      }
+   }
+
+   for (GLuint a = 0; a < _TNL_ATTRIB_MAX; a++) {
+      GLvector4f *v = &s->inputs[a];
+
+      v->data = s->data;
+      v->start = s->data[0];
+      v->count = num_verts;
+      v->stride = 4 * sizeof(GLfloat);
+      v->size = l->input_size[a] ? l->input_size[a] : 4;
+      TNL_CONTEXT(s->ctx)->vb.AttribPtr[a] = v;
+   }
+
+   memset(s->vp, 0, sizeof(s->vp));
+   s->vp[MAT_SX] = 320.0f;
+   s->vp[MAT_SY] = -240.0f;
+   s->vp[MAT_SZ] = 0.5f;
+   s->vp[MAT_TX] = 320.5f;
+   s->vp[MAT_TY] = 240.5f;
+   s->vp[MAT_TZ] = 0.5f;
+
+   _tnl_install_attrs(s->ctx, l->map, l->nr, s->vp, 0);
+}
+
+void
+fini_state(emit_state *s)
+{
+   _tnl_free_vertices(s->ctx);
+   free(s->ctx->swtnl_context);
+   free(s->ctx);
+   free(s->data);
+}
+
+} /* anonymous namespace */
+
+
+TEST(tnl_vertex_emit, codegen_matches_generic)
+{
+   for (unsigned i = 0; i < sizeof(layouts) / sizeof(layouts[0]); i++) {
+      const layout *l = &layouts[i];
+      emit_state ref, gen;
+      GLubyte *ref_buf = (GLubyte *) calloc(num_verts, max_vertex_size);
+      GLubyte *gen_buf = (GLubyte *) calloc(num_verts, max_vertex_size);
+      tnl_clipspace *vtx;
+
+      init_state(&ref, l, false);
+      init_state(&gen, l, true);
+
+      /* The first emit picks the function and sets up the per
+       * attribute input strides, then force the generic one.
+       */
+      _tnl_emit_vertices_to_buffer(ref.ctx, 0, num_verts, ref_buf);
+      vtx = GET_VERTEX_STATE(ref.ctx);
+      const tnl_emit_func c_emit = vtx->emit;
+      vtx->emit = _tnl_generic_emit;
+      _tnl_emit_vertices_to_buffer(ref.ctx, 0, num_verts, ref_buf);
+      _tnl_emit_vertices_to_buffer(gen.ctx, 0, num_verts, gen_buf);
+
+      vtx = GET_VERTEX_STATE(gen.ctx);
+#ifdef TNL_SSE_EMIT
+      /* Otherwise the comparison below would pass without the generated
+       * code ever running.  MESA_NO_CODEGEN turns the generator off.
+       */
+      if (vtx->codegen_emit) {
+         EXPECT_TRUE(vtx->emit != _tnl_generic_emit) << l->name;
+         EXPECT_TRUE(vtx->emit != c_emit) << l->name;
+      }
+#else
+      (void) c_emit;
+#endif
+      for (GLuint v = 0; v < num_verts; v++) {
+         const GLubyte *r = ref_buf + v * vtx->vertex_size;
+         const GLubyte *g = gen_buf + v * vtx->vertex_size;
+
+         for (GLuint j = 0; j < vtx->attr_count; j++) {
+            const tnl_clipspace_attr *a = &vtx->attr[j];
+            const GLuint size = a->vertattrsize;
+
+            if (is_ubyte_format(a->format)) {
+               /* Rounding of the float to ubyte conversions may differ */
+               for (GLuint k = 0; k < size; k++)
+                  EXPECT_LE(abs(r[a->vertoffset + k] - g[a->vertoffset + k]), 1)
+                     << l->name << " vertex " << v << " attr " << j;
+            }
+            else {
+               /* The float attributes are copied or scaled the same way */
+               EXPECT_EQ(0, memcmp(r + a->vertoffset, g + a->vertoffset, size))
+                  << l->name << " vertex " << v << " attr " << j;
+            }
+         }
+      }
+
+      fini_state(&ref);
+      fini_state(&gen);
+      free(ref_buf);
+      free(gen_buf);
+   }
+}
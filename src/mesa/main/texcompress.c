@@ -42,6 +42,7 @@
 #include "texcompress_rgtc.h"
 #include "texcompress_s3tc.h"
 #include "texcompress_etc.h"
+#include "threadpool.h"
 
 
 /**
@@ -625,3 +626,55 @@ _mesa_decompress_image(mesa_format format, GLuint width, GLuint height,
       }
    }
 }
+
+
+#define BLOCK_ROWS_MIN_TEXELS_PER_THREAD (256 * 256)
+
+/** Image split into bands of block rows, one per pool piece */
+struct block_rows_job {
+   block_rows_func func;
+   void *data;
+   GLuint blockRows;
+   GLuint numBands;
+};
+
+static void
+block_rows_band(void *data, unsigned band)
+{
+   const struct block_rows_job *job = data;
+   const GLuint first = job->blockRows * band / job->numBands;
+   const GLuint end = job->blockRows * (band + 1) / job->numBands;
+
+   job->func(job->data, first, end - first);
+}
+
+
+/**
+ * Run \p func over all the rows of blocks of a width x height image.
+ * Large images (big uploads, the base levels of big mip chains) are
+ * split into bands of block rows processed on the shared thread pool;
+ * small ones are done on the calling thread.  Each block only depends on
+ * its own texels, so the result doesn't depend on the split.
+ */
+void
+_mesa_process_block_rows(GLuint width, GLuint height, GLuint blockHeight,
+                         block_rows_func func, void *data)
+{
+   struct block_rows_job job;
+   GLint64 numBands;
+
+   job.func = func;
+   job.data = data;
+   job.blockRows = (height + blockHeight - 1) / blockHeight;
+
+   numBands = (GLint64) width * height / BLOCK_ROWS_MIN_TEXELS_PER_THREAD;
+   numBands = MIN2(numBands, (GLint64) job.blockRows);
+   if (numBands < 2) {
+      if (job.blockRows)
+         func(data, 0, job.blockRows);
+      return;
+   }
+
+   job.numBands = MIN2(numBands, (GLint64) _mesa_threadpool_num_threads());
+   _mesa_threadpool_run(job.numBands, block_rows_band, &job);
+}
@@ -63,4 +63,12 @@ _mesa_decompress_image(mesa_format format, GLuint width, GLuint height,
                        const GLubyte *src, GLint srcRowStride,
                        GLfloat *dest);
 
+
+/** Compress or decompress the rows of blocks [first, first + count) */
+typedef void (*block_rows_func)(void *data, GLuint first, GLuint count);
+
+extern void
+_mesa_process_block_rows(GLuint width, GLuint height, GLuint blockHeight,
+                         block_rows_func func, void *data);
+
 #endif /* TEXCOMPRESS_H */
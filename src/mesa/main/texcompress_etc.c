@@ -548,26 +548,29 @@ etc2_rgb8_fetch_texel(const struct etc2_block *block,
    }
 }
 
+static uint8_t
+etc2_alpha8_value(const struct etc2_block *block, int idx)
+{
+   int modifier, alpha;
+   modifier = etc2_modifier_tables[block->table_index][idx];
+   alpha = block->base_codeword + modifier * block->multiplier;
+   return etc2_clamp(alpha);
+}
+
 static void
 etc2_alpha8_fetch_texel(const struct etc2_block *block,
       int x, int y, uint8_t *dst)
 {
-   int modifier, alpha, idx;
    /* get pixel index */
-   idx = etc2_get_pixel_index(block, x, y);
-   modifier = etc2_modifier_tables[block->table_index][idx];
-   alpha = block->base_codeword + modifier * block->multiplier;
-   dst[3] = etc2_clamp(alpha);
+   int idx = etc2_get_pixel_index(block, x, y);
+   dst[3] = etc2_alpha8_value(block, idx);
 }
 
-static void
-etc2_r11_fetch_texel(const struct etc2_block *block,
-                     int x, int y, uint8_t *dst)
+static GLushort
+etc2_r11_value(const struct etc2_block *block, int idx)
 {
-   GLint modifier, idx;
+   GLint modifier;
    GLshort color;
-   /* Get pixel index */
-   idx = etc2_get_pixel_index(block, x, y);
    modifier = etc2_modifier_tables[block->table_index][idx];
 
    if (block->multiplier != 0)
@@ -583,22 +586,28 @@ etc2_r11_fetch_texel(const struct etc2_block *block,
     * 11 bits."
     */
    color = (color << 5) | (color >> 6);
-   ((GLushort *)dst)[0] = color;
+   return color;
 }
 
 static void
-etc2_signed_r11_fetch_texel(const struct etc2_block *block,
-                            int x, int y, uint8_t *dst)
+etc2_r11_fetch_texel(const struct etc2_block *block,
+                     int x, int y, uint8_t *dst)
+{
+   /* Get pixel index */
+   GLint idx = etc2_get_pixel_index(block, x, y);
+   ((GLushort *)dst)[0] = etc2_r11_value(block, idx);
+}
+
+static GLshort
+etc2_signed_r11_value(const struct etc2_block *block, int idx)
 {
-   GLint modifier, idx;
+   GLint modifier;
    GLshort color;
    GLbyte base_codeword = (GLbyte) block->base_codeword;
 
    if (base_codeword == -128)
       base_codeword = -127;
 
-   /* Get pixel index */
-   idx = etc2_get_pixel_index(block, x, y);
    modifier = etc2_modifier_tables[block->table_index][idx];
 
    if (block->multiplier != 0)
@@ -621,7 +630,16 @@ etc2_signed_r11_fetch_texel(const struct etc2_block *block,
       color = (color << 5) | (color >> 5);
       color = -color;
    }
-   ((GLshort *)dst)[0] = color;
+   return color;
+}
+
+static void
+etc2_signed_r11_fetch_texel(const struct etc2_block *block,
+                            int x, int y, uint8_t *dst)
+{
+   /* Get pixel index */
+   GLint idx = etc2_get_pixel_index(block, x, y);
+   ((GLshort *)dst)[0] = etc2_signed_r11_value(block, idx);
 }
 
 static void
@@ -664,426 +682,219 @@ etc2_rgba8_fetch_texel(const struct etc2_block *block,
    etc2_alpha8_fetch_texel(block, x, y, dst);
 }
 
+/**
+ * Decode a whole RGB8 block to RGBA texels, row major, the same way
+ * etc2_rgb8_fetch_texel() does texel by texel, with alpha set to 255 for
+ * opaque texels.  Except for planar mode a block has at most eight
+ * distinct colors, so build those once instead of clamping per texel.
+ */
 static void
-etc2_unpack_rgb8(uint8_t *dst_row,
-                 unsigned dst_stride,
-                 const uint8_t *src_row,
-                 unsigned src_stride,
-                 unsigned width,
-                 unsigned height)
+etc2_rgb8_decode_block(const struct etc2_block *block,
+                       uint8_t texels[16][4],
+                       GLboolean punchthrough_alpha)
 {
-   const unsigned bw = 4, bh = 4, bs = 8, comps = 4;
-   struct etc2_block block;
-   unsigned x, y, i, j;
-
-   for (y = 0; y < height; y += bh) {
-      const uint8_t *src = src_row;
-      /*
-       * Destination texture may not be a multiple of four texels in
-       * height. Compute a safe height to avoid writing outside the texture.
-       */
-      const unsigned h = MIN2(bh, height - y);
-
-      for (x = 0; x < width; x+= bw) {
-         /*
-          * Destination texture may not be a multiple of four texels in
-          * width. Compute a safe width to avoid writing outside the texture.
-          */
-         const unsigned w = MIN2(bw, width - x);
-
-         etc2_rgb8_parse_block(&block, src,
-                               false /* punchthrough_alpha */);
-
-         for (j = 0; j < h; j++) {
-            uint8_t *dst = dst_row + (y + j) * dst_stride + x * comps;
-            for (i = 0; i < w; i++) {
-               etc2_rgb8_fetch_texel(&block, i, j, dst,
-                                     false /* punchthrough_alpha */);
-               dst[3] = 255;
-               dst += comps;
-            }
+   const uint32_t indices = (uint32_t) block->pixel_indices[0];
+   const bool subblocks = block->is_ind_mode || block->is_diff_mode;
+   uint8_t palette[2][4][4];
+   int x, y, blk, idx, i;
+
+   if (block->is_planar_mode) {
+      for (y = 0; y < 4; y++) {
+         for (x = 0; x < 4; x++) {
+            etc2_rgb8_fetch_texel(block, x, y, texels[y * 4 + x],
+                                  punchthrough_alpha);
+            texels[y * 4 + x][3] = 255;
          }
-
-         src += bs;
       }
-
-      src_row += src_stride;
+      return;
    }
-}
 
-static void
-etc2_unpack_srgb8(uint8_t *dst_row,
-                  unsigned dst_stride,
-                  const uint8_t *src_row,
-                  unsigned src_stride,
-                  unsigned width,
-                  unsigned height)
-{
-   const unsigned bw = 4, bh = 4, bs = 8, comps = 4;
-   struct etc2_block block;
-   unsigned x, y, i, j;
-   uint8_t tmp;
-
-   for (y = 0; y < height; y += bh) {
-      const uint8_t *src = src_row;
-      const unsigned h = MIN2(bh, height - y);
+   for (blk = 0; blk < (subblocks ? 2 : 1); blk++) {
+      for (idx = 0; idx < 4; idx++) {
+         if (subblocks) {
+            const int modifier = block->modifier_tables[blk][idx];
 
-      for (x = 0; x < width; x+= bw) {
-         const unsigned w = MIN2(bw, width - x);
-         etc2_rgb8_parse_block(&block, src,
-                               false /* punchthrough_alpha */);
-
-
-         for (j = 0; j < h; j++) {
-            uint8_t *dst = dst_row + (y + j) * dst_stride + x * comps;
-            for (i = 0; i < w; i++) {
-               etc2_rgb8_fetch_texel(&block, i, j, dst,
-                                     false /* punchthrough_alpha */);
-               /* Convert to MESA_FORMAT_B8G8R8A8_SRGB */
-               tmp = dst[0];
-               dst[0] = dst[2];
-               dst[2] = tmp;
-               dst[3] = 255;
-
-               dst += comps;
-            }
+            for (i = 0; i < 3; i++)
+               palette[blk][idx][i] =
+                  etc2_clamp(block->base_colors[blk][i] + modifier);
          }
-         src += bs;
-      }
-
-      src_row += src_stride;
-   }
-}
-
-static void
-etc2_unpack_rgba8(uint8_t *dst_row,
-                  unsigned dst_stride,
-                  const uint8_t *src_row,
-                  unsigned src_stride,
-                  unsigned width,
-                  unsigned height)
-{
-   /* If internalformat is COMPRESSED_RGBA8_ETC2_EAC, each 4 × 4 block of
-    * RGBA8888 information is compressed to 128 bits. To decode a block, the
-    * two 64-bit integers int64bitAlpha and int64bitColor are calculated.
-   */
-   const unsigned bw = 4, bh = 4, bs = 16, comps = 4;
-   struct etc2_block block;
-   unsigned x, y, i, j;
-
-   for (y = 0; y < height; y += bh) {
-      const uint8_t *src = src_row;
-      const unsigned h = MIN2(bh, height - y);
-
-      for (x = 0; x < width; x+= bw) {
-         const unsigned w = MIN2(bw, width - x);
-         etc2_rgba8_parse_block(&block, src);
-
-         for (j = 0; j < h; j++) {
-            uint8_t *dst = dst_row + (y + j) * dst_stride + x * comps;
-            for (i = 0; i < w; i++) {
-               etc2_rgba8_fetch_texel(&block, i, j, dst);
-               dst += comps;
-            }
+         else {
+            /* T and H modes */
+            for (i = 0; i < 3; i++)
+               palette[blk][idx][i] = block->paint_colors[idx][i];
          }
-         src += bs;
+         palette[blk][idx][3] = 255;
       }
 
-      src_row += src_stride;
+      if (punchthrough_alpha && !block->opaque)
+         memset(palette[blk][2], 0, 4);
    }
-}
 
-static void
-etc2_unpack_srgb8_alpha8(uint8_t *dst_row,
-                         unsigned dst_stride,
-                         const uint8_t *src_row,
-                         unsigned src_stride,
-                         unsigned width,
-                         unsigned height)
-{
-   /* If internalformat is COMPRESSED_SRGB8_ALPHA8_ETC2_EAC, each 4 × 4 block
-    * of RGBA8888 information is compressed to 128 bits. To decode a block, the
-    * two 64-bit integers int64bitAlpha and int64bitColor are calculated.
-    */
-   const unsigned bw = 4, bh = 4, bs = 16, comps = 4;
-   struct etc2_block block;
-   unsigned x, y, i, j;
-   uint8_t tmp;
-
-   for (y = 0; y < height; y += bh) {
-      const unsigned h = MIN2(bh, height - y);
-      const uint8_t *src = src_row;
+   for (y = 0; y < 4; y++) {
+      for (x = 0; x < 4; x++) {
+         const int bit = y + x * 4;
 
-      for (x = 0; x < width; x+= bw) {
-         const unsigned w = MIN2(bw, width - x);
-         etc2_rgba8_parse_block(&block, src);
-
-         for (j = 0; j < h; j++) {
-            uint8_t *dst = dst_row + (y + j) * dst_stride + x * comps;
-            for (i = 0; i < w; i++) {
-               etc2_rgba8_fetch_texel(&block, i, j, dst);
-
-               /* Convert to MESA_FORMAT_B8G8R8A8_SRGB */
-               tmp = dst[0];
-               dst[0] = dst[2];
-               dst[2] = tmp;
-               dst[3] = dst[3];
-
-               dst += comps;
-            }
-         }
-         src += bs;
+         idx = ((indices >> (15 + bit)) & 0x2) |
+               ((indices >>      (bit)) & 0x1);
+         blk = !subblocks ? 0 : (block->flipped) ? (y >= 2) : (x >= 2);
+         memcpy(texels[y * 4 + x], palette[blk][idx], 4);
       }
-
-      src_row += src_stride;
    }
 }
 
 static void
-etc2_unpack_r11(uint8_t *dst_row,
-                unsigned dst_stride,
-                const uint8_t *src_row,
-                unsigned src_stride,
-                unsigned width,
-                unsigned height)
+etc2_alpha8_decode_block(const struct etc2_block *block,
+                         uint8_t texels[16][4])
 {
-   /* If internalformat is COMPRESSED_R11_EAC, each 4 × 4 block of
-      color information is compressed to 64 bits.
-   */
-   const unsigned bw = 4, bh = 4, bs = 8, comps = 1, comp_size = 2;
-   struct etc2_block block;
-   unsigned x, y, i, j;
-
-   for (y = 0; y < height; y += bh) {
-      const unsigned h = MIN2(bh, height - y);
-      const uint8_t *src = src_row;
+   uint8_t values[8];
+   int x, y, idx;
 
-      for (x = 0; x < width; x+= bw) {
-         const unsigned w = MIN2(bw, width - x);
-         etc2_r11_parse_block(&block, src);
+   for (idx = 0; idx < 8; idx++)
+      values[idx] = etc2_alpha8_value(block, idx);
 
-         for (j = 0; j < h; j++) {
-            uint8_t *dst = dst_row + (y + j) * dst_stride + x * comps * comp_size;
-            for (i = 0; i < w; i++) {
-               etc2_r11_fetch_texel(&block, i, j, dst);
-               dst += comps * comp_size;
-            }
-         }
-         src += bs;
-      }
-
-      src_row += src_stride;
-   }
+   for (y = 0; y < 4; y++)
+      for (x = 0; x < 4; x++)
+         texels[y * 4 + x][3] = values[etc2_get_pixel_index(block, x, y)];
 }
 
+/**
+ * Decode a whole R11 block to 16-bit values, row major, texel_size bytes
+ * apart.
+ */
 static void
-etc2_unpack_rg11(uint8_t *dst_row,
-                 unsigned dst_stride,
-                 const uint8_t *src_row,
-                 unsigned src_stride,
-                 unsigned width,
-                 unsigned height)
+etc2_r11_decode_block(const struct etc2_block *block,
+                      uint8_t *texels, unsigned texel_size,
+                      GLboolean is_signed)
 {
-   /* If internalformat is COMPRESSED_RG11_EAC, each 4 × 4 block of
-      RG color information is compressed to 128 bits.
-   */
-   const unsigned bw = 4, bh = 4, bs = 16, comps = 2, comp_size = 2;
-   struct etc2_block block;
-   unsigned x, y, i, j;
+   GLushort values[8];
+   int x, y, idx;
 
-   for (y = 0; y < height; y += bh) {
-      const unsigned h = MIN2(bh, height - y);
-      const uint8_t *src = src_row;
-
-      for (x = 0; x < width; x+= bw) {
-         const unsigned w = MIN2(bw, width - x);
-         /* red component */
-         etc2_r11_parse_block(&block, src);
-
-         for (j = 0; j < h; j++) {
-            uint8_t *dst = dst_row + (y + j) * dst_stride +
-                           x * comps * comp_size;
-            for (i = 0; i < w; i++) {
-               etc2_r11_fetch_texel(&block, i, j, dst);
-               dst += comps * comp_size;
-            }
-         }
-         /* green component */
-         etc2_r11_parse_block(&block, src + 8);
+   for (idx = 0; idx < 8; idx++) {
+      values[idx] = is_signed ? (GLushort) etc2_signed_r11_value(block, idx)
+                              : etc2_r11_value(block, idx);
+   }
 
-         for (j = 0; j < h; j++) {
-            uint8_t *dst = dst_row + (y + j) * dst_stride +
-                           x * comps * comp_size;
-            for (i = 0; i < w; i++) {
-               etc2_r11_fetch_texel(&block, i, j, dst + comp_size);
-               dst += comps * comp_size;
-            }
-         }
-         src += bs;
+   for (y = 0; y < 4; y++) {
+      for (x = 0; x < 4; x++) {
+         idx = etc2_get_pixel_index(block, x, y);
+         memcpy(texels + (y * 4 + x) * texel_size, &values[idx],
+                sizeof(GLushort));
       }
-
-      src_row += src_stride;
    }
 }
 
+/**
+ * Unpack an image of any of the formats _mesa_unpack_etc2_format()
+ * takes, a block at a time.
+ */
 static void
-etc2_unpack_signed_r11(uint8_t *dst_row,
-                       unsigned dst_stride,
-                       const uint8_t *src_row,
-                       unsigned src_stride,
-                       unsigned width,
-                       unsigned height)
+etc2_unpack_blocks(uint8_t *dst_row,
+                   unsigned dst_stride,
+                   const uint8_t *src_row,
+                   unsigned src_stride,
+                   unsigned width,
+                   unsigned height,
+                   mesa_format format)
 {
-   /* If internalformat is COMPRESSED_SIGNED_R11_EAC, each 4 × 4 block of
-      red color information is compressed to 64 bits.
-   */
-   const unsigned bw = 4, bh = 4, bs = 8, comps = 1, comp_size = 2;
+   const unsigned bw = 4, bh = 4;
+   unsigned bs, texel_size;
+   GLboolean punchthrough_alpha = false, is_signed = false, bgra = false;
    struct etc2_block block;
-   unsigned x, y, i, j;
-
-   for (y = 0; y < height; y += bh) {
-      const unsigned h = MIN2(bh, height - y);
-      const uint8_t *src = src_row;
-
-      for (x = 0; x < width; x+= bw) {
-         const unsigned w = MIN2(bw, width - x);
-         etc2_r11_parse_block(&block, src);
+   uint8_t texels[16][4];
+   unsigned x, y, j, k;
 
-         for (j = 0; j < h; j++) {
-            uint8_t *dst = dst_row + (y + j) * dst_stride +
-                           x * comps * comp_size;
-            for (i = 0; i < w; i++) {
-               etc2_signed_r11_fetch_texel(&block, i, j, dst);
-               dst += comps * comp_size;
-            }
-         }
-         src += bs;
-      }
-
-      src_row += src_stride;
+   switch (format) {
+   case MESA_FORMAT_ETC2_SRGB8:
+      bgra = true;
+      /* fall-through */
+   case MESA_FORMAT_ETC2_RGB8:
+      bs = 8;
+      texel_size = 4;
+      break;
+   case MESA_FORMAT_ETC2_SRGB8_ALPHA8_EAC:
+      bgra = true;
+      /* fall-through */
+   case MESA_FORMAT_ETC2_RGBA8_EAC:
+      bs = 16;
+      texel_size = 4;
+      break;
+   case MESA_FORMAT_ETC2_SIGNED_R11_EAC:
+      is_signed = true;
+      /* fall-through */
+   case MESA_FORMAT_ETC2_R11_EAC:
+      bs = 8;
+      texel_size = 2;
+      break;
+   case MESA_FORMAT_ETC2_SIGNED_RG11_EAC:
+      is_signed = true;
+      /* fall-through */
+   case MESA_FORMAT_ETC2_RG11_EAC:
+      bs = 16;
+      texel_size = 4;
+      break;
+   case MESA_FORMAT_ETC2_SRGB8_PUNCHTHROUGH_ALPHA1:
+      bgra = true;
+      /* fall-through */
+   case MESA_FORMAT_ETC2_RGB8_PUNCHTHROUGH_ALPHA1:
+      punchthrough_alpha = true;
+      bs = 8;
+      texel_size = 4;
+      break;
+   default:
+      return;
    }
-}
-
-static void
-etc2_unpack_signed_rg11(uint8_t *dst_row,
-                        unsigned dst_stride,
-                        const uint8_t *src_row,
-                        unsigned src_stride,
-                        unsigned width,
-                        unsigned height)
-{
-   /* If internalformat is COMPRESSED_SIGNED_RG11_EAC, each 4 × 4 block of
-      RG color information is compressed to 128 bits.
-   */
-   const unsigned bw = 4, bh = 4, bs = 16, comps = 2, comp_size = 2;
-   struct etc2_block block;
-   unsigned x, y, i, j;
 
    for (y = 0; y < height; y += bh) {
-      const unsigned h = MIN2(bh, height - y);
       const uint8_t *src = src_row;
+      /*
+       * Destination texture may not be a multiple of four texels in
+       * height. Compute a safe height to avoid writing outside the texture.
+       */
+      const unsigned h = MIN2(bh, height - y);
 
-      for (x = 0; x < width; x+= bw) {
+      for (x = 0; x < width; x += bw) {
          const unsigned w = MIN2(bw, width - x);
-         /* red component */
-         etc2_r11_parse_block(&block, src);
 
-         for (j = 0; j < h; j++) {
-            uint8_t *dst = dst_row + (y + j) * dst_stride +
-                          x * comps * comp_size;
-            for (i = 0; i < w; i++) {
-               etc2_signed_r11_fetch_texel(&block, i, j, dst);
-               dst += comps * comp_size;
-            }
+         switch (format) {
+         case MESA_FORMAT_ETC2_RGBA8_EAC:
+         case MESA_FORMAT_ETC2_SRGB8_ALPHA8_EAC:
+            etc2_rgba8_parse_block(&block, src);
+            etc2_rgb8_decode_block(&block, texels,
+                                   false /* punchthrough_alpha */);
+            etc2_alpha8_decode_block(&block, texels);
+            break;
+         case MESA_FORMAT_ETC2_R11_EAC:
+         case MESA_FORMAT_ETC2_SIGNED_R11_EAC:
+            etc2_r11_parse_block(&block, src);
+            etc2_r11_decode_block(&block, texels[0], 2, is_signed);
+            break;
+         case MESA_FORMAT_ETC2_RG11_EAC:
+         case MESA_FORMAT_ETC2_SIGNED_RG11_EAC:
+            /* red component */
+            etc2_r11_parse_block(&block, src);
+            etc2_r11_decode_block(&block, texels[0], 4, is_signed);
+            /* green component */
+            etc2_r11_parse_block(&block, src + 8);
+            etc2_r11_decode_block(&block, texels[0] + 2, 4, is_signed);
+            break;
+         default:
+            etc2_rgb8_parse_block(&block, src, punchthrough_alpha);
+            etc2_rgb8_decode_block(&block, texels, punchthrough_alpha);
+            break;
          }
-         /* green component */
-         etc2_r11_parse_block(&block, src + 8);
 
-         for (j = 0; j < h; j++) {
-            uint8_t *dst = dst_row + (y + j) * dst_stride +
-                           x * comps * comp_size;
-            for (i = 0; i < w; i++) {
-               etc2_signed_r11_fetch_texel(&block, i, j, dst + comp_size);
-               dst += comps * comp_size;
+         if (bgra) {
+            /* Convert to MESA_FORMAT_B8G8R8A8_SRGB */
+            for (k = 0; k < 16; k++) {
+               const uint8_t tmp = texels[k][0];
+               texels[k][0] = texels[k][2];
+               texels[k][2] = tmp;
             }
          }
-         src += bs;
-      }
-
-      src_row += src_stride;
-   }
-}
 
-static void
-etc2_unpack_rgb8_punchthrough_alpha1(uint8_t *dst_row,
-                                     unsigned dst_stride,
-                                     const uint8_t *src_row,
-                                     unsigned src_stride,
-                                     unsigned width,
-                                     unsigned height)
-{
-   const unsigned bw = 4, bh = 4, bs = 8, comps = 4;
-   struct etc2_block block;
-   unsigned x, y, i, j;
-
-   for (y = 0; y < height; y += bh) {
-      const unsigned h = MIN2(bh, height - y);
-      const uint8_t *src = src_row;
-
-      for (x = 0; x < width; x+= bw) {
-         const unsigned w = MIN2(bw, width - x);
-         etc2_rgb8_parse_block(&block, src,
-                               true /* punchthrough_alpha */);
          for (j = 0; j < h; j++) {
-            uint8_t *dst = dst_row + (y + j) * dst_stride + x * comps;
-            for (i = 0; i < w; i++) {
-               etc2_rgb8_fetch_texel(&block, i, j, dst,
-                                     true /* punchthrough_alpha */);
-               dst += comps;
-            }
-         }
-
-         src += bs;
-      }
-
-      src_row += src_stride;
-   }
-}
-
-static void
-etc2_unpack_srgb8_punchthrough_alpha1(uint8_t *dst_row,
-                                     unsigned dst_stride,
-                                     const uint8_t *src_row,
-                                     unsigned src_stride,
-                                     unsigned width,
-                                     unsigned height)
-{
-   const unsigned bw = 4, bh = 4, bs = 8, comps = 4;
-   struct etc2_block block;
-   unsigned x, y, i, j;
-   uint8_t tmp;
-
-   for (y = 0; y < height; y += bh) {
-      const unsigned h = MIN2(bh, height - y);
-      const uint8_t *src = src_row;
-
-      for (x = 0; x < width; x+= bw) {
-         const unsigned w = MIN2(bw, width - x);
-         etc2_rgb8_parse_block(&block, src,
-                               true /* punchthrough_alpha */);
-         for (j = 0; j < h; j++) {
-            uint8_t *dst = dst_row + (y + j) * dst_stride + x * comps;
-            for (i = 0; i < w; i++) {
-               etc2_rgb8_fetch_texel(&block, i, j, dst,
-                                     true /* punchthrough_alpha */);
-               /* Convert to MESA_FORMAT_B8G8R8A8_SRGB */
-               tmp = dst[0];
-               dst[0] = dst[2];
-               dst[2] = tmp;
-               dst[3] = dst[3];
-
-               dst += comps;
-            }
+            memcpy(dst_row + (y + j) * dst_stride + x * texel_size,
+                   texels[0] + j * bw * texel_size, w * texel_size);
          }
 
          src += bs;
@@ -1176,6 +987,28 @@ _mesa_texstore_etc2_srgb8_punchthrough_alpha1(TEXSTORE_PARAMS)
 }
 
 
+/** Arguments of etc2_unpack_rows() */
+struct etc2_unpack_rows {
+   uint8_t *dst_row;
+   unsigned dst_stride;
+   const uint8_t *src_row;
+   unsigned src_stride;
+   unsigned width;
+   unsigned height;
+   mesa_format format;
+};
+
+static void
+etc2_unpack_rows(void *data, GLuint first, GLuint count)
+{
+   const struct etc2_unpack_rows *u = data;
+
+   etc2_unpack_blocks(u->dst_row + first * 4 * u->dst_stride, u->dst_stride,
+                      u->src_row + first * u->src_stride, u->src_stride,
+                      u->width, MIN2(count * 4, u->height - first * 4),
+                      u->format);
+}
+
 /**
  * Decode texture data in any one of following formats:
  * `MESA_FORMAT_ETC2_RGB8`
@@ -1206,48 +1039,18 @@ _mesa_unpack_etc2_format(uint8_t *dst_row,
                          unsigned src_height,
                          mesa_format format)
 {
-   if (format == MESA_FORMAT_ETC2_RGB8)
-      etc2_unpack_rgb8(dst_row, dst_stride,
-                       src_row, src_stride,
-                       src_width, src_height);
-   else if (format == MESA_FORMAT_ETC2_SRGB8)
-      etc2_unpack_srgb8(dst_row, dst_stride,
-                        src_row, src_stride,
-                        src_width, src_height);
-   else if (format == MESA_FORMAT_ETC2_RGBA8_EAC)
-      etc2_unpack_rgba8(dst_row, dst_stride,
-                        src_row, src_stride,
-                        src_width, src_height);
-   else if (format == MESA_FORMAT_ETC2_SRGB8_ALPHA8_EAC)
-      etc2_unpack_srgb8_alpha8(dst_row, dst_stride,
-                               src_row, src_stride,
-                               src_width, src_height);
-   else if (format == MESA_FORMAT_ETC2_R11_EAC)
-      etc2_unpack_r11(dst_row, dst_stride,
-                      src_row, src_stride,
-                      src_width, src_height);
-   else if (format == MESA_FORMAT_ETC2_RG11_EAC)
-      etc2_unpack_rg11(dst_row, dst_stride,
-                       src_row, src_stride,
-                       src_width, src_height);
-   else if (format == MESA_FORMAT_ETC2_SIGNED_R11_EAC)
-      etc2_unpack_signed_r11(dst_row, dst_stride,
-                             src_row, src_stride,
-                             src_width, src_height);
-   else if (format == MESA_FORMAT_ETC2_SIGNED_RG11_EAC)
-      etc2_unpack_signed_rg11(dst_row, dst_stride,
-                              src_row, src_stride,
-                              src_width, src_height);
-   else if (format == MESA_FORMAT_ETC2_RGB8_PUNCHTHROUGH_ALPHA1)
-      etc2_unpack_rgb8_punchthrough_alpha1(dst_row, dst_stride,
-                                           src_row, src_stride,
-                                           src_width, src_height);
-   else if (format == MESA_FORMAT_ETC2_SRGB8_PUNCHTHROUGH_ALPHA1)
-      etc2_unpack_srgb8_punchthrough_alpha1(dst_row, dst_stride,
-                                            src_row, src_stride,
-                                            src_width, src_height);
-}
+   struct etc2_unpack_rows u;
+
+   u.dst_row = dst_row;
+   u.dst_stride = dst_stride;
+   u.src_row = src_row;
+   u.src_stride = src_stride;
+   u.width = src_width;
+   u.height = src_height;
+   u.format = format;
 
+   _mesa_process_block_rows(src_width, src_height, 4, etc2_unpack_rows, &u);
+}
 
 
 static void
@@ -135,6 +135,43 @@ TAG(etc1_fetch_texel)(const struct TAG(etc1_block) *block,
    dst[2] = TAG(etc1_clamp)(base_color[2], modifier);
 }
 
+/**
+ * Decode a whole block to RGBA texels, row major.  Each subblock has
+ * only four colors, so build those once instead of clamping per texel.
+ */
+static void
+TAG(etc1_decode_block)(const struct TAG(etc1_block) *block,
+                       UINT8_TYPE texels[16][4])
+{
+   UINT8_TYPE palette[2][4][4];
+   int x, y, blk, idx;
+
+   for (blk = 0; blk < 2; blk++) {
+      for (idx = 0; idx < 4; idx++) {
+         const int modifier = block->modifier_tables[blk][idx];
+
+         palette[blk][idx][0] =
+            TAG(etc1_clamp)(block->base_colors[blk][0], modifier);
+         palette[blk][idx][1] =
+            TAG(etc1_clamp)(block->base_colors[blk][1], modifier);
+         palette[blk][idx][2] =
+            TAG(etc1_clamp)(block->base_colors[blk][2], modifier);
+         palette[blk][idx][3] = 255;
+      }
+   }
+
+   for (y = 0; y < 4; y++) {
+      for (x = 0; x < 4; x++) {
+         const int bit = y + x * 4;
+
+         idx = ((block->pixel_indices >> (15 + bit)) & 0x2) |
+               ((block->pixel_indices >>      (bit)) & 0x1);
+         blk = (block->flipped) ? (y >= 2) : (x >= 2);
+         memcpy(texels[y * 4 + x], palette[blk][idx], 4);
+      }
+   }
+}
+
 static void
 etc1_unpack_rgba8888(uint8_t *dst_row,
                      unsigned dst_stride,
@@ -145,21 +182,22 @@ etc1_unpack_rgba8888(uint8_t *dst_row,
 {
    const unsigned bw = 4, bh = 4, bs = 8, comps = 4;
    struct etc1_block block;
-   unsigned x, y, i, j;
+   uint8_t texels[16][4];
+   unsigned x, y, j;
 
    for (y = 0; y < height; y += bh) {
       const uint8_t *src = src_row;
+      const unsigned h = MIN2(bh, height - y);
 
       for (x = 0; x < width; x+= bw) {
+         const unsigned w = MIN2(bw, width - x);
+
          etc1_parse_block(&block, src);
+         etc1_decode_block(&block, texels);
 
-         for (j = 0; j < MIN2(bh, height - y); j++) {
+         for (j = 0; j < h; j++) {
             uint8_t *dst = dst_row + (y + j) * dst_stride + x * comps;
-            for (i = 0; i < MIN2(bw, width - x); i++) {
-               etc1_fetch_texel(&block, i, j, dst);
-               dst[3] = 255;
-               dst += comps;
-            }
+            memcpy(dst, texels[j * 4], w * comps);
          }
 
          src += bs;
@@ -1275,14 +1275,45 @@ upscale_teximage2d(GLsizei inWidth, GLsizei inHeight,
 }
 
 
+/** Arguments of fxt1_encode_rows() */
+struct fxt1_encode_rows {
+   const GLubyte *source;
+   GLint srcRowStride;
+   GLubyte *dest;
+   GLint destRowStride;
+   GLuint width;
+   GLint comps;
+};
+
+static void
+fxt1_encode_rows (void *data, GLuint first, GLuint count)
+{
+   const struct fxt1_encode_rows *e = data;
+   GLuint x, y;
+
+   for (y = first; y < first + count; y++) {
+      const GLubyte *row = e->source + y * 4 * e->srcRowStride;
+      GLuint *encoded = (GLuint *) (e->dest + y * e->destRowStride);
+      for (x = 0; x < e->width; x += 8) {
+         const GLubyte *lines[4];
+         lines[0] = row + x * e->comps;
+         lines[1] = lines[0] + e->srcRowStride;
+         lines[2] = lines[1] + e->srcRowStride;
+         lines[3] = lines[2] + e->srcRowStride;
+         fxt1_quantize(encoded, lines, e->comps);
+         /* 128 bits per 8x4 block */
+         encoded += 4;
+      }
+   }
+}
+
+
 static void
 fxt1_encode (GLuint width, GLuint height, GLint comps,
              const void *source, GLint srcRowStride,
              void *dest, GLint destRowStride)
 {
-   GLuint x, y;
-   const GLubyte *data;
-   GLuint *encoded = (GLuint *)dest;
+   struct fxt1_encode_rows e;
    void *newSource = NULL;
 
    assert(comps == 3 || comps == 4);
@@ -1306,23 +1337,16 @@ fxt1_encode (GLuint width, GLuint height, GLint comps,
       srcRowStride = comps * newWidth;
    }
 
-   data = (const GLubyte *) source;
-   destRowStride = (destRowStride - width * 2) / 4;
-   for (y = 0; y < height; y += 4) {
-      GLuint offs = 0 + (y + 0) * srcRowStride;
-      for (x = 0; x < width; x += 8) {
-         const GLubyte *lines[4];
-         lines[0] = &data[offs];
-         lines[1] = lines[0] + srcRowStride;
-         lines[2] = lines[1] + srcRowStride;
-         lines[3] = lines[2] + srcRowStride;
-         offs += 8 * comps;
-         fxt1_quantize(encoded, lines, comps);
-         /* 128 bits per 8x4 block */
-         encoded += 4;
-      }
-      encoded += destRowStride;
-   }
+   /* Big images are encoded by several threads, a band of block rows
+    * each.
+    */
+   e.source = (const GLubyte *) source;
+   e.srcRowStride = srcRowStride;
+   e.dest = (GLubyte *) dest;
+   e.destRowStride = destRowStride;
+   e.width = width;
+   e.comps = comps;
+   _mesa_process_block_rows(width, height, 4, fxt1_encode_rows, &e);
 
  cleanUp:
    free(newSource);
@@ -50,6 +50,15 @@ static void unsigned_encode_rgtc_ubyte(GLubyte *blkaddr, GLubyte srccolors[4][4]
 					GLint numxpixels, GLint numypixels);
 static void signed_encode_rgtc_ubyte(GLbyte *blkaddr, GLbyte srccolors[4][4],
 			     GLint numxpixels, GLint numypixels);
+static void unsigned_encode_rgtc_ubyte_fast(GLubyte *blkaddr, GLubyte srccolors[4][4],
+					     GLint numxpixels, GLint numypixels);
+static void signed_encode_rgtc_ubyte_fast(GLbyte *blkaddr, GLbyte srccolors[4][4],
+					   GLint numxpixels, GLint numypixels);
+
+typedef void (*unsigned_encode_func)(GLubyte *blkaddr, GLubyte srccolors[4][4],
+				     GLint numxpixels, GLint numypixels);
+typedef void (*signed_encode_func)(GLbyte *blkaddr, GLbyte srccolors[4][4],
+				   GLint numxpixels, GLint numypixels);
 
 static void unsigned_fetch_texel_rgtc(unsigned srcRowStride, const GLubyte *pixdata,
 				      unsigned i, unsigned j, GLubyte *value, unsigned comps);
@@ -86,17 +95,100 @@ static void extractsrc_s( GLbyte srcpixels[4][4], const GLfloat *srcaddr,
 }
 
 
+/** Arguments of unsigned_encode_rows() and signed_encode_rows() */
+struct rgtc_encode_rows {
+   const void *src;             /**< GLubyte or GLfloat temp image */
+   void *dst;
+   GLint dstRowPitch;           /**< bytes from one row of blocks to the next */
+   GLint width, height;
+   GLint comps;                 /**< 1 for RGTC1, 2 for RGTC2 */
+   unsigned_encode_func uencode;
+   signed_encode_func sencode;
+};
+
+static void
+unsigned_encode_rows(void *data, GLuint first, GLuint count)
+{
+   const struct rgtc_encode_rows *e = data;
+   GLubyte srcpixels[4][4];
+   GLint i, j, c;
+
+   for (j = first * 4; j < (GLint) (first + count) * 4 && j < e->height; j += 4) {
+      const GLint numypixels = MIN2(e->height - j, 4);
+      const GLubyte *srcaddr = (const GLubyte *) e->src + j * e->width * e->comps;
+      GLubyte *blkaddr = (GLubyte *) e->dst + j / 4 * e->dstRowPitch;
+
+      for (i = 0; i < e->width; i += 4) {
+	 const GLint numxpixels = MIN2(e->width - i, 4);
+	 for (c = 0; c < e->comps; c++) {
+	    extractsrc_u(srcpixels, srcaddr + c, e->width, numxpixels, numypixels, e->comps);
+	    e->uencode(blkaddr, srcpixels, numxpixels, numypixels);
+	    blkaddr += 8;
+	 }
+	 srcaddr += numxpixels * e->comps;
+      }
+   }
+}
+
+static void
+signed_encode_rows(void *data, GLuint first, GLuint count)
+{
+   const struct rgtc_encode_rows *e = data;
+   GLbyte srcpixels[4][4];
+   GLint i, j, c;
+
+   for (j = first * 4; j < (GLint) (first + count) * 4 && j < e->height; j += 4) {
+      const GLint numypixels = MIN2(e->height - j, 4);
+      const GLfloat *srcaddr = (const GLfloat *) e->src + j * e->width * e->comps;
+      GLbyte *blkaddr = (GLbyte *) e->dst + j / 4 * e->dstRowPitch;
+
+      for (i = 0; i < e->width; i += 4) {
+	 const GLint numxpixels = MIN2(e->width - i, 4);
+	 for (c = 0; c < e->comps; c++) {
+	    extractsrc_s(srcpixels, srcaddr + c, e->width, numxpixels, numypixels, e->comps);
+	    e->sencode(blkaddr, srcpixels, numxpixels, numypixels);
+	    blkaddr += 8;
+	 }
+	 srcaddr += numxpixels * e->comps;
+      }
+   }
+}
+
+/**
+ * Encode a 1 or 2 component temp image, a band of block rows per
+ * thread for big images.
+ */
+static void
+encode_rgtc(struct gl_context *ctx, const void *src, GLboolean is_signed,
+            GLint comps, GLint srcWidth, GLint srcHeight,
+            GLubyte *dst, GLint dstRowStride)
+{
+   const GLint rowSize = ((srcWidth + 3) & ~3) * 2 * comps;
+   struct rgtc_encode_rows e;
+
+   e.src = src;
+   e.dst = dst;
+   e.dstRowPitch = rowSize +
+      (dstRowStride >= (srcWidth * 2 * comps) ? dstRowStride - rowSize : 0);
+   e.width = srcWidth;
+   e.height = srcHeight;
+   e.comps = comps;
+   e.uencode = ctx->FastTexCompress ?
+      unsigned_encode_rgtc_ubyte_fast : unsigned_encode_rgtc_ubyte;
+   e.sencode = ctx->FastTexCompress ?
+      signed_encode_rgtc_ubyte_fast : signed_encode_rgtc_ubyte;
+
+   _mesa_process_block_rows(srcWidth, srcHeight, 4,
+                            is_signed ? signed_encode_rows : unsigned_encode_rows,
+                            &e);
+}
+
+
 GLboolean
 _mesa_texstore_red_rgtc1(TEXSTORE_PARAMS)
 {
-   GLubyte *dst;
    const GLubyte *tempImage = NULL;
-   int i, j;
-   int numxpixels, numypixels;
-   const GLubyte *srcaddr;
-   GLubyte srcpixels[4][4];
-   GLubyte *blkaddr;
-   GLint dstRowDiff;
+
    ASSERT(dstFormat == MESA_FORMAT_R_RGTC1_UNORM ||
           dstFormat == MESA_FORMAT_L_LATC1_UNORM);
 
@@ -109,24 +201,8 @@ _mesa_texstore_red_rgtc1(TEXSTORE_PARAMS)
    if (!tempImage)
       return GL_FALSE; /* out of memory */
 
-   dst = dstSlices[0];
-
-   blkaddr = dst;
-   dstRowDiff = dstRowStride >= (srcWidth * 2) ? dstRowStride - (((srcWidth + 3) & ~3) * 2) : 0;
-   for (j = 0; j < srcHeight; j+=4) {
-      if (srcHeight > j + 3) numypixels = 4;
-      else numypixels = srcHeight - j;
-      srcaddr = tempImage + j * srcWidth;
-      for (i = 0; i < srcWidth; i += 4) {
-	 if (srcWidth > i + 3) numxpixels = 4;
-	 else numxpixels = srcWidth - i;
-	 extractsrc_u(srcpixels, srcaddr, srcWidth, numxpixels, numypixels, 1);
-	 unsigned_encode_rgtc_ubyte(blkaddr, srcpixels, numxpixels, numypixels);
-	 srcaddr += numxpixels;
-	 blkaddr += 8;
-      }
-      blkaddr += dstRowDiff;
-   }
+   encode_rgtc(ctx, tempImage, GL_FALSE, 1, srcWidth, srcHeight,
+               dstSlices[0], dstRowStride);
 
    free((void *) tempImage);
 
@@ -136,14 +212,8 @@ _mesa_texstore_red_rgtc1(TEXSTORE_PARAMS)
 GLboolean
 _mesa_texstore_signed_red_rgtc1(TEXSTORE_PARAMS)
 {
-   GLbyte *dst;
    const GLfloat *tempImage = NULL;
-   int i, j;
-   int numxpixels, numypixels;
-   const GLfloat *srcaddr;
-   GLbyte srcpixels[4][4];
-   GLbyte *blkaddr;
-   GLint dstRowDiff;
+
    ASSERT(dstFormat == MESA_FORMAT_R_RGTC1_SNORM ||
           dstFormat == MESA_FORMAT_L_LATC1_SNORM);
 
@@ -156,24 +226,8 @@ _mesa_texstore_signed_red_rgtc1(TEXSTORE_PARAMS)
    if (!tempImage)
       return GL_FALSE; /* out of memory */
 
-   dst = (GLbyte *) dstSlices[0];
-
-   blkaddr = dst;
-   dstRowDiff = dstRowStride >= (srcWidth * 2) ? dstRowStride - (((srcWidth + 3) & ~3) * 2) : 0;
-   for (j = 0; j < srcHeight; j+=4) {
-      if (srcHeight > j + 3) numypixels = 4;
-      else numypixels = srcHeight - j;
-      srcaddr = tempImage + j * srcWidth;
-      for (i = 0; i < srcWidth; i += 4) {
-	 if (srcWidth > i + 3) numxpixels = 4;
-	 else numxpixels = srcWidth - i;
-	 extractsrc_s(srcpixels, srcaddr, srcWidth, numxpixels, numypixels, 1);
-	 signed_encode_rgtc_ubyte(blkaddr, srcpixels, numxpixels, numypixels);
-	 srcaddr += numxpixels;
-	 blkaddr += 8;
-      }
-      blkaddr += dstRowDiff;
-   }
+   encode_rgtc(ctx, tempImage, GL_TRUE, 1, srcWidth, srcHeight,
+               dstSlices[0], dstRowStride);
 
    free((void *) tempImage);
 
@@ -183,14 +237,7 @@ _mesa_texstore_signed_red_rgtc1(TEXSTORE_PARAMS)
 GLboolean
 _mesa_texstore_rg_rgtc2(TEXSTORE_PARAMS)
 {
-   GLubyte *dst;
    const GLubyte *tempImage = NULL;
-   int i, j;
-   int numxpixels, numypixels;
-   const GLubyte *srcaddr;
-   GLubyte srcpixels[4][4];
-   GLubyte *blkaddr;
-   GLint dstRowDiff;
 
    ASSERT(dstFormat == MESA_FORMAT_RG_RGTC2_UNORM ||
           dstFormat == MESA_FORMAT_LA_LATC2_UNORM);
@@ -204,30 +251,8 @@ _mesa_texstore_rg_rgtc2(TEXSTORE_PARAMS)
    if (!tempImage)
       return GL_FALSE; /* out of memory */
 
-   dst = dstSlices[0];
-
-   blkaddr = dst;
-   dstRowDiff = dstRowStride >= (srcWidth * 4) ? dstRowStride - (((srcWidth + 3) & ~3) * 4) : 0;
-   for (j = 0; j < srcHeight; j+=4) {
-      if (srcHeight > j + 3) numypixels = 4;
-      else numypixels = srcHeight - j;
-      srcaddr = tempImage + j * srcWidth * 2;
-      for (i = 0; i < srcWidth; i += 4) {
-	 if (srcWidth > i + 3) numxpixels = 4;
-	 else numxpixels = srcWidth - i;
-	 extractsrc_u(srcpixels, srcaddr, srcWidth, numxpixels, numypixels, 2);
-	 unsigned_encode_rgtc_ubyte(blkaddr, srcpixels, numxpixels, numypixels);
-
-	 blkaddr += 8;
-	 extractsrc_u(srcpixels, (GLubyte *)srcaddr + 1, srcWidth, numxpixels, numypixels, 2);
-	 unsigned_encode_rgtc_ubyte(blkaddr, srcpixels, numxpixels, numypixels);
-
-	 blkaddr += 8;
-
-	 srcaddr += numxpixels * 2;
-      }
-      blkaddr += dstRowDiff;
-   }
+   encode_rgtc(ctx, tempImage, GL_FALSE, 2, srcWidth, srcHeight,
+               dstSlices[0], dstRowStride);
 
    free((void *) tempImage);
 
@@ -237,14 +262,7 @@ _mesa_texstore_rg_rgtc2(TEXSTORE_PARAMS)
 GLboolean
 _mesa_texstore_signed_rg_rgtc2(TEXSTORE_PARAMS)
 {
-   GLbyte *dst;
    const GLfloat *tempImage = NULL;
-   int i, j;
-   int numxpixels, numypixels;
-   const GLfloat *srcaddr;
-   GLbyte srcpixels[4][4];
-   GLbyte *blkaddr;
-   GLint dstRowDiff;
 
    ASSERT(dstFormat == MESA_FORMAT_RG_RGTC2_SNORM ||
           dstFormat == MESA_FORMAT_LA_LATC2_SNORM);
@@ -258,31 +276,8 @@ _mesa_texstore_signed_rg_rgtc2(TEXSTORE_PARAMS)
    if (!tempImage)
       return GL_FALSE; /* out of memory */
 
-   dst = (GLbyte *) dstSlices[0];
-
-   blkaddr = dst;
-   dstRowDiff = dstRowStride >= (srcWidth * 4) ? dstRowStride - (((srcWidth + 3) & ~3) * 4) : 0;
-   for (j = 0; j < srcHeight; j += 4) {
-      if (srcHeight > j + 3) numypixels = 4;
-      else numypixels = srcHeight - j;
-      srcaddr = tempImage + j * srcWidth * 2;
-      for (i = 0; i < srcWidth; i += 4) {
-	 if (srcWidth > i + 3) numxpixels = 4;
-	 else numxpixels = srcWidth - i;
-
-	 extractsrc_s(srcpixels, srcaddr, srcWidth, numxpixels, numypixels, 2);
-	 signed_encode_rgtc_ubyte(blkaddr, srcpixels, numxpixels, numypixels);
-	 blkaddr += 8;
-
-	 extractsrc_s(srcpixels, srcaddr + 1, srcWidth, numxpixels, numypixels, 2);
-	 signed_encode_rgtc_ubyte(blkaddr, srcpixels, numxpixels, numypixels);
-	 blkaddr += 8;
-
-	 srcaddr += numxpixels * 2;
-
-      }
-      blkaddr += dstRowDiff;
-   }
+   encode_rgtc(ctx, tempImage, GL_TRUE, 2, srcWidth, srcHeight,
+               dstSlices[0], dstRowStride);
 
    free((void *) tempImage);
 
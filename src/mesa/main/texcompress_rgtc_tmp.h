@@ -416,3 +416,43 @@ static void TAG(encode_rgtc_ubyte)(TYPE *blkaddr, TYPE srccolors[4][4],
       TAG(write_rgtc_encoded_channel)( blkaddr, (TYPE)alphatest[0], (TYPE)alphatest[1], alphaenc3 );
    }
 }
+
+/*
+ * Real-time variant of the above: always use the eight value encoding
+ * between the block's extremes and pick the indices arithmetically
+ * rather than trying the three encodings.
+ */
+static void TAG(encode_rgtc_ubyte_fast)(TYPE *blkaddr, TYPE srccolors[4][4],
+				  int numxpixels, int numypixels)
+{
+   TYPE alphaenc[16] = { 0 };
+   int i, j, amin = T_MAX, amax = T_MIN, range;
+
+   for (j = 0; j < numypixels; j++) {
+      for (i = 0; i < numxpixels; i++) {
+         if (srccolors[j][i] < amin)
+            amin = srccolors[j][i];
+         if (srccolors[j][i] > amax)
+            amax = srccolors[j][i];
+      }
+   }
+
+   range = amax - amin;
+   if (range > 0) {
+      for (j = 0; j < numypixels; j++) {
+         for (i = 0; i < numxpixels; i++) {
+            /* position between min (0) and max (7), rounded */
+            const int pos = ((srccolors[j][i] - amin) * 14 + range) / (2 * range);
+
+            if (pos == 7)
+               alphaenc[4*j + i] = 0;
+            else if (pos == 0)
+               alphaenc[4*j + i] = 1;
+            else
+               alphaenc[4*j + i] = 8 - pos;
+         }
+      }
+   }
+
+   TAG(write_rgtc_encoded_channel)(blkaddr, (TYPE)amax, (TYPE)amin, alphaenc);
+}
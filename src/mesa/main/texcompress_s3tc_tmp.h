@@ -0,0 +1,775 @@
+/*
+ * Mesa 3-D graphics library
+ *
+ * Copyright (c) 2014 The Mesa Authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * Included by texcompress_s3tc and gallium to define the DXT1/DXT3/DXT5
+ * decoders and encoders.  The entry points have the same signatures as
+ * the ones libtxc_dxtn used to provide.
+ *
+ * Two encoders are provided.  The fast one picks the endpoints from the
+ * (inset) bounding box of the block and the indices by projecting onto
+ * the endpoint axis; the high quality one uses the principal axis of the
+ * block and refines the endpoints with a least squares fit.  DXT5 alpha
+ * blocks are RGTC1 blocks and are handled by the RGTC channel coder.
+ */
+
+#include <math.h>
+#include <string.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#define TAG(x) s3tc_##x
+#define TYPE uint8_t
+#define T_MIN 0
+#define T_MAX 0xff
+#ifndef RGTC_DEBUG
+#define RGTC_DEBUG 0
+#endif
+
+#include "texcompress_rgtc_tmp.h"
+
+#undef TAG
+#undef TYPE
+#undef T_MIN
+#undef T_MAX
+
+#define DXTN_RGB_DXT1  0x83F0
+#define DXTN_RGBA_DXT1 0x83F1
+#define DXTN_RGBA_DXT3 0x83F2
+#define DXTN_RGBA_DXT5 0x83F3
+
+
+static inline unsigned
+s3tc_pack_565(int r, int g, int b)
+{
+   return (((r * 31 + 127) / 255) << 11) |
+          (((g * 63 + 127) / 255) << 5) |
+          ((b * 31 + 127) / 255);
+}
+
+static inline void
+s3tc_unpack_565(unsigned c, int rgb[3])
+{
+   rgb[0] = ((c >> 8) & 0xf8) | (c >> 13);
+   rgb[1] = ((c >> 3) & 0xfc) | ((c >> 9) & 0x3);
+   rgb[2] = ((c << 3) & 0xf8) | ((c >> 2) & 0x7);
+}
+
+/**
+ * Expand the two endpoints of a color block to its palette.  In three
+ * color mode, entry 3 is black (and transparent for RGBA DXT1).
+ */
+static void
+s3tc_palette(unsigned c0, unsigned c1, int four_color, int pal[4][3])
+{
+   int k;
+
+   s3tc_unpack_565(c0, pal[0]);
+   s3tc_unpack_565(c1, pal[1]);
+   for (k = 0; k < 3; k++) {
+      if (four_color) {
+         pal[2][k] = (2 * pal[0][k] + pal[1][k]) / 3;
+         pal[3][k] = (pal[0][k] + 2 * pal[1][k]) / 3;
+      }
+      else {
+         pal[2][k] = (pal[0][k] + pal[1][k]) / 2;
+         pal[3][k] = 0;
+      }
+   }
+}
+
+
+/*
+ * Decoding.
+ */
+
+static void
+s3tc_decode_color(const uint8_t *blk, int i, int j, int dxt1, int dxt1_alpha,
+                  uint8_t *rgba)
+{
+   const unsigned c0 = blk[0] | (blk[1] << 8);
+   const unsigned c1 = blk[2] | (blk[3] << 8);
+   const uint32_t bits = blk[4] | (blk[5] << 8) | (blk[6] << 16) |
+                         ((uint32_t) blk[7] << 24);
+   const unsigned code = (bits >> (2 * (4 * (j & 3) + (i & 3)))) & 3;
+   const int four_color = !dxt1 || c0 > c1;
+   int pal[4][3];
+
+   s3tc_palette(c0, c1, four_color, pal);
+   rgba[0] = pal[code][0];
+   rgba[1] = pal[code][1];
+   rgba[2] = pal[code][2];
+   rgba[3] = (!four_color && code == 3 && dxt1_alpha) ? 0 : 255;
+}
+
+static inline const uint8_t *
+s3tc_block_address(int srcRowStride, const uint8_t *pixdata, int i, int j,
+                   int blocksize)
+{
+   return pixdata + ((srcRowStride + 3) / 4 * (j / 4) + (i / 4)) * blocksize;
+}
+
+static void
+fetch_2d_texel_rgb_dxt1(int srcRowStride, const uint8_t *pixdata,
+                        int i, int j, uint8_t *texel)
+{
+   const uint8_t *blk = s3tc_block_address(srcRowStride, pixdata, i, j, 8);
+   s3tc_decode_color(blk, i, j, 1, 0, texel);
+}
+
+static void
+fetch_2d_texel_rgba_dxt1(int srcRowStride, const uint8_t *pixdata,
+                         int i, int j, uint8_t *texel)
+{
+   const uint8_t *blk = s3tc_block_address(srcRowStride, pixdata, i, j, 8);
+   s3tc_decode_color(blk, i, j, 1, 1, texel);
+}
+
+static void
+fetch_2d_texel_rgba_dxt3(int srcRowStride, const uint8_t *pixdata,
+                         int i, int j, uint8_t *texel)
+{
+   const uint8_t *blk = s3tc_block_address(srcRowStride, pixdata, i, j, 16);
+   const unsigned bit_pos = 4 * (4 * (j & 3) + (i & 3));
+   const unsigned a = (blk[bit_pos / 8] >> (bit_pos & 7)) & 0xf;
+
+   s3tc_decode_color(blk + 8, i, j, 0, 0, texel);
+   texel[3] = a | (a << 4);
+}
+
+static void
+fetch_2d_texel_rgba_dxt5(int srcRowStride, const uint8_t *pixdata,
+                         int i, int j, uint8_t *texel)
+{
+   const uint8_t *blk = s3tc_block_address(srcRowStride, pixdata, i, j, 16);
+
+   s3tc_decode_color(blk + 8, i, j, 0, 0, texel);
+   /* The alpha half is an RGTC1 block, two "components" of 8 bytes each
+    * give the same block stride.
+    */
+   s3tc_fetch_texel_rgtc(srcRowStride, pixdata, i, j, &texel[3], 2);
+}
+
+
+/*
+ * Encoding.
+ */
+
+static inline uint32_t
+s3tc_spread_bits(uint32_t x)
+{
+   x = (x | (x << 8)) & 0x00ff00ff;
+   x = (x | (x << 4)) & 0x0f0f0f0f;
+   x = (x | (x << 2)) & 0x33333333;
+   x = (x | (x << 1)) & 0x55555555;
+   return x;
+}
+
+/**
+ * Per channel minimum and maximum of n pixels.
+ */
+static void
+s3tc_bounding_box(uint8_t px[16][4], int n, int mn[3], int mx[3])
+{
+   int i, k;
+
+#if defined(__SSE2__)
+   if (n == 16) {
+      const __m128i p0 = _mm_loadu_si128((const __m128i *) px[0]);
+      const __m128i p1 = _mm_loadu_si128((const __m128i *) px[4]);
+      const __m128i p2 = _mm_loadu_si128((const __m128i *) px[8]);
+      const __m128i p3 = _mm_loadu_si128((const __m128i *) px[12]);
+      __m128i vmn = _mm_min_epu8(_mm_min_epu8(p0, p1), _mm_min_epu8(p2, p3));
+      __m128i vmx = _mm_max_epu8(_mm_max_epu8(p0, p1), _mm_max_epu8(p2, p3));
+      uint32_t lo, hi;
+
+      vmn = _mm_min_epu8(vmn, _mm_shuffle_epi32(vmn, _MM_SHUFFLE(1, 0, 3, 2)));
+      vmn = _mm_min_epu8(vmn, _mm_shuffle_epi32(vmn, _MM_SHUFFLE(2, 3, 0, 1)));
+      vmx = _mm_max_epu8(vmx, _mm_shuffle_epi32(vmx, _MM_SHUFFLE(1, 0, 3, 2)));
+      vmx = _mm_max_epu8(vmx, _mm_shuffle_epi32(vmx, _MM_SHUFFLE(2, 3, 0, 1)));
+      lo = _mm_cvtsi128_si32(vmn);
+      hi = _mm_cvtsi128_si32(vmx);
+      for (k = 0; k < 3; k++) {
+         mn[k] = (lo >> (8 * k)) & 0xff;
+         mx[k] = (hi >> (8 * k)) & 0xff;
+      }
+      return;
+   }
+#endif
+
+   for (k = 0; k < 3; k++) {
+      mn[k] = 255;
+      mx[k] = 0;
+   }
+   for (i = 0; i < n; i++) {
+      for (k = 0; k < 3; k++) {
+         if (px[i][k] < mn[k])
+            mn[k] = px[i][k];
+         if (px[i][k] > mx[k])
+            mx[k] = px[i][k];
+      }
+   }
+}
+
+/**
+ * Indices of the 16 pixels in a four color block, found by projecting the
+ * pixels onto the endpoint axis.  Since the palette entries are ordered
+ * along the axis this is the nearest entry, up to the rounding of the
+ * interpolated entries.
+ */
+static uint32_t
+s3tc_match_colors_axis(uint8_t px[16][4], int pal[4][3])
+{
+   const int dr = pal[0][0] - pal[1][0];
+   const int dg = pal[0][1] - pal[1][1];
+   const int db = pal[0][2] - pal[1][2];
+   int stops[4], c0_point, half_point, c3_point;
+   uint32_t bits0 = 0, bits1 = 0;
+   int i;
+
+   for (i = 0; i < 4; i++)
+      stops[i] = pal[i][0] * dr + pal[i][1] * dg + pal[i][2] * db;
+
+   /* stops[1] <= stops[3] <= stops[2] <= stops[0] */
+   c0_point = (stops[1] + stops[3]) >> 1;
+   half_point = (stops[3] + stops[2]) >> 1;
+   c3_point = (stops[2] + stops[0]) >> 1;
+
+#if defined(__SSE2__)
+   {
+      const __m128i dir = _mm_setr_epi16(dr, dg, db, 0, dr, dg, db, 0);
+      const __m128i vc0 = _mm_set1_epi32(c0_point);
+      const __m128i vhalf = _mm_set1_epi32(half_point);
+      const __m128i vc3 = _mm_set1_epi32(c3_point);
+      const __m128i zero = _mm_setzero_si128();
+      __m128i lt_half[4], lt_mix[4];
+
+      for (i = 0; i < 4; i++) {
+         const __m128i p = _mm_loadu_si128((const __m128i *) px[4 * i]);
+         const __m128i mlo = _mm_madd_epi16(_mm_unpacklo_epi8(p, zero), dir);
+         const __m128i mhi = _mm_madd_epi16(_mm_unpackhi_epi8(p, zero), dir);
+         const __m128i t0 = _mm_shuffle_epi32(mlo, _MM_SHUFFLE(3, 1, 2, 0));
+         const __m128i t1 = _mm_shuffle_epi32(mhi, _MM_SHUFFLE(3, 1, 2, 0));
+         const __m128i dots = _mm_add_epi32(_mm_unpacklo_epi64(t0, t1),
+                                            _mm_unpackhi_epi64(t0, t1));
+
+         /* index bit 0 is set below the half point, bit 1 between the
+          * c0 and c3 points.
+          */
+         lt_half[i] = _mm_cmplt_epi32(dots, vhalf);
+         lt_mix[i] = _mm_xor_si128(_mm_cmplt_epi32(dots, vc3),
+                                   _mm_cmplt_epi32(dots, vc0));
+      }
+
+      bits0 = _mm_movemask_epi8(
+         _mm_packs_epi16(_mm_packs_epi32(lt_half[0], lt_half[1]),
+                         _mm_packs_epi32(lt_half[2], lt_half[3])));
+      bits1 = _mm_movemask_epi8(
+         _mm_packs_epi16(_mm_packs_epi32(lt_mix[0], lt_mix[1]),
+                         _mm_packs_epi32(lt_mix[2], lt_mix[3])));
+   }
+#else
+   for (i = 0; i < 16; i++) {
+      const int dot = px[i][0] * dr + px[i][1] * dg + px[i][2] * db;
+
+      if (dot < half_point) {
+         bits0 |= 1 << i;
+         if (dot >= c0_point)
+            bits1 |= 1 << i;
+      }
+      else if (dot < c3_point) {
+         bits1 |= 1 << i;
+      }
+   }
+#endif
+
+   return s3tc_spread_bits(bits0) | (s3tc_spread_bits(bits1) << 1);
+}
+
+/**
+ * Indices of the 16 pixels by exhaustive search of the first \p ncolors
+ * palette entries.  Pixels with alpha < 128 get index 3 if \p transparent
+ * is set.  Returns the squared error in \p error.
+ */
+static uint32_t
+s3tc_match_colors_exact(uint8_t px[16][4], int pal[4][3], int ncolors,
+                        int transparent, unsigned *error)
+{
+   uint32_t bits = 0;
+   unsigned err = 0;
+   int i, k;
+
+   for (i = 0; i < 16; i++) {
+      unsigned best = ~0u, idx = 0;
+
+      if (transparent && px[i][3] < 128) {
+         bits |= 3u << (2 * i);
+         continue;
+      }
+
+      for (k = 0; k < ncolors; k++) {
+         const int dr = px[i][0] - pal[k][0];
+         const int dg = px[i][1] - pal[k][1];
+         const int db = px[i][2] - pal[k][2];
+         const unsigned d = dr * dr + dg * dg + db * db;
+
+         if (d < best) {
+            best = d;
+            idx = k;
+         }
+      }
+      bits |= idx << (2 * i);
+      err += best;
+   }
+
+   *error = err;
+   return bits;
+}
+
+/**
+ * Endpoints along the principal axis of n pixels: the pixels with the
+ * smallest and largest projection.
+ */
+static void
+s3tc_principal_endpoints(uint8_t px[16][4], int n, int lo[3], int hi[3])
+{
+   float mean[3] = { 0.0f, 0.0f, 0.0f }, cov[6] = { 0.0f };
+   float axis[3];
+   float pmin = 1e30f, pmax = -1e30f;
+   int mn[3], mx[3];
+   int i, k, imin = 0, imax = 0;
+
+   for (i = 0; i < n; i++)
+      for (k = 0; k < 3; k++)
+         mean[k] += px[i][k];
+   for (k = 0; k < 3; k++)
+      mean[k] /= n;
+
+   for (i = 0; i < n; i++) {
+      const float r = px[i][0] - mean[0];
+      const float g = px[i][1] - mean[1];
+      const float b = px[i][2] - mean[2];
+
+      cov[0] += r * r;
+      cov[1] += r * g;
+      cov[2] += r * b;
+      cov[3] += g * g;
+      cov[4] += g * b;
+      cov[5] += b * b;
+   }
+
+   /* Power iteration, starting from the bounding box diagonal. */
+   s3tc_bounding_box(px, n, mn, mx);
+   for (k = 0; k < 3; k++)
+      axis[k] = (float) (mx[k] - mn[k]);
+
+   for (i = 0; i < 4; i++) {
+      const float r = axis[0] * cov[0] + axis[1] * cov[1] + axis[2] * cov[2];
+      const float g = axis[0] * cov[1] + axis[1] * cov[3] + axis[2] * cov[4];
+      const float b = axis[0] * cov[2] + axis[1] * cov[4] + axis[2] * cov[5];
+      const float m = fabsf(r) > fabsf(g) ?
+         (fabsf(r) > fabsf(b) ? fabsf(r) : fabsf(b)) :
+         (fabsf(g) > fabsf(b) ? fabsf(g) : fabsf(b));
+
+      if (m < 1e-6f)
+         break;
+      axis[0] = r / m;
+      axis[1] = g / m;
+      axis[2] = b / m;
+   }
+
+   if (fabsf(axis[0]) + fabsf(axis[1]) + fabsf(axis[2]) < 1e-6f) {
+      /* flat block, any axis will do */
+      axis[0] = 0.299f;
+      axis[1] = 0.587f;
+      axis[2] = 0.114f;
+   }
+
+   for (i = 0; i < n; i++) {
+      const float p = px[i][0] * axis[0] + px[i][1] * axis[1] +
+                      px[i][2] * axis[2];
+
+      if (p < pmin) {
+         pmin = p;
+         imin = i;
+      }
+      if (p > pmax) {
+         pmax = p;
+         imax = i;
+      }
+   }
+
+   for (k = 0; k < 3; k++) {
+      lo[k] = px[imin][k];
+      hi[k] = px[imax][k];
+   }
+}
+
+/**
+ * Least squares fit of the endpoints of a four color block to its pixels,
+ * given the indices.  Returns 0 if the system is singular.
+ */
+static int
+s3tc_refine_endpoints(uint8_t px[16][4], uint32_t bits,
+                      unsigned *c0, unsigned *c1)
+{
+   static const int w0_table[4] = { 3, 0, 2, 1 };
+   int aa = 0, bb = 0, ab = 0;
+   int at[3] = { 0, 0, 0 }, bt[3] = { 0, 0, 0 };
+   int e0[3], e1[3];
+   float det;
+   int i, k;
+
+   for (i = 0; i < 16; i++) {
+      const int w0 = w0_table[(bits >> (2 * i)) & 3];
+      const int w1 = 3 - w0;
+
+      aa += w0 * w0;
+      bb += w1 * w1;
+      ab += w0 * w1;
+      for (k = 0; k < 3; k++) {
+         at[k] += w0 * px[i][k];
+         bt[k] += w1 * px[i][k];
+      }
+   }
+
+   det = (float) aa * bb - (float) ab * ab;
+   if (det == 0.0f)
+      return 0;
+
+   for (k = 0; k < 3; k++) {
+      const float f0 = 3.0f * ((float) at[k] * bb - (float) bt[k] * ab) / det;
+      const float f1 = 3.0f * ((float) bt[k] * aa - (float) at[k] * ab) / det;
+
+      e0[k] = f0 < 0.0f ? 0 : f0 > 255.0f ? 255 : (int) (f0 + 0.5f);
+      e1[k] = f1 < 0.0f ? 0 : f1 > 255.0f ? 255 : (int) (f1 + 0.5f);
+   }
+
+   *c0 = s3tc_pack_565(e0[0], e0[1], e0[2]);
+   *c1 = s3tc_pack_565(e1[0], e1[1], e1[2]);
+   return 1;
+}
+
+static void
+s3tc_write_color_block(uint8_t *blk, unsigned c0, unsigned c1, uint32_t bits)
+{
+   blk[0] = c0 & 0xff;
+   blk[1] = c0 >> 8;
+   blk[2] = c1 & 0xff;
+   blk[3] = c1 >> 8;
+   blk[4] = bits & 0xff;
+   blk[5] = (bits >> 8) & 0xff;
+   blk[6] = (bits >> 16) & 0xff;
+   blk[7] = bits >> 24;
+}
+
+/**
+ * Endpoints from the bounding box of n pixels.  The box diagonal is
+ * flipped in red and blue when those correlate negatively with green.
+ */
+static void
+s3tc_box_endpoints(uint8_t px[16][4], int n, int lo[3], int hi[3])
+{
+   int center[3];
+   int cov_rg = 0, cov_bg = 0;
+   int i, k;
+
+   s3tc_bounding_box(px, n, lo, hi);
+
+   for (k = 0; k < 3; k++)
+      center[k] = (lo[k] + hi[k] + 1) >> 1;
+   for (i = 0; i < n; i++) {
+      const int g = px[i][1] - center[1];
+
+      cov_rg += (px[i][0] - center[0]) * g;
+      cov_bg += (px[i][2] - center[2]) * g;
+   }
+   if (cov_rg < 0) {
+      const int t = lo[0];
+      lo[0] = hi[0];
+      hi[0] = t;
+   }
+   if (cov_bg < 0) {
+      const int t = lo[2];
+      lo[2] = hi[2];
+      hi[2] = t;
+   }
+}
+
+/**
+ * Four color block, bounding box endpoints inset by 1/16 of the box
+ * extent to account for the interpolated entries.
+ */
+static void
+s3tc_encode_color_fast(uint8_t *blk, uint8_t px[16][4])
+{
+   int mn[3], mx[3];
+   unsigned c0, c1;
+   uint32_t bits = 0;
+   int pal[4][3];
+   int k;
+
+   s3tc_box_endpoints(px, 16, mn, mx);
+
+   for (k = 0; k < 3; k++) {
+      const int inset = (mx[k] - mn[k]) / 16;
+
+      mx[k] -= inset;
+      mn[k] += inset;
+   }
+
+   c0 = s3tc_pack_565(mx[0], mx[1], mx[2]);
+   c1 = s3tc_pack_565(mn[0], mn[1], mn[2]);
+   if (c0 < c1) {
+      const unsigned t = c0;
+      c0 = c1;
+      c1 = t;
+   }
+
+   if (c0 != c1) {
+      s3tc_palette(c0, c1, 1, pal);
+      bits = s3tc_match_colors_axis(px, pal);
+   }
+
+   s3tc_write_color_block(blk, c0, c1, bits);
+}
+
+/**
+ * Four color block, principal axis endpoints refined by least squares.
+ */
+static void
+s3tc_encode_color_quality(uint8_t *blk, uint8_t px[16][4])
+{
+   int lo[3], hi[3];
+   unsigned c0, c1, err = 0;
+   uint32_t bits = 0;
+   int pal[4][3];
+   int iter;
+
+   s3tc_principal_endpoints(px, 16, lo, hi);
+   c0 = s3tc_pack_565(hi[0], hi[1], hi[2]);
+   c1 = s3tc_pack_565(lo[0], lo[1], lo[2]);
+   if (c0 < c1) {
+      const unsigned t = c0;
+      c0 = c1;
+      c1 = t;
+   }
+
+   if (c0 == c1) {
+      s3tc_write_color_block(blk, c0, c1, 0);
+      return;
+   }
+
+   s3tc_palette(c0, c1, 1, pal);
+   bits = s3tc_match_colors_exact(px, pal, 4, 0, &err);
+
+   for (iter = 0; iter < 2 && err > 0; iter++) {
+      unsigned n0, n1, nerr;
+      uint32_t nbits;
+
+      if (!s3tc_refine_endpoints(px, bits, &n0, &n1))
+         break;
+      if (n0 < n1) {
+         const unsigned t = n0;
+         n0 = n1;
+         n1 = t;
+      }
+      if (n0 == n1 || (n0 == c0 && n1 == c1))
+         break;
+
+      s3tc_palette(n0, n1, 1, pal);
+      nbits = s3tc_match_colors_exact(px, pal, 4, 0, &nerr);
+      if (nerr >= err)
+         break;
+
+      c0 = n0;
+      c1 = n1;
+      bits = nbits;
+      err = nerr;
+   }
+
+   s3tc_write_color_block(blk, c0, c1, bits);
+}
+
+/**
+ * RGBA DXT1 block with transparent pixels: three color mode, endpoints
+ * from the opaque pixels only.
+ */
+static void
+s3tc_encode_color_dxt1a(uint8_t *blk, uint8_t px[16][4], int fast)
+{
+   uint8_t opaque[16][4];
+   int lo[3], hi[3];
+   unsigned c0, c1, err;
+   uint32_t bits;
+   int pal[4][3];
+   int i, n = 0;
+
+   for (i = 0; i < 16; i++) {
+      if (px[i][3] >= 128) {
+         memcpy(opaque[n], px[i], 4);
+         n++;
+      }
+   }
+
+   if (n == 0) {
+      s3tc_write_color_block(blk, 0, 0, 0xffffffff);
+      return;
+   }
+
+   if (fast)
+      s3tc_box_endpoints(opaque, n, lo, hi);
+   else
+      s3tc_principal_endpoints(opaque, n, lo, hi);
+
+   c0 = s3tc_pack_565(lo[0], lo[1], lo[2]);
+   c1 = s3tc_pack_565(hi[0], hi[1], hi[2]);
+   if (c0 > c1) {
+      const unsigned t = c0;
+      c0 = c1;
+      c1 = t;
+   }
+
+   s3tc_palette(c0, c1, 0, pal);
+   bits = s3tc_match_colors_exact(px, pal, 3, 1, &err);
+   s3tc_write_color_block(blk, c0, c1, bits);
+}
+
+static void
+s3tc_encode_alpha_dxt3(uint8_t *blk, uint8_t px[16][4])
+{
+   int i;
+
+   for (i = 0; i < 8; i++) {
+      const unsigned a0 = (px[2 * i][3] * 15 + 127) / 255;
+      const unsigned a1 = (px[2 * i + 1][3] * 15 + 127) / 255;
+
+      blk[i] = a0 | (a1 << 4);
+   }
+}
+
+static void
+s3tc_encode_alpha_dxt5(uint8_t *blk, uint8_t px[16][4], int fast)
+{
+   uint8_t alpha[4][4];
+   int i;
+
+   for (i = 0; i < 16; i++)
+      alpha[i / 4][i % 4] = px[i][3];
+
+   if (fast)
+      s3tc_encode_rgtc_ubyte_fast(blk, alpha, 4, 4);
+   else
+      s3tc_encode_rgtc_ubyte(blk, alpha, 4, 4);
+}
+
+/**
+ * Gather a 4x4 block of a srccomps x width x height image, replicating
+ * the last row and column for partial blocks.
+ */
+static void
+s3tc_extract_block(uint8_t px[16][4], const uint8_t *src, int srccomps,
+                   int width, int height, int x, int y)
+{
+   int i, j;
+
+   for (j = 0; j < 4; j++) {
+      const int sy = y + j < height ? y + j : height - 1;
+      const uint8_t *row = src + sy * width * srccomps;
+
+      for (i = 0; i < 4; i++) {
+         const int sx = x + i < width ? x + i : width - 1;
+         const uint8_t *s = row + sx * srccomps;
+
+         px[4 * j + i][0] = s[0];
+         px[4 * j + i][1] = s[1];
+         px[4 * j + i][2] = s[2];
+         px[4 * j + i][3] = srccomps == 4 ? s[3] : 0xff;
+      }
+   }
+}
+
+/**
+ * Compress a srccomps (3 or 4) x width x height ubyte image.  \p fast
+ * selects the bounding box encoder over the principal axis one.
+ */
+static void
+s3tc_compress_dxtn(int srccomps, int width, int height,
+                   const uint8_t *srcPixData, unsigned destformat,
+                   uint8_t *dest, int dstRowStride, int fast)
+{
+   const int blocksize = (destformat == DXTN_RGB_DXT1 ||
+                          destformat == DXTN_RGBA_DXT1) ? 8 : 16;
+   const int rowsize = (width + 3) / 4 * blocksize;
+   const int dstRowDiff = dstRowStride >= rowsize ? dstRowStride - rowsize : 0;
+   uint8_t px[16][4];
+   uint8_t *blkaddr = dest;
+   int i, j, k;
+
+   for (j = 0; j < height; j += 4) {
+      for (i = 0; i < width; i += 4) {
+         s3tc_extract_block(px, srcPixData, srccomps, width, height, i, j);
+
+         switch (destformat) {
+         case DXTN_RGBA_DXT1:
+            for (k = 0; k < 16; k++) {
+               if (px[k][3] < 128)
+                  break;
+            }
+            if (k < 16) {
+               s3tc_encode_color_dxt1a(blkaddr, px, fast);
+               break;
+            }
+            /* fallthrough */
+         case DXTN_RGB_DXT1:
+            if (fast)
+               s3tc_encode_color_fast(blkaddr, px);
+            else
+               s3tc_encode_color_quality(blkaddr, px);
+            break;
+         case DXTN_RGBA_DXT3:
+            s3tc_encode_alpha_dxt3(blkaddr, px);
+            if (fast)
+               s3tc_encode_color_fast(blkaddr + 8, px);
+            else
+               s3tc_encode_color_quality(blkaddr + 8, px);
+            break;
+         case DXTN_RGBA_DXT5:
+            s3tc_encode_alpha_dxt5(blkaddr, px, fast);
+            if (fast)
+               s3tc_encode_color_fast(blkaddr + 8, px);
+            else
+               s3tc_encode_color_quality(blkaddr + 8, px);
+            break;
+         default:
+            return;
+         }
+
+         blkaddr += blocksize;
+      }
+      blkaddr += dstRowDiff;
+   }
+}
@@ -44,6 +44,10 @@
 #include "texgetimage.h"
 #include "teximage.h"
 
+#ifdef __SSE4_1__
+#include "streaming-load-memcpy.h"
+#endif
+
 
 
 /**
@@ -512,6 +516,61 @@ get_tex_rgba_uncompressed(struct gl_context *ctx, GLuint dimensions,
 }
 
 
+/**
+ * Try to get an uncompressed color texture image by packing the texture
+ * rows directly into the user's format/type (e.g. swizzling BGRA to RGBA).
+ * \return GL_TRUE if done, GL_FALSE otherwise
+ */
+static GLboolean
+get_tex_rgba_direct(struct gl_context *ctx, GLuint dimensions,
+                    GLenum format, GLenum type, GLvoid *pixels,
+                    struct gl_texture_image *texImage)
+{
+   const GLuint width = texImage->Width;
+   GLuint height = texImage->Height;
+   GLuint depth = texImage->Depth;
+   mesa_pack_row_func packRow;
+   GLuint img, row;
+
+   packRow = _mesa_get_pack_row_func(texImage->TexFormat,
+                                     texImage->_BaseFormat,
+                                     format, type, ctx->Pack.SwapBytes);
+   if (!packRow)
+      return GL_FALSE;
+
+   if (texImage->TexObject->Target == GL_TEXTURE_1D_ARRAY) {
+      depth = height;
+      height = 1;
+   }
+
+   for (img = 0; img < depth; img++) {
+      GLubyte *srcMap;
+      GLint rowstride;
+
+      /* map src texture buffer */
+      ctx->Driver.MapTextureImage(ctx, texImage, img,
+                                  0, 0, width, height, GL_MAP_READ_BIT,
+                                  &srcMap, &rowstride);
+      if (!srcMap) {
+         _mesa_error(ctx, GL_OUT_OF_MEMORY, "glGetTexImage");
+         break;
+      }
+
+      for (row = 0; row < height; row++) {
+         GLubyte *dest = _mesa_image_address(dimensions, &ctx->Pack, pixels,
+                                             width, height, format, type,
+                                             img, row, 0);
+         packRow(width, srcMap + row * rowstride, dest);
+      }
+
+      /* Unmap the src texture buffer */
+      ctx->Driver.UnmapTextureImage(ctx, texImage, img);
+   }
+
+   return GL_TRUE;
+}
+
+
 /**
  * glGetTexImage for color formats (RGBA, RGB, alpha, LA, etc).
  * Compressed textures are handled here as well.
@@ -542,13 +601,29 @@ get_tex_rgba(struct gl_context *ctx, GLuint dimensions,
       get_tex_rgba_compressed(ctx, dimensions, format, type,
                               pixels, texImage, transferOps);
    }
-   else {
+   else if (transferOps ||
+            !get_tex_rgba_direct(ctx, dimensions, format, type,
+                                 pixels, texImage)) {
       get_tex_rgba_uncompressed(ctx, dimensions, format, type,
                                 pixels, texImage, transferOps);
    }
 }
 
 
+/**
+ * memcpy() from a texture mapping, which may well be uncached.
+ */
+static inline void
+copy_from_map(void *dst, void *src, size_t len)
+{
+#ifdef __SSE4_1__
+   _mesa_streaming_load_memcpy(dst, src, len);
+#else
+   memcpy(dst, src, len);
+#endif
+}
+
+
 /**
  * Try to do glGetTexImage() with simple memcpy().
  * \return GL_TRUE if done, GL_FALSE otherwise
@@ -595,12 +670,12 @@ get_tex_memcpy(struct gl_context *ctx, GLenum format, GLenum type,
 
       if (src) {
          if (bytesPerRow == dstRowStride && bytesPerRow == srcRowStride) {
-            memcpy(dst, src, bytesPerRow * texImage->Height);
+            copy_from_map(dst, src, bytesPerRow * texImage->Height);
          }
          else {
             GLuint row;
             for (row = 0; row < texImage->Height; row++) {
-               memcpy(dst, src, bytesPerRow);
+               copy_from_map(dst, src, bytesPerRow);
                dst += dstRowStride;
                src += srcRowStride;
             }
@@ -3932,6 +3932,305 @@ _mesa_texstore_memcpy(TEXSTORE_PARAMS)
 }
 
 
+/**
+ * \name Direct conversion paths
+ *
+ * Conversions for some common pairs of user format/type and texture format
+ * which are done one row at a time, straight from the user's image into the
+ * texture, instead of going through a temporary float or ubyte image.  They
+ * produce the same texels as the general paths.
+ */
+/*@{*/
+
+/**
+ * Convert \p n elements of a row.  What an element is depends on the
+ * conversion (see direct_conversion::ElementsPerTexel).
+ */
+typedef void (*ConvertRowFunc)(const GLubyte *src, GLubyte *dst, GLuint n);
+
+
+static void
+swap_rb_8888_row(const GLubyte *src, GLubyte *dst, GLuint n)
+{
+   _mesa_swizzle_rgba8_row(src, dst, n, GL_TRUE, GL_FALSE);
+}
+
+static void
+swap_rb_8888_opaque_row(const GLubyte *src, GLubyte *dst, GLuint n)
+{
+   _mesa_swizzle_rgba8_row(src, dst, n, GL_TRUE, GL_TRUE);
+}
+
+static void
+copy_8888_opaque_row(const GLubyte *src, GLubyte *dst, GLuint n)
+{
+   _mesa_swizzle_rgba8_row(src, dst, n, GL_FALSE, GL_TRUE);
+}
+
+
+/** Expand 8-bit RGB to RGBX, or BGR to BGRX */
+static void
+rgb888_to_rgbx8888_row(const GLubyte *src, GLubyte *dst, GLuint n)
+{
+   GLuint *d = (GLuint *) dst;
+   GLuint i;
+
+   for (i = 0; i < n; i++) {
+      const GLubyte *s = src + i * 3;
+      d[i] = PACK_COLOR_8888(0xff, s[2], s[1], s[0]);
+   }
+}
+
+/** Expand 8-bit RGB to BGRX, or BGR to RGBX */
+static void
+rgb888_to_bgrx8888_row(const GLubyte *src, GLubyte *dst, GLuint n)
+{
+   GLuint *d = (GLuint *) dst;
+   GLuint i;
+
+   for (i = 0; i < n; i++) {
+      const GLubyte *s = src + i * 3;
+      d[i] = PACK_COLOR_8888(0xff, s[0], s[1], s[2]);
+   }
+}
+
+
+/**
+ * Store 8-bit RGBA texels as B10G10R10A2 texels.  This is what
+ * UNCLAMPED_FLOAT_TO_USHORT() and PACK_COLOR_2101010_US() give for the
+ * floats of UBYTE_TO_FLOAT(), since UBYTE_TO_FLOAT(x) rounds to x * 257.
+ */
+static inline void
+ubyte_rgba_to_2101010_row(const GLubyte *src, GLubyte *dst, GLuint n,
+                          GLboolean opaque)
+{
+   GLuint *d = (GLuint *) dst;
+   GLuint i;
+
+   for (i = 0; i < n; i++) {
+      const GLubyte *s = src + i * 4;
+      const GLuint a = opaque ? 0x3 : s[3] >> 6;
+      d[i] = (a << 30) |
+             (((s[0] * 257) >> 6) << 20) |
+             (((s[1] * 257) >> 6) << 10) |
+             ((s[2] * 257) >> 6);
+   }
+}
+
+static void
+ubyte_rgba_to_2101010_row_alpha(const GLubyte *src, GLubyte *dst, GLuint n)
+{
+   ubyte_rgba_to_2101010_row(src, dst, n, GL_FALSE);
+}
+
+static void
+ubyte_rgba_to_2101010_row_opaque(const GLubyte *src, GLubyte *dst, GLuint n)
+{
+   ubyte_rgba_to_2101010_row(src, dst, n, GL_TRUE);
+}
+
+
+/** Store float RGBA texels as B10G10R10A2 texels, clamping to [0, 1] */
+static inline void
+float_rgba_to_2101010_row(const GLubyte *src, GLubyte *dst, GLuint n,
+                          GLboolean opaque)
+{
+   const GLfloat *s = (const GLfloat *) src;
+   GLuint *d = (GLuint *) dst;
+   GLuint i;
+
+   for (i = 0; i < n; i++) {
+      GLushort a, r, g, b;
+
+      if (opaque)
+         a = 0xffff;
+      else
+         UNCLAMPED_FLOAT_TO_USHORT(a, s[ACOMP]);
+      UNCLAMPED_FLOAT_TO_USHORT(r, s[RCOMP]);
+      UNCLAMPED_FLOAT_TO_USHORT(g, s[GCOMP]);
+      UNCLAMPED_FLOAT_TO_USHORT(b, s[BCOMP]);
+      d[i] = PACK_COLOR_2101010_US(a, r, g, b);
+      s += 4;
+   }
+}
+
+static void
+float_rgba_to_2101010_row_alpha(const GLubyte *src, GLubyte *dst, GLuint n)
+{
+   float_rgba_to_2101010_row(src, dst, n, GL_FALSE);
+}
+
+static void
+float_rgba_to_2101010_row_opaque(const GLubyte *src, GLubyte *dst, GLuint n)
+{
+   float_rgba_to_2101010_row(src, dst, n, GL_TRUE);
+}
+
+
+static void
+float_to_half_row(const GLubyte *src, GLubyte *dst, GLuint n)
+{
+   _mesa_float_to_half_row((const GLfloat *) src, (GLhalfARB *) dst, n);
+}
+
+static void
+half_to_float_row(const GLubyte *src, GLubyte *dst, GLuint n)
+{
+   _mesa_half_to_float_row((const GLhalfARB *) src, (GLfloat *) dst, n);
+}
+
+
+struct direct_conversion
+{
+   GLenum SrcFormat, SrcType;
+   GLenum BaseInternalFormat;
+   mesa_format DstFormat;   /**< never an sRGB format */
+   /** Number of elements passed to Convert per texel */
+   GLuint ElementsPerTexel;
+   ConvertRowFunc Convert;
+};
+
+/**
+ * The direct conversions.  The packed formats are described for little
+ * endian hosts, so these are only used there.
+ */
+static const struct direct_conversion direct_conversions[] = {
+   /* 8-bit RGBA */
+   { GL_RGBA, GL_UNSIGNED_BYTE, GL_RGBA, MESA_FORMAT_B8G8R8A8_UNORM,
+     1, swap_rb_8888_row },
+   { GL_RGBA, GL_UNSIGNED_BYTE, GL_RGB, MESA_FORMAT_B8G8R8A8_UNORM,
+     1, swap_rb_8888_opaque_row },
+   { GL_RGBA, GL_UNSIGNED_BYTE, GL_RGB, MESA_FORMAT_B8G8R8X8_UNORM,
+     1, swap_rb_8888_opaque_row },
+   { GL_RGBA, GL_UNSIGNED_BYTE, GL_RGB, MESA_FORMAT_R8G8B8A8_UNORM,
+     1, copy_8888_opaque_row },
+   { GL_RGBA, GL_UNSIGNED_BYTE, GL_RGB, MESA_FORMAT_R8G8B8X8_UNORM,
+     1, copy_8888_opaque_row },
+   { GL_BGRA, GL_UNSIGNED_BYTE, GL_RGBA, MESA_FORMAT_R8G8B8A8_UNORM,
+     1, swap_rb_8888_row },
+   { GL_BGRA, GL_UNSIGNED_BYTE, GL_RGB, MESA_FORMAT_R8G8B8A8_UNORM,
+     1, swap_rb_8888_opaque_row },
+   { GL_BGRA, GL_UNSIGNED_BYTE, GL_RGB, MESA_FORMAT_R8G8B8X8_UNORM,
+     1, swap_rb_8888_opaque_row },
+   { GL_BGRA, GL_UNSIGNED_BYTE, GL_RGB, MESA_FORMAT_B8G8R8A8_UNORM,
+     1, copy_8888_opaque_row },
+   { GL_BGRA, GL_UNSIGNED_BYTE, GL_RGB, MESA_FORMAT_B8G8R8X8_UNORM,
+     1, copy_8888_opaque_row },
+
+   /* 8-bit RGB */
+   { GL_RGB, GL_UNSIGNED_BYTE, GL_RGBA, MESA_FORMAT_R8G8B8A8_UNORM,
+     1, rgb888_to_rgbx8888_row },
+   { GL_RGB, GL_UNSIGNED_BYTE, GL_RGB, MESA_FORMAT_R8G8B8A8_UNORM,
+     1, rgb888_to_rgbx8888_row },
+   { GL_RGB, GL_UNSIGNED_BYTE, GL_RGB, MESA_FORMAT_R8G8B8X8_UNORM,
+     1, rgb888_to_rgbx8888_row },
+   { GL_RGB, GL_UNSIGNED_BYTE, GL_RGBA, MESA_FORMAT_B8G8R8A8_UNORM,
+     1, rgb888_to_bgrx8888_row },
+   { GL_RGB, GL_UNSIGNED_BYTE, GL_RGB, MESA_FORMAT_B8G8R8A8_UNORM,
+     1, rgb888_to_bgrx8888_row },
+   { GL_RGB, GL_UNSIGNED_BYTE, GL_RGB, MESA_FORMAT_B8G8R8X8_UNORM,
+     1, rgb888_to_bgrx8888_row },
+   { GL_BGR, GL_UNSIGNED_BYTE, GL_RGBA, MESA_FORMAT_B8G8R8A8_UNORM,
+     1, rgb888_to_rgbx8888_row },
+   { GL_BGR, GL_UNSIGNED_BYTE, GL_RGB, MESA_FORMAT_B8G8R8A8_UNORM,
+     1, rgb888_to_rgbx8888_row },
+   { GL_BGR, GL_UNSIGNED_BYTE, GL_RGB, MESA_FORMAT_B8G8R8X8_UNORM,
+     1, rgb888_to_rgbx8888_row },
+   { GL_BGR, GL_UNSIGNED_BYTE, GL_RGBA, MESA_FORMAT_R8G8B8A8_UNORM,
+     1, rgb888_to_bgrx8888_row },
+   { GL_BGR, GL_UNSIGNED_BYTE, GL_RGB, MESA_FORMAT_R8G8B8A8_UNORM,
+     1, rgb888_to_bgrx8888_row },
+   { GL_BGR, GL_UNSIGNED_BYTE, GL_RGB, MESA_FORMAT_R8G8B8X8_UNORM,
+     1, rgb888_to_bgrx8888_row },
+
+   /* 10/10/10/2 */
+   { GL_RGBA, GL_UNSIGNED_BYTE, GL_RGBA, MESA_FORMAT_B10G10R10A2_UNORM,
+     1, ubyte_rgba_to_2101010_row_alpha },
+   { GL_RGBA, GL_UNSIGNED_BYTE, GL_RGB, MESA_FORMAT_B10G10R10A2_UNORM,
+     1, ubyte_rgba_to_2101010_row_opaque },
+   { GL_RGBA, GL_UNSIGNED_BYTE, GL_RGB, MESA_FORMAT_B10G10R10X2_UNORM,
+     1, ubyte_rgba_to_2101010_row_opaque },
+   { GL_RGBA, GL_FLOAT, GL_RGBA, MESA_FORMAT_B10G10R10A2_UNORM,
+     1, float_rgba_to_2101010_row_alpha },
+   { GL_RGBA, GL_FLOAT, GL_RGB, MESA_FORMAT_B10G10R10A2_UNORM,
+     1, float_rgba_to_2101010_row_opaque },
+   { GL_RGBA, GL_FLOAT, GL_RGB, MESA_FORMAT_B10G10R10X2_UNORM,
+     1, float_rgba_to_2101010_row_opaque },
+
+   /* float to half float */
+   { GL_RGBA, GL_FLOAT, GL_RGBA, MESA_FORMAT_RGBA_FLOAT16,
+     4, float_to_half_row },
+   { GL_RGB, GL_FLOAT, GL_RGB, MESA_FORMAT_RGB_FLOAT16,
+     3, float_to_half_row },
+   { GL_RG, GL_FLOAT, GL_RG, MESA_FORMAT_RG_FLOAT16,
+     2, float_to_half_row },
+   { GL_RED, GL_FLOAT, GL_RED, MESA_FORMAT_R_FLOAT16,
+     1, float_to_half_row },
+
+   /* half float to float */
+   { GL_RGBA, GL_HALF_FLOAT, GL_RGBA, MESA_FORMAT_RGBA_FLOAT32,
+     4, half_to_float_row },
+   { GL_RGB, GL_HALF_FLOAT, GL_RGB, MESA_FORMAT_RGB_FLOAT32,
+     3, half_to_float_row },
+   { GL_RG, GL_HALF_FLOAT, GL_RG, MESA_FORMAT_RG_FLOAT32,
+     2, half_to_float_row },
+   { GL_RED, GL_HALF_FLOAT, GL_RED, MESA_FORMAT_R_FLOAT32,
+     1, half_to_float_row },
+};
+
+
+/**
+ * Store the image with one of the direct conversions, if there is one for
+ * these formats.
+ * \return GL_TRUE if the image was stored, GL_FALSE otherwise.
+ */
+static GLboolean
+_mesa_texstore_direct(TEXSTORE_PARAMS)
+{
+   /* sRGB texels are stored just like the linear ones */
+   const mesa_format linearFormat = _mesa_get_srgb_format_linear(dstFormat);
+   const struct direct_conversion *conv = NULL;
+   GLint srcRowStride, img, row;
+   GLuint i;
+
+   if (!_mesa_little_endian() ||
+       srcPacking->SwapBytes ||
+       _mesa_texstore_needs_transfer_ops(ctx, baseInternalFormat, dstFormat))
+      return GL_FALSE;
+
+   for (i = 0; i < ARRAY_SIZE(direct_conversions); i++) {
+      if (direct_conversions[i].DstFormat == linearFormat &&
+          direct_conversions[i].SrcFormat == srcFormat &&
+          direct_conversions[i].SrcType == srcType &&
+          direct_conversions[i].BaseInternalFormat == baseInternalFormat) {
+         conv = &direct_conversions[i];
+         break;
+      }
+   }
+
+   if (!conv)
+      return GL_FALSE;
+
+   srcRowStride = _mesa_image_row_stride(srcPacking, srcWidth,
+                                         srcFormat, srcType);
+   for (img = 0; img < srcDepth; img++) {
+      const GLubyte *srcRow = (const GLubyte *)
+         _mesa_image_address(dims, srcPacking, srcAddr, srcWidth,
+                             srcHeight, srcFormat, srcType, img, 0, 0);
+      GLubyte *dstRow = dstSlices[img];
+      for (row = 0; row < srcHeight; row++) {
+         conv->Convert(srcRow, dstRow, srcWidth * conv->ElementsPerTexel);
+         dstRow += dstRowStride;
+         srcRow += srcRowStride;
+      }
+   }
+
+   return GL_TRUE;
+}
+
+/*@}*/
+
+
 /**
  * Store user data into texture memory.
  * Called via glTex[Sub]Image1/2/3D()
@@ -3951,6 +4250,14 @@ _mesa_texstore(TEXSTORE_PARAMS)
       return GL_TRUE;
    }
 
+   if (_mesa_texstore_direct(ctx, dims, baseInternalFormat,
+                             dstFormat,
+                             dstRowStride, dstSlices,
+                             srcWidth, srcHeight, srcDepth,
+                             srcFormat, srcType, srcAddr, srcPacking)) {
+      return GL_TRUE;
+   }
+
    storeImage = _mesa_get_texstore_func(dstFormat);
 
    success = storeImage(ctx, dims, baseInternalFormat,
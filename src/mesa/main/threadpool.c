@@ -0,0 +1,210 @@
+/*
+ * Copyright (c) 2014 The Mesa Authors
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+ * FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * \file threadpool.c
+ * Process-wide pool of worker threads.
+ *
+ * The pool is created the first time a job is run and lives until exit.
+ * A job is a number of independent pieces; the calling thread works on
+ * its own job's pieces alongside the pool threads and returns once all of
+ * them are done, so a job always completes even if every pool thread is
+ * busy with other callers' jobs (or none could be created).
+ */
+
+#include "main/imports.h"
+#include "main/macros.h"
+#include "main/threadpool.h"
+#include "c11/threads.h"
+
+
+#define THREADPOOL_MAX_THREADS 8
+
+struct threadpool_job {
+   threadpool_func func;
+   void *data;
+   unsigned count;
+   unsigned next;       /**< next piece to hand out */
+   unsigned pending;    /**< pieces not finished yet */
+   cnd_t done;
+   struct threadpool_job *next_job;
+};
+
+static struct {
+   mtx_t mutex;
+   cnd_t work;
+   /** Jobs which still have pieces to hand out, oldest first */
+   struct threadpool_job *head;
+   thrd_t threads[THREADPOOL_MAX_THREADS - 1];
+   unsigned num_threads;
+   bool shutdown;
+} pool;
+
+static once_flag pool_once = ONCE_FLAG_INIT;
+
+
+static void
+unlink_job(struct threadpool_job *job)
+{
+   struct threadpool_job **p;
+
+   for (p = &pool.head; *p != job; p = &(*p)->next_job)
+      ;
+   *p = job->next_job;
+}
+
+
+/**
+ * Run the next piece of \p job.  Called with the pool mutex held, which
+ * is dropped while the piece runs.
+ */
+static void
+run_piece(struct threadpool_job *job)
+{
+   const unsigned index = job->next++;
+
+   if (job->next == job->count)
+      unlink_job(job);
+
+   mtx_unlock(&pool.mutex);
+   job->func(job->data, index);
+   mtx_lock(&pool.mutex);
+
+   if (--job->pending == 0)
+      cnd_signal(&job->done);
+}
+
+
+static int
+worker_thread(void *arg)
+{
+   (void) arg;
+
+   mtx_lock(&pool.mutex);
+   for (;;) {
+      while (!pool.head && !pool.shutdown)
+         cnd_wait(&pool.work, &pool.mutex);
+      if (pool.shutdown)
+         break;
+      run_piece(pool.head);
+   }
+   mtx_unlock(&pool.mutex);
+
+   return 0;
+}
+
+
+static void
+threadpool_fini(void)
+{
+   unsigned i;
+
+   mtx_lock(&pool.mutex);
+   pool.shutdown = true;
+   cnd_broadcast(&pool.work);
+   mtx_unlock(&pool.mutex);
+
+   for (i = 0; i < pool.num_threads; i++)
+      thrd_join(pool.threads[i], NULL);
+   pool.num_threads = 0;
+}
+
+
+static void
+threadpool_init(void)
+{
+   const unsigned num_threads = MIN2(_mesa_get_cpu_count(),
+                                     THREADPOOL_MAX_THREADS) - 1;
+
+   mtx_init(&pool.mutex, mtx_plain);
+   cnd_init(&pool.work);
+
+   while (pool.num_threads < num_threads &&
+          thrd_create(&pool.threads[pool.num_threads], worker_thread,
+                      NULL) == thrd_success)
+      pool.num_threads++;
+
+   if (pool.num_threads)
+      atexit(threadpool_fini);
+}
+
+
+/**
+ * Number of threads that can work on a job at once, counting the caller.
+ */
+unsigned
+_mesa_threadpool_num_threads(void)
+{
+   call_once(&pool_once, threadpool_init);
+   return pool.num_threads + 1;
+}
+
+
+/**
+ * Call \p func for every index in [0, count), spread over the pool
+ * threads and the calling thread, and return when all calls are done.
+ * The calls must not depend on each other.
+ */
+void
+_mesa_threadpool_run(unsigned count, threadpool_func func, void *data)
+{
+   struct threadpool_job job;
+   unsigned i;
+
+   call_once(&pool_once, threadpool_init);
+
+   if (count < 2 || pool.num_threads == 0) {
+      for (i = 0; i < count; i++)
+         func(data, i);
+      return;
+   }
+
+   job.func = func;
+   job.data = data;
+   job.count = count;
+   job.next = 0;
+   job.pending = count;
+   job.next_job = NULL;
+   cnd_init(&job.done);
+
+   mtx_lock(&pool.mutex);
+
+   if (pool.head) {
+      struct threadpool_job *last = pool.head;
+      while (last->next_job)
+         last = last->next_job;
+      last->next_job = &job;
+   } else {
+      pool.head = &job;
+   }
+   cnd_broadcast(&pool.work);
+
+   while (job.next < job.count)
+      run_piece(&job);
+
+   while (job.pending)
+      cnd_wait(&job.done, &pool.mutex);
+
+   mtx_unlock(&pool.mutex);
+   cnd_destroy(&job.done);
+}
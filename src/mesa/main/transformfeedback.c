@@ -538,6 +538,7 @@ bind_buffer_range(struct gl_context *ctx, GLuint index,
                                  bufObj);
 
    obj->BufferNames[index] = bufObj->Name;
+   bufObj->UsageHistory |= USAGE_TRANSFORM_FEEDBACK_BUFFER;
 
    obj->Offset[index] = offset;
    obj->RequestedSize[index] = size;
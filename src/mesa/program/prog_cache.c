@@ -27,6 +27,7 @@
 
 
 #include "main/glheader.h"
+#include "main/errors.h"
 #include "main/mtypes.h"
 #include "main/imports.h"
 #include "main/shaderobj.h"
@@ -40,17 +41,27 @@ struct cache_item
    unsigned keysize;
    void *key;
    struct gl_program *program;
-   struct cache_item *next;
+   struct cache_item *next;      /**< next item in the same hash bucket */
+   struct cache_item *lru_prev;  /**< more recently used item */
+   struct cache_item *lru_next;  /**< less recently used item */
 };
 
 struct gl_program_cache
 {
    struct cache_item **items;
    struct cache_item *last;
+   struct cache_item lru;        /**< sentinel, lru.lru_next is the MRU item */
    GLuint size, n_items;
+   GLuint hits, misses, evictions;
 };
 
 
+/**
+ * Once the cache holds this many programs, inserting another one throws
+ * out the least recently used program rather than growing the cache.
+ */
+#define CACHE_MAX_ITEMS 2048
+
 
 /**
  * Compute hash index from state key.
@@ -76,6 +87,24 @@ hash_key(const void *key, GLuint key_size)
 }
 
 
+static void
+lru_remove(struct cache_item *c)
+{
+   c->lru_prev->lru_next = c->lru_next;
+   c->lru_next->lru_prev = c->lru_prev;
+}
+
+
+static void
+lru_add_head(struct gl_program_cache *cache, struct cache_item *c)
+{
+   c->lru_prev = &cache->lru;
+   c->lru_next = cache->lru.lru_next;
+   c->lru_next->lru_prev = c;
+   cache->lru.lru_next = c;
+}
+
+
 /**
  * Rebuild/expand the hash table to accomodate more entries
  */
@@ -105,6 +134,47 @@ rehash(struct gl_program_cache *cache)
 }
 
 
+static void
+free_item(struct gl_context *ctx, struct cache_item *c, GLboolean shader)
+{
+   free(c->key);
+   if (shader) {
+      _mesa_reference_shader_program(ctx,
+                                     (struct gl_shader_program **)&c->program,
+                                     NULL);
+   } else {
+      _mesa_reference_program(ctx, &c->program, NULL);
+   }
+   free(c);
+}
+
+
+/**
+ * Drop the least recently used program from the cache.
+ */
+static void
+evict_lru(struct gl_context *ctx, struct gl_program_cache *cache,
+          GLboolean shader)
+{
+   struct cache_item *c = cache->lru.lru_prev;
+   struct cache_item **p;
+
+   assert(c != &cache->lru);
+
+   for (p = &cache->items[c->hash % cache->size]; *p != c; p = &(*p)->next)
+      ;
+   *p = c->next;
+
+   lru_remove(c);
+   if (cache->last == c)
+      cache->last = NULL;
+
+   free_item(ctx, c, shader);
+   cache->n_items--;
+   cache->evictions++;
+}
+
+
 static void
 clear_cache(struct gl_context *ctx, struct gl_program_cache *cache,
 	    GLboolean shader)
@@ -117,24 +187,28 @@ clear_cache(struct gl_context *ctx, struct gl_program_cache *cache,
    for (i = 0; i < cache->size; i++) {
       for (c = cache->items[i]; c; c = next) {
 	 next = c->next;
-	 free(c->key);
-	 if (shader) {
-	    _mesa_reference_shader_program(ctx,
-					   (struct gl_shader_program **)&c->program,
-					   NULL);
-	 } else {
-	    _mesa_reference_program(ctx, &c->program, NULL);
-	 }
-	 free(c);
+	 free_item(ctx, c, shader);
       }
       cache->items[i] = NULL;
    }
 
-
+   cache->lru.lru_prev = cache->lru.lru_next = &cache->lru;
    cache->n_items = 0;
 }
 
 
+static void
+print_stats(const struct gl_program_cache *cache)
+{
+   const GLuint lookups = cache->hits + cache->misses;
+
+   _mesa_debug(NULL, "program cache %p: %u lookups, %u hits (%.1f%%), "
+               "%u evictions, %u programs\n", (void *) cache, lookups,
+               cache->hits, lookups ? 100.0 * cache->hits / lookups : 0.0,
+               cache->evictions, cache->n_items);
+}
+
+
 
 struct gl_program_cache *
 _mesa_new_program_cache(void)
@@ -148,6 +222,7 @@ _mesa_new_program_cache(void)
          free(cache);
          return NULL;
       }
+      cache->lru.lru_prev = cache->lru.lru_next = &cache->lru;
    }
    return cache;
 }
@@ -156,6 +231,8 @@ _mesa_new_program_cache(void)
 void
 _mesa_delete_program_cache(struct gl_context *ctx, struct gl_program_cache *cache)
 {
+   if (MESA_VERBOSE & VERBOSE_STATE)
+      print_stats(cache);
    clear_cache(ctx, cache, GL_FALSE);
    free(cache->items);
    free(cache);
@@ -165,12 +242,28 @@ void
 _mesa_delete_shader_cache(struct gl_context *ctx,
 			  struct gl_program_cache *cache)
 {
+   if (MESA_VERBOSE & VERBOSE_STATE)
+      print_stats(cache);
    clear_cache(ctx, cache, GL_TRUE);
    free(cache->items);
    free(cache);
 }
 
 
+/**
+ * Return the number of lookups which found a program, the number which
+ * didn't, and the number of programs evicted to make room for new ones.
+ */
+void
+_mesa_program_cache_stats(const struct gl_program_cache *cache,
+                          GLuint *hits, GLuint *misses, GLuint *evictions)
+{
+   *hits = cache->hits;
+   *misses = cache->misses;
+   *evictions = cache->evictions;
+}
+
+
 struct gl_program *
 _mesa_search_program_cache(struct gl_program_cache *cache,
                            const void *key, GLuint keysize)
@@ -178,6 +271,9 @@ _mesa_search_program_cache(struct gl_program_cache *cache,
    if (cache->last &&
        cache->last->keysize == keysize &&
        memcmp(cache->last->key, key, keysize) == 0) {
+      lru_remove(cache->last);
+      lru_add_head(cache, cache->last);
+      cache->hits++;
       return cache->last->program;
    }
    else {
@@ -189,21 +285,25 @@ _mesa_search_program_cache(struct gl_program_cache *cache,
              c->keysize == keysize &&
              memcmp(c->key, key, keysize) == 0) {
 
+            lru_remove(c);
+            lru_add_head(cache, c);
             cache->last = c;
+            cache->hits++;
             return c->program;
          }
       }
 
+      cache->misses++;
       return NULL;
    }
 }
 
 
-void
-_mesa_program_cache_insert(struct gl_context *ctx,
-                           struct gl_program_cache *cache,
-                           const void *key, GLuint keysize,
-                           struct gl_program *program)
+static void
+cache_insert(struct gl_context *ctx,
+             struct gl_program_cache *cache,
+             const void *key, GLuint keysize,
+             struct gl_program *program, GLboolean shader)
 {
    const GLuint hash = hash_key(key, keysize);
    struct cache_item *c = CALLOC_STRUCT(cache_item);
@@ -216,16 +316,25 @@ _mesa_program_cache_insert(struct gl_context *ctx,
 
    c->program = program;  /* no refcount change */
 
-   if (cache->n_items > cache->size * 1.5) {
-      if (cache->size < 1000)
-	 rehash(cache);
-      else 
-	 clear_cache(ctx, cache, GL_FALSE);
-   }
+   if (cache->n_items >= CACHE_MAX_ITEMS)
+      evict_lru(ctx, cache, shader);
+   else if (cache->n_items > cache->size * 1.5)
+      rehash(cache);
 
    cache->n_items++;
    c->next = cache->items[hash % cache->size];
    cache->items[hash % cache->size] = c;
+   lru_add_head(cache, c);
+}
+
+
+void
+_mesa_program_cache_insert(struct gl_context *ctx,
+                           struct gl_program_cache *cache,
+                           const void *key, GLuint keysize,
+                           struct gl_program *program)
+{
+   cache_insert(ctx, cache, key, keysize, program, GL_FALSE);
 }
 
 void
@@ -234,25 +343,6 @@ _mesa_shader_cache_insert(struct gl_context *ctx,
 			  const void *key, GLuint keysize,
 			  struct gl_shader_program *program)
 {
-   const GLuint hash = hash_key(key, keysize);
-   struct cache_item *c = CALLOC_STRUCT(cache_item);
-
-   c->hash = hash;
-
-   c->key = malloc(keysize);
-   memcpy(c->key, key, keysize);
-   c->keysize = keysize;
-
-   c->program = (struct gl_program *)program;  /* no refcount change */
-
-   if (cache->n_items > cache->size * 1.5) {
-      if (cache->size < 1000)
-	 rehash(cache);
-      else
-	 clear_cache(ctx, cache, GL_TRUE);
-   }
-
-   cache->n_items++;
-   c->next = cache->items[hash % cache->size];
-   cache->items[hash % cache->size] = c;
+   cache_insert(ctx, cache, key, keysize,
+                (struct gl_program *) program, GL_TRUE);
 }
@@ -48,6 +48,10 @@ extern void
 _mesa_delete_shader_cache(struct gl_context *ctx,
 			  struct gl_program_cache *cache);
 
+extern void
+_mesa_program_cache_stats(const struct gl_program_cache *cache,
+                          GLuint *hits, GLuint *misses, GLuint *evictions);
+
 extern struct gl_program *
 _mesa_search_program_cache(struct gl_program_cache *cache,
                            const void *key, GLuint keysize);
@@ -44,6 +44,10 @@
 #include "prog_print.h"
 #include "prog_noise.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 
 /* debug predicate */
 #define DEBUG_PROG 0
@@ -1677,3 +1681,857 @@ _mesa_execute_program(struct gl_context * ctx,
 
    return GL_TRUE;
 }
+
+
+
+/**********************************************************************
+ * Batched execution.
+ *
+ * Straight-line programs without relative addressing or condition codes,
+ * which includes everything generated for fixed-function vertex and
+ * fragment processing, can be run on PROG_BATCH_SIZE vertices/fragments
+ * at once.  The instructions are decoded once by
+ * _mesa_prepare_program_batch() and then each one operates on whole rows
+ * of the gl_program_batch registers.  The results are bit-identical to
+ * running _mesa_execute_program() on each element.
+ */
+
+typedef GLfloat prog_row[PROG_BATCH_SIZE];
+
+
+/**
+ * A decoded source register.
+ */
+struct prog_batch_src
+{
+   /** Per-element register, or NULL if the value is the same for all */
+   prog_row *Reg;
+   GLubyte Swizzle[4];
+   GLubyte Negate;
+   GLboolean Abs;
+   /**
+    * The swizzled value of a constant register, replicated across the
+    * row, or the rows selected by SWIZZLE_ZERO/ONE for other registers.
+    */
+   prog_row Const[4];
+};
+
+
+/**
+ * A decoded instruction.
+ */
+struct prog_batch_inst
+{
+   const struct prog_instruction *Inst;
+   struct prog_batch_src Src[3];
+   prog_row *Dst;
+   GLuint WriteMask;
+   GLboolean Saturate;
+};
+
+
+#if defined(__SSE2__)
+
+#define ROW_OP1(NAME, SSE_EXPR, C_EXPR)                                 \
+static inline void                                                      \
+NAME(GLfloat *d, const GLfloat *a)                                      \
+{                                                                       \
+   const __m128 signbit = _mm_set1_ps(-0.0F);                           \
+   GLuint l;                                                            \
+   (void) signbit;                                                      \
+   for (l = 0; l < PROG_BATCH_SIZE; l += 4) {                           \
+      const __m128 va = _mm_loadu_ps(a + l);                            \
+      _mm_storeu_ps(d + l, SSE_EXPR);                                   \
+   }                                                                    \
+}
+
+#define ROW_OP2(NAME, SSE_EXPR, C_EXPR)                                 \
+static inline void                                                      \
+NAME(GLfloat *d, const GLfloat *a, const GLfloat *b)                    \
+{                                                                       \
+   const __m128 one = _mm_set1_ps(1.0F);                                \
+   GLuint l;                                                            \
+   (void) one;                                                          \
+   for (l = 0; l < PROG_BATCH_SIZE; l += 4) {                           \
+      const __m128 va = _mm_loadu_ps(a + l);                            \
+      const __m128 vb = _mm_loadu_ps(b + l);                            \
+      _mm_storeu_ps(d + l, SSE_EXPR);                                   \
+   }                                                                    \
+}
+
+#define ROW_OP3(NAME, SSE_EXPR, C_EXPR)                                 \
+static inline void                                                      \
+NAME(GLfloat *d, const GLfloat *a, const GLfloat *b, const GLfloat *c)  \
+{                                                                       \
+   const __m128 one = _mm_set1_ps(1.0F);                                \
+   const __m128 zero = _mm_setzero_ps();                                \
+   GLuint l;                                                            \
+   (void) one;                                                          \
+   (void) zero;                                                         \
+   for (l = 0; l < PROG_BATCH_SIZE; l += 4) {                           \
+      const __m128 va = _mm_loadu_ps(a + l);                            \
+      const __m128 vb = _mm_loadu_ps(b + l);                            \
+      const __m128 vc = _mm_loadu_ps(c + l);                            \
+      _mm_storeu_ps(d + l, SSE_EXPR);                                   \
+   }                                                                    \
+}
+
+/** Select b where mask is set, else c */
+#define SSE_SELECT(mask, b, c) \
+   _mm_or_ps(_mm_and_ps(mask, b), _mm_andnot_ps(mask, c))
+
+#else
+
+#define ROW_OP1(NAME, SSE_EXPR, C_EXPR)                                 \
+static inline void                                                      \
+NAME(GLfloat *d, const GLfloat *a)                                      \
+{                                                                       \
+   GLuint l;                                                            \
+   for (l = 0; l < PROG_BATCH_SIZE; l++) {                              \
+      const GLfloat va = a[l];                                          \
+      d[l] = C_EXPR;                                                    \
+   }                                                                    \
+}
+
+#define ROW_OP2(NAME, SSE_EXPR, C_EXPR)                                 \
+static inline void                                                      \
+NAME(GLfloat *d, const GLfloat *a, const GLfloat *b)                    \
+{                                                                       \
+   GLuint l;                                                            \
+   for (l = 0; l < PROG_BATCH_SIZE; l++) {                              \
+      const GLfloat va = a[l], vb = b[l];                               \
+      d[l] = C_EXPR;                                                    \
+   }                                                                    \
+}
+
+#define ROW_OP3(NAME, SSE_EXPR, C_EXPR)                                 \
+static inline void                                                      \
+NAME(GLfloat *d, const GLfloat *a, const GLfloat *b, const GLfloat *c)  \
+{                                                                       \
+   GLuint l;                                                            \
+   for (l = 0; l < PROG_BATCH_SIZE; l++) {                              \
+      const GLfloat va = a[l], vb = b[l], vc = c[l];                    \
+      d[l] = C_EXPR;                                                    \
+   }                                                                    \
+}
+
+#endif
+
+/*
+ * The SSE versions are written to give exactly the same results as the
+ * C expressions used by _mesa_execute_program(), including for NaNs and
+ * negative zero; note the operand order of the min/max ops.
+ */
+ROW_OP1(row_abs, _mm_andnot_ps(signbit, va), FABSF(va))
+ROW_OP1(row_neg, _mm_xor_ps(signbit, va), -va)
+ROW_OP1(row_rcp, _mm_div_ps(_mm_set1_ps(1.0F), va), 1.0F / va)
+ROW_OP1(row_rsq, _mm_div_ps(_mm_set1_ps(1.0F),
+                            _mm_sqrt_ps(_mm_andnot_ps(signbit, va))),
+        INV_SQRTF(FABSF(va)))
+ROW_OP1(row_saturate,
+        _mm_max_ps(_mm_setzero_ps(), _mm_min_ps(_mm_set1_ps(1.0F), va)),
+        CLAMP(va, 0.0F, 1.0F))
+
+ROW_OP2(row_add, _mm_add_ps(va, vb), va + vb)
+ROW_OP2(row_sub, _mm_sub_ps(va, vb), va - vb)
+ROW_OP2(row_mul, _mm_mul_ps(va, vb), va * vb)
+ROW_OP2(row_min, _mm_min_ps(va, vb), MIN2(va, vb))
+ROW_OP2(row_max, _mm_max_ps(va, vb), MAX2(va, vb))
+ROW_OP2(row_seq, _mm_and_ps(_mm_cmpeq_ps(va, vb), one),
+        (va == vb) ? 1.0F : 0.0F)
+ROW_OP2(row_sne, _mm_and_ps(_mm_cmpneq_ps(va, vb), one),
+        (va != vb) ? 1.0F : 0.0F)
+ROW_OP2(row_slt, _mm_and_ps(_mm_cmplt_ps(va, vb), one),
+        (va < vb) ? 1.0F : 0.0F)
+ROW_OP2(row_sle, _mm_and_ps(_mm_cmple_ps(va, vb), one),
+        (va <= vb) ? 1.0F : 0.0F)
+ROW_OP2(row_sgt, _mm_and_ps(_mm_cmpgt_ps(va, vb), one),
+        (va > vb) ? 1.0F : 0.0F)
+ROW_OP2(row_sge, _mm_and_ps(_mm_cmpge_ps(va, vb), one),
+        (va >= vb) ? 1.0F : 0.0F)
+
+ROW_OP3(row_mad, _mm_add_ps(_mm_mul_ps(va, vb), vc), va * vb + vc)
+ROW_OP3(row_lrp, _mm_add_ps(_mm_mul_ps(va, vb),
+                            _mm_mul_ps(_mm_sub_ps(one, va), vc)),
+        va * vb + (1.0F - va) * vc)
+ROW_OP3(row_cmp, SSE_SELECT(_mm_cmplt_ps(va, zero), vb, vc),
+        va < 0.0F ? vb : vc)
+
+
+static inline void
+row_set(GLfloat *d, GLfloat value)
+{
+   GLuint l;
+   for (l = 0; l < PROG_BATCH_SIZE; l++)
+      d[l] = value;
+}
+
+
+/** Iterate over the components enabled in a write mask */
+#define FOREACH_COMPONENT(j, mask) \
+   for (j = 0; j < 4; j++) if ((mask) & (1 << j))
+
+
+/**
+ * Get the rows of a source register for the components in \p mask,
+ * applying the swizzle, absolute value and negation.  The rows point
+ * either directly at the register or at the scratch space in \p tmp.
+ */
+static inline void
+fetch_rows(const struct prog_batch_src *src, GLuint mask,
+           prog_row tmp[4], const GLfloat *rows[4])
+{
+   GLuint j;
+
+   if (!src->Reg) {
+      for (j = 0; j < 4; j++)
+         rows[j] = src->Const[j];
+      return;
+   }
+
+   FOREACH_COMPONENT(j, mask) {
+      const GLuint swz = src->Swizzle[j];
+      const GLfloat *row = swz <= SWIZZLE_W ? src->Reg[swz] : src->Const[j];
+
+      if (src->Abs) {
+         row_abs(tmp[j], row);
+         row = tmp[j];
+      }
+      if (src->Negate & (1 << j)) {
+         row_neg(tmp[j], row);
+         row = tmp[j];
+      }
+      rows[j] = row;
+   }
+}
+
+
+/**
+ * Write the result rows to the destination register, observing the
+ * write mask and saturation.
+ */
+static inline void
+store_rows(const struct prog_batch_inst *code, const GLfloat *rows[4])
+{
+   GLuint j;
+
+   FOREACH_COMPONENT(j, code->WriteMask) {
+      if (code->Saturate)
+         row_saturate(code->Dst[j], rows[j]);
+      else if (code->Dst[j] != rows[j])
+         memcpy(code->Dst[j], rows[j], sizeof(prog_row));
+   }
+}
+
+
+/**
+ * Gather the coordinates for a texture instruction and look up the texels
+ * one element at a time, as done by _mesa_execute_program().
+ */
+static void
+fetch_texel_rows(struct gl_context *ctx,
+                 const struct gl_program_machine *machine,
+                 const struct gl_program_batch *batch,
+                 const struct prog_instruction *inst,
+                 const GLfloat *coord[4], GLuint count,
+                 prog_row result[4])
+{
+   GLuint l;
+
+   for (l = 0; l < PROG_BATCH_SIZE; l++) {
+      GLfloat texcoord[4], color[4], lodBias = 0.0F;
+
+      if (l >= count || batch->Killed[l]) {
+         result[0][l] = result[1][l] = result[2][l] = result[3][l] = 0.0F;
+         continue;
+      }
+
+      texcoord[0] = coord[0][l];
+      texcoord[1] = coord[1][l];
+      texcoord[2] = coord[2][l];
+      texcoord[3] = coord[3][l];
+
+      switch (inst->Opcode) {
+      case OPCODE_TEX:
+         texcoord[3] = 1.0f;
+         break;
+      case OPCODE_TXB:
+         lodBias = texcoord[3];
+         break;
+      case OPCODE_TXP:
+         if (texcoord[3] != 0.0) {
+            texcoord[0] /= texcoord[3];
+            texcoord[1] /= texcoord[3];
+            texcoord[2] /= texcoord[3];
+         }
+         break;
+      default:
+         assert(0);
+      }
+
+      fetch_texel(ctx, machine, inst, texcoord, lodBias, color);
+
+      result[0][l] = color[0];
+      result[1][l] = color[1];
+      result[2][l] = color[2];
+      result[3][l] = color[3];
+   }
+}
+
+
+static GLboolean
+decode_src(const struct gl_program *prog,
+           const struct gl_program_machine *machine,
+           struct gl_program_batch *batch,
+           const struct prog_instruction *inst,
+           const struct prog_src_register *source,
+           struct prog_batch_src *src)
+{
+   const GLfloat *values = NULL;
+   const GLint reg = source->Index;
+   GLuint j;
+
+   if (source->RelAddr || reg < 0)
+      return GL_FALSE;
+
+   /* Only SWZ has per-component negation.  We negate based on the mask
+    * for scalar operands too, which only works for all or nothing.
+    */
+   if (inst->Opcode != OPCODE_SWZ &&
+       source->Negate != NEGATE_NONE && source->Negate != NEGATE_XYZW)
+      return GL_FALSE;
+
+   src->Reg = NULL;
+
+   switch (source->File) {
+   case PROGRAM_TEMPORARY:
+      if (reg >= MAX_PROGRAM_TEMPS)
+         return GL_FALSE;
+      src->Reg = batch->Temporaries[reg];
+      break;
+   case PROGRAM_INPUT:
+      if (reg >= (prog->Target == GL_VERTEX_PROGRAM_ARB ?
+                  VERT_ATTRIB_MAX : VARYING_SLOT_MAX))
+         return GL_FALSE;
+      src->Reg = batch->Inputs[reg];
+      break;
+   case PROGRAM_OUTPUT:
+      if (reg >= MAX_PROGRAM_OUTPUTS)
+         return GL_FALSE;
+      src->Reg = batch->Outputs[reg];
+      break;
+   case PROGRAM_STATE_VAR:
+   case PROGRAM_CONSTANT:
+   case PROGRAM_UNIFORM:
+      if (reg >= (GLint) prog->Parameters->NumParameters)
+         return GL_FALSE;
+      values = (const GLfloat *) prog->Parameters->ParameterValues[reg];
+      break;
+   case PROGRAM_SYSTEM_VALUE:
+      if (reg >= SYSTEM_VALUE_MAX)
+         return GL_FALSE;
+      values = machine->SystemValues[reg];
+      break;
+   default:
+      return GL_FALSE;
+   }
+
+   src->Negate = source->Negate;
+   src->Abs = source->Abs;
+
+   for (j = 0; j < 4; j++) {
+      const GLuint swz = GET_SWZ(source->Swizzle, j);
+      GLfloat value;
+
+      if (swz > SWIZZLE_ONE || (swz > SWIZZLE_W && inst->Opcode != OPCODE_SWZ))
+         return GL_FALSE;
+
+      src->Swizzle[j] = swz;
+
+      if (swz == SWIZZLE_ZERO)
+         value = 0.0F;
+      else if (swz == SWIZZLE_ONE)
+         value = 1.0F;
+      else if (values)
+         value = values[swz];
+      else
+         continue;
+
+      /* Constant over the batch, so apply the modifiers now */
+      if (values) {
+         if (src->Abs)
+            value = FABSF(value);
+         if (src->Negate & (1 << j))
+            value = -value;
+      }
+      row_set(src->Const[j], value);
+   }
+
+   return GL_TRUE;
+}
+
+
+struct gl_program_batch *
+_mesa_new_program_batch(void)
+{
+   return CALLOC_STRUCT(gl_program_batch);
+}
+
+
+void
+_mesa_delete_program_batch(struct gl_program_batch *batch)
+{
+   if (batch) {
+      free(batch->Code);
+      free(batch);
+   }
+}
+
+
+/**
+ * Decode a program for _mesa_execute_program_batch().  This needs to be
+ * done again whenever the program or any of its parameters change.
+ *
+ * \param machine  provides the system values
+ * \param batch  may be NULL, in which case GL_FALSE is returned
+ * \return GL_TRUE if the program can be run batched, GL_FALSE if it needs
+ *         to go through _mesa_execute_program() one element at a time.
+ */
+GLboolean
+_mesa_prepare_program_batch(struct gl_context *ctx,
+                            const struct gl_program *program,
+                            const struct gl_program_machine *machine,
+                            struct gl_program_batch *batch)
+{
+   GLuint pc;
+
+   STATIC_ASSERT(PROG_BATCH_SIZE % 4 == 0);
+   STATIC_ASSERT((int) VERT_ATTRIB_MAX <= (int) VARYING_SLOT_MAX);
+
+   if (!batch)
+      return GL_FALSE;
+
+   if (batch->MaxCode < program->NumInstructions) {
+      struct prog_batch_inst *code =
+         realloc(batch->Code, program->NumInstructions * sizeof(*code));
+      if (!code)
+         return GL_FALSE;
+      batch->Code = code;
+      batch->MaxCode = program->NumInstructions;
+   }
+
+   batch->NumCode = 0;
+
+   for (pc = 0; pc < program->NumInstructions; pc++) {
+      const struct prog_instruction *inst = program->Instructions + pc;
+      struct prog_batch_inst *code = &batch->Code[batch->NumCode];
+      GLuint i;
+
+      switch (inst->Opcode) {
+      case OPCODE_END:
+         return GL_TRUE;
+      case OPCODE_NOP:
+         continue;
+      case OPCODE_ABS:
+      case OPCODE_ADD:
+      case OPCODE_CMP:
+      case OPCODE_COS:
+      case OPCODE_DP2:
+      case OPCODE_DP3:
+      case OPCODE_DP4:
+      case OPCODE_DPH:
+      case OPCODE_DST:
+      case OPCODE_EX2:
+      case OPCODE_FLR:
+      case OPCODE_FRC:
+      case OPCODE_KIL:
+      case OPCODE_LG2:
+      case OPCODE_LIT:
+      case OPCODE_LRP:
+      case OPCODE_MAD:
+      case OPCODE_MAX:
+      case OPCODE_MIN:
+      case OPCODE_MOV:
+      case OPCODE_MUL:
+      case OPCODE_POW:
+      case OPCODE_RCP:
+      case OPCODE_RSQ:
+      case OPCODE_SCS:
+      case OPCODE_SEQ:
+      case OPCODE_SFL:
+      case OPCODE_SGE:
+      case OPCODE_SGT:
+      case OPCODE_SIN:
+      case OPCODE_SLE:
+      case OPCODE_SLT:
+      case OPCODE_SNE:
+      case OPCODE_SSG:
+      case OPCODE_STR:
+      case OPCODE_SUB:
+      case OPCODE_SWZ:
+      case OPCODE_TEX:
+      case OPCODE_TXB:
+      case OPCODE_TXP:
+      case OPCODE_TRUNC:
+      case OPCODE_XPD:
+         break;
+      default:
+         /* flow control, condition codes, derivatives, packing, ... */
+         return GL_FALSE;
+      }
+
+      if (inst->CondUpdate || inst->DstReg.CondMask != COND_TR)
+         return GL_FALSE;
+
+      code->Inst = inst;
+
+      for (i = 0; i < _mesa_num_inst_src_regs(inst->Opcode); i++) {
+         if (!decode_src(program, machine, batch, inst,
+                         &inst->SrcReg[i], &code->Src[i]))
+            return GL_FALSE;
+      }
+
+      code->Dst = NULL;
+      code->WriteMask = 0;
+      code->Saturate = inst->SaturateMode == SATURATE_ZERO_ONE;
+
+      if (_mesa_num_inst_dst_regs(inst->Opcode)) {
+         const struct prog_dst_register *dstReg = &inst->DstReg;
+
+         if (dstReg->RelAddr)
+            return GL_FALSE;
+
+         switch (dstReg->File) {
+         case PROGRAM_TEMPORARY:
+            if (dstReg->Index >= MAX_PROGRAM_TEMPS)
+               return GL_FALSE;
+            code->Dst = batch->Temporaries[dstReg->Index];
+            break;
+         case PROGRAM_OUTPUT:
+            if (dstReg->Index >= MAX_PROGRAM_OUTPUTS)
+               return GL_FALSE;
+            code->Dst = batch->Outputs[dstReg->Index];
+            break;
+         default:
+            return GL_FALSE;
+         }
+         code->WriteMask = dstReg->WriteMask;
+      }
+
+      batch->NumCode++;
+   }
+
+   return GL_TRUE;
+}
+
+
+/**
+ * Run the program decoded by _mesa_prepare_program_batch() on the first
+ * \p count elements of the batch registers.  The remaining elements are
+ * computed too, but no texture lookups are done for them.
+ *
+ * \param machine  used for texture lookups
+ */
+void
+_mesa_execute_program_batch(struct gl_context *ctx,
+                            struct gl_program_machine *machine,
+                            struct gl_program_batch *batch,
+                            GLuint count)
+{
+   GLuint pc;
+
+   memset(batch->Killed, 0, sizeof(batch->Killed));
+
+   for (pc = 0; pc < batch->NumCode; pc++) {
+      const struct prog_batch_inst *code = &batch->Code[pc];
+      const struct prog_instruction *inst = code->Inst;
+      const GLuint mask = code->WriteMask;
+      prog_row tmp[3][4], result[4];
+      const GLfloat *a[4], *b[4], *c[4], *res[4];
+      GLuint j, l;
+
+      /* Most opcodes are computed into result[] */
+      res[0] = result[0];
+      res[1] = result[1];
+      res[2] = result[2];
+      res[3] = result[3];
+
+#define FETCH(i, m, rows) fetch_rows(&code->Src[i], m, tmp[i], rows)
+
+#define COMPONENTWISE1(OP)                      \
+         FETCH(0, mask, a);                     \
+         FOREACH_COMPONENT(j, mask)             \
+            OP(result[j], a[j]);
+
+#define COMPONENTWISE2(OP)                      \
+         FETCH(0, mask, a);                     \
+         FETCH(1, mask, b);                     \
+         FOREACH_COMPONENT(j, mask)             \
+            OP(result[j], a[j], b[j]);
+
+#define COMPONENTWISE3(OP)                      \
+         FETCH(0, mask, a);                     \
+         FETCH(1, mask, b);                     \
+         FETCH(2, mask, c);                     \
+         FOREACH_COMPONENT(j, mask)             \
+            OP(result[j], a[j], b[j], c[j]);
+
+/* For opcodes computing a single value, computed into result[0] */
+#define SCALAR_RESULT()                         \
+         res[1] = res[2] = res[3] = result[0];
+
+      switch (inst->Opcode) {
+      case OPCODE_ABS:
+         COMPONENTWISE1(row_abs);
+         break;
+      case OPCODE_ADD:
+         COMPONENTWISE2(row_add);
+         break;
+      case OPCODE_CMP:
+         COMPONENTWISE3(row_cmp);
+         break;
+      case OPCODE_COS:
+         FETCH(0, WRITEMASK_X, a);
+         for (l = 0; l < PROG_BATCH_SIZE; l++)
+            result[0][l] = (GLfloat) cos(a[0][l]);
+         SCALAR_RESULT();
+         break;
+      case OPCODE_DP2:
+         FETCH(0, WRITEMASK_XY, a);
+         FETCH(1, WRITEMASK_XY, b);
+         row_mul(result[0], a[0], b[0]);
+         row_mad(result[0], a[1], b[1], result[0]);
+         SCALAR_RESULT();
+         break;
+      case OPCODE_DP3:
+         FETCH(0, WRITEMASK_XYZ, a);
+         FETCH(1, WRITEMASK_XYZ, b);
+         row_mul(result[0], a[0], b[0]);
+         row_mad(result[0], a[1], b[1], result[0]);
+         row_mad(result[0], a[2], b[2], result[0]);
+         SCALAR_RESULT();
+         break;
+      case OPCODE_DP4:
+         FETCH(0, WRITEMASK_XYZW, a);
+         FETCH(1, WRITEMASK_XYZW, b);
+         row_mul(result[0], a[0], b[0]);
+         row_mad(result[0], a[1], b[1], result[0]);
+         row_mad(result[0], a[2], b[2], result[0]);
+         row_mad(result[0], a[3], b[3], result[0]);
+         SCALAR_RESULT();
+         break;
+      case OPCODE_DPH:
+         FETCH(0, WRITEMASK_XYZ, a);
+         FETCH(1, WRITEMASK_XYZW, b);
+         row_mul(result[0], a[0], b[0]);
+         row_mad(result[0], a[1], b[1], result[0]);
+         row_mad(result[0], a[2], b[2], result[0]);
+         row_add(result[0], result[0], b[3]);
+         SCALAR_RESULT();
+         break;
+      case OPCODE_DST:
+         FETCH(0, WRITEMASK_YZ, a);
+         FETCH(1, WRITEMASK_YW, b);
+         row_set(result[0], 1.0F);
+         row_mul(result[1], a[1], b[1]);
+         memcpy(result[2], a[2], sizeof(prog_row));
+         memcpy(result[3], b[3], sizeof(prog_row));
+         break;
+      case OPCODE_EX2:
+         FETCH(0, WRITEMASK_X, a);
+         for (l = 0; l < PROG_BATCH_SIZE; l++)
+            result[0][l] = (GLfloat) pow(2.0, a[0][l]);
+         SCALAR_RESULT();
+         break;
+      case OPCODE_FLR:
+         FETCH(0, mask, a);
+         FOREACH_COMPONENT(j, mask) {
+            for (l = 0; l < PROG_BATCH_SIZE; l++)
+               result[j][l] = FLOORF(a[j][l]);
+         }
+         break;
+      case OPCODE_FRC:
+         FETCH(0, mask, a);
+         FOREACH_COMPONENT(j, mask) {
+            for (l = 0; l < PROG_BATCH_SIZE; l++)
+               result[j][l] = a[j][l] - FLOORF(a[j][l]);
+         }
+         break;
+      case OPCODE_KIL:
+         FETCH(0, WRITEMASK_XYZW, a);
+         for (l = 0; l < PROG_BATCH_SIZE; l++) {
+            if (a[0][l] < 0.0F || a[1][l] < 0.0F ||
+                a[2][l] < 0.0F || a[3][l] < 0.0F)
+               batch->Killed[l] = GL_TRUE;
+         }
+         continue;
+      case OPCODE_LG2:
+         FETCH(0, WRITEMASK_X, a);
+         for (l = 0; l < PROG_BATCH_SIZE; l++) {
+            const GLfloat x = a[0][l];
+            result[0][l] = x == 0.0F ? -FLT_MAX : (float)(log(x) * 1.442695F);
+         }
+         SCALAR_RESULT();
+         break;
+      case OPCODE_LIT:
+         {
+            const GLfloat epsilon = 1.0F / 256.0F;      /* from NV VP spec */
+
+            FETCH(0, WRITEMASK_XY | WRITEMASK_W, a);
+            row_set(result[0], 1.0F);
+            row_set(result[3], 1.0F);
+            for (l = 0; l < PROG_BATCH_SIZE; l++) {
+               const GLfloat x = MAX2(a[0][l], 0.0F);
+               const GLfloat y = MAX2(a[1][l], 0.0F);
+               const GLfloat w = CLAMP(a[3][l], -(128.0F - epsilon),
+                                       (128.0F - epsilon));
+               result[1][l] = x;
+               if (x > 0.0F) {
+                  if (y == 0.0 && w == 0.0)
+                     result[2][l] = 1.0F;
+                  else
+                     result[2][l] = (GLfloat) pow(y, w);
+               }
+               else {
+                  result[2][l] = 0.0F;
+               }
+            }
+         }
+         break;
+      case OPCODE_LRP:
+         COMPONENTWISE3(row_lrp);
+         break;
+      case OPCODE_MAD:
+         COMPONENTWISE3(row_mad);
+         break;
+      case OPCODE_MAX:
+         COMPONENTWISE2(row_max);
+         break;
+      case OPCODE_MIN:
+         COMPONENTWISE2(row_min);
+         break;
+      case OPCODE_MOV:
+      case OPCODE_SWZ:
+         FETCH(0, mask, a);
+         FOREACH_COMPONENT(j, mask) {
+            /* Copy unless the rows can't alias the destination */
+            if (code->Src[0].Reg == code->Dst)
+               memcpy(result[j], a[j], sizeof(prog_row));
+            else
+               res[j] = a[j];
+         }
+         break;
+      case OPCODE_MUL:
+         COMPONENTWISE2(row_mul);
+         break;
+      case OPCODE_POW:
+         FETCH(0, WRITEMASK_X, a);
+         FETCH(1, WRITEMASK_X, b);
+         for (l = 0; l < PROG_BATCH_SIZE; l++)
+            result[0][l] = (GLfloat) pow(a[0][l], b[0][l]);
+         SCALAR_RESULT();
+         break;
+      case OPCODE_RCP:
+         FETCH(0, WRITEMASK_X, a);
+         row_rcp(result[0], a[0]);
+         SCALAR_RESULT();
+         break;
+      case OPCODE_RSQ:
+         FETCH(0, WRITEMASK_X, a);
+         row_rsq(result[0], a[0]);
+         SCALAR_RESULT();
+         break;
+      case OPCODE_SCS:
+         FETCH(0, WRITEMASK_X, a);
+         for (l = 0; l < PROG_BATCH_SIZE; l++) {
+            result[0][l] = (GLfloat) cos(a[0][l]);
+            result[1][l] = (GLfloat) sin(a[0][l]);
+         }
+         row_set(result[2], 0.0F);
+         row_set(result[3], 0.0F);
+         break;
+      case OPCODE_SEQ:
+         COMPONENTWISE2(row_seq);
+         break;
+      case OPCODE_SFL:
+         row_set(result[0], 0.0F);
+         SCALAR_RESULT();
+         break;
+      case OPCODE_SGE:
+         COMPONENTWISE2(row_sge);
+         break;
+      case OPCODE_SGT:
+         COMPONENTWISE2(row_sgt);
+         break;
+      case OPCODE_SIN:
+         FETCH(0, WRITEMASK_X, a);
+         for (l = 0; l < PROG_BATCH_SIZE; l++)
+            result[0][l] = (GLfloat) sin(a[0][l]);
+         SCALAR_RESULT();
+         break;
+      case OPCODE_SLE:
+         COMPONENTWISE2(row_sle);
+         break;
+      case OPCODE_SLT:
+         COMPONENTWISE2(row_slt);
+         break;
+      case OPCODE_SNE:
+         COMPONENTWISE2(row_sne);
+         break;
+      case OPCODE_SSG:
+         FETCH(0, mask, a);
+         FOREACH_COMPONENT(j, mask) {
+            for (l = 0; l < PROG_BATCH_SIZE; l++)
+               result[j][l] =
+                  (GLfloat) ((a[j][l] > 0.0F) - (a[j][l] < 0.0F));
+         }
+         break;
+      case OPCODE_STR:
+         row_set(result[0], 1.0F);
+         SCALAR_RESULT();
+         break;
+      case OPCODE_SUB:
+         COMPONENTWISE2(row_sub);
+         break;
+      case OPCODE_TEX:
+      case OPCODE_TXB:
+      case OPCODE_TXP:
+         FETCH(0, WRITEMASK_XYZW, a);
+         fetch_texel_rows(ctx, machine, batch, inst, a, count, result);
+         break;
+      case OPCODE_TRUNC:
+         FETCH(0, mask, a);
+         FOREACH_COMPONENT(j, mask) {
+            for (l = 0; l < PROG_BATCH_SIZE; l++)
+               result[j][l] = (GLfloat) (GLint) a[j][l];
+         }
+         break;
+      case OPCODE_XPD:
+         FETCH(0, WRITEMASK_XYZ, a);
+         FETCH(1, WRITEMASK_XYZ, b);
+         row_mul(result[0], a[1], b[2]);
+         row_mul(tmp[2][0], a[2], b[1]);
+         row_sub(result[0], result[0], tmp[2][0]);
+         row_mul(result[1], a[2], b[0]);
+         row_mul(tmp[2][0], a[0], b[2]);
+         row_sub(result[1], result[1], tmp[2][0]);
+         row_mul(result[2], a[0], b[1]);
+         row_mul(tmp[2][0], a[1], b[0]);
+         row_sub(result[2], result[2], tmp[2][0]);
+         row_set(result[3], 1.0F);
+         break;
+      default:
+         _mesa_problem(ctx, "Bad opcode %d in _mesa_execute_program_batch",
+                       inst->Opcode);
+         return;
+      }
+
+#undef FETCH
+#undef COMPONENTWISE1
+#undef COMPONENTWISE2
+#undef COMPONENTWISE3
+#undef SCALAR_RESULT
+
+      store_rows(code, res);
+   }
+}
@@ -50,8 +50,8 @@ struct gl_program_machine
 {
    const struct gl_program *CurProgram;
 
-   /** Fragment Input attributes */
-   GLfloat (*Attribs)[PROG_MAX_WIDTH][4];
+   /** Fragment Input attributes, a row of PROG_MAX_WIDTH per attribute */
+   GLfloat (**Attribs)[4];
    GLfloat (*DerivX)[4];
    GLfloat (*DerivY)[4];
    GLuint NumDeriv; /**< Max index into DerivX/Y arrays */
@@ -78,6 +78,30 @@ struct gl_program_machine
 };
 
 
+/** Number of vertices/fragments run together by the batched interpreter */
+#define PROG_BATCH_SIZE 8
+
+struct prog_batch_inst;
+
+/**
+ * Registers for running a program on PROG_BATCH_SIZE vertices or
+ * fragments at once.  They're stored as structure-of-arrays, with one row
+ * of PROG_BATCH_SIZE values per register component, so that each
+ * instruction can be applied to all the elements with a few SIMD ops.
+ */
+struct gl_program_batch
+{
+   GLfloat Inputs[VARYING_SLOT_MAX][4][PROG_BATCH_SIZE];
+   GLfloat Temporaries[MAX_PROGRAM_TEMPS][4][PROG_BATCH_SIZE];
+   GLfloat Outputs[MAX_PROGRAM_OUTPUTS][4][PROG_BATCH_SIZE];
+   GLboolean Killed[PROG_BATCH_SIZE]; /**< Fragment program executed KIL */
+
+   /** The decoded program, see _mesa_prepare_program_batch() */
+   struct prog_batch_inst *Code;
+   GLuint NumCode, MaxCode;
+};
+
+
 extern void
 _mesa_get_program_register(struct gl_context *ctx, gl_register_file file,
                            GLuint index, GLfloat val[4]);
@@ -87,5 +111,23 @@ _mesa_execute_program(struct gl_context *ctx,
                       const struct gl_program *program,
                       struct gl_program_machine *machine);
 
+extern struct gl_program_batch *
+_mesa_new_program_batch(void);
+
+extern void
+_mesa_delete_program_batch(struct gl_program_batch *batch);
+
+extern GLboolean
+_mesa_prepare_program_batch(struct gl_context *ctx,
+                            const struct gl_program *program,
+                            const struct gl_program_machine *machine,
+                            struct gl_program_batch *batch);
+
+extern void
+_mesa_execute_program_batch(struct gl_context *ctx,
+                            struct gl_program_machine *machine,
+                            struct gl_program_batch *batch,
+                            GLuint count);
+
 
 #endif /* PROG_EXECUTE_H */
@@ -647,11 +647,6 @@ void st_init_extensions(struct st_context *st)
 
    /* Below are the cases which cannot be moved into tables easily. */
 
-   if (!ctx->Mesa_DXTn && !st->options.force_s3tc_enable) {
-      ctx->Extensions.EXT_texture_compression_s3tc = GL_FALSE;
-      ctx->Extensions.ANGLE_texture_compression_dxt = GL_FALSE;
-   }
-
    if (screen->get_shader_param(screen, PIPE_SHADER_GEOMETRY,
                                 PIPE_SHADER_CAP_MAX_INSTRUCTIONS) > 0) {
 #if 0 /* XXX re-enable when GLSL compiler again supports geometry shaders */
@@ -39,6 +39,7 @@
 #include "glsl_parser_extras.h"
 #include "../glsl/program.h"
 #include "ir_optimization.h"
+#include "ir_stats.h"
 #include "ast.h"
 
 #include "main/mtypes.h"
@@ -5117,6 +5118,8 @@ get_mesa_program(struct gl_context *ctx,
          &ctx->ShaderCompilerOptions[_mesa_shader_enum_to_shader_stage(shader->Type)];
    struct pipe_screen *pscreen = ctx->st->pipe->screen;
    unsigned ptarget = shader_stage_to_ptarget(shader->Stage);
+   const uint64_t start_time =
+      (ctx->_Shader->Flags & GLSL_STATS) ? ir_stats_get_time_ns() : 0;
 
    validate_ir_tree(shader->ir);
 
@@ -5199,6 +5202,23 @@ get_mesa_program(struct gl_context *ctx,
    /* Write the END instruction. */
    v->emit(NULL, TGSI_OPCODE_END);
 
+   if (ctx->_Shader->Flags & GLSL_STATS) {
+      unsigned num_instructions = 0;
+
+      foreach_list(node, &v->instructions)
+         num_instructions++;
+
+      fprintf(stderr, "{\"event\": \"backend\", \"program\": %u, "
+              "\"stage\": \"%s\", \"backend\": \"tgsi\", "
+              "\"ir_nodes\": %u, \"instructions\": %u, \"temps\": %d, "
+              "\"time_ns\": %llu}\n",
+              shader_program->Name,
+              _mesa_shader_stage_to_string(shader->Stage),
+              ir_stats_count_nodes(shader->ir), num_instructions,
+              v->next_temp,
+              (unsigned long long) (ir_stats_get_time_ns() - start_time));
+   }
+
    if (ctx->_Shader->Flags & GLSL_DUMP) {
       printf("\n");
       printf("GLSL IR for linked %s program %d:\n",
@@ -5352,16 +5372,25 @@ st_link_shader(struct gl_context *ctx, struct gl_shader_program *prog)
          lower_discard(ir);
       }
 
+      opt_pass_tracker tracker;
       do {
          progress = false;
 
-         progress = do_lower_jumps(ir, true, true, options->EmitNoMainReturn, options->EmitNoCont, options->EmitNoLoops) || progress;
+         if (do_lower_jumps(ir, true, true, options->EmitNoMainReturn,
+                            options->EmitNoCont, options->EmitNoLoops)) {
+            tracker.invalidate();
+            progress = true;
+         }
 
          progress = do_common_optimization(ir, true, true, options,
-                                           ctx->Const.NativeIntegers)
+                                           ctx->Const.NativeIntegers,
+                                           &tracker)
 	   || progress;
 
-         progress = lower_if_to_cond_assign(ir, options->MaxIfDepth) || progress;
+         if (lower_if_to_cond_assign(ir, options->MaxIfDepth)) {
+            tracker.invalidate();
+            progress = true;
+         }
 
       } while (progress);
 
@@ -33,6 +33,7 @@
 #include "main/errors.h"
 #include "main/framebuffer.h"
 #include "main/fbobject.h"
+#include "main/glthread.h"
 #include "main/renderbuffer.h"
 #include "main/version.h"
 #include "st_texture.h"
@@ -52,6 +53,10 @@
 #include "util/u_inlines.h"
 #include "util/u_atomic.h"
 #include "util/u_surface.h"
+#include "util/u_debug.h"
+
+
+DEBUG_GET_ONCE_BOOL_OPTION(mesa_glthread, "MESA_GLTHREAD", FALSE)
 
 /**
  * Cast wrapper to convert a struct gl_framebuffer to an st_framebuffer.
@@ -488,6 +493,8 @@ st_context_flush(struct st_context_iface *stctxi, unsigned flags,
    struct st_context *st = (struct st_context *) stctxi;
    unsigned pipe_flags = 0;
 
+   _mesa_glthread_finish(st->ctx);
+
    if (flags & ST_FLUSH_END_OF_FRAME) {
       pipe_flags |= PIPE_FLUSH_END_OF_FRAME;
    }
@@ -497,6 +504,14 @@ st_context_flush(struct st_context_iface *stctxi, unsigned flags,
       st_manager_flush_frontbuffer(st);
 }
 
+static void
+st_context_thread_finish(struct st_context_iface *stctxi)
+{
+   struct st_context *st = (struct st_context *) stctxi;
+
+   _mesa_glthread_finish(st->ctx);
+}
+
 static boolean
 st_context_teximage(struct st_context_iface *stctxi,
                     enum st_texture_type tex_type,
@@ -513,6 +528,8 @@ st_context_teximage(struct st_context_iface *stctxi,
    GLuint width, height, depth;
    GLenum target;
 
+   _mesa_glthread_finish(ctx);
+
    switch (tex_type) {
    case ST_TEXTURE_1D:
       target = GL_TEXTURE_1D;
@@ -594,6 +611,8 @@ st_context_copy(struct st_context_iface *stctxi,
    struct st_context *st = (struct st_context *) stctxi;
    struct st_context *src = (struct st_context *) stsrci;
 
+   _mesa_glthread_finish(src->ctx);
+   _mesa_glthread_finish(st->ctx);
    _mesa_copy_context(src->ctx, st->ctx, mask);
 }
 
@@ -691,6 +710,7 @@ st_api_create_context(struct st_api *stapi, struct st_manager *smapi,
 
    st->iface.destroy = st_context_destroy;
    st->iface.flush = st_context_flush;
+   st->iface.thread_finish = st_context_thread_finish;
    st->iface.teximage = st_context_teximage;
    st->iface.copy = st_context_copy;
    st->iface.share = st_context_share;
@@ -744,6 +764,11 @@ st_api_make_current(struct st_api *stapi, struct st_context_iface *stctxi,
    _glapi_check_multithread();
 
    if (st) {
+      /* The framebuffers are revalidated and rebound below, so the
+       * commands still queued against the old ones have to run first.
+       */
+      _mesa_glthread_finish(st->ctx);
+
       /* reuse or create the draw fb */
       stdraw = st_framebuffer_reuse_or_create(st,
             st->ctx->WinSysDrawBuffer, stdrawi);
@@ -782,6 +807,10 @@ st_api_make_current(struct st_api *stapi, struct st_context_iface *stctxi,
       ret = _mesa_make_current(NULL, NULL, NULL);
    }
 
+   /* GL threading starts once the context is first made current. */
+   if (st && ret && !st->ctx->GLThread && debug_get_option_mesa_glthread())
+      _mesa_glthread_init(st->ctx);
+
    return ret;
 }
 
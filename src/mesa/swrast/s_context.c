@@ -42,6 +42,7 @@
 #include "s_texfetch.h"
 #include "s_triangle.h"
 #include "s_texfilter.h"
+#include "s_tile.h"
 
 
 /**
@@ -265,6 +266,12 @@ _swrast_update_fog_state( struct gl_context *ctx )
 static void
 _swrast_update_fragment_program(struct gl_context *ctx, GLbitfield newState)
 {
+   SWcontext *swrast = SWRAST_CONTEXT(ctx);
+
+   /* The batched programs have the parameter values baked in */
+   memset(swrast->FragProgBatchStatus, SWRAST_BATCH_STALE,
+          swrast->MaxThreads * sizeof(GLubyte));
+
    if (!_swrast_use_fragment_program(ctx))
       return;
 
@@ -353,6 +360,12 @@ _swrast_validate_triangle( struct gl_context *ctx,
    swrast->choose_triangle( ctx );
    ASSERT(swrast->Triangle);
 
+   if (_swrast_use_tiled_triangles(ctx)) {
+      /* bin the triangles, rasterize them per tile at flush time */
+      swrast->TileTriangle = swrast->Triangle;
+      swrast->Triangle = _swrast_bin_triangle;
+   }
+
    if (swrast->SpecularVertexAdd) {
       /* separate specular color, but no texture */
       swrast->SpecTriangle = swrast->Triangle;
@@ -543,6 +556,15 @@ _swrast_update_active_attribs(struct gl_context *ctx)
       }
       swrast->_NumActiveAttribs = num;
    }
+
+   /* Keep the active attributes' span rows together */
+   {
+      GLuint i;
+      for (i = 0; i < swrast->MaxThreads; i++)
+         _swrast_layout_span_arrays(swrast, &swrast->SpanArrays[i]);
+      if (swrast->ZoomedArrays)
+         _swrast_layout_span_arrays(swrast, swrast->ZoomedArrays);
+   }
 }
 
 
@@ -637,6 +659,7 @@ _swrast_Line( struct gl_context *ctx, const SWvertex *v0, const SWvertex *v1 )
       _swrast_print_vertex( ctx, v0 );
       _swrast_print_vertex( ctx, v1 );
    }
+   _swrast_flush_tiles(ctx);
    SWRAST_CONTEXT(ctx)->Line( ctx, v0, v1 );
 }
 
@@ -647,6 +670,7 @@ _swrast_Point( struct gl_context *ctx, const SWvertex *v0 )
       _mesa_debug(ctx, "_swrast_Point\n");
       _swrast_print_vertex( ctx, v0 );
    }
+   _swrast_flush_tiles(ctx);
    SWRAST_CONTEXT(ctx)->Point( ctx, v0 );
 }
 
@@ -768,6 +792,8 @@ _swrast_CreateContext( struct gl_context *ctx )
    for (i = 0; i < ARRAY_SIZE(swrast->TextureSample); i++)
       swrast->TextureSample[i] = NULL;
 
+   swrast->MaxThreads = maxThreads;
+
    /* SpanArrays is global and shared by all SWspan instances. However, when
     * using multiple threads, it is necessary to have one SpanArrays instance
     * per thread.
@@ -778,13 +804,13 @@ _swrast_CreateContext( struct gl_context *ctx )
       return GL_FALSE;
    }
    for(i = 0; i < maxThreads; i++) {
+      /* the layout points rgba at the COL0 row for float colors */
       swrast->SpanArrays[i].ChanType = CHAN_TYPE;
+      _swrast_layout_span_arrays(swrast, &swrast->SpanArrays[i]);
 #if CHAN_TYPE == GL_UNSIGNED_BYTE
       swrast->SpanArrays[i].rgba = swrast->SpanArrays[i].rgba8;
 #elif CHAN_TYPE == GL_UNSIGNED_SHORT
       swrast->SpanArrays[i].rgba = swrast->SpanArrays[i].rgba16;
-#else
-      swrast->SpanArrays[i].rgba = swrast->SpanArrays[i].attribs[VARYING_SLOT_COL0];
 #endif
    }
 
@@ -800,19 +826,31 @@ _swrast_CreateContext( struct gl_context *ctx )
 
    ctx->swrast_context = swrast;
 
-   swrast->stencil_temp.buf1 = malloc(SWRAST_MAX_WIDTH * sizeof(GLubyte));
-   swrast->stencil_temp.buf2 = malloc(SWRAST_MAX_WIDTH * sizeof(GLubyte));
-   swrast->stencil_temp.buf3 = malloc(SWRAST_MAX_WIDTH * sizeof(GLubyte));
-   swrast->stencil_temp.buf4 = malloc(SWRAST_MAX_WIDTH * sizeof(GLubyte));
+   /* Like SpanArrays, the stencil temporaries and fragment program state
+    * are needed once per thread.
+    */
+   swrast->stencil_temp.buf1 = malloc(maxThreads * SWRAST_MAX_WIDTH * sizeof(GLubyte));
+   swrast->stencil_temp.buf2 = malloc(maxThreads * SWRAST_MAX_WIDTH * sizeof(GLubyte));
+   swrast->stencil_temp.buf3 = malloc(maxThreads * SWRAST_MAX_WIDTH * sizeof(GLubyte));
+   swrast->stencil_temp.buf4 = malloc(maxThreads * SWRAST_MAX_WIDTH * sizeof(GLubyte));
+
+   swrast->FragProgMachine = calloc(maxThreads, sizeof(struct gl_program_machine));
+   swrast->FragProgBatch = calloc(maxThreads, sizeof(struct gl_program_batch *));
+   swrast->FragProgBatchStatus = calloc(maxThreads, sizeof(GLubyte));
 
    if (!swrast->stencil_temp.buf1 ||
        !swrast->stencil_temp.buf2 ||
        !swrast->stencil_temp.buf3 ||
-       !swrast->stencil_temp.buf4) {
+       !swrast->stencil_temp.buf4 ||
+       !swrast->FragProgMachine ||
+       !swrast->FragProgBatch ||
+       !swrast->FragProgBatchStatus) {
       _swrast_DestroyContext(ctx);
       return GL_FALSE;
    }
 
+   _swrast_init_tiles(ctx);
+
    return GL_TRUE;
 }
 
@@ -820,6 +858,7 @@ void
 _swrast_DestroyContext( struct gl_context *ctx )
 {
    SWcontext *swrast = SWRAST_CONTEXT(ctx);
+   GLuint i;
 
    if (SWRAST_DEBUG) {
       _mesa_debug(ctx, "_swrast_DestroyContext\n");
@@ -828,6 +867,14 @@ _swrast_DestroyContext( struct gl_context *ctx )
    free( swrast->SpanArrays );
    free( swrast->ZoomedArrays );
    free( swrast->TexelBuffer );
+   if (swrast->FragProgBatch) {
+      for (i = 0; i < swrast->MaxThreads; i++)
+         _mesa_delete_program_batch( swrast->FragProgBatch[i] );
+   }
+   free( swrast->FragProgBatch );
+   free( swrast->FragProgBatchStatus );
+   free( swrast->FragProgMachine );
+   free( swrast->TileBin );
 
    free(swrast->stencil_temp.buf1);
    free(swrast->stencil_temp.buf2);
@@ -851,6 +898,10 @@ void
 _swrast_flush( struct gl_context *ctx )
 {
    SWcontext *swrast = SWRAST_CONTEXT(ctx);
+
+   /* rasterize any binned triangles */
+   _swrast_flush_tiles(ctx);
+
    /* flush any pending fragments from rendering points */
    if (swrast->PointSpan.end > 0) {
       _swrast_write_rgba_span(ctx, &(swrast->PointSpan));
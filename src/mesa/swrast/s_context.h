@@ -51,6 +51,10 @@
 #include "s_fragprog.h"
 #include "s_span.h"
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 
 typedef void (*texture_sample_func)(struct gl_context *ctx,
                                     const struct gl_sampler_object *samp,
@@ -72,6 +76,32 @@ typedef void (*swrast_tri_func)( struct gl_context *ctx, const SWvertex *,
                                  const SWvertex *, const SWvertex *);
 
 
+/**
+ * Index of the calling thread, for picking the per-thread copy of the
+ * scratch storage below when rasterizing with OpenMP.
+ */
+#ifdef _OPENMP
+#define SWRAST_THREAD_NUM() omp_get_thread_num()
+#else
+#define SWRAST_THREAD_NUM() 0
+#endif
+
+
+/**
+ * Height, in rows, of the screen tiles of the tiled triangle rasterizer.
+ * Tile t belongs to thread (t % _TileThreads).  Tiles span the whole
+ * width of the framebuffer so that spans are never clipped horizontally,
+ * which would change the rounding of the interpolated attributes.
+ */
+#define SWRAST_TILE_ROWS 16
+
+/** Does the calling thread rasterize row y? */
+#define SWRAST_TILE_OWNS_ROW(SWRAST, Y)                                 \
+   ((SWRAST)->_TileThreads <= 1 ||                                      \
+    (GLuint) ((Y) / SWRAST_TILE_ROWS) % (SWRAST)->_TileThreads ==       \
+    (GLuint) SWRAST_THREAD_NUM())
+
+
 typedef void (*validate_texture_image_func)(struct gl_context *ctx,
                                             struct gl_texture_object *texObj,
                                             GLuint face, GLuint level);
@@ -208,6 +238,15 @@ swrast_renderbuffer(struct gl_renderbuffer *img)
 }
 
 
+/** State of a thread's decoded copy of the current fragment program */
+enum swrast_batch_status
+{
+   SWRAST_BATCH_STALE = 0,     /**< needs _mesa_prepare_program_batch() */
+   SWRAST_BATCH_READY,         /**< decoded, run it batched */
+   SWRAST_BATCH_UNSUPPORTED    /**< run it one fragment at a time */
+};
+
+
 
 /**
  * \struct SWcontext
@@ -321,16 +360,33 @@ typedef struct
 
    validate_texture_image_func ValidateTextureImage;
 
-   /** State used during execution of fragment programs */
-   struct gl_program_machine FragProgMachine;
+   /** Number of threads the per-thread storage below is allocated for */
+   GLuint MaxThreads;
+
+   /** State used during execution of fragment programs, one per thread */
+   struct gl_program_machine *FragProgMachine;
+   struct gl_program_batch **FragProgBatch;
+   GLubyte *FragProgBatchStatus; /**< SWRAST_BATCH_x, see run_program() */
 
    /** Temporary arrays for stencil operations.  To avoid large stack
-    * allocations.
+    * allocations.  SWRAST_MAX_WIDTH entries per thread.
     */
    struct {
       GLubyte *buf1, *buf2, *buf3, *buf4;
    } stencil_temp;
 
+   /**
+    * Tiled triangle rasterization (see s_tile.c).  When TileThreads > 1,
+    * triangles are binned in TileBin and rasterized per screen tile by
+    * that many threads at _swrast_flush() time.
+    */
+   /*@{*/
+   GLuint TileThreads;
+   GLuint _TileThreads;       /**< non-zero while the bin is rasterized */
+   swrast_tri_func TileTriangle;
+   struct swrast_tile_bin *TileBin;
+   /*@}*/
+
 } SWcontext;
 
 
@@ -340,6 +396,9 @@ _swrast_validate_derived( struct gl_context *ctx );
 extern void
 _swrast_update_texture_samplers(struct gl_context *ctx);
 
+extern void
+_swrast_layout_span_arrays(const SWcontext *swrast, SWspanarrays *array);
+
 
 /** Return SWcontext for the given struct gl_context */
 static inline SWcontext *
@@ -203,6 +203,122 @@ init_machine(struct gl_context *ctx, struct gl_program_machine *machine,
 }
 
 
+/**
+ * Store the fragment program results for the pixel at 'col' in the span.
+ */
+static void
+store_outputs(struct gl_context *ctx, SWspan *span, GLuint col,
+              const GLfloat (*outputs)[4])
+{
+   const struct gl_fragment_program *program = ctx->FragmentProgram._Current;
+   const GLbitfield64 outputsWritten = program->Base.OutputsWritten;
+
+   /* Store result color */
+   if (outputsWritten & BITFIELD64_BIT(FRAG_RESULT_COLOR)) {
+      COPY_4V(span->array->attribs[VARYING_SLOT_COL0][col],
+              outputs[FRAG_RESULT_COLOR]);
+   }
+   else {
+      /* Multiple drawbuffers / render targets
+       * Note that colors beyond 0 and 1 will overwrite other
+       * attributes, such as FOGC, TEX0, TEX1, etc.  That's OK.
+       */
+      GLuint buf;
+      for (buf = 0; buf < ctx->DrawBuffer->_NumColorDrawBuffers; buf++) {
+         if (outputsWritten & BITFIELD64_BIT(FRAG_RESULT_DATA0 + buf)) {
+            COPY_4V(span->array->attribs[VARYING_SLOT_COL0 + buf][col],
+                    outputs[FRAG_RESULT_DATA0 + buf]);
+         }
+      }
+   }
+
+   /* Store result depth/z */
+   if (outputsWritten & BITFIELD64_BIT(FRAG_RESULT_DEPTH)) {
+      const GLfloat depth = outputs[FRAG_RESULT_DEPTH][2];
+      if (depth <= 0.0)
+         span->array->z[col] = 0;
+      else if (depth >= 1.0)
+         span->array->z[col] = ctx->DrawBuffer->_DepthMax;
+      else
+         span->array->z[col] =
+            (GLuint) (depth * ctx->DrawBuffer->_DepthMaxF + 0.5F);
+   }
+}
+
+
+/**
+ * Run fragment program on the pixels in span from 'start' to 'end' - 1,
+ * PROG_BATCH_SIZE pixels at a time.  The program must have been decoded
+ * by _mesa_prepare_program_batch().
+ */
+static void
+run_program_batched(struct gl_context *ctx, SWspan *span,
+                    GLuint start, GLuint end)
+{
+   SWcontext *swrast = SWRAST_CONTEXT(ctx);
+   const struct gl_fragment_program *program = ctx->FragmentProgram._Current;
+   const GLbitfield64 inputsRead = program->Base.InputsRead;
+   const GLbitfield64 outputsWritten = program->Base.OutputsWritten;
+   const GLuint thread = SWRAST_THREAD_NUM();
+   struct gl_program_machine *machine = &swrast->FragProgMachine[thread];
+   struct gl_program_batch *batch = swrast->FragProgBatch[thread];
+   GLuint i = start;
+
+   while (i < end) {
+      GLuint cols[PROG_BATCH_SIZE];
+      GLuint count = 0, attr, l;
+
+      /* collect the next few live fragments */
+      for (; i < end && count < PROG_BATCH_SIZE; i++) {
+         if (span->array->mask[i]) {
+            init_machine(ctx, machine, program, span, i);
+            cols[count++] = i;
+         }
+      }
+
+      if (count == 0)
+         break;
+
+      for (attr = 0; attr < VARYING_SLOT_MAX; attr++) {
+         if (inputsRead & BITFIELD64_BIT(attr)) {
+            GLfloat (*rows)[PROG_BATCH_SIZE] = batch->Inputs[attr];
+
+            for (l = 0; l < count; l++) {
+               const GLfloat *v = span->array->attribs[attr][cols[l]];
+               rows[0][l] = v[0];
+               rows[1][l] = v[1];
+               rows[2][l] = v[2];
+               rows[3][l] = v[3];
+            }
+         }
+      }
+
+      _mesa_execute_program_batch(ctx, machine, batch, count);
+
+      for (l = 0; l < count; l++) {
+         if (!batch->Killed[l]) {
+            GLfloat outputs[FRAG_RESULT_MAX][4];
+
+            for (attr = 0; attr < FRAG_RESULT_MAX; attr++) {
+               if (outputsWritten & BITFIELD64_BIT(attr)) {
+                  outputs[attr][0] = batch->Outputs[attr][0][l];
+                  outputs[attr][1] = batch->Outputs[attr][1][l];
+                  outputs[attr][2] = batch->Outputs[attr][2][l];
+                  outputs[attr][3] = batch->Outputs[attr][3][l];
+               }
+            }
+            store_outputs(ctx, span, cols[l], (const GLfloat (*)[4]) outputs);
+         }
+         else {
+            /* killed fragment */
+            span->array->mask[cols[l]] = GL_FALSE;
+            span->writeAll = GL_FALSE;
+         }
+      }
+   }
+}
+
+
 /**
  * Run fragment program on the pixels in span from 'start' to 'end' - 1.
  */
@@ -211,46 +327,35 @@ run_program(struct gl_context *ctx, SWspan *span, GLuint start, GLuint end)
 {
    SWcontext *swrast = SWRAST_CONTEXT(ctx);
    const struct gl_fragment_program *program = ctx->FragmentProgram._Current;
-   const GLbitfield64 outputsWritten = program->Base.OutputsWritten;
-   struct gl_program_machine *machine = &swrast->FragProgMachine;
+   const GLuint thread = SWRAST_THREAD_NUM();
+   struct gl_program_machine *machine = &swrast->FragProgMachine[thread];
    GLuint i;
 
+   /* Decode the program once per program or parameter change, see
+    * _swrast_update_fragment_program().
+    */
+   if (swrast->FragProgBatchStatus[thread] == SWRAST_BATCH_STALE) {
+      if (!swrast->FragProgBatch[thread])
+         swrast->FragProgBatch[thread] = _mesa_new_program_batch();
+
+      swrast->FragProgBatchStatus[thread] =
+         _mesa_prepare_program_batch(ctx, &program->Base, machine,
+                                     swrast->FragProgBatch[thread]) ?
+         SWRAST_BATCH_READY : SWRAST_BATCH_UNSUPPORTED;
+   }
+
+   if (swrast->FragProgBatchStatus[thread] == SWRAST_BATCH_READY) {
+      run_program_batched(ctx, span, start, end);
+      return;
+   }
+
    for (i = start; i < end; i++) {
       if (span->array->mask[i]) {
          init_machine(ctx, machine, program, span, i);
 
          if (_mesa_execute_program(ctx, &program->Base, machine)) {
-
-            /* Store result color */
-	    if (outputsWritten & BITFIELD64_BIT(FRAG_RESULT_COLOR)) {
-               COPY_4V(span->array->attribs[VARYING_SLOT_COL0][i],
-                       machine->Outputs[FRAG_RESULT_COLOR]);
-            }
-            else {
-               /* Multiple drawbuffers / render targets
-                * Note that colors beyond 0 and 1 will overwrite other
-                * attributes, such as FOGC, TEX0, TEX1, etc.  That's OK.
-                */
-               GLuint buf;
-               for (buf = 0; buf < ctx->DrawBuffer->_NumColorDrawBuffers; buf++) {
-                  if (outputsWritten & BITFIELD64_BIT(FRAG_RESULT_DATA0 + buf)) {
-                     COPY_4V(span->array->attribs[VARYING_SLOT_COL0 + buf][i],
-                             machine->Outputs[FRAG_RESULT_DATA0 + buf]);
-                  }
-               }
-            }
-
-            /* Store result depth/z */
-            if (outputsWritten & BITFIELD64_BIT(FRAG_RESULT_DEPTH)) {
-               const GLfloat depth = machine->Outputs[FRAG_RESULT_DEPTH][2];
-               if (depth <= 0.0)
-                  span->array->z[i] = 0;
-               else if (depth >= 1.0)
-                  span->array->z[i] = ctx->DrawBuffer->_DepthMax;
-               else
-                  span->array->z[i] =
-                     (GLuint) (depth * ctx->DrawBuffer->_DepthMaxF + 0.5F);
-            }
+            store_outputs(ctx, span, i,
+                          (const GLfloat (*)[4]) machine->Outputs);
          }
          else {
             /* killed fragment */
@@ -55,6 +55,10 @@
 
 #include <stdbool.h>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 /**
  * Set default fragment attributes for the span using the
  * current raster values.  Used prior to glDraw/CopyPixels
@@ -161,17 +165,64 @@ _swrast_span_default_attribs(struct gl_context *ctx, SWspan *span)
 }
 
 
+/**
+ * Assign the attribute rows of a span arrays object: window position
+ * first, then the active fragment attributes in _ActiveAttribs order,
+ * then everything else.  Called whenever the active attributes change.
+ * Float colors live in the VARYING_SLOT_COL0 row, so array->rgba follows
+ * that row when it moves.
+ */
+void
+_swrast_layout_span_arrays(const SWcontext *swrast, SWspanarrays *array)
+{
+   GLbitfield64 placed = VARYING_BIT_POS;
+   GLuint row = 0, i;
+
+   array->attribs[VARYING_SLOT_POS] = array->attribStorage[row++];
+
+   ATTRIB_LOOP_BEGIN
+      if (!(placed & BITFIELD64_BIT(attr))) {
+         array->attribs[attr] = array->attribStorage[row++];
+         placed |= BITFIELD64_BIT(attr);
+      }
+   ATTRIB_LOOP_END
+
+   for (i = 0; i < VARYING_SLOT_MAX; i++) {
+      if (!(placed & BITFIELD64_BIT(i)))
+         array->attribs[i] = array->attribStorage[row++];
+   }
+
+   ASSERT(row == VARYING_SLOT_MAX);
+
+   if (array->ChanType == GL_FLOAT)
+      array->rgba = (void *) array->attribs[VARYING_SLOT_COL0];
+}
+
+
+/** Number of fragments interpolated at a time */
+#define INTERP_CHUNK 64
+
 /**
  * Interpolate the active attributes (and'd with attrMask) to
  * fill in span->array->attribs[].
  * Perspective correction will be done.  The point/line/triangle function
  * should have computed attrStart/Step values for VARYING_SLOT_POS[3]!
+ *
+ * The 1/w values are computed once per fragment for all attributes, a
+ * chunk of fragments at a time, and each attribute is stepped as a
+ * 4-vector.  The arithmetic is the same as doing each attribute and
+ * component on its own, so the results are too.
  */
 static inline void
 interpolate_active_attribs(struct gl_context *ctx, SWspan *span,
                            GLbitfield64 attrMask)
 {
    const SWcontext *swrast = SWRAST_CONTEXT(ctx);
+   const GLfloat dwdx = span->attrStepX[VARYING_SLOT_POS][3];
+   GLfloat w = span->attrStart[VARYING_SLOT_POS][3];
+   GLuint attrs[VARYING_SLOT_MAX], numAttrs = 0;
+   GLfloat values[VARYING_SLOT_MAX][4];
+   GLuint start, a;
 
    /*
     * Don't overwrite existing array values, such as colors that may have
@@ -181,33 +232,58 @@ interpolate_active_attribs(struct gl_context *ctx, SWspan *span,
 
    ATTRIB_LOOP_BEGIN
       if (attrMask & BITFIELD64_BIT(attr)) {
-         const GLfloat dwdx = span->attrStepX[VARYING_SLOT_POS][3];
-         GLfloat w = span->attrStart[VARYING_SLOT_POS][3];
-         const GLfloat dv0dx = span->attrStepX[attr][0];
-         const GLfloat dv1dx = span->attrStepX[attr][1];
-         const GLfloat dv2dx = span->attrStepX[attr][2];
-         const GLfloat dv3dx = span->attrStepX[attr][3];
-         GLfloat v0 = span->attrStart[attr][0] + span->leftClip * dv0dx;
-         GLfloat v1 = span->attrStart[attr][1] + span->leftClip * dv1dx;
-         GLfloat v2 = span->attrStart[attr][2] + span->leftClip * dv2dx;
-         GLfloat v3 = span->attrStart[attr][3] + span->leftClip * dv3dx;
-         GLuint k;
-         for (k = 0; k < span->end; k++) {
-            const GLfloat invW = 1.0f / w;
-            span->array->attribs[attr][k][0] = v0 * invW;
-            span->array->attribs[attr][k][1] = v1 * invW;
-            span->array->attribs[attr][k][2] = v2 * invW;
-            span->array->attribs[attr][k][3] = v3 * invW;
-            v0 += dv0dx;
-            v1 += dv1dx;
-            v2 += dv2dx;
-            v3 += dv3dx;
-            w += dwdx;
+         GLuint c;
+         for (c = 0; c < 4; c++) {
+            values[numAttrs][c] = span->attrStart[attr][c]
+               + span->leftClip * span->attrStepX[attr][c];
          }
+         attrs[numAttrs++] = attr;
          ASSERT((span->arrayAttribs & BITFIELD64_BIT(attr)) == 0);
          span->arrayAttribs |= BITFIELD64_BIT(attr);
       }
    ATTRIB_LOOP_END
+
+   if (numAttrs == 0)
+      return;
+
+   for (start = 0; start < span->end; start += INTERP_CHUNK) {
+      const GLuint n = MIN2(INTERP_CHUNK, span->end - start);
+      GLfloat invW[INTERP_CHUNK];
+      GLuint k;
+
+      for (k = 0; k < n; k++) {
+         invW[k] = 1.0f / w;
+         w += dwdx;
+      }
+
+      for (a = 0; a < numAttrs; a++) {
+         GLfloat (*dst)[4] = span->array->attribs[attrs[a]] + start;
+         const GLfloat *dvdx = span->attrStepX[attrs[a]];
+#if defined(__SSE2__)
+         const __m128 dv = _mm_loadu_ps(dvdx);
+         __m128 v = _mm_loadu_ps(values[a]);
+
+         for (k = 0; k < n; k++) {
+            _mm_storeu_ps(dst[k], _mm_mul_ps(v, _mm_set1_ps(invW[k])));
+            v = _mm_add_ps(v, dv);
+         }
+         _mm_storeu_ps(values[a], v);
+#else
+         GLfloat *v = values[a];
+
+         for (k = 0; k < n; k++) {
+            dst[k][0] = v[0] * invW[k];
+            dst[k][1] = v[1] * invW[k];
+            dst[k][2] = v[2] * invW[k];
+            dst[k][3] = v[3] * invW[k];
+            v[0] += dvdx[0];
+            v[1] += dvdx[1];
+            v[2] += dvdx[2];
+            v[3] += dvdx[3];
+         }
+#endif
+      }
+   }
 }
 
 
@@ -68,11 +68,19 @@ struct gl_renderbuffer;
  */
 typedef struct sw_span_arrays
 {
-   /** Per-fragment attributes (indexed by VARYING_SLOT_* tokens) */
-   /* XXX someday look at transposing first two indexes for better memory
-    * access pattern.
+   /**
+    * Per-fragment attributes (indexed by VARYING_SLOT_* tokens).  Each
+    * entry points to a row of attribStorage.  The rows are handed out by
+    * _swrast_layout_span_arrays() so that the attributes a span actually
+    * uses are next to each other instead of a full row apart.
+    */
+   GLfloat (*attribs[VARYING_SLOT_MAX])[4];
+
+   /**
+    * The rows are padded so that they don't all start on the same cache
+    * sets, which the power of two row size would otherwise cause.
     */
-   GLfloat attribs[VARYING_SLOT_MAX][SWRAST_MAX_WIDTH][4];
+   GLfloat attribStorage[VARYING_SLOT_MAX][SWRAST_MAX_WIDTH + 4][4];
 
    /** This mask indicates which fragments are alive or culled */
    GLubyte mask[SWRAST_MAX_WIDTH];
@@ -179,7 +187,7 @@ do {						\
    (S).end = 0;					\
    (S).leftClip = 0;				\
    (S).facing = 0;				\
-   (S).array = SWRAST_CONTEXT(ctx)->SpanArrays;	\
+   (S).array = SWRAST_CONTEXT(ctx)->SpanArrays + SWRAST_THREAD_NUM(); \
 } while (0)
 
 
@@ -0,0 +1,250 @@
+/*
+ * Mesa 3-D graphics library
+ *
+ * Copyright (C) 2014  The Mesa Authors   All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+
+/**
+ * \file s_tile.c
+ * Tiled, multithreaded triangle rasterization.
+ *
+ * Instead of rasterizing each triangle as it arrives, swrast->Triangle
+ * copies it into a bin.  When the bin fills up, or at _swrast_flush()
+ * time, the binned triangles are rasterized by a team of OpenMP threads.
+ * The framebuffer is cut into tiles of SWRAST_TILE_ROWS rows and tile t
+ * belongs to thread (t % numThreads).  Each thread walks, in order, the
+ * binned triangles touching one of its tiles and only emits the spans in
+ * its own rows (see SWRAST_TILE_OWNS_ROW in s_tritemp.h), using its own
+ * span arrays and other scratch storage.
+ *
+ * Every pixel is thus touched by a single thread, in the original
+ * triangle order, and with the same per-triangle setup, so the results
+ * are identical to rasterizing on one thread.
+ */
+
+
+#include "main/glheader.h"
+#include "main/imports.h"
+#include "main/macros.h"
+#include "main/mtypes.h"
+
+#include "s_blend.h"
+#include "s_context.h"
+#include "s_texfilter.h"
+#include "s_tile.h"
+
+
+/** Number of triangles binned before they are rasterized */
+#define SWRAST_TILE_BIN_SIZE 512
+
+
+struct swrast_tile_triangle
+{
+   SWvertex v[3];
+   swrast_tri_func func;
+   GLint firstTile, lastTile;   /**< range of tiles the triangle may touch */
+};
+
+
+struct swrast_tile_bin
+{
+   GLuint Count;
+   struct swrast_tile_triangle Triangles[SWRAST_TILE_BIN_SIZE];
+};
+
+
+/**
+ * Set the number of rasterization threads.  Tiled rasterization is off
+ * unless SWRAST_NUM_THREADS asks for more than one thread.
+ */
+void
+_swrast_init_tiles(struct gl_context *ctx)
+{
+   SWcontext *swrast = SWRAST_CONTEXT(ctx);
+   const char *threads = _mesa_getenv("SWRAST_NUM_THREADS");
+
+   swrast->TileThreads = 1;
+   if (threads && atoi(threads) > 1)
+      swrast->TileThreads = MIN2((GLuint) atoi(threads), swrast->MaxThreads);
+}
+
+
+/**
+ * Can the triangles be binned with the current state?
+ */
+GLboolean
+_swrast_use_tiled_triangles(struct gl_context *ctx)
+{
+   const SWcontext *swrast = SWRAST_CONTEXT(ctx);
+
+   /* Antialiased triangles are already rasterized a row per thread, and
+    * the occlusion query counters are not updated atomically.
+    */
+   return swrast->TileThreads > 1 &&
+          !ctx->Polygon.SmoothFlag &&
+          !ctx->Query.CurrentOcclusionObject;
+}
+
+
+/**
+ * Called via swrast->Triangle when tiled rasterization is in use.  The
+ * triangle is rasterized later by swrast->TileTriangle.
+ */
+void
+_swrast_bin_triangle(struct gl_context *ctx,
+                     const SWvertex *v0,
+                     const SWvertex *v1,
+                     const SWvertex *v2)
+{
+   SWcontext *swrast = SWRAST_CONTEXT(ctx);
+   struct swrast_tile_bin *bin = swrast->TileBin;
+   struct swrast_tile_triangle *tri;
+   GLfloat ymin, ymax;
+
+   if (!bin) {
+      bin = swrast->TileBin = malloc(sizeof(struct swrast_tile_bin));
+      if (!bin) {
+         swrast->TileTriangle(ctx, v0, v1, v2);
+         return;
+      }
+      bin->Count = 0;
+   }
+   else if (bin->Count == SWRAST_TILE_BIN_SIZE) {
+      _swrast_flush_tiles(ctx);
+   }
+
+   tri = &bin->Triangles[bin->Count++];
+   tri->v[0] = *v0;
+   tri->v[1] = *v1;
+   tri->v[2] = *v2;
+   tri->func = swrast->TileTriangle;
+
+   /* Rows the triangle may cover, rounded out by a row on each side; the
+    * rasterizer does the exact test.  NaNs make it cover everything.
+    */
+   ymin = MIN3(v0->attrib[VARYING_SLOT_POS][1],
+               v1->attrib[VARYING_SLOT_POS][1],
+               v2->attrib[VARYING_SLOT_POS][1]) - 1.0F;
+   ymax = MAX3(v0->attrib[VARYING_SLOT_POS][1],
+               v1->attrib[VARYING_SLOT_POS][1],
+               v2->attrib[VARYING_SLOT_POS][1]) + 1.0F;
+   if (!(ymin >= 0.0F))
+      ymin = 0.0F;
+   if (!(ymax <= (GLfloat) ctx->DrawBuffer->Height))
+      ymax = (GLfloat) ctx->DrawBuffer->Height;
+
+   tri->firstTile = (GLint) ymin / SWRAST_TILE_ROWS;
+   tri->lastTile = (GLint) ymax / SWRAST_TILE_ROWS;
+}
+
+
+/**
+ * Does the triangle touch one of the tiles of the given thread?
+ */
+static inline GLboolean
+touches_thread_tiles(const struct swrast_tile_triangle *tri,
+                     GLuint thread, GLuint numThreads)
+{
+   /* the thread's first tile at or after tri->firstTile */
+   const GLuint first = tri->firstTile +
+      (thread + numThreads - tri->firstTile % numThreads) % numThreads;
+
+   return first <= (GLuint) tri->lastTile;
+}
+
+
+/**
+ * Set up the state that swrast otherwise builds on first use from inside
+ * the span functions, so that the rasterization threads only read it.
+ */
+static void
+validate_shared_state(struct gl_context *ctx)
+{
+   struct gl_framebuffer *fb = ctx->DrawBuffer;
+   GLuint buf;
+
+   _swrast_validate_derived(ctx);
+
+   /* swrast->BlendFunc picks the blend function for the channel type of
+    * the first buffer it blends into.
+    */
+   for (buf = 0; buf < fb->_NumColorDrawBuffers; buf++) {
+      struct gl_renderbuffer *rb = fb->_ColorDrawBuffers[buf];
+
+      if (rb && (ctx->Color.BlendEnabled >> buf) & 1) {
+         _swrast_choose_blend_func(ctx, swrast_renderbuffer(rb)->ColorType);
+         break;
+      }
+   }
+
+   _swrast_create_filter_table();
+}
+
+
+/**
+ * Rasterize the binned triangles.
+ */
+void
+_swrast_flush_tiles(struct gl_context *ctx)
+{
+   SWcontext *swrast = SWRAST_CONTEXT(ctx);
+   struct swrast_tile_bin *bin = swrast->TileBin;
+
+   if (!bin || bin->Count == 0)
+      return;
+
+#ifdef _OPENMP
+   validate_shared_state(ctx);
+
+#pragma omp parallel num_threads(swrast->TileThreads)
+   {
+      const GLuint thread = omp_get_thread_num();
+      const GLuint numThreads = omp_get_num_threads();
+      GLuint i;
+
+      /* the team may be smaller than what was asked for */
+#pragma omp single
+      swrast->_TileThreads = numThreads;
+
+      for (i = 0; i < bin->Count; i++) {
+         const struct swrast_tile_triangle *tri = &bin->Triangles[i];
+
+         if (touches_thread_tiles(tri, thread, numThreads))
+            tri->func(ctx, &tri->v[0], &tri->v[1], &tri->v[2]);
+      }
+   }
+   swrast->_TileThreads = 0;
+#else
+   {
+      GLuint i;
+
+      for (i = 0; i < bin->Count; i++) {
+         const struct swrast_tile_triangle *tri = &bin->Triangles[i];
+         tri->func(ctx, &tri->v[0], &tri->v[1], &tri->v[2]);
+      }
+   }
+   (void) touches_thread_tiles;
+   (void) validate_shared_state;
+#endif
+
+   bin->Count = 0;
+}
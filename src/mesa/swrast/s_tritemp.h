@@ -803,8 +803,11 @@ static void NAME(struct gl_context *ctx, const SWvertex *v0,
                /* This is where we actually generate fragments */
                /* XXX the test for span.y > 0 _shouldn't_ be needed but
                 * it fixes a problem on 64-bit Opterons (bug 4842).
+                * With tiled rasterization, the other rows are some other
+                * thread's business.
                 */
-               if (span.end > 0 && span.y >= 0) {
+               if (span.end > 0 && span.y >= 0 &&
+                   SWRAST_TILE_OWNS_ROW(swrast, span.y)) {
                   const GLint len = span.end - 1;
                   (void) len;
 #ifdef INTERP_RGB
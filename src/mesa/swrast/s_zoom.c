@@ -146,6 +146,7 @@ zoom_span( struct gl_context *ctx, GLint imgX, GLint imgY, const SWspan *span,
       swrast->ZoomedArrays = (SWspanarrays *) calloc(1, sizeof(SWspanarrays));
       if (!swrast->ZoomedArrays)
          return;
+      _swrast_layout_span_arrays(swrast, swrast->ZoomedArrays);
    }
 
    zoomedWidth = x1 - x0;
@@ -526,9 +526,10 @@ typedef struct
 
    GLvector4f tmp_inputs[VERT_ATTRIB_MAX];
 
-   /* Temp storage for t_draw.c: 
+   /* Temp storage for t_draw.c: a gathered and a converted copy of
+    * each attribute, the elements, the compaction maps and edgeflags.
     */
-   GLubyte *block[VERT_ATTRIB_MAX];
+   GLubyte *block[2 * VERT_ATTRIB_MAX + 5];
    GLuint nr_blocks;
 
    GLuint CurInstance;
@@ -550,5 +551,21 @@ typedef struct
 extern void
 tnl_clip_prepare(struct gl_context *ctx);
 
+extern void
+_tnl_bind_draw(struct gl_context *ctx,
+               const struct gl_client_array *arrays[],
+               const struct _mesa_prim *prim,
+               GLuint nr_prims,
+               const struct _mesa_index_buffer *ib,
+               GLuint count,
+               GLboolean compact,
+               struct gl_buffer_object **bo,
+               GLuint *nr_bo);
+
+extern void
+_tnl_unbind_draw(struct gl_context *ctx,
+                 struct gl_buffer_object **bo,
+                 GLuint nr_bo);
+
 
 #endif
@@ -263,9 +263,45 @@ static GLboolean *_tnl_import_edgeflag( struct gl_context *ctx,
 }
 
 
+/* Pack the vertices listed in verts[] into temporary storage, keeping
+ * the array's own type, so that they can be imported as a tightly
+ * packed array.
+ */
+static const GLubyte *gather_array( struct gl_context *ctx,
+				    const struct gl_client_array *input,
+				    const GLubyte *ptr,
+				    const GLuint *verts,
+				    GLuint count,
+				    struct gl_client_array *packed )
+{
+   const GLuint size = input->_ElementSize;
+   GLubyte *buf = get_space(ctx, count * size);
+   GLuint i;
+
+   if (size == 4 * sizeof(GLfloat)) {
+      for (i = 0; i < count; i++)
+	 COPY_4FV((GLfloat *)(buf + i * size),
+		  (const GLfloat *)(ptr + verts[i] * input->StrideB));
+   }
+   else {
+      for (i = 0; i < count; i++)
+	 memcpy(buf + i * size, ptr + verts[i] * input->StrideB, size);
+   }
+
+   *packed = *input;
+   packed->StrideB = size;
+   return buf;
+}
+
+
+/* Import the vertex arrays.  If verts is non-NULL only the count
+ * vertices it lists are imported, in that order, otherwise vertices
+ * 0 to count-1 are.
+ */
 static void bind_inputs( struct gl_context *ctx, 
 			 const struct gl_client_array *inputs[],
 			 GLint count,
+			 const GLuint *verts,
 			 struct gl_buffer_object **bo,
 			 GLuint *nr_bo )
 {
@@ -302,10 +338,18 @@ static void bind_inputs( struct gl_context *ctx,
        * XXX: remove the GLvector4f type at some stage and just use
        * client arrays.
        */
-      _tnl_import_array(ctx, i, count, inputs[i], ptr);
+      if (verts && inputs[i]->StrideB) {
+	 struct gl_client_array packed;
+	 ptr = gather_array(ctx, inputs[i], ptr, verts, count, &packed);
+	 _tnl_import_array(ctx, i, count, &packed, ptr);
+      }
+      else {
+	 _tnl_import_array(ctx, i, count, inputs[i], ptr);
+      }
    }
 
-   /* We process only the vertices between min & max index:
+   /* We process only the vertices between min & max index, or just
+    * the ones the elements reference:
     */
    VB->Count = count;
 
@@ -389,6 +433,74 @@ static void bind_indices( struct gl_context *ctx,
    }
 }
 
+/* An indexed draw may reference only a few of the vertices between 0
+ * and max_index, for instance when it draws a small part of a large
+ * mesh.  Running the whole range through the pipeline then transforms,
+ * lights and clips vertices that are never rendered.
+ *
+ * Find the vertices the bound primitives reference and, if that's a
+ * small enough part of the range, renumber VB->Elts in first-use order
+ * so the elements index a compact vertex list.  The original index of
+ * each compacted vertex is returned in *verts.  Returns the number of
+ * referenced vertices, or zero to process the whole range.
+ */
+static GLuint compact_elts( struct gl_context *ctx,
+			    GLuint count,
+			    const GLuint **verts )
+{
+   TNLcontext *tnl = TNL_CONTEXT(ctx);
+   struct vertex_buffer *VB = &tnl->vb;
+   GLuint nr_elts = 0, end = 0, n = 0;
+   GLuint *map, *list, *elts;
+   GLuint i, j;
+
+   if (!VB->Elts)
+      return 0;
+
+   for (i = 0; i < VB->PrimitiveCount; i++) {
+      nr_elts += VB->Primitive[i].count;
+      end = MAX2(end, VB->Primitive[i].start + VB->Primitive[i].count);
+   }
+
+   /* With at least as many elements as vertices the draw most likely
+    * uses the whole range, don't spend time looking.
+    */
+   if (nr_elts >= count)
+      return 0;
+
+   map = (GLuint *) get_space(ctx, count * sizeof(GLuint));
+   list = (GLuint *) get_space(ctx, nr_elts * sizeof(GLuint));
+   elts = (GLuint *) get_space(ctx, end * sizeof(GLuint));
+   memset(map, 0xff, count * sizeof(GLuint));
+
+   for (i = 0; i < VB->PrimitiveCount; i++) {
+      const GLuint start = VB->Primitive[i].start;
+
+      for (j = start; j < start + VB->Primitive[i].count; j++) {
+	 const GLuint e = VB->Elts[j];
+
+	 if (e >= count)
+	    return 0;
+
+	 if (map[e] == ~0u) {
+	    map[e] = n;
+	    list[n++] = e;
+	 }
+	 elts[j] = map[e];
+      }
+   }
+
+   /* Gathering the vertices isn't free, only compact when it saves a
+    * good share of the pipeline work.
+    */
+   if (n > count - count / 4)
+      return 0;
+
+   VB->Elts = elts;
+   *verts = list;
+   return n;
+}
+
 static void bind_prims( struct gl_context *ctx,
 			const struct _mesa_prim *prim,
 			GLuint nr_prims )
@@ -411,6 +523,50 @@ static void unmap_vbos( struct gl_context *ctx,
 }
 
 
+/* Bind a run of primitives sharing a basevertex, their elements and the
+ * vertices 0 to count-1 of the arrays to the vertex buffer.  With
+ * compact set, an indexed draw that only uses a small part of that
+ * range only gets the vertices it references, see compact_elts().
+ * Any buffer objects mapped on the way are added to bo[].
+ */
+void _tnl_bind_draw( struct gl_context *ctx,
+		     const struct gl_client_array *arrays[],
+		     const struct _mesa_prim *prim,
+		     GLuint nr_prims,
+		     const struct _mesa_index_buffer *ib,
+		     GLuint count,
+		     GLboolean compact,
+		     struct gl_buffer_object **bo,
+		     GLuint *nr_bo )
+{
+   const GLuint *verts = NULL;
+   GLuint nr_verts = 0;
+
+   bind_prims(ctx, prim, nr_prims);
+   bind_indices(ctx, ib, bo, nr_bo);
+
+   if (compact)
+      nr_verts = compact_elts(ctx, count, &verts);
+
+   if (nr_verts)
+      bind_inputs(ctx, arrays, nr_verts, verts, bo, nr_bo);
+   else
+      bind_inputs(ctx, arrays, count, NULL, bo, nr_bo);
+}
+
+
+/* Unmap the buffer objects _tnl_bind_draw() mapped and free its
+ * temporary storage.
+ */
+void _tnl_unbind_draw( struct gl_context *ctx,
+		       struct gl_buffer_object **bo,
+		       GLuint nr_bo )
+{
+   unmap_vbos(ctx, bo, nr_bo);
+   free_space(ctx);
+}
+
+
 /* This is the main entrypoint into the slimmed-down software tnl
  * module.  In a regular swtnl driver, this can be plugged straight
  * into the vbo->Driver.DrawPrims() callback.
@@ -508,16 +664,14 @@ void _tnl_draw_prims(struct gl_context *ctx,
 	  */
          for (inst = 0; inst < prim[i].num_instances; inst++) {
 
-            bind_prims(ctx, &prim[i], this_nr_prims);
-            bind_inputs(ctx, arrays, max_index + prim[i].basevertex + 1,
-                        bo, &nr_bo);
-            bind_indices(ctx, ib, bo, &nr_bo);
+            _tnl_bind_draw(ctx, arrays, &prim[i], this_nr_prims, ib,
+                           max_index + prim[i].basevertex + 1, GL_TRUE,
+                           bo, &nr_bo);
 
             tnl->CurInstance = inst;
             TNL_CONTEXT(ctx)->Driver.RunPipeline(ctx);
 
-            unmap_vbos(ctx, bo, nr_bo);
-            free_space(ctx);
+            _tnl_unbind_draw(ctx, bo, nr_bo);
          }
 
 	 i += this_nr_prims;
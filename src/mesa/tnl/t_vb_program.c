@@ -72,6 +72,7 @@ struct vp_stage_data {
    GLboolean vertex_textures;
 
    struct gl_program_machine machine;
+   struct gl_program_batch *batch;   /**< for running several vertices at once */
 };
 
 
@@ -289,6 +290,73 @@ unmap_textures(struct gl_context *ctx, const struct gl_vertex_program *vp)
 }
 
 
+/**
+ * Run the vertex program on PROG_BATCH_SIZE vertices at a time, after
+ * it's been decoded by _mesa_prepare_program_batch().
+ */
+static void
+run_vp_batched(struct gl_context *ctx, struct vp_stage_data *store,
+               const struct gl_vertex_program *program,
+               const GLuint *outputs, GLuint numOutputs)
+{
+   TNLcontext *tnl = TNL_CONTEXT(ctx);
+   struct vertex_buffer *VB = &tnl->vb;
+   struct gl_program_batch *batch = store->batch;
+   GLuint i, j, l;
+
+   for (i = 0; i < VB->Count; i += PROG_BATCH_SIZE) {
+      const GLuint count = MIN2(VB->Count - i, PROG_BATCH_SIZE);
+      GLuint attr;
+
+      /* transpose the vertex arrays into the input registers */
+      for (attr = 0; attr < VERT_ATTRIB_MAX; attr++) {
+         if (program->Base.InputsRead & BITFIELD64_BIT(attr)) {
+            const GLubyte *ptr = (const GLubyte*) VB->AttribPtr[attr]->data;
+            const GLuint size = VB->AttribPtr[attr]->size;
+            const GLuint stride = VB->AttribPtr[attr]->stride;
+            GLfloat (*rows)[PROG_BATCH_SIZE] = batch->Inputs[attr];
+
+            for (l = 0; l < count; l++) {
+               const GLfloat *data = (GLfloat *) (ptr + stride * (i + l));
+               GLfloat v[4];
+               COPY_CLEAN_4V(v, size, data);
+               rows[0][l] = v[0];
+               rows[1][l] = v[1];
+               rows[2][l] = v[2];
+               rows[3][l] = v[3];
+            }
+         }
+      }
+
+      _mesa_execute_program_batch(ctx, &store->machine, batch, count);
+
+      /* and the output registers back into the VB->attribs arrays */
+      for (j = 0; j < numOutputs; j++) {
+         GLfloat (*rows)[PROG_BATCH_SIZE] = batch->Outputs[outputs[j]];
+         GLfloat (*data)[4] = store->results[outputs[j]].data + i;
+
+         for (l = 0; l < count; l++) {
+            data[l][0] = rows[0][l];
+            data[l][1] = rows[1][l];
+            data[l][2] = rows[2][l];
+            data[l][3] = rows[3][l];
+         }
+      }
+
+      /* FOGC is a special case.  Fragment shader expects (f,0,0,1) */
+      if (program->Base.OutputsWritten & BITFIELD64_BIT(VARYING_SLOT_FOGC)) {
+         GLfloat (*data)[4] = store->results[VARYING_SLOT_FOGC].data + i;
+
+         for (l = 0; l < count; l++) {
+            data[l][1] = 0.0;
+            data[l][2] = 0.0;
+            data[l][3] = 1.0;
+         }
+      }
+   }
+}
+
+
 /**
  * This function executes vertex programs
  */
@@ -326,81 +394,90 @@ run_vp( struct gl_context *ctx, struct tnl_pipeline_stage *stage )
          _mesa_vector4f_alloc( &store->results[i], 0, VB->Size, 32 );
          store->results[i].size = 4;
       }
+      store->batch = _mesa_new_program_batch();
    }
 
    map_textures(ctx, program);
 
-   for (i = 0; i < VB->Count; i++) {
-      GLuint attr;
+   init_machine(ctx, machine, tnl->CurInstance);
 
-      init_machine(ctx, machine, tnl->CurInstance);
+   if (_mesa_prepare_program_batch(ctx, &program->Base, machine,
+                                   store->batch)) {
+      run_vp_batched(ctx, store, program, outputs, numOutputs);
+   }
+   else {
+      for (i = 0; i < VB->Count; i++) {
+         GLuint attr;
+
+         init_machine(ctx, machine, tnl->CurInstance);
 
 #if 0
-      printf("Input  %d: %f, %f, %f, %f\n", i,
-             VB->AttribPtr[0]->data[i][0],
-             VB->AttribPtr[0]->data[i][1],
-             VB->AttribPtr[0]->data[i][2],
-             VB->AttribPtr[0]->data[i][3]);
-      printf("   color: %f, %f, %f, %f\n",
-             VB->AttribPtr[3]->data[i][0],
-             VB->AttribPtr[3]->data[i][1],
-             VB->AttribPtr[3]->data[i][2],
-             VB->AttribPtr[3]->data[i][3]);
-      printf("  normal: %f, %f, %f, %f\n",
-             VB->AttribPtr[2]->data[i][0],
-             VB->AttribPtr[2]->data[i][1],
-             VB->AttribPtr[2]->data[i][2],
-             VB->AttribPtr[2]->data[i][3]);
+         printf("Input  %d: %f, %f, %f, %f\n", i,
+                VB->AttribPtr[0]->data[i][0],
+                VB->AttribPtr[0]->data[i][1],
+                VB->AttribPtr[0]->data[i][2],
+                VB->AttribPtr[0]->data[i][3]);
+         printf("   color: %f, %f, %f, %f\n",
+                VB->AttribPtr[3]->data[i][0],
+                VB->AttribPtr[3]->data[i][1],
+                VB->AttribPtr[3]->data[i][2],
+                VB->AttribPtr[3]->data[i][3]);
+         printf("  normal: %f, %f, %f, %f\n",
+                VB->AttribPtr[2]->data[i][0],
+                VB->AttribPtr[2]->data[i][1],
+                VB->AttribPtr[2]->data[i][2],
+                VB->AttribPtr[2]->data[i][3]);
 #endif
 
-      /* the vertex array case */
-      for (attr = 0; attr < VERT_ATTRIB_MAX; attr++) {
-	 if (program->Base.InputsRead & BITFIELD64_BIT(attr)) {
-	    const GLubyte *ptr = (const GLubyte*) VB->AttribPtr[attr]->data;
-	    const GLuint size = VB->AttribPtr[attr]->size;
-	    const GLuint stride = VB->AttribPtr[attr]->stride;
-	    const GLfloat *data = (GLfloat *) (ptr + stride * i);
+         /* the vertex array case */
+         for (attr = 0; attr < VERT_ATTRIB_MAX; attr++) {
+            if (program->Base.InputsRead & BITFIELD64_BIT(attr)) {
+               const GLubyte *ptr = (const GLubyte*) VB->AttribPtr[attr]->data;
+               const GLuint size = VB->AttribPtr[attr]->size;
+               const GLuint stride = VB->AttribPtr[attr]->stride;
+               const GLfloat *data = (GLfloat *) (ptr + stride * i);
 #ifdef NAN_CHECK
-            check_float(data[0]);
-            check_float(data[1]);
-            check_float(data[2]);
-            check_float(data[3]);
+               check_float(data[0]);
+               check_float(data[1]);
+               check_float(data[2]);
+               check_float(data[3]);
 #endif
-	    COPY_CLEAN_4V(machine->VertAttribs[attr], size, data);
-	 }
-      }
+               COPY_CLEAN_4V(machine->VertAttribs[attr], size, data);
+            }
+         }
 
-      /* execute the program */
-      _mesa_execute_program(ctx, &program->Base, machine);
+         /* execute the program */
+         _mesa_execute_program(ctx, &program->Base, machine);
 
-      /* copy the output registers into the VB->attribs arrays */
-      for (j = 0; j < numOutputs; j++) {
-         const GLuint attr = outputs[j];
+         /* copy the output registers into the VB->attribs arrays */
+         for (j = 0; j < numOutputs; j++) {
+            const GLuint attr = outputs[j];
 #ifdef NAN_CHECK
-         check_float(machine->Outputs[attr][0]);
-         check_float(machine->Outputs[attr][1]);
-         check_float(machine->Outputs[attr][2]);
-         check_float(machine->Outputs[attr][3]);
+            check_float(machine->Outputs[attr][0]);
+            check_float(machine->Outputs[attr][1]);
+            check_float(machine->Outputs[attr][2]);
+            check_float(machine->Outputs[attr][3]);
 #endif
-         COPY_4V(store->results[attr].data[i], machine->Outputs[attr]);
-      }
-
-      /* FOGC is a special case.  Fragment shader expects (f,0,0,1) */
-      if (program->Base.OutputsWritten & BITFIELD64_BIT(VARYING_SLOT_FOGC)) {
-         store->results[VARYING_SLOT_FOGC].data[i][1] = 0.0;
-         store->results[VARYING_SLOT_FOGC].data[i][2] = 0.0;
-         store->results[VARYING_SLOT_FOGC].data[i][3] = 1.0;
-      }
+            COPY_4V(store->results[attr].data[i], machine->Outputs[attr]);
+         }
+
+         /* FOGC is a special case.  Fragment shader expects (f,0,0,1) */
+         if (program->Base.OutputsWritten & BITFIELD64_BIT(VARYING_SLOT_FOGC)) {
+            store->results[VARYING_SLOT_FOGC].data[i][1] = 0.0;
+            store->results[VARYING_SLOT_FOGC].data[i][2] = 0.0;
+            store->results[VARYING_SLOT_FOGC].data[i][3] = 1.0;
+         }
 #ifdef NAN_CHECK
-      ASSERT(machine->Outputs[0][3] != 0.0F);
+         ASSERT(machine->Outputs[0][3] != 0.0F);
 #endif
 #if 0
-      printf("HPOS: %f %f %f %f\n",
-             machine->Outputs[0][0], 
-             machine->Outputs[0][1], 
-             machine->Outputs[0][2], 
-             machine->Outputs[0][3]);
+         printf("HPOS: %f %f %f %f\n",
+                machine->Outputs[0][0], 
+                machine->Outputs[0][1], 
+                machine->Outputs[0][2], 
+                machine->Outputs[0][3]);
 #endif
+      }
    }
 
    unmap_textures(ctx, program);
@@ -508,6 +585,7 @@ dtr(struct tnl_pipeline_stage *stage)
       /* free misc arrays */
       _mesa_vector4f_free( &store->ndcCoords );
       _mesa_align_free( store->clipmask );
+      _mesa_delete_program_batch( store->batch );
 
       free( store );
       stage->privatePtr = NULL;
@@ -532,7 +532,7 @@ void _tnl_init_vertices( struct gl_context *ctx,
 
    vtx->codegen_emit = NULL;
 
-#ifdef USE_SSE_ASM
+#ifdef TNL_SSE_EMIT
    if (!_mesa_getenv("MESA_NO_CODEGEN"))
       vtx->codegen_emit = _tnl_generate_sse_emit;
 #endif
@@ -178,7 +178,14 @@ void _tnl_generic_emit( struct gl_context *ctx,
 void _tnl_generate_hardwired_emit( struct gl_context *ctx );
 
 /* t_vertex_sse.c -- Internal functions for t_vertex.c
+ *
+ * The x86-64 code generator follows the System V calling convention,
+ * so Win64 builds stay with the C emitters.
  */
+#if defined(USE_SSE_ASM) || (defined(USE_X86_64_ASM) && !defined(_WIN64))
+#define TNL_SSE_EMIT
+#endif
+
 void _tnl_generate_sse_emit( struct gl_context *ctx );
 
 #endif
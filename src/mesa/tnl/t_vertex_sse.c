@@ -34,7 +34,7 @@
 #include "t_context.h"
 #include "t_vertex.h"
 
-#if defined(USE_SSE_ASM)
+#ifdef TNL_SSE_EMIT
 
 #include "x86/rtasm/x86sse.h"
 #include "x86/common_x86_asm.h"
@@ -311,6 +311,7 @@ static void get_src_ptr( struct x86_program *p,
 
    /* Load current a[j].inputptr
     */
+   x64_rexw(&p->func);
    x86_mov(&p->func, srcREG, ptr_to_src);
 }
 
@@ -326,10 +327,12 @@ static void update_src_ptr( struct x86_program *p,
       /* add a[j].inputstride (hardcoded value - could just as easily
        * pull the stride value from memory each time).
        */
+      x64_rexw(&p->func);
       x86_lea(&p->func, srcREG, x86_make_disp(srcREG, a->inputstride));
       
       /* save new value of a[j].inputptr 
        */
+      x64_rexw(&p->func);
       x86_mov(&p->func, ptr_to_src, srcREG);
    }
 }
@@ -340,6 +343,9 @@ static void update_src_ptr( struct x86_program *p,
  * EAX -- pointer to current output vertex
  * ECX -- pointer to current attribute 
  * 
+ * On x86-64 the same registers are used, with the pointer loads and
+ * arithmetic widened to 64 bits by x64_rexw().  The arguments arrive
+ * in registers there, so the count must be read before ESI is reused.
  */
 static GLboolean build_vertex_emit( struct x86_program *p )
 {
@@ -373,11 +379,14 @@ static GLboolean build_vertex_emit( struct x86_program *p )
 
    /* Initialize destination register. 
     */
+   x64_rexw(&p->func);
    x86_mov(&p->func, vertexEAX, x86_fn_arg(&p->func, 3));
 
    /* Dereference ctx to get tnl, then vtx:
     */
+   x64_rexw(&p->func);
    x86_mov(&p->func, vtxESI, x86_fn_arg(&p->func, 1));
+   x64_rexw(&p->func);
    x86_mov(&p->func, vtxESI, x86_make_disp(vtxESI, get_offset(ctx, &ctx->swtnl_context)));
    vtxESI = x86_make_disp(vtxESI, get_offset(tnl, &tnl->clipspace));
 
@@ -607,6 +616,7 @@ static GLboolean build_vertex_emit( struct x86_program *p )
 
    /* Next vertex:
     */
+   x64_rexw(&p->func);
    x86_lea(&p->func, vertexEAX, x86_make_disp(vertexEAX, vtx->vertex_size));
 
    /* decr count, loop if not zero
@@ -644,17 +654,23 @@ void _tnl_generate_sse_emit( struct gl_context *ctx )
    struct tnl_clipspace *vtx = GET_VERTEX_STATE(ctx);
    struct x86_program p;   
 
+#ifdef USE_SSE_ASM
    if (!cpu_has_xmm) {
       vtx->codegen_emit = NULL;
       return;
    }
+#endif
 
    memset(&p, 0, sizeof(p));
 
    p.ctx = ctx;
    p.inputs_safe = 0;		/* for now */
    p.outputs_safe = 0;		/* for now */
+#ifdef USE_SSE_ASM
    p.have_sse2 = cpu_has_xmm2;
+#else
+   p.have_sse2 = GL_TRUE;	/* always there on x86-64 */
+#endif
    p.identity = x86_make_reg(file_XMM, 6);
    p.chan0 = x86_make_reg(file_XMM, 7);
 
@@ -679,7 +695,8 @@ void _tnl_generate_sse_emit( struct gl_context *ctx )
 
 void _tnl_generate_sse_emit( struct gl_context *ctx )
 {
-   /* Dummy version for when USE_SSE_ASM not defined */
+   /* Dummy version for when there is no code generator, see
+    * TNL_SSE_EMIT */
 }
 
 #endif
@@ -0,0 +1,522 @@
+/*
+ * Copyright 2003 VMware, Inc.
+ * Copyright 2009 VMware, Inc.
+ * All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sub license, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject to
+ * the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the
+ * next paragraph) shall be included in all copies or substantial portions
+ * of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT.
+ * IN NO EVENT SHALL VMWARE AND/OR ITS SUPPLIERS BE LIABLE FOR
+ * ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+ * TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ * SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * \file vbo_minmax_index.c
+ *
+ * Computation of the index range referenced by glDraw[Range]Elements()
+ * calls, and a per-buffer-object cache of the results so that static
+ * index buffers only have to be scanned once.
+ */
+
+#include "main/glheader.h"
+#include "main/context.h"
+#include "main/bufferobj.h"
+#include "main/hash_table.h"
+#include "main/macros.h"
+#include "main/varray.h"
+
+#include "vbo.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+
+/**
+ * Once this many indices have been scanned for a buffer object without
+ * the cache paying off, stop caching for that buffer.  Index buffers that
+ * are rewritten every frame (or drawn from with ever-changing ranges)
+ * would otherwise just accumulate cache entries.
+ */
+#define MINMAX_CACHE_MISS_THRESHOLD 500000
+
+
+struct minmax_cache_key {
+   GLintptr offset;
+   GLuint count;
+   GLuint index_size;
+   GLuint restart_index; /**< ~0 if primitive restart is disabled */
+   GLboolean restart;
+};
+
+
+struct minmax_cache_entry {
+   struct minmax_cache_key key;
+   GLuint min;
+   GLuint max;
+};
+
+
+static bool
+vbo_minmax_cache_key_equal(const void *a, const void *b)
+{
+   return memcmp(a, b, sizeof(struct minmax_cache_key)) == 0;
+}
+
+
+static void
+vbo_minmax_cache_delete_entry(struct hash_entry *entry)
+{
+   free(entry->data);
+}
+
+
+/**
+ * Can cached ranges of this buffer object be trusted?
+ *
+ * Buffers that may be written by the GPU, or that the application may
+ * write at any time through a persistent mapping, are never cached since
+ * we would not notice their contents changing.
+ */
+static bool
+vbo_use_minmax_cache(const struct gl_buffer_object *bufferObj)
+{
+   if (bufferObj->UsageHistory & (USAGE_TEXTURE_BUFFER |
+                                  USAGE_ATOMIC_COUNTER_BUFFER |
+                                  USAGE_TRANSFORM_FEEDBACK_BUFFER |
+                                  USAGE_PIXEL_PACK_BUFFER |
+                                  USAGE_DISABLE_MINMAX_CACHE))
+      return false;
+
+   if ((bufferObj->Mappings[MAP_USER].AccessFlags &
+        (GL_MAP_PERSISTENT_BIT | GL_MAP_WRITE_BIT)) ==
+       (GL_MAP_PERSISTENT_BIT | GL_MAP_WRITE_BIT))
+      return false;
+
+   return true;
+}
+
+
+/**
+ * Free the index range cache of a buffer object.  Called when the
+ * buffer object is deleted.
+ */
+void
+vbo_delete_minmax_cache(struct gl_buffer_object *bufferObj)
+{
+   if (bufferObj->MinMaxCache) {
+      _mesa_hash_table_destroy(bufferObj->MinMaxCache,
+                               vbo_minmax_cache_delete_entry);
+      bufferObj->MinMaxCache = NULL;
+   }
+   bufferObj->MinMaxCacheDirty = false;
+}
+
+
+static bool
+vbo_get_minmax_cached(struct gl_buffer_object *bufferObj,
+                      const struct minmax_cache_key *key,
+                      GLuint *min_index, GLuint *max_index)
+{
+   struct hash_entry *result;
+   bool found = false;
+
+   mtx_lock(&bufferObj->Mutex);
+
+   if (bufferObj->MinMaxCacheDirty) {
+      /* The buffer contents changed since the ranges were computed. */
+      vbo_delete_minmax_cache(bufferObj);
+      goto out;
+   }
+
+   if (!bufferObj->MinMaxCache)
+      goto out;
+
+   result = _mesa_hash_table_search(bufferObj->MinMaxCache,
+                                    _mesa_hash_data(key, sizeof(*key)), key);
+   if (result) {
+      const struct minmax_cache_entry *entry = result->data;
+      *min_index = entry->min;
+      *max_index = entry->max;
+      bufferObj->MinMaxCacheHitIndices += key->count;
+      found = true;
+   }
+
+out:
+   mtx_unlock(&bufferObj->Mutex);
+   return found;
+}
+
+
+static void
+vbo_minmax_cache_store(struct gl_buffer_object *bufferObj,
+                       const struct minmax_cache_key *key,
+                       GLuint min, GLuint max)
+{
+   struct minmax_cache_entry *entry;
+
+   mtx_lock(&bufferObj->Mutex);
+
+   bufferObj->MinMaxCacheMissIndices += key->count;
+   if (bufferObj->MinMaxCacheMissIndices > MINMAX_CACHE_MISS_THRESHOLD &&
+       bufferObj->MinMaxCacheMissIndices >
+       bufferObj->MinMaxCacheHitIndices * 10) {
+      /* The cache is not paying off for this buffer; give up on it. */
+      bufferObj->UsageHistory |= USAGE_DISABLE_MINMAX_CACHE;
+      vbo_delete_minmax_cache(bufferObj);
+      goto out;
+   }
+
+   if (!bufferObj->MinMaxCache) {
+      bufferObj->MinMaxCache =
+         _mesa_hash_table_create(NULL, vbo_minmax_cache_key_equal);
+      if (!bufferObj->MinMaxCache)
+         goto out;
+   }
+
+   entry = malloc(sizeof(*entry));
+   if (!entry)
+      goto out;
+
+   entry->key = *key;
+   entry->min = min;
+   entry->max = max;
+   _mesa_hash_table_insert(bufferObj->MinMaxCache,
+                           _mesa_hash_data(&entry->key, sizeof(entry->key)),
+                           &entry->key, entry);
+
+out:
+   mtx_unlock(&bufferObj->Mutex);
+}
+
+
+/*
+ * The scanning functions below ignore restart indices by replacing them
+ * with ~0 when looking for the minimum and with 0 when looking for the
+ * maximum, which lets the SSE2 paths stay branch free.  SSE2 has no
+ * unsigned 16- and 32-bit min/max, so those values are biased into the
+ * signed range first.
+ */
+
+static void
+vbo_minmax_uint(const GLuint *indices, GLuint count,
+                GLboolean restart, GLuint restartIndex,
+                GLuint *min_index, GLuint *max_index)
+{
+   GLuint max_ui = 0;
+   GLuint min_ui = ~0U;
+   GLuint i = 0;
+
+#if defined(__SSE2__)
+   if (count >= 8) {
+      const __m128i bias = _mm_set1_epi32(0x80000000);
+      const __m128i restart_vec = _mm_set1_epi32(restartIndex);
+      __m128i min_vec = _mm_set1_epi32(0x7fffffff);
+      __m128i max_vec = _mm_set1_epi32(0x80000000);
+      GLuint tmp_min[4], tmp_max[4];
+      unsigned j;
+
+      for (; i + 4 <= count; i += 4) {
+         __m128i v = _mm_loadu_si128((const __m128i *) (indices + i));
+         __m128i v_min = v, v_max = v;
+         __m128i lt, gt;
+
+         if (restart) {
+            const __m128i is_restart = _mm_cmpeq_epi32(v, restart_vec);
+            v_min = _mm_or_si128(v, is_restart);
+            v_max = _mm_andnot_si128(is_restart, v);
+         }
+
+         v_min = _mm_xor_si128(v_min, bias);
+         v_max = _mm_xor_si128(v_max, bias);
+
+         lt = _mm_cmplt_epi32(v_min, min_vec);
+         min_vec = _mm_or_si128(_mm_and_si128(lt, v_min),
+                                _mm_andnot_si128(lt, min_vec));
+         gt = _mm_cmpgt_epi32(v_max, max_vec);
+         max_vec = _mm_or_si128(_mm_and_si128(gt, v_max),
+                                _mm_andnot_si128(gt, max_vec));
+      }
+
+      _mm_storeu_si128((__m128i *) tmp_min, _mm_xor_si128(min_vec, bias));
+      _mm_storeu_si128((__m128i *) tmp_max, _mm_xor_si128(max_vec, bias));
+      for (j = 0; j < 4; j++) {
+         min_ui = MIN2(min_ui, tmp_min[j]);
+         max_ui = MAX2(max_ui, tmp_max[j]);
+      }
+   }
+#endif
+
+   if (restart) {
+      for (; i < count; i++) {
+         if (indices[i] != restartIndex) {
+            if (indices[i] > max_ui) max_ui = indices[i];
+            if (indices[i] < min_ui) min_ui = indices[i];
+         }
+      }
+   }
+   else {
+      for (; i < count; i++) {
+         if (indices[i] > max_ui) max_ui = indices[i];
+         if (indices[i] < min_ui) min_ui = indices[i];
+      }
+   }
+
+   *min_index = min_ui;
+   *max_index = max_ui;
+}
+
+
+static void
+vbo_minmax_ushort(const GLushort *indices, GLuint count,
+                  GLboolean restart, GLuint restartIndex,
+                  GLuint *min_index, GLuint *max_index)
+{
+   GLuint max_us = 0;
+   GLuint min_us = ~0U;
+   GLuint i = 0;
+
+#if defined(__SSE2__)
+   if (count >= 16) {
+      /* A restart index that does not fit the index type never matches. */
+      const GLboolean match_restart = restart && restartIndex <= 0xffff;
+      const __m128i bias = _mm_set1_epi16((short) 0x8000);
+      const __m128i restart_vec = _mm_set1_epi16((short) restartIndex);
+      __m128i min_vec = _mm_set1_epi16(0x7fff);
+      __m128i max_vec = _mm_set1_epi16((short) 0x8000);
+      GLushort tmp_min[8], tmp_max[8];
+      unsigned j;
+
+      for (; i + 8 <= count; i += 8) {
+         __m128i v = _mm_loadu_si128((const __m128i *) (indices + i));
+         __m128i v_min = v, v_max = v;
+
+         if (match_restart) {
+            const __m128i is_restart = _mm_cmpeq_epi16(v, restart_vec);
+            v_min = _mm_or_si128(v, is_restart);
+            v_max = _mm_andnot_si128(is_restart, v);
+         }
+
+         min_vec = _mm_min_epi16(min_vec, _mm_xor_si128(v_min, bias));
+         max_vec = _mm_max_epi16(max_vec, _mm_xor_si128(v_max, bias));
+      }
+
+      _mm_storeu_si128((__m128i *) tmp_min, _mm_xor_si128(min_vec, bias));
+      _mm_storeu_si128((__m128i *) tmp_max, _mm_xor_si128(max_vec, bias));
+      for (j = 0; j < 8; j++) {
+         min_us = MIN2(min_us, tmp_min[j]);
+         max_us = MAX2(max_us, tmp_max[j]);
+      }
+
+      /* If nothing but restart indices were seen, the lanes still hold
+       * 0xffff as the minimum.  Report ~0 like the scalar loop does.
+       */
+      if (min_us > max_us)
+         min_us = ~0U;
+   }
+#endif
+
+   if (restart) {
+      for (; i < count; i++) {
+         if (indices[i] != restartIndex) {
+            if (indices[i] > max_us) max_us = indices[i];
+            if (indices[i] < min_us) min_us = indices[i];
+         }
+      }
+   }
+   else {
+      for (; i < count; i++) {
+         if (indices[i] > max_us) max_us = indices[i];
+         if (indices[i] < min_us) min_us = indices[i];
+      }
+   }
+
+   *min_index = min_us;
+   *max_index = max_us;
+}
+
+
+static void
+vbo_minmax_ubyte(const GLubyte *indices, GLuint count,
+                 GLboolean restart, GLuint restartIndex,
+                 GLuint *min_index, GLuint *max_index)
+{
+   GLuint max_ub = 0;
+   GLuint min_ub = ~0U;
+   GLuint i = 0;
+
+#if defined(__SSE2__)
+   if (count >= 32) {
+      /* A restart index that does not fit the index type never matches. */
+      const GLboolean match_restart = restart && restartIndex <= 0xff;
+      const __m128i restart_vec = _mm_set1_epi8((char) restartIndex);
+      __m128i min_vec = _mm_set1_epi8((char) 0xff);
+      __m128i max_vec = _mm_setzero_si128();
+      GLubyte tmp_min[16], tmp_max[16];
+      unsigned j;
+
+      for (; i + 16 <= count; i += 16) {
+         __m128i v = _mm_loadu_si128((const __m128i *) (indices + i));
+         __m128i v_min = v, v_max = v;
+
+         if (match_restart) {
+            const __m128i is_restart = _mm_cmpeq_epi8(v, restart_vec);
+            v_min = _mm_or_si128(v, is_restart);
+            v_max = _mm_andnot_si128(is_restart, v);
+         }
+
+         min_vec = _mm_min_epu8(min_vec, v_min);
+         max_vec = _mm_max_epu8(max_vec, v_max);
+      }
+
+      _mm_storeu_si128((__m128i *) tmp_min, min_vec);
+      _mm_storeu_si128((__m128i *) tmp_max, max_vec);
+      for (j = 0; j < 16; j++) {
+         min_ub = MIN2(min_ub, tmp_min[j]);
+         max_ub = MAX2(max_ub, tmp_max[j]);
+      }
+
+      /* See vbo_minmax_ushort(). */
+      if (min_ub > max_ub)
+         min_ub = ~0U;
+   }
+#endif
+
+   if (restart) {
+      for (; i < count; i++) {
+         if (indices[i] != restartIndex) {
+            if (indices[i] > max_ub) max_ub = indices[i];
+            if (indices[i] < min_ub) min_ub = indices[i];
+         }
+      }
+   }
+   else {
+      for (; i < count; i++) {
+         if (indices[i] > max_ub) max_ub = indices[i];
+         if (indices[i] < min_ub) min_ub = indices[i];
+      }
+   }
+
+   *min_index = min_ub;
+   *max_index = max_ub;
+}
+
+
+/**
+ * Compute min and max elements by scanning the index buffer for
+ * glDraw[Range]Elements() calls.
+ * If primitive restart is enabled, we need to ignore restart
+ * indexes when computing min/max.
+ */
+static void
+vbo_get_minmax_index(struct gl_context *ctx,
+		     const struct _mesa_prim *prim,
+		     const struct _mesa_index_buffer *ib,
+		     GLuint *min_index, GLuint *max_index,
+		     const GLuint count)
+{
+   const GLboolean restart = ctx->Array._PrimitiveRestart;
+   const GLuint restartIndex = _mesa_primitive_restart_index(ctx, ib->type);
+   const int index_size = vbo_sizeof_ib_type(ib->type);
+   const char *indices;
+   struct minmax_cache_key key;
+   bool use_cache = false;
+
+   indices = (char *) ib->ptr + prim->start * index_size;
+   if (_mesa_is_bufferobj(ib->obj)) {
+      GLsizeiptr size = MIN2(count * index_size, ib->obj->Size);
+
+      if (vbo_use_minmax_cache(ib->obj)) {
+         memset(&key, 0, sizeof(key));
+         key.offset = (GLintptr) indices;
+         key.count = count;
+         key.index_size = index_size;
+         key.restart = restart;
+         key.restart_index = restart ? restartIndex : ~0U;
+
+         if (vbo_get_minmax_cached(ib->obj, &key, min_index, max_index))
+            return;
+
+         use_cache = true;
+      }
+
+      indices = ctx->Driver.MapBufferRange(ctx, (GLintptr) indices, size,
+                                           GL_MAP_READ_BIT, ib->obj,
+                                           MAP_INTERNAL);
+   }
+
+   switch (ib->type) {
+   case GL_UNSIGNED_INT:
+      vbo_minmax_uint((const GLuint *) indices, count, restart, restartIndex,
+                      min_index, max_index);
+      break;
+   case GL_UNSIGNED_SHORT:
+      vbo_minmax_ushort((const GLushort *) indices, count, restart,
+                        restartIndex, min_index, max_index);
+      break;
+   case GL_UNSIGNED_BYTE:
+      vbo_minmax_ubyte((const GLubyte *) indices, count, restart,
+                       restartIndex, min_index, max_index);
+      break;
+   default:
+      assert(0);
+      break;
+   }
+
+   if (_mesa_is_bufferobj(ib->obj)) {
+      ctx->Driver.UnmapBuffer(ctx, ib->obj, MAP_INTERNAL);
+
+      if (use_cache)
+         vbo_minmax_cache_store(ib->obj, &key, *min_index, *max_index);
+   }
+}
+
+
+/**
+ * Compute min and max elements for nr_prims
+ */
+void
+vbo_get_minmax_indices(struct gl_context *ctx,
+                       const struct _mesa_prim *prims,
+                       const struct _mesa_index_buffer *ib,
+                       GLuint *min_index,
+                       GLuint *max_index,
+                       GLuint nr_prims)
+{
+   GLuint tmp_min, tmp_max;
+   GLuint i;
+   GLuint count;
+
+   *min_index = ~0;
+   *max_index = 0;
+
+   for (i = 0; i < nr_prims; i++) {
+      const struct _mesa_prim *start_prim;
+
+      start_prim = &prims[i];
+      count = start_prim->count;
+      /* Do combination if possible to reduce map/unmap count */
+      while ((i + 1 < nr_prims) &&
+             (prims[i].start + prims[i].count == prims[i+1].start)) {
+         count += prims[i+1].count;
+         i++;
+      }
+      vbo_get_minmax_index(ctx, start_prim, ib, &tmp_min, &tmp_max, count);
+      *min_index = MIN2(*min_index, tmp_min);
+      *max_index = MAX2(*max_index, tmp_max);
+   }
+}
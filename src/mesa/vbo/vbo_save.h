@@ -81,6 +81,16 @@ struct vbo_save_vertex_list {
    struct _mesa_prim *prim;
    GLuint prim_count;
 
+   /* The same primitives as indexed points, lines and triangles, with
+    * each run of compatible primitives merged into a single draw and
+    * identical vertices shared.  Built at compile time when that takes
+    * fewer draws, and used on playback when the current state doesn't
+    * tell the two apart (see vbo_save_draw.c).  NULL otherwise.
+    */
+   struct _mesa_prim *merged_prim;
+   GLuint merged_prim_count;
+   struct _mesa_index_buffer merged_ib;
+
    struct vbo_save_vertex_store *vertex_store;
    struct vbo_save_primitive_store *prim_store;
 };
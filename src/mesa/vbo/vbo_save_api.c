@@ -363,6 +363,312 @@ merge_prims(struct gl_context *ctx,
    *prim_count = prev_prim - prim_list + 1;
 }
 
+/**
+ * Which indexed primitive a glBegin mode can be drawn as: GL_POINTS,
+ * GL_LINES or GL_TRIANGLES.  Returns GL_NONE for the adjacency modes, and
+ * for line loops which were split across vertex lists.
+ */
+static GLenum
+merged_prim_mode(const struct _mesa_prim *prim)
+{
+   switch (prim->mode) {
+   case GL_POINTS:
+      return GL_POINTS;
+   case GL_LINE_LOOP:
+      if (!prim->begin || !prim->end)
+         return GL_NONE;
+      /* fall-through */
+   case GL_LINES:
+   case GL_LINE_STRIP:
+      return GL_LINES;
+   case GL_TRIANGLES:
+   case GL_TRIANGLE_STRIP:
+   case GL_TRIANGLE_FAN:
+   case GL_QUADS:
+   case GL_QUAD_STRIP:
+   case GL_POLYGON:
+      return GL_TRIANGLES;
+   default:
+      return GL_NONE;
+   }
+}
+
+
+/**
+ * Number of indices needed to draw \p count vertices of \p mode as
+ * points, lines or triangles.
+ */
+static GLuint
+merged_index_count(GLenum mode, GLuint count)
+{
+   switch (mode) {
+   case GL_POINTS:
+      return count;
+   case GL_LINES:
+      return count & ~1;
+   case GL_LINE_STRIP:
+      return count >= 2 ? 2 * (count - 1) : 0;
+   case GL_LINE_LOOP:
+      return count >= 2 ? 2 * count : 0;
+   case GL_TRIANGLES:
+      return count - count % 3;
+   case GL_TRIANGLE_STRIP:
+   case GL_TRIANGLE_FAN:
+   case GL_POLYGON:
+      return count >= 3 ? 3 * (count - 2) : 0;
+   case GL_QUADS:
+      return (count / 4) * 6;
+   case GL_QUAD_STRIP:
+      return count >= 4 ? (count / 2 - 1) * 6 : 0;
+   default:
+      assert(0);
+      return 0;
+   }
+}
+
+
+/**
+ * Write the indices of one primitive as points, lines or triangles.
+ *
+ * The winding of each triangle is kept, and so is the vertex that flat
+ * shading takes the color from with the default last vertex convention:
+ * it is the last vertex of every triangle or line emitted here.
+ */
+static GLushort *
+emit_merged_indices(GLushort *out, const struct _mesa_prim *prim,
+                    const GLushort *remap)
+{
+   const GLushort *v = remap + prim->start;
+   const GLuint n = prim->count;
+   GLuint i;
+
+   switch (prim->mode) {
+   case GL_POINTS:
+   case GL_LINES:
+   case GL_TRIANGLES:
+      for (i = 0; i < merged_index_count(prim->mode, n); i++)
+         *out++ = v[i];
+      break;
+   case GL_LINE_STRIP:
+   case GL_LINE_LOOP:
+      for (i = 0; i + 1 < n; i++) {
+         *out++ = v[i];
+         *out++ = v[i + 1];
+      }
+      if (prim->mode == GL_LINE_LOOP && n >= 2) {
+         *out++ = v[n - 1];
+         *out++ = v[0];
+      }
+      break;
+   case GL_TRIANGLE_STRIP:
+      for (i = 0; i + 2 < n; i++) {
+         *out++ = v[i + (i & 1)];
+         *out++ = v[i + 1 - (i & 1)];
+         *out++ = v[i + 2];
+      }
+      break;
+   case GL_TRIANGLE_FAN:
+      for (i = 1; i + 1 < n; i++) {
+         *out++ = v[0];
+         *out++ = v[i];
+         *out++ = v[i + 1];
+      }
+      break;
+   case GL_POLYGON:
+      /* Polygons are flat shaded with their first vertex. */
+      for (i = 1; i + 1 < n; i++) {
+         *out++ = v[i];
+         *out++ = v[i + 1];
+         *out++ = v[0];
+      }
+      break;
+   case GL_QUADS:
+      for (i = 0; i + 3 < n; i += 4) {
+         *out++ = v[i + 0];
+         *out++ = v[i + 1];
+         *out++ = v[i + 3];
+         *out++ = v[i + 1];
+         *out++ = v[i + 2];
+         *out++ = v[i + 3];
+      }
+      break;
+   case GL_QUAD_STRIP:
+      for (i = 0; i + 3 < n; i += 2) {
+         *out++ = v[i + 0];
+         *out++ = v[i + 1];
+         *out++ = v[i + 3];
+         *out++ = v[i + 2];
+         *out++ = v[i + 0];
+         *out++ = v[i + 3];
+      }
+      break;
+   default:
+      assert(0);
+   }
+
+   return out;
+}
+
+
+/**
+ * Map each vertex of the list to the first vertex with the same contents.
+ */
+static GLboolean
+find_unique_vertices(const GLfloat *buffer, GLuint count, GLuint vertex_size,
+                     GLushort *remap)
+{
+   const GLuint *words = (const GLuint *) buffer;
+   GLuint table_size = 64;
+   GLuint *table;
+   GLuint i, j;
+
+   while (table_size < 2 * count)
+      table_size *= 2;
+
+   /* Slots hold the vertex number + 1, or 0 if empty */
+   table = calloc(table_size, sizeof(GLuint));
+   if (!table)
+      return GL_FALSE;
+
+   for (i = 0; i < count; i++) {
+      const GLuint *vert = words + i * vertex_size;
+      GLuint hash = 2166136261u;
+      GLuint slot;
+
+      for (j = 0; j < vertex_size; j++)
+         hash = (hash ^ vert[j]) * 16777619u;
+
+      for (slot = hash & (table_size - 1); ;
+           slot = (slot + 1) & (table_size - 1)) {
+         if (!table[slot]) {
+            table[slot] = i + 1;
+            remap[i] = i;
+            break;
+         }
+         if (memcmp(words + (table[slot] - 1) * vertex_size, vert,
+                    vertex_size * sizeof(GLuint)) == 0) {
+            remap[i] = table[slot] - 1;
+            break;
+         }
+      }
+   }
+
+   free(table);
+   return GL_TRUE;
+}
+
+
+/**
+ * Lists of many small glBegin/End primitives would otherwise take one draw
+ * per primitive on playback.  Build the indexed version of the list, with
+ * each run of primitives that can be drawn as points, lines or triangles
+ * merged into one, and store the indices in a buffer object of their own.
+ *
+ * The vertices themselves stay where they are, so that the list can still
+ * be drawn as it was recorded, or looped back, when the merged primitives
+ * would look different.
+ */
+static void
+build_merged_prims(struct gl_context *ctx, struct vbo_save_vertex_list *node,
+                   const GLfloat *buffer)
+{
+   struct _mesa_prim *merged;
+   struct gl_buffer_object *obj;
+   GLushort *remap, *indices, *out;
+   GLuint num_indices = 0, num_merged = 0;
+   GLenum mode = GL_NONE;
+   GLuint i;
+
+   if (node->prim_count < 2 || node->count == 0)
+      return;
+
+   /* Indices are GLushorts */
+   STATIC_ASSERT(VBO_SAVE_BUFFER_SIZE <= 65536);
+
+   for (i = 0; i < node->prim_count; i++) {
+      const struct _mesa_prim *prim = &node->prim[i];
+      const GLenum prim_mode = merged_prim_mode(prim);
+
+      if (prim_mode == GL_NONE || prim->num_instances != 1)
+         return;
+
+      if (prim_mode != mode) {
+         mode = prim_mode;
+         num_merged++;
+      }
+      num_indices += merged_index_count(prim->mode, prim->count);
+   }
+
+   if (num_merged >= node->prim_count || num_indices == 0)
+      return;
+
+   merged = malloc(num_merged * sizeof(*merged));
+   remap = malloc(node->count * sizeof(GLushort));
+   indices = malloc(num_indices * sizeof(GLushort));
+   if (!merged || !remap || !indices ||
+       !find_unique_vertices(buffer, node->count, node->vertex_size, remap))
+      goto fail;
+
+   out = indices;
+   num_merged = 0;
+   mode = GL_NONE;
+   for (i = 0; i < node->prim_count; i++) {
+      const struct _mesa_prim *prim = &node->prim[i];
+      const GLenum prim_mode = merged_prim_mode(prim);
+      struct _mesa_prim *m;
+
+      if (prim_mode != mode) {
+         mode = prim_mode;
+         m = &merged[num_merged++];
+         memset(m, 0, sizeof(*m));
+         m->mode = mode;
+         m->indexed = 1;
+         m->begin = prim->begin;
+         m->weak = prim->weak;
+         m->no_current_update = prim->no_current_update;
+         m->start = out - indices;
+         m->num_instances = 1;
+      }
+
+      m = &merged[num_merged - 1];
+      out = emit_merged_indices(out, prim, remap);
+      m->count = (out - indices) - m->start;
+      m->end = prim->end;
+   }
+   assert(out - indices == num_indices);
+
+   obj = ctx->Driver.NewBufferObject(ctx, VBO_BUF_ID,
+                                     GL_ELEMENT_ARRAY_BUFFER_ARB);
+   if (!obj)
+      goto fail;
+
+   if (!ctx->Driver.BufferData(ctx, GL_ELEMENT_ARRAY_BUFFER_ARB,
+                               num_indices * sizeof(GLushort), indices,
+                               GL_STATIC_DRAW_ARB, GL_DYNAMIC_STORAGE_BIT,
+                               obj)) {
+      _mesa_reference_buffer_object(ctx, &obj, NULL);
+      goto fail;
+   }
+
+   node->merged_prim = merged;
+   node->merged_prim_count = num_merged;
+   node->merged_ib.count = num_indices;
+   node->merged_ib.type = GL_UNSIGNED_SHORT;
+   node->merged_ib.obj = obj;
+   node->merged_ib.ptr = NULL;
+
+   free(remap);
+   free(indices);
+   return;
+
+fail:
+   /* Not an error, the list is just drawn as recorded */
+   free(merged);
+   free(remap);
+   free(indices);
+}
+
+
 /**
  * Insert the active immediate struct onto the display list currently
  * being built.
@@ -394,6 +700,9 @@ _save_compile_vertex_list(struct gl_context *ctx)
    node->dangling_attr_ref = save->dangling_attr_ref;
    node->prim = save->prim;
    node->prim_count = save->prim_count;
+   node->merged_prim = NULL;
+   node->merged_prim_count = 0;
+   memset(&node->merged_ib, 0, sizeof(node->merged_ib));
    node->vertex_store = save->vertex_store;
    node->prim_store = save->prim_store;
 
@@ -443,6 +752,9 @@ _save_compile_vertex_list(struct gl_context *ctx)
 
    merge_prims(ctx, node->prim, &node->prim_count);
 
+   if (!save->out_of_memory)
+      build_merged_prims(ctx, node, save->buffer);
+
    /* Deal with GL_COMPILE_AND_EXECUTE:
     */
    if (ctx->ExecuteFlag) {
@@ -1521,6 +1833,10 @@ vbo_destroy_vertex_list(struct gl_context *ctx, void *data)
 
    free(node->current_data);
    node->current_data = NULL;
+
+   free(node->merged_prim);
+   node->merged_prim = NULL;
+   _mesa_reference_buffer_object(ctx, &node->merged_ib.obj, NULL);
 }
 
 
@@ -1545,6 +1861,10 @@ vbo_print_vertex_list(struct gl_context *ctx, void *data)
              (prim->begin) ? "BEGIN" : "(wrap)",
              (prim->end) ? "END" : "(wrap)");
    }
+   if (node->merged_prim) {
+      printf("   merged into %d indexed primitives, %u indices\n",
+             node->merged_prim_count, node->merged_ib.count);
+   }
 }
 
 
@@ -34,6 +34,7 @@
 #include "main/macros.h"
 #include "main/light.h"
 #include "main/state.h"
+#include "main/transformfeedback.h"
 
 #include "vbo_context.h"
 
@@ -241,6 +242,34 @@ vbo_save_loopback_vertex_list(struct gl_context *ctx,
 }
 
 
+/**
+ * Whether the merged, indexed primitives of a vertex list draw the same as
+ * the recorded ones with the current state.  The conversion to lines and
+ * triangles shows through line stipple, polygon modes other than GL_FILL,
+ * the first vertex convention (which flat varyings of a GLSL program use
+ * regardless of the shade model), transform feedback, geometry shaders and
+ * gl_PrimitiveID, and the indices could hit a primitive restart index.
+ * The merged vertices are also deduplicated, which renumbers gl_VertexID.
+ */
+static GLboolean
+can_draw_merged_prims(const struct gl_context *ctx)
+{
+   const struct gl_vertex_program *vp = ctx->VertexProgram._Current;
+   const struct gl_fragment_program *fp = ctx->FragmentProgram._Current;
+
+   return !ctx->Array._PrimitiveRestart &&
+          !ctx->Line.StippleFlag &&
+          ctx->Polygon.FrontMode == GL_FILL &&
+          ctx->Polygon.BackMode == GL_FILL &&
+          ctx->Light.ProvokingVertex == GL_LAST_VERTEX_CONVENTION_EXT &&
+          !_mesa_is_xfb_active_and_unpaused(ctx) &&
+          !ctx->GeometryProgram._Current &&
+          !(vp && (vp->Base.SystemValuesRead &
+                   BITFIELD64_BIT(SYSTEM_VALUE_VERTEX_ID))) &&
+          !(fp && (fp->Base.InputsRead & VARYING_BIT_PRIMITIVE_ID));
+}
+
+
 /**
  * Execute the buffer and save copied verts.
  * This is called from the display list code when executing
@@ -307,7 +336,17 @@ vbo_save_playback_vertex_list(struct gl_context *ctx, void *data)
       if (ctx->NewState)
 	 _mesa_update_state( ctx );
 
-      if (node->count > 0) {
+      if (node->merged_prim && can_draw_merged_prims(ctx)) {
+         vbo_context(ctx)->draw_prims(ctx,
+                                      node->merged_prim,
+                                      node->merged_prim_count,
+                                      &node->merged_ib,
+                                      GL_TRUE,
+                                      0,
+                                      node->count - 1,
+                                      NULL, NULL);
+      }
+      else if (node->count > 0) {
          vbo_context(ctx)->draw_prims(ctx, 
                                       node->prim,
                                       node->prim_count,
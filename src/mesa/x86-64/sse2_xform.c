@@ -0,0 +1,447 @@
+/*
+ * Mesa 3-D graphics library
+ *
+ * Copyright (C) 2014  The Mesa Authors   All Rights Reserved.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+ * OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL
+ * THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR
+ * OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE,
+ * ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+ * OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*
+ * SSE2 intrinsics versions of the point transform, normal transform and
+ * clip test functions in math/m_xform_tmp.h, m_norm_tmp.h and
+ * m_clip_tmp.h, for x86-64 where SSE2 is always available.
+ *
+ * Each vertex is handled as one 4-wide vector.  The arithmetic is done
+ * in the same order as the C versions so that the results are
+ * bit-identical to them, which keeps software rendering output the same
+ * whichever set of functions is installed.
+ */
+
+#include "main/glheader.h"
+#include "main/macros.h"
+#include "math/m_matrix.h"
+#include "math/m_xform.h"
+#include "x86-64.h"
+
+#if defined(USE_X86_64_ASM) && defined(__SSE2__)
+
+#include <emmintrin.h>
+
+/* The generic kernels below are instantiated for each vector size and
+ * matrix type; make sure they are actually specialized.
+ */
+#define SPECIALIZE static inline __attribute__((always_inline))
+
+
+static inline __m128
+load3(const GLfloat *p)
+{
+   const __m128 xy = _mm_castpd_ps(_mm_load_sd((const double *) p));
+   return _mm_movelh_ps(xy, _mm_load_ss(p + 2));
+}
+
+/** Load the first \p n components of a point, without reading past them */
+static inline __m128
+load_n(const GLfloat *p, GLuint n)
+{
+   switch (n) {
+   case 1:
+      return _mm_load_ss(p);
+   case 2:
+      return _mm_castpd_ps(_mm_load_sd((const double *) p));
+   case 3:
+      return load3(p);
+   default:
+      return _mm_loadu_ps(p);
+   }
+}
+
+#define SPLAT(v, n) _mm_shuffle_ps(v, v, _MM_SHUFFLE(n, n, n, n))
+
+static inline void
+store3(GLfloat *p, __m128 v)
+{
+   _mm_storel_pi((__m64 *) p, v);
+   _mm_store_ss(p + 2, _mm_movehl_ps(v, v));
+}
+
+
+/**********************************************************************
+ * Point transformation
+ *
+ * Only the general and 3D matrix types, where every output component
+ * is a full dot product, are done here.  For the sparser matrix types
+ * the C functions do so little arithmetic per vertex that a vector
+ * version which reproduces their results exactly is no faster, and
+ * 4-component points are left to xform4.S.
+ */
+
+/**
+ * Transform a vector of \p size component points, size < 4, by a
+ * general (\p is_3d false) or 3D matrix.  Each output component is
+ * summed in the order m0 * x + m4 * y + m8 * z + m12, like the C code.
+ */
+SPECIALIZE void
+transform_points(GLvector4f *to_vec, const GLfloat m[16],
+                 const GLvector4f *from_vec, const GLuint size,
+                 const GLboolean is_3d)
+{
+   const GLuint stride = from_vec->stride;
+   const GLfloat *from = from_vec->start;
+   GLfloat (*to)[4] = (GLfloat (*)[4]) to_vec->start;
+   const GLuint count = from_vec->count;
+   const __m128 c0 = _mm_loadu_ps(m);
+   const __m128 c1 = _mm_loadu_ps(m + 4);
+   const __m128 c2 = _mm_loadu_ps(m + 8);
+   const __m128 c3 = _mm_loadu_ps(m + 12);
+   GLuint i;
+
+   for (i = 0; i < count; i++, STRIDE_F(from, stride)) {
+      const __m128 v = load_n(from, size);
+      __m128 r = _mm_mul_ps(c0, SPLAT(v, 0));
+      if (size > 1)
+         r = _mm_add_ps(r, _mm_mul_ps(c1, SPLAT(v, 1)));
+      if (size > 2)
+         r = _mm_add_ps(r, _mm_mul_ps(c2, SPLAT(v, 2)));
+      r = _mm_add_ps(r, c3);
+
+      if (is_3d)
+         store3(to[i], r);
+      else
+         _mm_storeu_ps(to[i], r);
+   }
+
+   if (is_3d) {
+      to_vec->size = 3;
+      to_vec->flags |= VEC_SIZE_3;
+   }
+   else {
+      to_vec->size = 4;
+      to_vec->flags |= VEC_SIZE_4;
+   }
+   to_vec->count = from_vec->count;
+}
+
+
+#define XFORM_FUNC(size, name, is_3d)                                   \
+static void                                                             \
+transform_points##size##_##name(GLvector4f *to_vec, const GLfloat m[16], \
+                                const GLvector4f *from_vec)             \
+{                                                                       \
+   transform_points(to_vec, m, from_vec, size, is_3d);                  \
+}
+
+XFORM_FUNC(1, general, GL_FALSE)
+XFORM_FUNC(2, general, GL_FALSE)
+XFORM_FUNC(1, 3d, GL_TRUE)
+XFORM_FUNC(2, 3d, GL_TRUE)
+XFORM_FUNC(3, 3d, GL_TRUE)
+
+
+/**********************************************************************
+ * Normal transformation
+ *
+ * As above, only the cases with a full 3x3 matrix are worth doing here.
+ */
+
+/** The upper 3x3 of the inverse matrix, transposed and scaled */
+static inline void
+normal_columns(const GLfloat *m, GLfloat scale, __m128 c[3])
+{
+   c[0] = _mm_setr_ps(scale * m[0], scale * m[4], scale * m[8], 0.0F);
+   c[1] = _mm_setr_ps(scale * m[1], scale * m[5], scale * m[9], 0.0F);
+   c[2] = _mm_setr_ps(scale * m[2], scale * m[6], scale * m[10], 0.0F);
+}
+
+static inline __m128
+transform_normal(const __m128 c[3], const GLfloat *from)
+{
+   const __m128 v = load3(from);
+
+   return _mm_add_ps(_mm_add_ps(_mm_mul_ps(SPLAT(v, 0), c[0]),
+                                _mm_mul_ps(SPLAT(v, 1), c[1])),
+                     _mm_mul_ps(SPLAT(v, 2), c[2]));
+}
+
+/** x*x + y*y + z*z, summed in that order */
+static inline __m128
+dot3_ss(__m128 v)
+{
+   const __m128 sq = _mm_mul_ps(v, v);
+   return _mm_add_ss(_mm_add_ss(sq, _mm_shuffle_ps(sq, sq, 1)),
+                     _mm_movehl_ps(sq, sq));
+}
+
+SPECIALIZE void
+transform_normals_common(const GLmatrix *mat, GLfloat scale,
+                         const GLvector4f *in, const GLfloat *lengths,
+                         GLvector4f *dest, GLboolean normalize)
+{
+   GLfloat (*out)[4] = (GLfloat (*)[4]) dest->start;
+   const GLfloat *from = in->start;
+   const GLuint stride = in->stride;
+   const GLuint count = in->count;
+   __m128 c[3];
+   GLuint i;
+
+   normal_columns(mat->inv, scale, c);
+
+   if (normalize && lengths) {
+      for (i = 0; i < count; i++, STRIDE_F(from, stride)) {
+         const __m128 t = transform_normal(c, from);
+         store3(out[i], _mm_mul_ps(t, _mm_set1_ps(lengths[i])));
+      }
+   }
+   else if (normalize) {
+      for (i = 0; i < count; i++, STRIDE_F(from, stride)) {
+         const __m128 t = transform_normal(c, from);
+         const __m128 len = dot3_ss(t);
+
+         if ((GLdouble) _mm_cvtss_f32(len) > 1e-20) {
+            __m128 s = _mm_div_ss(_mm_set_ss(1.0F), _mm_sqrt_ss(len));
+            s = _mm_shuffle_ps(s, s, 0);
+            store3(out[i], _mm_mul_ps(t, s));
+         }
+         else {
+            store3(out[i], _mm_setzero_ps());
+         }
+      }
+   }
+   else {
+      for (i = 0; i < count; i++, STRIDE_F(from, stride))
+         store3(out[i], transform_normal(c, from));
+   }
+   dest->count = in->count;
+}
+
+static void
+transform_normals(const GLmatrix *mat, GLfloat scale, const GLvector4f *in,
+                  const GLfloat *lengths, GLvector4f *dest)
+{
+   (void) scale;
+   transform_normals_common(mat, 1.0F, in, lengths, dest, GL_FALSE);
+}
+
+static void
+transform_rescale_normals(const GLmatrix *mat, GLfloat scale,
+                          const GLvector4f *in, const GLfloat *lengths,
+                          GLvector4f *dest)
+{
+   transform_normals_common(mat, scale, in, lengths, dest, GL_FALSE);
+}
+
+static void
+transform_normalize_normals(const GLmatrix *mat, GLfloat scale,
+                            const GLvector4f *in, const GLfloat *lengths,
+                            GLvector4f *dest)
+{
+   /* Like the C version, the scale only applies with precomputed lengths */
+   transform_normals_common(mat, lengths ? scale : 1.0F, in, lengths, dest,
+                            GL_TRUE);
+}
+
+
+/**********************************************************************
+ * Clip testing
+ */
+
+/* Outcode bits for the x, y and z components of (w - v) < 0, or v > 1,
+ * and of (w + v) < 0, or v < -1.
+ */
+static const GLubyte clip_pos_bits[8] = {
+   0,
+   CLIP_RIGHT_BIT,
+   CLIP_TOP_BIT,
+   CLIP_RIGHT_BIT | CLIP_TOP_BIT,
+   CLIP_FAR_BIT,
+   CLIP_RIGHT_BIT | CLIP_FAR_BIT,
+   CLIP_TOP_BIT | CLIP_FAR_BIT,
+   CLIP_RIGHT_BIT | CLIP_TOP_BIT | CLIP_FAR_BIT
+};
+
+static const GLubyte clip_neg_bits[8] = {
+   0,
+   CLIP_LEFT_BIT,
+   CLIP_BOTTOM_BIT,
+   CLIP_LEFT_BIT | CLIP_BOTTOM_BIT,
+   CLIP_NEAR_BIT,
+   CLIP_LEFT_BIT | CLIP_NEAR_BIT,
+   CLIP_BOTTOM_BIT | CLIP_NEAR_BIT,
+   CLIP_LEFT_BIT | CLIP_BOTTOM_BIT | CLIP_NEAR_BIT
+};
+
+SPECIALIZE GLvector4f *
+cliptest_points4_common(GLvector4f *clip_vec, GLvector4f *proj_vec,
+                        GLubyte clipMask[], GLubyte *orMask,
+                        GLubyte *andMask, GLboolean viewport_z_clip,
+                        GLboolean project)
+{
+   const GLuint stride = clip_vec->stride;
+   const GLfloat *from = (GLfloat *) clip_vec->start;
+   const GLuint count = clip_vec->count;
+   GLfloat (*vProj)[4] = (GLfloat (*)[4]) proj_vec->start;
+   const int bits = viewport_z_clip ? 0x7 : 0x3;
+   const __m128 zero = _mm_setzero_ps();
+   const __m128 one = _mm_set1_ps(1.0F);
+   const __m128 clipped = _mm_setr_ps(0.0F, 0.0F, 0.0F, 1.0F);
+   GLubyte tmpAndMask = *andMask;
+   GLubyte tmpOrMask = *orMask;
+   GLuint c = 0;
+   GLuint i;
+
+   for (i = 0; i < count; i++, STRIDE_F(from, stride)) {
+      const __m128 v = _mm_loadu_ps(from);
+      const __m128 w = _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3));
+      const int pos = _mm_movemask_ps(_mm_cmplt_ps(_mm_sub_ps(w, v), zero));
+      const int neg = _mm_movemask_ps(_mm_cmplt_ps(_mm_add_ps(w, v), zero));
+      const GLubyte mask = clip_pos_bits[pos & bits] |
+                           clip_neg_bits[neg & bits];
+
+      clipMask[i] = mask;
+      if (mask) {
+         c++;
+         tmpAndMask &= mask;
+         tmpOrMask |= mask;
+         if (project)
+            _mm_storeu_ps(vProj[i], clipped);
+      }
+      else if (project) {
+         const __m128 oow = _mm_div_ps(one, w);
+         _mm_storeu_ps(vProj[i], _mm_mul_ps(v, oow));
+         _mm_store_ss(&vProj[i][3], oow);
+      }
+   }
+
+   *orMask = tmpOrMask;
+   *andMask = (GLubyte) (c < count ? 0 : tmpAndMask);
+
+   if (project) {
+      proj_vec->flags |= VEC_SIZE_4;
+      proj_vec->size = 4;
+      proj_vec->count = clip_vec->count;
+      return proj_vec;
+   }
+   return clip_vec;
+}
+
+static GLvector4f *
+cliptest_points4(GLvector4f *clip_vec, GLvector4f *proj_vec,
+                 GLubyte clipMask[], GLubyte *orMask, GLubyte *andMask,
+                 GLboolean viewport_z_clip)
+{
+   return cliptest_points4_common(clip_vec, proj_vec, clipMask, orMask,
+                                  andMask, viewport_z_clip, GL_TRUE);
+}
+
+static GLvector4f *
+cliptest_np_points4(GLvector4f *clip_vec, GLvector4f *proj_vec,
+                    GLubyte clipMask[], GLubyte *orMask, GLubyte *andMask,
+                    GLboolean viewport_z_clip)
+{
+   return cliptest_points4_common(clip_vec, proj_vec, clipMask, orMask,
+                                  andMask, viewport_z_clip, GL_FALSE);
+}
+
+SPECIALIZE GLvector4f *
+cliptest_points_ndc(GLvector4f *clip_vec, GLubyte clipMask[],
+                    GLubyte *orMask, GLubyte *andMask,
+                    GLboolean viewport_z_clip, const GLuint size)
+{
+   const GLuint stride = clip_vec->stride;
+   const GLuint count = clip_vec->count;
+   const GLfloat *from = (GLfloat *) clip_vec->start;
+   const int bits = size == 3 && viewport_z_clip ? 0x7 : 0x3;
+   const __m128 one = _mm_set1_ps(1.0F);
+   const __m128 minus_one = _mm_set1_ps(-1.0F);
+   GLubyte tmpOrMask = *orMask;
+   GLubyte tmpAndMask = *andMask;
+   GLuint i;
+
+   for (i = 0; i < count; i++, STRIDE_F(from, stride)) {
+      const __m128 v = size == 3 ? load3(from) :
+         _mm_castpd_ps(_mm_load_sd((const double *) from));
+      const int pos = _mm_movemask_ps(_mm_cmpgt_ps(v, one));
+      const int neg = _mm_movemask_ps(_mm_cmplt_ps(v, minus_one));
+      const GLubyte mask = clip_pos_bits[pos & bits] |
+                           clip_neg_bits[neg & bits];
+
+      clipMask[i] = mask;
+      tmpOrMask |= mask;
+      tmpAndMask &= mask;
+   }
+
+   *orMask = tmpOrMask;
+   *andMask = tmpAndMask;
+   return clip_vec;
+}
+
+static GLvector4f *
+cliptest_points3(GLvector4f *clip_vec, GLvector4f *proj_vec,
+                 GLubyte clipMask[], GLubyte *orMask, GLubyte *andMask,
+                 GLboolean viewport_z_clip)
+{
+   (void) proj_vec;
+   return cliptest_points_ndc(clip_vec, clipMask, orMask, andMask,
+                              viewport_z_clip, 3);
+}
+
+static GLvector4f *
+cliptest_points2(GLvector4f *clip_vec, GLvector4f *proj_vec,
+                 GLubyte clipMask[], GLubyte *orMask, GLubyte *andMask,
+                 GLboolean viewport_z_clip)
+{
+   (void) proj_vec;
+   return cliptest_points_ndc(clip_vec, clipMask, orMask, andMask,
+                              viewport_z_clip, 2);
+}
+
+
+void
+_mesa_init_x86_64_sse2_transform(void)
+{
+   _mesa_transform_tab[1][MATRIX_GENERAL] = transform_points1_general;
+   _mesa_transform_tab[2][MATRIX_GENERAL] = transform_points2_general;
+   _mesa_transform_tab[1][MATRIX_3D] = transform_points1_3d;
+   _mesa_transform_tab[2][MATRIX_3D] = transform_points2_3d;
+   _mesa_transform_tab[3][MATRIX_3D] = transform_points3_3d;
+
+   _mesa_normal_tab[NORM_TRANSFORM] =
+      transform_normals;
+   _mesa_normal_tab[NORM_TRANSFORM | NORM_RESCALE] =
+      transform_rescale_normals;
+   _mesa_normal_tab[NORM_TRANSFORM | NORM_NORMALIZE] =
+      transform_normalize_normals;
+
+   _mesa_clip_tab[4] = cliptest_points4;
+   _mesa_clip_tab[3] = cliptest_points3;
+   _mesa_clip_tab[2] = cliptest_points2;
+
+   _mesa_clip_np_tab[4] = cliptest_np_points4;
+   _mesa_clip_np_tab[3] = cliptest_points3;
+   _mesa_clip_np_tab[2] = cliptest_points2;
+}
+
+#else
+
+void
+_mesa_init_x86_64_sse2_transform(void)
+{
+}
+
+#endif
@@ -108,7 +108,9 @@ void _mesa_init_all_x86_64_transform_asm(void)
 
    }
 
-   
+   message("Installing SSE2 transform, normal and clip test functions\n");
+   _mesa_init_x86_64_sse2_transform();
+
 #ifdef DEBUG_MATH
    _math_test_all_transform_functions("x86_64");
    _math_test_all_cliptest_functions("x86_64");
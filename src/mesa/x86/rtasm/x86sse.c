@@ -1,5 +1,6 @@
-#ifdef USE_X86_ASM
-#if defined(__i386__) || defined(__386__)
+#if defined(USE_X86_ASM) || defined(USE_X86_64_ASM)
+#if defined(__i386__) || defined(__386__) || \
+    (defined(__x86_64__) && !defined(_WIN64))
 
 #include "main/imports.h"
 #include "x86sse.h"
@@ -314,7 +315,7 @@ void x86_push( struct x86_function *p,
 {
    assert(reg.mod == mod_REG);
    emit_1ub(p, 0x50 + reg.idx);
-   p->stack_offset += 4;
+   p->stack_offset += sizeof(void *);
 }
 
 void x86_pop( struct x86_function *p,
@@ -322,21 +323,46 @@ void x86_pop( struct x86_function *p,
 {
    assert(reg.mod == mod_REG);
    emit_1ub(p, 0x58 + reg.idx);
-   p->stack_offset -= 4;
+   p->stack_offset -= sizeof(void *);
 }
 
+/* The one byte inc/dec encodings are REX prefixes on x86-64, use the
+ * modrm forms there.
+ */
 void x86_inc( struct x86_function *p,
 	      struct x86_reg reg )
 {
    assert(reg.mod == mod_REG);
+#ifdef __x86_64__
+   emit_1ub(p, 0xff);
+   emit_modrm_noreg(p, 0, reg);
+#else
    emit_1ub(p, 0x40 + reg.idx);
+#endif
 }
 
 void x86_dec( struct x86_function *p,
 	      struct x86_reg reg )
 {
    assert(reg.mod == mod_REG);
+#ifdef __x86_64__
+   emit_1ub(p, 0xff);
+   emit_modrm_noreg(p, 1, reg);
+#else
    emit_1ub(p, 0x48 + reg.idx);
+#endif
+}
+
+/* Make the following instruction operate on 64 bit registers, for
+ * pointer arithmetic.  A no-op on 32 bit x86.
+ */
+void x64_rexw( struct x86_function *p )
+{
+#ifdef __x86_64__
+   emit_1ub(p, 0x48);
+#else
+   (void) p;
+#endif
 }
 
 void x86_ret( struct x86_function *p )
@@ -1152,8 +1178,23 @@ void mmx_movq( struct x86_function *p,
 struct x86_reg x86_fn_arg( struct x86_function *p,
 			   unsigned arg )
 {
+#ifdef __x86_64__
+   /* System V ABI, the first four integer arguments are in registers.
+    * Only the ones that don't need a REX prefix are supported.  Win64
+    * passes them in other registers and has other callee-saved ones,
+    * this file isn't built there.
+    */
+   static const enum x86_reg_name regs[4] = {
+      reg_DI, reg_SI, reg_DX, reg_CX
+   };
+
+   (void) p;
+   assert(arg >= 1 && arg <= 4);
+   return x86_make_reg(file_REG32, regs[arg - 1]);
+#else
    return x86_make_disp(x86_make_reg(file_REG32, reg_SP), 
 			p->stack_offset + arg * 4);	/* ??? */
+#endif
 }
 
 
@@ -1196,8 +1237,8 @@ void x86sse_dummy( void )
 
 #endif
 
-#else  /* USE_X86_ASM */
+#else  /* USE_X86_ASM || USE_X86_64_ASM */
 
 int x86sse_c_dummy_var; /* silence warning */
 
-#endif /* USE_X86_ASM */
+#endif /* USE_X86_ASM || USE_X86_64_ASM */
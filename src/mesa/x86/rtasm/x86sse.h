@@ -2,7 +2,11 @@
 #ifndef _X86SSE_H_
 #define _X86SSE_H_
 
-#if defined(__i386__) || defined(__386__)
+/* On x86-64 only the System V calling convention is supported, see
+ * x86_fn_arg(), so there is no Win64 version.
+ */
+#if defined(__i386__) || defined(__386__) || \
+    (defined(__x86_64__) && !defined(_WIN64))
 
 /* It is up to the caller to ensure that instructions issued are
  * suitable for the host cpu.  There are no checks made in this module
@@ -193,6 +197,7 @@ void x86_or( struct x86_function *p, struct x86_reg dst, struct x86_reg src );
 void x86_pop( struct x86_function *p, struct x86_reg reg );
 void x86_push( struct x86_function *p, struct x86_reg reg );
 void x86_ret( struct x86_function *p );
+void x64_rexw( struct x86_function *p );
 void x86_sub( struct x86_function *p, struct x86_reg dst, struct x86_reg src );
 void x86_test( struct x86_function *p, struct x86_reg dst, struct x86_reg src );
 void x86_xor( struct x86_function *p, struct x86_reg dst, struct x86_reg src );
@@ -248,7 +253,8 @@ void x87_fucom( struct x86_function *p, struct x86_reg arg );
 
 /* Retreive a reference to one of the function arguments, taking into
  * account any push/pop activity.  Note - doesn't track explict
- * manipulation of ESP by other instructions.
+ * manipulation of ESP by other instructions.  On x86-64 this is the
+ * argument's register.
  */
 struct x86_reg x86_fn_arg( struct x86_function *p, unsigned arg );
 